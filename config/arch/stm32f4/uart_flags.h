@@ -288,6 +288,83 @@ this:AddItem("4000000", "")
 --*/
 #define __UART_DEFAULT_BAUD__ 115200
 
+
+/*--
+this:AddExtraWidget("Label", "LabelDMA", "\nDMA Configuration (Rx)", -1, "bold")
+this:AddExtraWidget("Void", "VoidDMA")
+++*/
+/*--
+if this:PortExist(1) then
+    this:AddWidget("Combobox", "UART1 Rx DMA")
+    this:AddItem("No", "_NO_")
+    this:AddItem("Yes", "_YES_")
+end
+--*/
+#define __UART_UART1_RX_DMA__ _NO_
+
+/*--
+if this:PortExist(2) then
+    this:AddWidget("Combobox", "UART2 Rx DMA")
+    this:AddItem("No", "_NO_")
+    this:AddItem("Yes", "_YES_")
+end
+--*/
+#define __UART_UART2_RX_DMA__ _NO_
+
+/*--
+if this:PortExist(3) then
+    this:AddWidget("Combobox", "UART3 Rx DMA")
+    this:AddItem("No", "_NO_")
+    this:AddItem("Yes", "_YES_")
+end
+--*/
+#define __UART_UART3_RX_DMA__ _NO_
+
+/*--
+if this:PortExist(4) then
+    this:AddWidget("Combobox", "UART4 Rx DMA")
+    this:AddItem("No", "_NO_")
+    this:AddItem("Yes", "_YES_")
+end
+--*/
+#define __UART_UART4_RX_DMA__ _NO_
+
+/*--
+if this:PortExist(5) then
+    this:AddWidget("Combobox", "UART5 Rx DMA")
+    this:AddItem("No", "_NO_")
+    this:AddItem("Yes", "_YES_")
+end
+--*/
+#define __UART_UART5_RX_DMA__ _NO_
+
+/*--
+if this:PortExist(6) then
+    this:AddWidget("Combobox", "UART6 Rx DMA")
+    this:AddItem("No", "_NO_")
+    this:AddItem("Yes", "_YES_")
+end
+--*/
+#define __UART_UART6_RX_DMA__ _NO_
+
+/*--
+if this:PortExist(7) then
+    this:AddWidget("Combobox", "UART7 Rx DMA")
+    this:AddItem("No", "_NO_")
+    this:AddItem("Yes", "_YES_")
+end
+--*/
+#define __UART_UART7_RX_DMA__ _NO_
+
+/*--
+if this:PortExist(8) then
+    this:AddWidget("Combobox", "UART8 Rx DMA")
+    this:AddItem("No", "_NO_")
+    this:AddItem("Yes", "_YES_")
+end
+--*/
+#define __UART_UART8_RX_DMA__ _NO_
+
 #endif /* _UART_FLAGS_H_ */
 /*==============================================================================
   End of file
@@ -40,7 +40,7 @@ this:SetLayout("TitledGridBack", 2, "Home > File Systems > ramfs",
 ++*/
 
 /*--
-this:AddWidget("Spinbox", 8, 2048, "File chain size (bytes)")
+this:AddWidget("Spinbox", 8, 2048, "File chunk size (bytes)")
 --*/
 #define __RAMFS_FILE_CHAIN_SIZE__ 32
 
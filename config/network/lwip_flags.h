@@ -682,6 +682,21 @@ this:AddWidget("Spinbox", 0, 100, "LWIP_LOOPBACK_MAX_PBUFS")
 this:SetToolTip("LWIP_LOOPBACK_MAX_PBUFS: Maximum number of pbufs\non queue for loopback sending for each netif (0 = disabled).")
 --*/
 #define __NETWORK_LWIP_LOOPBACK_MAX_PBUFS__ 0
+/*--
+this:AddWidget("Combobox", "Zero-copy interface")
+this:AddItem("Disable (0)", "0")
+this:AddItem("Enable (1)", "1")
+this:SetToolTip("Zero-copy interface: Ethernet DMA receives packets directly to\n"..
+                "pre-allocated custom pbufs and transmits packets directly from\n"..
+                "pbuf payloads. Received packets are drained in batches.")
+--*/
+#define __NETWORK_NETIF_ZERO_COPY__ 0
+/*--
+this:AddWidget("Spinbox", 2, 64, "Zero-copy Rx buffers")
+this:SetToolTip("Number of pre-allocated Rx pbufs (Ethernet frame size each)\n"..
+                "used by zero-copy interface.")
+--*/
+#define __NETWORK_NETIF_ZERO_COPY_RX_BUFFERS__ 8
 
 
 /*------------------------------------------------------------------------------
@@ -95,9 +95,10 @@ this:SetToolTip("Number of threads that can be started by user process.")
 this:AddWidget("Combobox", "Mode of kworker syscall threads")
 this:AddItem("Automatic syscall thread allocation", "0")
 this:AddItem("Fixed number of syscall threads", "1")
-this:SetToolTip("When 'Automatic syscall thread allocation' is enabled then system creates\n"..
-                "syscall threads on demand. This option is slow but if system usage is\n"..
-                "not too intense then this option can limit RAM usage (peek usage can be high).\n\n"..
+this:SetToolTip("When 'Automatic syscall thread allocation' is enabled then system keeps\n"..
+                "a pool of syscall threads that grows on demand up to the maximum number of\n"..
+                "kworker threads. Threads that are idle longer than the idle time are\n"..
+                "finished. This option can limit RAM usage (peek usage can be high).\n\n"..
                 "When 'Fixed number of syscall threads' is used then user define how many\n"..
                 "syscall threads are created at system startup. This option provides\n"..
                 "the fastest response for syscalls but may use a lot of RAM.")
@@ -113,13 +114,22 @@ this:SetToolTip("Number of threads that can be started by system process.")
 /*--
 this:AddWidget("Spinbox", 1, 32, "Number of fixed I/O kworker threads")
 this:SetToolTip("Number of kworker threads for I/O syscall handling.\n"..
-                "Option valid only for 'Fixed number of syscall threads' mode.")
+                "In 'Automatic syscall thread allocation' mode this is the number\n"..
+                "of threads that are always running.")
 --*/
 #define __OS_TASK_KWORKER_IO_THREADS__ 2
 
+/*--
+this:AddWidget("Spinbox", 100, 60000, "Idle time of extra I/O kworker threads [ms]")
+this:SetToolTip("Extra I/O thread is finished when there is no request for this time.\n"..
+                "Option valid only for 'Automatic syscall thread allocation' mode.")
+--*/
+#define __OS_TASK_KWORKER_IDLE_TIME__ 5000
+
 
 
 /*--
+this:AddExtraWidget("Void", "VoidTaskEnd") -- number of upper widgets is odd
 this:AddExtraWidget("Label", "LabelFeatures", "\nSystem features (advanced)", -1, "bold")
 this:AddExtraWidget("Void", "VoidFeatures")
 ++*/
@@ -243,6 +253,24 @@ this:SetToolTip("If this option is selected then some file system are using cach
 --*/
 #define __OS_SYSTEM_FS_CACHE_ENABLE__ _NO_
 
+/*--
+this:AddWidget("Checkbox", "Kernel object pools")
+this:SetToolTip("If this option is selected then frequently used kernel objects (files,\n"..
+                "directories, mutexes, semaphores, list items, etc) are allocated from\n"..
+                "fixed-size object pools. The allocation is faster and there is no heap\n"..
+                "block overhead, but each pool reserves memory for a few objects\n"..
+                "at first use.")
+--*/
+#define __OS_SYSTEM_OBJECT_POOLS_ENABLE__ _YES_
+
+/*--
+this:AddWidget("Checkbox", "Syscall statistics")
+this:SetToolTip("If this option is selected then system collects number of calls and\n"..
+                "latency histogram of each syscall. Statistics are available in the\n"..
+                "/syscalls file of procfs. Each syscall uses 44 bytes of RAM.")
+--*/
+#define __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ _NO_
+
 /*--
 this:AddWidget("Checkbox", "Execute scripts")
 this:SetToolTip("If this option is enabled then system is able to run scripts with shebang (#!).")
@@ -250,7 +278,7 @@ this:SetToolTip("If this option is enabled then system is able to run scripts wi
 #define __OS_SYSTEM_SHEBANG_ENABLE__ _NO_
 
 /*--
-this:AddExtraWidget("Void", "VoidOption") -- uncomment if number of upper widgets is odd
+--this:AddExtraWidget("Void", "VoidOption") -- uncomment if number of upper widgets is odd
 this:AddExtraWidget("Label", "LabelSizes", "\nMemory parameters", -1, "bold")
 this:AddExtraWidget("Void", "VoidSizes")
 ++*/
@@ -262,7 +290,8 @@ this:SetToolTip("This value determines a size of buffer used in the particular s
 
 /*--
 this:AddWidget("Spinbox", 8, 1024, "Length of pipe buffer [bytes]")
-this:SetToolTip("This value determines a size of buffer used in the each pipe (FIFO file).")
+this:SetToolTip("This value determines a default size of buffer used in the each pipe (FIFO file).\n"..
+                "The buffer size of selected pipe can be changed by IOCTL_PIPE__SET_CAPACITY request.")
 --*/
 #define __OS_PIPE_LENGTH__ 8
 
@@ -273,7 +302,31 @@ this:SetToolTip("The allocation block size is a minimal memory block that can be
 #define __HEAP_BLOCK_SIZE__ 4
 
 /*--
---this:AddExtraWidget("Void", "VoidOption")
+this:AddWidget("Combobox", "Heap allocator")
+this:AddItem("First fit (the lowest RAM usage)", "0")
+this:AddItem("TLSF (constant allocation time)", "1")
+this:SetToolTip("This option selects the dynamic memory allocator algorithm.\n\n"..
+                "The 'First fit' allocator searches list of blocks starting from the\n"..
+                "lowest free block. The allocation time grows with heap fragmentation.\n\n"..
+                "The 'TLSF' (Two-Level Segregated Fit) allocator finds suitable free\n"..
+                "block in constant time by using segregated free lists. The allocator\n"..
+                "reduces fragmentation but uses a small part of each memory region\n"..
+                "for its control structure.")
+--*/
+#define __HEAP_ALLOCATOR__ 0
+
+/*--
+this:AddWidget("Spinbox", 0, 16384, "User heap arena chunk [bytes]")
+this:SetToolTip("Small objects (up to 128 bytes) allocated by malloc() family functions\n"..
+                "are served in the program context from per-process arena, without\n"..
+                "syscalls. The arena takes memory from the program heap in chunks of\n"..
+                "this size, chunks are released when program exits.\n"..
+                "Set 0 to disable the arena (minimal chunk size is 256 bytes).")
+--*/
+#define __OS_USER_HEAP_ARENA_CHUNK_SIZE__ 1024
+
+/*--
+this:AddExtraWidget("Void", "VoidOption")
 this:AddWidget("Spinbox", 1, 250, "System log columns")
 this:SetToolTip("This option determine how many characters in row can be stored. " ..
                 "Option is active when system log function is enabled.")
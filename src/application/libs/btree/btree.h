@@ -57,6 +57,10 @@ extern "C" {
 #define btree_foreach_reverse(type, element, btree_t__list)\
         _builtinfunc(btree_foreach_reverse, type, element, btree_t__list)
 
+// btree range foreach (objects in range [from, to])
+#define btree_foreach_range(type, element, btree_t__list, from, to)\
+        _builtinfunc(btree_foreach_range, type, element, btree_t__list, from, to)
+
 /*==============================================================================
   Exported object types
 ==============================================================================*/
@@ -233,6 +237,38 @@ static inline int btree_remove(btree_t *tree, void *data)
         return _builtinfunc(btree_remove, tree, data);
 }
 
+//==============================================================================
+/**
+ * @brief  Function return first object that is not less than key.
+ *
+ * @param  tree         BTree object
+ * @param  key          key to find (does not have to exist in tree)
+ * @param  ret          found object
+ *
+ * @return On success 0 is returned.
+ */
+//==============================================================================
+static inline int btree_lower_bound(btree_t *tree, void *key, void *ret)
+{
+        return _builtinfunc(btree_lower_bound, tree, key, ret);
+}
+
+//==============================================================================
+/**
+ * @brief  Function return first object that is greater than key.
+ *
+ * @param  tree         BTree object
+ * @param  key          key to find (does not have to exist in tree)
+ * @param  ret          found object
+ *
+ * @return On success 0 is returned.
+ */
+//==============================================================================
+static inline int btree_upper_bound(btree_t *tree, void *key, void *ret)
+{
+        return _builtinfunc(btree_upper_bound, tree, key, ret);
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -80,6 +80,7 @@ int_main(dmesg, STACK_DEPTH_LOW, int argc, char *argv[])
 {
         bool clear = false;
         bool loop  = false;
+        bool stat  = false;
 
         for (int i = 1; i < argc; i++) {
             if (isstreq(argv[i], "-h") || isstreq(argv[i], "--help")) {
@@ -88,6 +89,7 @@ int_main(dmesg, STACK_DEPTH_LOW, int argc, char *argv[])
                     puts("  -c, --clear     log clear");
                     puts("  -h, --help      this help");
                     puts("  -l,             loop");
+                    puts("  -s,             log statistics");
                     return EXIT_FAILURE;
             }
 
@@ -98,11 +100,28 @@ int_main(dmesg, STACK_DEPTH_LOW, int argc, char *argv[])
             if (isstreq(argv[i], "-l")) {
                     loop = true;
             }
+
+            if (isstreq(argv[i], "-s")) {
+                    stat = true;
+            }
         }
 
         if (clear) {
                 syslog_clear();
 
+        } else if (stat) {
+                printk_stat_t st;
+                if (syslog_get_stat(&st) == 0) {
+                        printf("Logged: %u\n"
+                               "Dropped: %u\n"
+                               "Truncated: %u\n"
+                               "Pending: %u\n",
+                               st.logged, st.dropped, st.truncated, st.pending);
+                } else {
+                        puts("System log statistics not available");
+                        return EXIT_FAILURE;
+                }
+
         } else {
                 do {
                         char  str[128];
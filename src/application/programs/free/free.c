@@ -102,7 +102,20 @@ int_main(free, STACK_DEPTH_LOW, int argc, char *argv[])
                 printf("  Programs   : %d\n", sysmem.programs_memory_usage);
                 printf("  Shared     : %d\n", sysmem.shared_memory_usage);
                 printf("  Cached     : %d\n", sysmem.cached_memory_usage);
-                printf("  Static     : %d\n\n", sysmem.static_memory_usage);
+                printf("  Static     : %d\n", sysmem.static_memory_usage);
+                printf("  Pools      : %d\n\n", sysmem.pools_memory_usage);
+
+                printf("Detailed object pools usage:\n");
+                mempoolstat_t pool;
+                for (uint i = 0; get_memory_pool_stat(i, &pool) == 0; i++) {
+                        printf("  %s"VT100_CURSOR_BACKWARD(99)VT100_CURSOR_FORWARD(14)": %d/%d (max %d, heap %d)\n",
+                               pool.name,
+                               (int)pool.used,
+                               (int)pool.object_count,
+                               (int)pool.used_max,
+                               (int)pool.fallbacks);
+                }
+                printf("\n");
 
                 printf("Detailed modules memory usage:\n");
                 for (uint module = 0; module < drv_count; module++) {
@@ -172,6 +172,27 @@ allocated and added to the buffer. The single chain will contain only small part
 of data. One should keep in mind that total_size field in first chain should be
 updated when new chain link is added, this field in other chain links is
 ignored by driver.
+
+\subsubsection drv-ethmac-ddesc-zerocopy Zero-copy packet handling
+Packets can be exchanged without copying to/from driver buffers. The
+@ref IOCTL_ETHMAC__RECEIVE_PACKETS_ZERO_COPY request receives a batch of
+packets. For each table entry user gives a free buffer of size
+@ref ETHMAC_PACKET_BUFFER_SIZE that replaces a buffer with received packet in
+the DMA ring, so the received buffer is handed over to the user without copy.
+Buffers of the driver are never handed over: a packet held in the driver's own
+buffer is copied to the user buffer. To receive without copy the user attaches
+own buffers to the DMA ring by the @ref IOCTL_ETHMAC__SET_RX_BUFFERS request
+before Ethernet start and takes them back by the same request after Ethernet
+stop. This way all exchanged buffers belong to the user.
+
+The @ref IOCTL_ETHMAC__SEND_PACKET_ZERO_COPY request sends a packet directly
+from chain buffer payloads (each chain link uses a single DMA descriptor).
+The payloads must stay unchanged until the driver calls the release function
+given by user. The release function is called from next transmit requests
+(the context of the thread that sends packets). Packets not released yet are
+released at Ethernet stop and at driver release. If payload cannot be reached by
+DMA or the chain has more links than DMA descriptors then the packet is copied
+and release function is called immediately.
 @{
 */
 
@@ -237,6 +258,41 @@ extern "C" {
  */
 #define IOCTL_ETHMAC__GET_LINK_STATUS                   _IOR(ETHMAC, 0x06, ETHMAC_link_status_t*)
 
+/**
+ * @brief  Send packet directly from chain buffer payloads (zero-copy).
+ * @param  [WR] @ref ETHMAC_packet_zero_copy_t*   packet and release function.
+ * @return On success 0 is returned, otherwise -1 and @ref errno code is set.
+ *         On error release function is not called.
+ */
+#define IOCTL_ETHMAC__SEND_PACKET_ZERO_COPY             _IOW(ETHMAC, 0x07, ETHMAC_packet_zero_copy_t*)
+
+/**
+ * @brief  Receive batch of packets by exchanging buffers (zero-copy).
+ *         Function waits for packet only if no packet is pending.
+ * @param  [WR,RD] @ref ETHMAC_packet_batch_t*    buffers, timeout and number of received packets.
+ * @return On success 0 is returned, otherwise -1 and @ref errno code is set.
+ */
+#define IOCTL_ETHMAC__RECEIVE_PACKETS_ZERO_COPY         _IOWR(ETHMAC, 0x08, ETHMAC_packet_batch_t*)
+
+/**
+ * @brief  Exchange all buffers of Rx DMA ring with buffers given by user.
+ *         Request can be used only when Ethernet is stopped. Table must have
+ *         at least as many entries as Rx DMA ring. Entry with NULL buffer
+ *         restores the driver's own buffer. At response the table contains
+ *         the previous ring buffers (NULL for driver's own buffers) and
+ *         <i>count</i> is set to the ring size. Field <i>timeout</i> is not
+ *         used.
+ * @param  [WR,RD] @ref ETHMAC_packet_batch_t*    buffers, ring size.
+ * @return On success 0 is returned, otherwise -1 and @ref errno code is set.
+ *         If table is too small then <i>count</i> is set to the ring size.
+ */
+#define IOCTL_ETHMAC__SET_RX_BUFFERS                    _IOWR(ETHMAC, 0x09, ETHMAC_packet_batch_t*)
+
+/**
+ * @brief  Size of buffer exchanged by zero-copy receive request.
+ */
+#define ETHMAC_PACKET_BUFFER_SIZE                       1524
+
 /*==============================================================================
   Exported object types
 ==============================================================================*/
@@ -266,6 +322,36 @@ typedef struct {
         size_t   pkt_size;   /*!< Size of received packet. Value is set by driver at response.*/
 } ETHMAC_packet_wait_t;
 
+/**
+ * Type represent function that release packet sent in zero-copy mode.
+ */
+typedef void (*ETHMAC_packet_release_t)(ETHMAC_packet_chain_t *packet);
+
+/**
+ * Type represent packet sent in zero-copy mode.
+ */
+typedef struct {
+        ETHMAC_packet_chain_t  *packet;         /*!< Packet to send.*/
+        ETHMAC_packet_release_t release;        /*!< Function called when packet was sent.*/
+} ETHMAC_packet_zero_copy_t;
+
+/**
+ * Type represent buffer exchanged in zero-copy mode.
+ */
+typedef struct {
+        void     *buffer;    /*!< Free buffer given to driver at request, buffer with packet at response.*/
+        uint16_t  size;      /*!< Size of received packet (without CRC). Value is set by driver at response.*/
+} ETHMAC_packet_buffer_t;
+
+/**
+ * Type represent batch of packets received in zero-copy mode.
+ */
+typedef struct {
+        ETHMAC_packet_buffer_t *packet;  /*!< Table of buffers. Value is set by user at request.*/
+        uint16_t                count;   /*!< Table size at request, number of received packets at response.*/
+        uint32_t                timeout; /*!< Timeout value in milliseconds. Value is set by user at request.*/
+} ETHMAC_packet_batch_t;
+
 /*==============================================================================
   Exported objects
 ==============================================================================*/
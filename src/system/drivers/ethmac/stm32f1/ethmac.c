@@ -41,6 +41,10 @@
 #define INIT_TIMEOUT            2000
 #define PHY_BSR_LINK_STATUS     (1 << 2)
 
+#if ETH_MAX_PACKET_SIZE > ETHMAC_PACKET_BUFFER_SIZE
+#error ETHMAC_PACKET_BUFFER_SIZE is too small
+#endif
+
 /*==============================================================================
   Local object types
 ==============================================================================*/
@@ -53,6 +57,8 @@ struct ethmac {
         ETH_DMADESCTypeDef  DMA_rx_descriptor[ETHMAC_RXBUFNB];
         u8_t                tx_buffer[ETHMAC_TXBUFNB][ETH_MAX_PACKET_SIZE];
         u8_t                rx_buffer[ETHMAC_RXBUFNB][ETH_MAX_PACKET_SIZE];
+        ETHMAC_packet_chain_t  *tx_packet[ETHMAC_TXBUFNB];
+        ETHMAC_packet_release_t tx_release[ETHMAC_TXBUFNB];
 };
 
 /*==============================================================================
@@ -60,6 +66,15 @@ struct ethmac {
 ==============================================================================*/
 static bool   is_Ethernet_started       (void);
 static void   send_packet               (size_t size);
+static void   resume_transmission       (void);
+static bool   is_DMA_accessible         (const void *buffer);
+static int    send_packet_zero_copy     (struct ethmac *hdl, ETHMAC_packet_zero_copy_t *zc);
+static void   release_sent_packets      (struct ethmac *hdl, bool force);
+static void   init_Tx_descriptors       (struct ethmac *hdl);
+static u8_t  *get_Tx_buffer             (struct ethmac *hdl);
+static void   receive_packets_zero_copy (struct ethmac *hdl, ETHMAC_packet_batch_t *batch);
+static int    set_Rx_buffers            (struct ethmac *hdl, ETHMAC_packet_batch_t *batch);
+static bool   is_own_Rx_buffer          (struct ethmac *hdl, const void *buffer);
 static size_t wait_for_packet           (struct ethmac *hdl, uint32_t timeout);
 static void   give_Rx_buffer_to_DMA     (void);
 static bool   is_buffer_owned_by_DMA    (ETH_DMADESCTypeDef *DMA_descriptor);
@@ -181,21 +196,12 @@ API_MOD_INIT(ETHMAC, void **device_handle, u8_t major, u8_t minor)
 
                         ETH_DMAITConfig(ETH_DMA_IT_NIS | ETH_DMA_IT_R, ENABLE);
 
-                        ETH_DMATxDescChainInit(ethmac->DMA_tx_descriptor,
-                                               &ethmac->tx_buffer[0][0],
-                                               ETHMAC_TXBUFNB);
+                        init_Tx_descriptors(ethmac);
 
                         ETH_DMARxDescChainInit(ethmac->DMA_rx_descriptor,
                                                &ethmac->rx_buffer[0][0],
                                                ETHMAC_RXBUFNB);
 
-                        if (__ETHMAC_CHECKSUM_BY_HARDWARE__ != 0) {
-                                for (uint i = 0; i < ETHMAC_TXBUFNB; i++) {
-                                        ETH_DMATxDescChecksumInsertionConfig(&ethmac->DMA_tx_descriptor[i],
-                                                                             ETH_DMATxDesc_ChecksumTCPUDPICMPFull);
-                                }
-                        }
-
                         for (uint i = 0; i < ETHMAC_RXBUFNB; i++) {
                                 ETH_DMARxDescReceiveITConfig(&ethmac->DMA_rx_descriptor[i], ENABLE);
                         }
@@ -242,6 +248,7 @@ API_MOD_RELEASE(ETHMAC, void *device_handle)
                 ETH_DeInit();
                 NVIC_DisableIRQ(ETH_IRQn);
                 CLEAR_BIT(RCC->AHBENR, RCC_AHBENR_ETHMACRXEN | RCC_AHBENR_ETHMACTXEN | RCC_AHBENR_ETHMACEN);
+                release_sent_packets(hdl, true);
                 sys_semaphore_destroy(hdl->rx_data_ready);
                 sys_mutex_destroy(hdl->rx_access);
                 sys_mutex_destroy(hdl->tx_access);
@@ -338,9 +345,11 @@ API_MOD_WRITE(ETHMAC,
                                         sys_sleep_ms(1);
                                 }
 
+                                release_sent_packets(hdl, false);
+
                                 size_t packet_size = min(count, ETH_MAX_PACKET_SIZE);
 
-                                u8_t *buffer = get_buffer_address(DMATxDescToSet);
+                                u8_t *buffer = get_Tx_buffer(hdl);
                                 memcpy(buffer, src, packet_size);
                                 send_packet(packet_size);
 
@@ -472,13 +481,15 @@ API_MOD_IOCTL(ETHMAC, void *device_handle, int request, void *arg)
                                         sys_sleep_ms(1);
                                 }
 
+                                release_sent_packets(hdl, false);
+
                                 if (  !is_buffer_owned_by_DMA(DMATxDescToSet)
                                    && pkt->payload
                                    && pkt->payload_size
                                    && pkt->total_size > 0
                                    && pkt->total_size <= ETH_MAX_PACKET_SIZE) {
 
-                                        u8_t  *buffer = get_buffer_address(DMATxDescToSet);
+                                        u8_t  *buffer = get_Tx_buffer(hdl);
                                         size_t offset = 0;
 
                                         for (ETHMAC_packet_chain_t *p = pkt; p != NULL; p = p->next) {
@@ -549,12 +560,58 @@ API_MOD_IOCTL(ETHMAC, void *device_handle, int request, void *arg)
                 }
                 break;
 
+        case IOCTL_ETHMAC__SEND_PACKET_ZERO_COPY:
+                if (arg) {
+                        if (sys_mutex_lock(hdl->tx_access, MAX_DELAY_MS) == ESUCC) {
+                                err = send_packet_zero_copy(hdl, arg);
+                                sys_mutex_unlock(hdl->tx_access);
+                        } else {
+                                err = EAGAIN;
+                        }
+                } else {
+                        err = EINVAL;
+                }
+                break;
+
+        case IOCTL_ETHMAC__RECEIVE_PACKETS_ZERO_COPY:
+                if (arg) {
+                        if (sys_mutex_lock(hdl->rx_access, MAX_DELAY_MS) == ESUCC) {
+                                receive_packets_zero_copy(hdl, arg);
+                                sys_mutex_unlock(hdl->rx_access);
+                                err = ESUCC;
+                        } else {
+                                err = EAGAIN;
+                        }
+                } else {
+                        err = EINVAL;
+                }
+                break;
+
+        case IOCTL_ETHMAC__SET_RX_BUFFERS:
+                if (arg) {
+                        if (sys_mutex_lock(hdl->rx_access, MAX_DELAY_MS) == ESUCC) {
+                                err = set_Rx_buffers(hdl, arg);
+                                sys_mutex_unlock(hdl->rx_access);
+                        } else {
+                                err = EAGAIN;
+                        }
+                } else {
+                        err = EINVAL;
+                }
+                break;
+
         case IOCTL_ETHMAC__ETHERNET_START:
                 ETH_Start();
                 return ESUCC;
 
         case IOCTL_ETHMAC__ETHERNET_STOP:
                 ETH_Stop();
+
+                if (sys_mutex_lock(hdl->tx_access, MAX_DELAY_MS) == ESUCC) {
+                        release_sent_packets(hdl, true);
+                        init_Tx_descriptors(hdl);
+                        sys_mutex_unlock(hdl->tx_access);
+                }
                 return ESUCC;
 
         case IOCTL_ETHMAC__GET_LINK_STATUS:
@@ -650,6 +707,24 @@ static void send_packet(size_t size)
         /* Set Own bit of the Tx descriptor Status: gives the buffer back to ETHERNET DMA */
         DMATxDescToSet->Status |= ETH_DMATxDesc_OWN;
 
+        resume_transmission();
+
+        /* Update the ETHERNET DMA global Tx descriptor with next Tx decriptor */
+        /* Chained Mode */
+        /* Selects the next DMA Tx descriptor list for next buffer to send */
+        DMATxDescToSet = cast(ETH_DMADESCTypeDef*, DMATxDescToSet->Buffer2NextDescAddr);
+}
+
+//==============================================================================
+/**
+ * @brief  Resume DMA transmission if DMA suspended because of Tx buffer
+ *         unavailable
+ * @param  None
+ * @return None
+ */
+//==============================================================================
+static void resume_transmission(void)
+{
         /* When Tx Buffer unavailable flag is set: clear it and resume transmission */
         if (ETH->DMASR & ETH_DMASR_TBUS) {
                 /* Clear TBUS ETHERNET DMA flag */
@@ -658,11 +733,291 @@ static void send_packet(size_t size)
                 /* Resume DMA transmission*/
                 ETH->DMATPDR = 0;
         }
+}
 
-        /* Update the ETHERNET DMA global Tx descriptor with next Tx decriptor */
-        /* Chained Mode */
-        /* Selects the next DMA Tx descriptor list for next buffer to send */
-        DMATxDescToSet = cast(ETH_DMADESCTypeDef*, DMATxDescToSet->Buffer2NextDescAddr);
+//==============================================================================
+/**
+ * @brief  Function returns own buffer of current Tx descriptor (descriptor
+ *         could point to payload of packet sent in zero-copy mode)
+ * @param  hdl          driver context
+ * @return Buffer address
+ */
+//==============================================================================
+static u8_t *get_Tx_buffer(struct ethmac *hdl)
+{
+        size_t idx = DMATxDescToSet - hdl->DMA_tx_descriptor;
+
+        DMATxDescToSet->Buffer1Addr = cast(u32_t, hdl->tx_buffer[idx]);
+
+        return get_buffer_address(DMATxDescToSet);
+}
+
+//==============================================================================
+/**
+ * @brief  Function checks if buffer can be accessed by the DMA controller
+ * @param  buffer       buffer address
+ * @return If buffer is accessible then true is returned, otherwise false
+ */
+//==============================================================================
+static bool is_DMA_accessible(const void *buffer)
+{
+#if defined(CCMDATARAM_BASE)
+        u32_t addr = cast(u32_t, buffer);
+        return !(addr >= CCMDATARAM_BASE && addr < CCMDATARAM_BASE + 0x10000);
+#else
+        UNUSED_ARG1(buffer);
+        return true;
+#endif
+}
+
+//==============================================================================
+/**
+ * @brief  Function calls release function of packets sent in zero-copy mode
+ *         that DMA does not use anymore
+ * @param  hdl          driver context
+ * @param  force        release all packets (DMA stopped)
+ * @return None
+ */
+//==============================================================================
+static void release_sent_packets(struct ethmac *hdl, bool force)
+{
+        for (size_t i = 0; i < ETHMAC_TXBUFNB; i++) {
+                if (  hdl->tx_packet[i]
+                   && (force || !is_buffer_owned_by_DMA(&hdl->DMA_tx_descriptor[i]))) {
+
+                        ETHMAC_packet_chain_t *pkt = hdl->tx_packet[i];
+                        hdl->tx_packet[i] = NULL;
+                        hdl->tx_release[i](pkt);
+                }
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Function initializes Tx DMA descriptors with driver's buffers
+ * @param  hdl          driver context
+ * @return None
+ */
+//==============================================================================
+static void init_Tx_descriptors(struct ethmac *hdl)
+{
+        ETH_DMATxDescChainInit(hdl->DMA_tx_descriptor,
+                               &hdl->tx_buffer[0][0],
+                               ETHMAC_TXBUFNB);
+
+        if (__ETHMAC_CHECKSUM_BY_HARDWARE__ != 0) {
+                for (uint i = 0; i < ETHMAC_TXBUFNB; i++) {
+                        ETH_DMATxDescChecksumInsertionConfig(&hdl->DMA_tx_descriptor[i],
+                                                             ETH_DMATxDesc_ChecksumTCPUDPICMPFull);
+                }
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Send packet directly from chain payloads. Each chain link is
+ *         transmitted by separate DMA descriptor. If payload is not accessible
+ *         by DMA or there is not enough descriptors then packet is copied to
+ *         the Tx buffer.
+ * @param  hdl          driver context
+ * @param  zc           packet and release function
+ * @return One of errno value
+ */
+//==============================================================================
+static int send_packet_zero_copy(struct ethmac *hdl, ETHMAC_packet_zero_copy_t *zc)
+{
+        ETHMAC_packet_chain_t *pkt = zc->packet;
+
+        if (  !pkt
+           || !zc->release
+           || pkt->total_size == 0
+           || pkt->total_size > ETH_MAX_PACKET_SIZE) {
+                return EINVAL;
+        }
+
+        size_t segments   = 0;
+        bool   accessible = true;
+
+        for (ETHMAC_packet_chain_t *p = pkt; p != NULL; p = p->next) {
+                if (p->payload_size) {
+                        accessible &= is_DMA_accessible(p->payload);
+                        segments++;
+                }
+        }
+
+        bool zero_copy = accessible && (segments <= ETHMAC_TXBUFNB);
+
+        // wait for descriptors used by packet
+        ETH_DMADESCTypeDef *desc = DMATxDescToSet;
+
+        for (size_t i = 0; i < (zero_copy ? segments : 1); i++) {
+                while (is_buffer_owned_by_DMA(desc)) {
+                        sys_sleep_ms(1);
+                }
+
+                desc = cast(ETH_DMADESCTypeDef*, desc->Buffer2NextDescAddr);
+        }
+
+        release_sent_packets(hdl, false);
+
+        if (zero_copy) {
+                ETH_DMADESCTypeDef *first = DMATxDescToSet;
+
+                for (ETHMAC_packet_chain_t *p = pkt; p != NULL; p = p->next) {
+                        if (p->payload_size == 0) {
+                                continue;
+                        }
+
+                        u32_t status = DMATxDescToSet->Status & ~(ETH_DMATxDesc_FS | ETH_DMATxDesc_LS);
+
+                        if (DMATxDescToSet == first) {
+                                status |= ETH_DMATxDesc_FS;
+                        } else {
+                                status |= ETH_DMATxDesc_OWN;
+                        }
+
+                        if (--segments == 0) {
+                                size_t idx = DMATxDescToSet - hdl->DMA_tx_descriptor;
+                                hdl->tx_packet[idx]  = pkt;
+                                hdl->tx_release[idx] = zc->release;
+                                status |= ETH_DMATxDesc_LS;
+                        }
+
+                        DMATxDescToSet->Buffer1Addr       = cast(u32_t, p->payload);
+                        DMATxDescToSet->ControlBufferSize = (p->payload_size & ETH_DMATxDesc_TBS1);
+                        DMATxDescToSet->Status            = status;
+
+                        DMATxDescToSet = cast(ETH_DMADESCTypeDef*, DMATxDescToSet->Buffer2NextDescAddr);
+                }
+
+                /* first descriptor is given to DMA at the end, so DMA gets entire frame */
+                first->Status |= ETH_DMATxDesc_OWN;
+
+                resume_transmission();
+
+        } else {
+                u8_t  *buffer = get_Tx_buffer(hdl);
+                size_t offset = 0;
+
+                for (ETHMAC_packet_chain_t *p = pkt; p != NULL; p = p->next) {
+                        memcpy(&buffer[offset], p->payload, p->payload_size);
+                        offset += p->payload_size;
+                }
+
+                send_packet(pkt->total_size);
+
+                zc->release(pkt);
+        }
+
+        return ESUCC;
+}
+
+//==============================================================================
+/**
+ * @brief  Function receive all pending packets (up to batch size) by
+ *         exchanging descriptor buffers with buffers given by user. Packet
+ *         in driver's own buffer is copied to user buffer. If there is no
+ *         pending packet then function waits for packet.
+ * @param  hdl          driver context
+ * @param  batch        batch of buffers
+ * @return None
+ */
+//==============================================================================
+static void receive_packets_zero_copy(struct ethmac *hdl, ETHMAC_packet_batch_t *batch)
+{
+        u16_t count = 0;
+
+        if (batch->count > 0 && batch->packet) {
+
+                wait_for_packet(hdl, batch->timeout);
+
+                while (count < batch->count && !is_buffer_owned_by_DMA(DMARxDescToGet)) {
+
+                        size_t size = ETH_GetRxPktSize();
+
+                        if (size > ETH_CRC && batch->packet[count].buffer) {
+                                void *buffer = get_buffer_address(DMARxDescToGet);
+
+                                if (is_own_Rx_buffer(hdl, buffer)) {
+                                        memcpy(batch->packet[count].buffer, buffer, size - ETH_CRC);
+                                } else {
+                                        DMARxDescToGet->Buffer1Addr = cast(u32_t, batch->packet[count].buffer);
+                                        batch->packet[count].buffer = buffer;
+                                }
+
+                                batch->packet[count].size = size - ETH_CRC;
+                                count++;
+                        }
+
+                        give_Rx_buffer_to_DMA();
+                }
+
+                make_Rx_buffer_available();
+        }
+
+        batch->count = count;
+}
+
+//==============================================================================
+/**
+ * @brief  Function exchanges all buffers of Rx DMA ring with buffers given by
+ *         user. NULL buffer restores driver's own buffer, own buffers are
+ *         returned as NULL, so driver's buffers never leave the driver.
+ * @param  hdl          driver context
+ * @param  batch        table of buffers
+ * @return One of errno value
+ */
+//==============================================================================
+static int set_Rx_buffers(struct ethmac *hdl, ETHMAC_packet_batch_t *batch)
+{
+        if (is_Ethernet_started()) {
+                return EBUSY;
+        }
+
+        if (!batch->packet || batch->count < ETHMAC_RXBUFNB) {
+                batch->count = ETHMAC_RXBUFNB;
+                return EINVAL;
+        }
+
+        for (size_t i = 0; i < ETHMAC_RXBUFNB; i++) {
+                ETH_DMADESCTypeDef *desc   = &hdl->DMA_rx_descriptor[i];
+                void               *buffer = get_buffer_address(desc);
+
+                if (batch->packet[i].buffer) {
+                        desc->Buffer1Addr = cast(u32_t, batch->packet[i].buffer);
+                } else {
+                        desc->Buffer1Addr = cast(u32_t, hdl->rx_buffer[i]);
+                }
+
+                desc->Status = ETH_DMARxDesc_OWN;
+
+                batch->packet[i].buffer = is_own_Rx_buffer(hdl, buffer) ? NULL : buffer;
+                batch->packet[i].size   = 0;
+        }
+
+        /* frames not read so far are dropped, reception restarts from first descriptor */
+        DMARxDescToGet = &hdl->DMA_rx_descriptor[0];
+        ETH->DMARDLAR  = cast(u32_t, hdl->DMA_rx_descriptor);
+
+        batch->count = ETHMAC_RXBUFNB;
+
+        return ESUCC;
+}
+
+//==============================================================================
+/**
+ * @brief  Function checks if buffer is one of driver's Rx buffers
+ * @param  hdl          driver context
+ * @param  buffer       buffer to check
+ * @return True if buffer belongs to driver, otherwise false.
+ */
+//==============================================================================
+static bool is_own_Rx_buffer(struct ethmac *hdl, const void *buffer)
+{
+        const u8_t *buf = buffer;
+
+        return (buf >= &hdl->rx_buffer[0][0])
+            && (buf <  &hdl->rx_buffer[ETHMAC_RXBUFNB - 1][ETH_MAX_PACKET_SIZE]);
 }
 
 //==============================================================================
@@ -358,21 +358,18 @@ static void IRQ_Rx_handle(u8_t major)
         USART_TypeDef *usart = UART[major].usart;
 
         /* receiver interrupt handler */
-        int received = 0;
+        if (usart->IF & USART_IF_RXOF) {
+                usart->IFC = USART_IFC_RXOF;
+                _UART_mem[major]->Rx_HW_overruns++;
+        }
+
         while (usart->STATUS & USART_STATUS_RXDATAV) {
                 u8_t data = usart->RXDATA;
-
-                if (_UART_FIFO__write(&_UART_mem[major]->Rx_FIFO, &data)) {
-                        received++;
-                }
+                _UART_FIFO__write(&_UART_mem[major]->Rx_FIFO, &data);
         }
 
-        // set receive semaphore to number of received bytes
-        bool yield = received > 0;
-
-        while (received--) {
-                sys_semaphore_signal_from_ISR(_UART_mem[major]->data_read_sem, NULL);
-        }
+        // wake up reader if enough data was received
+        bool yield = _UART__rx_notify_from_ISR(major, false);
 
         /* yield thread if data received */
         sys_thread_yield_from_ISR(yield);
@@ -195,7 +195,7 @@ void _UART_LLD__abort_trasmission(u8_t major)
 //==============================================================================
 void _UART_LLD__rx_resume(u8_t major)
 {
-        SET_BIT(UART[major].UART->CR1, USART_CR1_RXNEIE);
+        SET_BIT(UART[major].UART->CR1, USART_CR1_RXNEIE | USART_CR1_IDLEIE);
 }
 
 //==============================================================================
@@ -207,7 +207,7 @@ void _UART_LLD__rx_resume(u8_t major)
 //==============================================================================
 void _UART_LLD__rx_hold(u8_t major)
 {
-        CLEAR_BIT(UART[major].UART->CR1, USART_CR1_RXNEIE);
+        CLEAR_BIT(UART[major].UART->CR1, USART_CR1_RXNEIE | USART_CR1_IDLEIE);
 }
 
 //==============================================================================
@@ -301,8 +301,8 @@ void _UART_LLD__configure(u8_t major, const struct UART_config *config)
                 CLEAR_BIT(DEV->UART->CR3, USART_CR3_HDSEL);
         }
 
-        /* enable RXNE interrupt */
-        SET_BIT(DEV->UART->CR1, USART_CR1_RXNEIE);
+        /* enable RXNE and IDLE interrupts */
+        SET_BIT(DEV->UART->CR1, USART_CR1_RXNEIE | USART_CR1_IDLEIE);
 
         /* enable UART */
         SET_BIT(DEV->UART->CR1, USART_CR1_UE);
@@ -322,13 +322,22 @@ static void IRQ_handle(u8_t major)
         const UART_regs_t *DEV = &UART[major];
 
         /* receiver interrupt handler */
-        int received = 0;
+        bool idle     = (DEV->UART->CR1 & USART_CR1_IDLEIE) && (DEV->UART->SR & USART_SR_IDLE);
+        bool received = false;
+
         while ((DEV->UART->CR1 & USART_CR1_RXNEIE) && (DEV->UART->SR & (USART_SR_RXNE | USART_SR_ORE))) {
+                if (DEV->UART->SR & USART_SR_ORE) {
+                        _UART_mem[major]->Rx_HW_overruns++;
+                }
+
                 u8_t DR = DEV->UART->DR;
+                _UART_FIFO__write(&_UART_mem[major]->Rx_FIFO, &DR);
+                received = true;
+        }
 
-                if (_UART_FIFO__write(&_UART_mem[major]->Rx_FIFO, &DR)) {
-                        received++;
-                }
+        // IDLE flag is cleared by SR read followed by DR read
+        if (idle && !received) {
+                (void)DEV->UART->DR;
         }
 
         /* transmitter interrupt handler */
@@ -347,10 +356,9 @@ static void IRQ_handle(u8_t major)
                 }
         }
 
-        // set receive semaphore to number of received bytes
-        while (received--) {
-                sys_semaphore_signal_from_ISR(_UART_mem[major]->data_read_sem, NULL);
-                yield = true;
+        // wake up reader if enough data was received or line is idle
+        if (received || idle) {
+                yield |= _UART__rx_notify_from_ISR(major, idle);
         }
 
         /* yield thread if data send or received */
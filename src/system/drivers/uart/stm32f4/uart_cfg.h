@@ -54,6 +54,16 @@ extern "C" {
 #define _UART_DEFAULT_SINGLE_WIRE_MODE          __UART_DEFAULT_SINGLE_WIRE_MODE__
 #define _UART_DEFAULT_BAUD                      __UART_DEFAULT_BAUD__
 
+/* Rx DMA (circular mode) */
+#define _UART1_RX_DMA                           __UART_UART1_RX_DMA__
+#define _UART2_RX_DMA                           __UART_UART2_RX_DMA__
+#define _UART3_RX_DMA                           __UART_UART3_RX_DMA__
+#define _UART4_RX_DMA                           __UART_UART4_RX_DMA__
+#define _UART5_RX_DMA                           __UART_UART5_RX_DMA__
+#define _UART6_RX_DMA                           __UART_UART6_RX_DMA__
+#define _UART7_RX_DMA                           __UART_UART7_RX_DMA__
+#define _UART8_RX_DMA                           __UART_UART8_RX_DMA__
+
 /*==============================================================================
   Exported types, enums definitions
 ==============================================================================*/
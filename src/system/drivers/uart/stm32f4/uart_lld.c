@@ -36,10 +36,15 @@
 #include "stm32f4/uart_cfg.h"
 #include "stm32f4/stm32f4xx.h"
 #include "stm32f4/lib/stm32f4xx_rcc.h"
+#include "stm32f4/dma_ddi.h"
 
 /*==============================================================================
   Local symbolic constants/macros
 ==============================================================================*/
+#define USE_DMA         (  (_UART1_RX_DMA > 0) || (_UART2_RX_DMA > 0)\
+                        || (_UART3_RX_DMA > 0) || (_UART4_RX_DMA > 0)\
+                        || (_UART5_RX_DMA > 0) || (_UART6_RX_DMA > 0)\
+                        || (_UART7_RX_DMA > 0) || (_UART8_RX_DMA > 0))
 
 /*==============================================================================
   Local types, enums definitions
@@ -52,11 +57,30 @@ typedef struct {
         const uint32_t  APBENR_UARTEN;
         const uint32_t  APBRSTR_UARTRST;
         const IRQn_Type IRQn;
+    #if USE_DMA > 0
+        const bool      use_DMA;                //!< receiver uses DMA in circular mode
+        const u8_t      DMA_rx_stream_pri;      //!< primary Rx stream number
+        const u8_t      DMA_rx_stream_alt;      //!< alternative Rx stream number
+        const u8_t      DMA_channel;            //!< DMA peripheral request channel number
+        const u8_t      DMA_major;              //!< DMA peripheral number
+    #endif
 } UART_regs_t;
 
+#if USE_DMA > 0
+/* Rx DMA runtime data */
+typedef struct {
+        u32_t               dmad;               //!< DMA descriptor
+        DMA_Stream_TypeDef *stream;             //!< Rx stream registers (NULL: DMA not used)
+} UART_DMA_t;
+#endif
+
 /*==============================================================================
   Local function prototypes
 ==============================================================================*/
+#if USE_DMA > 0
+static bool DMA_rx_start(u8_t major);
+static bool DMA_rx_callback(DMA_Stream_TypeDef *stream, u8_t SR, void *arg);
+#endif
 
 /*==============================================================================
   Local object definitions
@@ -71,6 +95,13 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB2ENR_USART1EN,
                 .APBRSTR_UARTRST = RCC_APB2RSTR_USART1RST,
                 .IRQn            = USART1_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = _UART1_RX_DMA,
+                .DMA_rx_stream_pri = 2,
+                .DMA_rx_stream_alt = 5,
+                .DMA_channel       = 4,
+                .DMA_major         = 1,
+                #endif
         },
         #endif
         #if defined(RCC_APB1ENR_USART2EN)
@@ -81,6 +112,13 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB1ENR_USART2EN,
                 .APBRSTR_UARTRST = RCC_APB1RSTR_USART2RST,
                 .IRQn            = USART2_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = _UART2_RX_DMA,
+                .DMA_rx_stream_pri = 5,
+                .DMA_rx_stream_alt = 5,
+                .DMA_channel       = 4,
+                .DMA_major         = 0,
+                #endif
         },
         #endif
         #if defined(RCC_APB1ENR_USART3EN)
@@ -91,6 +129,13 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB1ENR_USART3EN,
                 .APBRSTR_UARTRST = RCC_APB1RSTR_USART3RST,
                 .IRQn            = USART3_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = _UART3_RX_DMA,
+                .DMA_rx_stream_pri = 1,
+                .DMA_rx_stream_alt = 1,
+                .DMA_channel       = 4,
+                .DMA_major         = 0,
+                #endif
         },
         #endif
         #if defined(RCC_APB1ENR_UART4EN)
@@ -101,6 +146,13 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB1ENR_UART4EN,
                 .APBRSTR_UARTRST = RCC_APB1RSTR_UART4RST,
                 .IRQn            = UART4_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = _UART4_RX_DMA,
+                .DMA_rx_stream_pri = 2,
+                .DMA_rx_stream_alt = 2,
+                .DMA_channel       = 4,
+                .DMA_major         = 0,
+                #endif
         },
         #endif
         #if defined(RCC_APB1ENR_UART5EN)
@@ -111,6 +163,13 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB1ENR_UART5EN,
                 .APBRSTR_UARTRST = RCC_APB1RSTR_UART5RST,
                 .IRQn            = UART5_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = _UART5_RX_DMA,
+                .DMA_rx_stream_pri = 0,
+                .DMA_rx_stream_alt = 0,
+                .DMA_channel       = 4,
+                .DMA_major         = 0,
+                #endif
         },
         #endif
         #if defined(RCC_APB2ENR_USART6EN)
@@ -121,6 +180,13 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB2ENR_USART6EN,
                 .APBRSTR_UARTRST = RCC_APB2RSTR_USART6RST,
                 .IRQn            = USART6_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = _UART6_RX_DMA,
+                .DMA_rx_stream_pri = 1,
+                .DMA_rx_stream_alt = 2,
+                .DMA_channel       = 5,
+                .DMA_major         = 1,
+                #endif
         },
         #endif
         #if defined(RCC_APB1ENR_UART7EN)
@@ -131,6 +197,13 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB1ENR_UART7EN,
                 .APBRSTR_UARTRST = RCC_APB1RSTR_UART7RST,
                 .IRQn            = UART7_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = _UART7_RX_DMA,
+                .DMA_rx_stream_pri = 3,
+                .DMA_rx_stream_alt = 3,
+                .DMA_channel       = 5,
+                .DMA_major         = 0,
+                #endif
         },
         #endif
         #if defined(RCC_APB1ENR_UART8EN)
@@ -141,6 +214,13 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB1ENR_UART8EN,
                 .APBRSTR_UARTRST = RCC_APB1RSTR_UART8RST,
                 .IRQn            = UART8_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = _UART8_RX_DMA,
+                .DMA_rx_stream_pri = 6,
+                .DMA_rx_stream_alt = 6,
+                .DMA_channel       = 5,
+                .DMA_major         = 0,
+                #endif
         },
         #endif
         #if defined(RCC_APB2ENR_UART9EN)
@@ -151,6 +231,13 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB2ENR_UART9EN,
                 .APBRSTR_UARTRST = RCC_APB2RSTR_UART9RST,
                 .IRQn            = UART9_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = false,
+                .DMA_rx_stream_pri = 0,
+                .DMA_rx_stream_alt = 0,
+                .DMA_channel       = 0,
+                .DMA_major         = 0,
+                #endif
         },
         #endif
         #if defined(RCC_APB2ENR_UART10EN)
@@ -161,10 +248,21 @@ static const UART_regs_t UART[] = {
                 .APBENR_UARTEN   = RCC_APB2ENR_UART10EN,
                 .APBRSTR_UARTRST = RCC_APB2RSTR_UART10RST,
                 .IRQn            = UART10_IRQn,
+                #if USE_DMA > 0
+                .use_DMA           = false,
+                .DMA_rx_stream_pri = 0,
+                .DMA_rx_stream_alt = 0,
+                .DMA_channel       = 0,
+                .DMA_major         = 0,
+                #endif
         }
         #endif
 };
 
+#if USE_DMA > 0
+static UART_DMA_t DMA_rx[_UART_COUNT];
+#endif
+
 /*==============================================================================
   Function definitions
 ==============================================================================*/
@@ -205,6 +303,16 @@ int _UART_LLD__turn_on(u8_t major)
 int _UART_LLD__turn_off(u8_t major)
 {
         NVIC_DisableIRQ(UART[major].IRQn);
+
+#if USE_DMA > 0
+        if (DMA_rx[major].dmad) {
+                CLEAR_BIT(UART[major].UART->CR3, USART_CR3_DMAR);
+                _DMA_DDI_release(DMA_rx[major].dmad);
+                DMA_rx[major].dmad   = 0;
+                DMA_rx[major].stream = NULL;
+        }
+#endif
+
         SET_BIT(*UART[major].APBRSTR, UART[major].APBRSTR_UARTRST);
         CLEAR_BIT(*UART[major].APBRSTR, UART[major].APBRSTR_UARTRST);
         CLEAR_BIT(*UART[major].APBENR, UART[major].APBENR_UARTEN);
@@ -244,19 +352,36 @@ void _UART_LLD__abort_trasmission(u8_t major)
 //==============================================================================
 void _UART_LLD__rx_resume(u8_t major)
 {
-        SET_BIT(UART[major].UART->CR1, USART_CR1_RXNEIE);
+#if USE_DMA > 0
+        if (DMA_rx[major].stream) {
+                sys_critical_section_end();
+                return;
+        }
+#endif
+        SET_BIT(UART[major].UART->CR1, USART_CR1_RXNEIE | USART_CR1_IDLEIE);
 }
 
 //==============================================================================
 /**
- * @brief Function hold byte receiving.
+ * @brief Function hold byte receiving. In DMA mode receiving is not stopped,
+ *        only Rx FIFO is updated to the current DMA position and IRQs are
+ *        blocked.
  *
  * @param major         UART number
  */
 //==============================================================================
 void _UART_LLD__rx_hold(u8_t major)
 {
-        CLEAR_BIT(UART[major].UART->CR1, USART_CR1_RXNEIE);
+#if USE_DMA > 0
+        if (DMA_rx[major].stream) {
+                struct Rx_FIFO *fifo = &_UART_mem[major]->Rx_FIFO;
+
+                sys_critical_section_begin();
+                _UART_FIFO__commit(fifo, fifo->size - DMA_rx[major].stream->NDTR);
+                return;
+        }
+#endif
+        CLEAR_BIT(UART[major].UART->CR1, USART_CR1_RXNEIE | USART_CR1_IDLEIE);
 }
 
 //==============================================================================
@@ -358,8 +483,14 @@ void _UART_LLD__configure(u8_t major, const struct UART_config *config)
                 CLEAR_BIT(DEV->UART->CR3, USART_CR3_HDSEL);
         }
 
-        /* enable RXNE interrupt */
-        SET_BIT(DEV->UART->CR1, USART_CR1_RXNEIE);
+        /* enable IDLE interrupt and RXNE interrupt (if Rx DMA is not used) */
+        bool rx_DMA = false;
+
+#if USE_DMA > 0
+        rx_DMA = DMA_rx_start(major);
+#endif
+
+        SET_BIT(DEV->UART->CR1, USART_CR1_IDLEIE | (rx_DMA ? 0 : USART_CR1_RXNEIE));
 
         /* enable UART */
         SET_BIT(DEV->UART->CR1, USART_CR1_UE);
@@ -379,13 +510,36 @@ static void IRQ_handle(u8_t major)
         const UART_regs_t *DEV = &UART[major];
 
         /* receiver interrupt handler */
-        int received = 0;
+        bool idle     = (DEV->UART->CR1 & USART_CR1_IDLEIE) && (DEV->UART->SR & USART_SR_IDLE);
+        bool received = false;
+
+#if USE_DMA > 0
+        if (idle && DMA_rx[major].stream) {
+                struct Rx_FIFO *fifo = &_UART_mem[major]->Rx_FIFO;
+
+                if (DEV->UART->SR & USART_SR_ORE) {
+                        _UART_mem[major]->Rx_HW_overruns++;
+                }
+
+                (void)DEV->UART->DR;
+                _UART_FIFO__commit(fifo, fifo->size - DMA_rx[major].stream->NDTR);
+                received = true;
+        }
+#endif
+
         while ((DEV->UART->CR1 & USART_CR1_RXNEIE) && (DEV->UART->SR & (USART_SR_RXNE | USART_SR_ORE))) {
+                if (DEV->UART->SR & USART_SR_ORE) {
+                        _UART_mem[major]->Rx_HW_overruns++;
+                }
+
                 u8_t DR = DEV->UART->DR;
+                _UART_FIFO__write(&_UART_mem[major]->Rx_FIFO, &DR);
+                received = true;
+        }
 
-                if (_UART_FIFO__write(&_UART_mem[major]->Rx_FIFO, &DR)) {
-                        received++;
-                }
+        // IDLE flag is cleared by SR read followed by DR read
+        if (idle && !received) {
+                (void)DEV->UART->DR;
         }
 
         /* transmitter interrupt handler */
@@ -404,16 +558,105 @@ static void IRQ_handle(u8_t major)
                 }
         }
 
-        // set receive semaphore to number of received bytes
-        while (received--) {
-                sys_semaphore_signal_from_ISR(_UART_mem[major]->data_read_sem, NULL);
-                yield = true;
+        // wake up reader if enough data was received or line is idle
+        if (received || idle) {
+                yield |= _UART__rx_notify_from_ISR(major, idle);
         }
 
         /* yield thread if data send or received */
         sys_thread_yield_from_ISR(yield);
 }
 
+#if USE_DMA > 0
+//==============================================================================
+/**
+ * @brief Function start receiving by using DMA in circular mode. DMA writes
+ *        directly to Rx FIFO buffer. FIFO is updated on half/full transfer
+ *        and IDLE line interrupts.
+ *
+ * @param major         major device number
+ *
+ * @return true if DMA is used, false if receiver should use RXNE interrupt.
+ */
+//==============================================================================
+static bool DMA_rx_start(u8_t major)
+{
+        const UART_regs_t *DEV = &UART[major];
+
+        if (DMA_rx[major].stream || !DEV->use_DMA) {
+                return DMA_rx[major].stream != NULL;
+        }
+
+        u8_t  stream = DEV->DMA_rx_stream_pri;
+        u32_t dmad   = _DMA_DDI_reserve(DEV->DMA_major, stream);
+        if (dmad == 0) {
+                stream = DEV->DMA_rx_stream_alt;
+                dmad   = _DMA_DDI_reserve(DEV->DMA_major, stream);
+        }
+
+        if (dmad) {
+                struct Rx_FIFO *fifo = &_UART_mem[major]->Rx_FIFO;
+
+                fifo->buffer_level = 0;
+                fifo->read_index   = 0;
+                fifo->write_index  = 0;
+
+                _DMA_DDI_config_t config;
+                config.arg      = _UART_mem[major];
+                config.callback = DMA_rx_callback;
+                config.release  = false;
+                config.PA       = cast(u32_t, &DEV->UART->DR);
+                config.MA[0]    = cast(u32_t, fifo->buffer);
+                config.MA[1]    = 0;
+                config.NDT      = fifo->size;
+                config.FC       = 0;
+                config.CR       = DMA_SxCR_CHSEL_SEL(DEV->DMA_channel)
+                                | DMA_SxCR_MINC_ENABLE
+                                | DMA_SxCR_CIRC_ENABLE
+                                | DMA_SxCR_DIR_P2M
+                                | DMA_SxCR_MSIZE_BYTE
+                                | DMA_SxCR_PSIZE_BYTE
+                                | DMA_SxCR_HTIE;
+
+                if (_DMA_DDI_transfer(dmad, &config) == ESUCC) {
+                        DMA_Stream_TypeDef *base = (DEV->DMA_major == 0)
+                                                 ? DMA1_Stream0 : DMA2_Stream0;
+
+                        DMA_rx[major].dmad   = dmad;
+                        DMA_rx[major].stream = &base[stream];
+
+                        SET_BIT(DEV->UART->CR3, USART_CR3_DMAR);
+                } else {
+                        _DMA_DDI_release(dmad);
+                }
+        }
+
+        return DMA_rx[major].stream != NULL;
+}
+
+//==============================================================================
+/**
+ * @brief Function handle Rx DMA half and full transfer interrupts.
+ *
+ * @param stream        DMA stream
+ * @param SR            DMA status
+ * @param arg           UART memory
+ *
+ * @return true if context switch is required, otherwise false.
+ */
+//==============================================================================
+static bool DMA_rx_callback(DMA_Stream_TypeDef *stream, u8_t SR, void *arg)
+{
+        UNUSED_ARG1(SR);
+
+        struct UART_mem *hdl = arg;
+
+        _UART_FIFO__commit(&hdl->Rx_FIFO, hdl->Rx_FIFO.size - stream->NDTR);
+
+        return _UART__rx_notify_from_ISR(hdl->major, false);
+}
+#endif
+
 //==============================================================================
 /**
  * @brief USART1 Interrupt
@@ -47,7 +47,7 @@
 /*==============================================================================
   Local function prototypes
 ==============================================================================*/
-static bool _UART_FIFO__read(struct Rx_FIFO *fifo, u8_t *data);
+
 
 /*==============================================================================
   Local object definitions
@@ -97,11 +97,15 @@ API_MOD_INIT(UART, void **device_handle, u8_t major, u8_t minor)
         if (!err) {
                 _UART_mem[major] = *device_handle;
 
+                _UART_FIFO__init(&_UART_mem[major]->Rx_FIFO,
+                                 _UART_mem[major]->Rx_buffer,
+                                 _UART_RX_BUFFER_SIZE);
+
                 err = sys_semaphore_create(1, 0, &_UART_mem[major]->write_ready_sem);
                 if (err)
                         goto finish;
 
-                err = sys_semaphore_create(_UART_RX_BUFFER_SIZE, 0, &_UART_mem[major]->data_read_sem);
+                err = sys_semaphore_create(1, 0, &_UART_mem[major]->data_read_sem);
                 if (err)
                         goto finish;
 
@@ -128,8 +132,8 @@ API_MOD_INIT(UART, void **device_handle, u8_t major, u8_t minor)
                         if (_UART_mem[major]->port_lock_rx_mtx)
                                 sys_mutex_destroy(_UART_mem[major]->port_lock_rx_mtx);
 
-                        if (_UART_mem[major]->write_ready_sem)
-                                sys_semaphore_destroy(_UART_mem[major]->write_ready_sem);
+                        if (_UART_mem[major]->data_read_sem)
+                                sys_semaphore_destroy(_UART_mem[major]->data_read_sem);
 
                         if (_UART_mem[major]->write_ready_sem)
                                 sys_semaphore_destroy(_UART_mem[major]->write_ready_sem);
@@ -161,10 +165,11 @@ API_MOD_RELEASE(UART, void *device_handle)
                         sys_mutex_destroy(hdl->port_lock_rx_mtx);
                         sys_mutex_destroy(hdl->port_lock_tx_mtx);
 
-                        sys_semaphore_destroy(hdl->write_ready_sem);
-
                         _UART_LLD__turn_off(hdl->major);
 
+                        sys_semaphore_destroy(hdl->write_ready_sem);
+                        sys_semaphore_destroy(hdl->data_read_sem);
+
                         _UART_mem[hdl->major] = NULL;
                         sys_free(device_handle);
 
@@ -294,7 +299,7 @@ API_MOD_READ(UART,
              size_t          *rdcnt,
              struct vfs_fattr fattr)
 {
-        UNUSED_ARG2(fpos, fattr);
+        UNUSED_ARG1(fpos);
 
         struct UART_mem *hdl = device_handle;
 
@@ -302,15 +307,26 @@ API_MOD_READ(UART,
         if (!err) {
                 *rdcnt = 0;
 
-                while (count--) {
-                        err = sys_semaphore_wait(hdl->data_read_sem, RX_WAIT_TIMEOUT);
-                        if (!err) {
-                                _UART_LLD__rx_hold(hdl->major);
-                                if (_UART_FIFO__read(&hdl->Rx_FIFO, dst)) {
-                                        dst++;
-                                        (*rdcnt)++;
-                                }
-                                _UART_LLD__rx_resume(hdl->major);
+                while (!err) {
+                        _UART_LLD__rx_hold(hdl->major);
+
+                        *rdcnt += _UART_FIFO__read(&hdl->Rx_FIFO,
+                                                   &dst[*rdcnt],
+                                                   count - *rdcnt);
+
+                        bool wait = (*rdcnt < count) && !fattr.non_blocking_rd;
+                        if (wait) {
+                                _UART_FIFO__set_wake_level(&hdl->Rx_FIFO,
+                                                           count - *rdcnt);
+                        }
+
+                        _UART_LLD__rx_resume(hdl->major);
+
+                        if (wait) {
+                                err = sys_semaphore_wait(hdl->data_read_sem,
+                                                         RX_WAIT_TIMEOUT);
+                        } else {
+                                break;
                         }
                 }
 
@@ -350,12 +366,28 @@ API_MOD_IOCTL(UART, void *device_handle, int request, void *arg)
                         break;
 
                 case IOCTL_UART__GET_CHAR_UNBLOCKING:
-                        if (!_UART_FIFO__read(&hdl->Rx_FIFO, arg)) {
+                        _UART_LLD__rx_hold(hdl->major);
+                        if (_UART_FIFO__read(&hdl->Rx_FIFO, arg, 1) == 0) {
                                 err = EAGAIN;
                         } else {
                                 err = ESUCC;
                         }
+                        _UART_LLD__rx_resume(hdl->major);
+                        break;
+
+                case IOCTL_UART__GET_RX_STAT: {
+                        UART_rx_stat_t *stat = arg;
+
+                        _UART_LLD__rx_hold(hdl->major);
+                        stat->received      = hdl->Rx_FIFO.received;
+                        stat->fifo_overruns = hdl->Rx_FIFO.overruns;
+                        stat->hw_overruns   = hdl->Rx_HW_overruns;
+                        stat->buffered      = hdl->Rx_FIFO.buffer_level;
+                        _UART_LLD__rx_resume(hdl->major);
+
+                        err = ESUCC;
                         break;
+                }
 
                 default:
                         err = EBADRQC;
@@ -405,56 +437,26 @@ API_MOD_STAT(UART, void *device_handle, struct vfs_dev_stat *device_stat)
 
 //==============================================================================
 /**
- * @brief Function write data to FIFO
+ * @brief Function wake up reader if enough data was received or line is idle.
+ *        Function is called by LLD from IRQ (after data was put to Rx FIFO).
  *
- * @param fifo          fifo buffer
- * @param data          data to write
+ * @param major         UART major number
+ * @param idle          line idle detected
  *
- * @return true if success, false on error
+ * @return true if context switch is required, otherwise false.
  */
 //==============================================================================
-bool _UART_FIFO__write(struct Rx_FIFO *fifo, u8_t *data)
+bool _UART__rx_notify_from_ISR(u8_t major, bool idle)
 {
-        if (fifo->buffer_level < _UART_RX_BUFFER_SIZE) {
-                fifo->buffer[fifo->write_index++] = *data;
-
-                if (fifo->write_index >= _UART_RX_BUFFER_SIZE) {
-                        fifo->write_index = 0;
-                }
+        bool yield = false;
 
-                fifo->buffer_level++;
+        struct UART_mem *hdl = _UART_mem[major];
 
-                return true;
-        } else {
-                return false;
+        if (hdl && _UART_FIFO__wake_reader(&hdl->Rx_FIFO, idle)) {
+                sys_semaphore_signal_from_ISR(hdl->data_read_sem, &yield);
         }
-}
-
-//==============================================================================
-/**
- * @brief Function read data from FIFO
- *
- * @param fifo          fifo buffer
- * @param data          data result
- *
- * @return true if success, false on error
- */
-//==============================================================================
-static bool _UART_FIFO__read(struct Rx_FIFO *fifo, u8_t *data)
-{
-        if (fifo->buffer_level > 0) {
-                *data = fifo->buffer[fifo->read_index++];
 
-                if (fifo->read_index >= _UART_RX_BUFFER_SIZE) {
-                        fifo->read_index = 0;
-                }
-
-                fifo->buffer_level--;
-
-                return true;
-        } else {
-                return false;
-        }
+        return yield;
 }
 
 /*==============================================================================
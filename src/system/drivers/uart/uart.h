@@ -33,6 +33,7 @@
   Include files
 ==============================================================================*/
 #include "uart_ioctl.h"
+#include "uart_fifo.h"
 
 #if defined(ARCH_stm32f1)
 #include "stm32f1/uart_cfg.h"
@@ -121,12 +122,9 @@ enum {
 /* USART handling structure */
 struct UART_mem {
         // Rx FIFO
-        struct Rx_FIFO {
-                u8_t            buffer[_UART_RX_BUFFER_SIZE];
-                u16_t           buffer_level;
-                u16_t           read_index;
-                u16_t           write_index;
-        } Rx_FIFO;
+        struct Rx_FIFO          Rx_FIFO;
+        u8_t                    Rx_buffer[_UART_RX_BUFFER_SIZE];
+        u32_t                   Rx_HW_overruns;
 
         // Tx FIFO
         struct Tx_buffer {
@@ -158,7 +156,7 @@ extern void _UART_LLD__abort_trasmission(u8_t major);
 extern void _UART_LLD__rx_resume(u8_t major);
 extern void _UART_LLD__rx_hold(u8_t major);
 extern void _UART_LLD__configure(u8_t major, const struct UART_config *config);
-extern bool _UART_FIFO__write(struct Rx_FIFO *fifo, u8_t *data);
+extern bool _UART__rx_notify_from_ISR(u8_t major, bool idle);
 
 /*==============================================================================
   Exported inline functions
@@ -0,0 +1,220 @@
+/*=========================================================================*//**
+@file    uart_fifo.c
+
+@author  Daniel Zorychta
+
+@brief   UART receive FIFO. Functions are called from IRQ (write, commit,
+         wake_reader) and from driver with IRQ held (read, set_wake_level).
+
+@note    Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include <string.h>
+#include "uart_fifo.h"
+
+/*==============================================================================
+  Local symbolic constants/macros
+==============================================================================*/
+
+/*==============================================================================
+  Local types, enums definitions
+==============================================================================*/
+
+/*==============================================================================
+  Local function prototypes
+==============================================================================*/
+
+/*==============================================================================
+  Local object definitions
+==============================================================================*/
+
+/*==============================================================================
+  Function definitions
+==============================================================================*/
+
+//==============================================================================
+/**
+ * @brief Function initialize FIFO
+ *
+ * @param fifo          fifo buffer
+ * @param buffer        data buffer
+ * @param size          data buffer size
+ */
+//==============================================================================
+void _UART_FIFO__init(struct Rx_FIFO *fifo, uint8_t *buffer, uint16_t size)
+{
+        memset(fifo, 0, sizeof(struct Rx_FIFO));
+        fifo->buffer = buffer;
+        fifo->size   = size;
+}
+
+//==============================================================================
+/**
+ * @brief Function write data to FIFO
+ *
+ * @param fifo          fifo buffer
+ * @param data          data to write
+ *
+ * @return true if success, false on error
+ */
+//==============================================================================
+bool _UART_FIFO__write(struct Rx_FIFO *fifo, uint8_t *data)
+{
+        if (fifo->buffer_level < fifo->size) {
+                fifo->buffer[fifo->write_index++] = *data;
+
+                if (fifo->write_index >= fifo->size) {
+                        fifo->write_index = 0;
+                }
+
+                fifo->buffer_level++;
+                fifo->received++;
+
+                return true;
+        } else {
+                fifo->overruns++;
+                return false;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Function read all available data from FIFO (at most two copies).
+ *
+ * @param fifo          fifo buffer
+ * @param dst           destination buffer
+ * @param count         destination buffer size
+ *
+ * @return Number of read bytes.
+ */
+//==============================================================================
+size_t _UART_FIFO__read(struct Rx_FIFO *fifo, uint8_t *dst, size_t count)
+{
+        size_t n = 0;
+
+        while (n < count && fifo->buffer_level > 0) {
+                size_t span = fifo->size - fifo->read_index;
+
+                if (span > fifo->buffer_level) {
+                        span = fifo->buffer_level;
+                }
+
+                if (span > count - n) {
+                        span = count - n;
+                }
+
+                memcpy(&dst[n], &fifo->buffer[fifo->read_index], span);
+
+                n                  += span;
+                fifo->buffer_level -= span;
+                fifo->read_index   += span;
+
+                if (fifo->read_index >= fifo->size) {
+                        fifo->read_index = 0;
+                }
+        }
+
+        return n;
+}
+
+//==============================================================================
+/**
+ * @brief Function commit data written to FIFO buffer directly by DMA
+ *        (circular mode). If received data overwrote not read data then the
+ *        oldest data are lost.
+ *
+ * @param fifo          fifo buffer
+ * @param write_index   current write position of DMA
+ */
+//==============================================================================
+void _UART_FIFO__commit(struct Rx_FIFO *fifo, uint16_t write_index)
+{
+        if (write_index >= fifo->size) {
+                write_index = 0;
+        }
+
+        uint16_t n = (write_index >= fifo->write_index)
+                   ? (write_index - fifo->write_index)
+                   : (fifo->size - fifo->write_index + write_index);
+
+        fifo->write_index = write_index;
+        fifo->received   += n;
+
+        if (fifo->buffer_level + n > fifo->size) {
+                fifo->overruns    += fifo->buffer_level + n - fifo->size;
+                fifo->buffer_level = fifo->size;
+                fifo->read_index   = write_index;
+        } else {
+                fifo->buffer_level += n;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Function set FIFO level that wake up reader. Level is limited to half
+ *        of buffer, so reader drain FIFO before it overflow.
+ *
+ * @param fifo          fifo buffer
+ * @param count         number of bytes expected by reader (0: reader not waiting)
+ */
+//==============================================================================
+void _UART_FIFO__set_wake_level(struct Rx_FIFO *fifo, size_t count)
+{
+        size_t max = fifo->size / 2;
+
+        if (max == 0) {
+                max = 1;
+        }
+
+        fifo->wake_level = (count > max) ? max : count;
+}
+
+//==============================================================================
+/**
+ * @brief Function check if waiting reader should be woken up. Reader is woken
+ *        up when FIFO level reach wake level or when line is idle and FIFO
+ *        contains any data. Wake level is cleared when reader is woken up.
+ *
+ * @param fifo          fifo buffer
+ * @param idle          line idle detected
+ *
+ * @return true if reader should be woken up, otherwise false.
+ */
+//==============================================================================
+bool _UART_FIFO__wake_reader(struct Rx_FIFO *fifo, bool idle)
+{
+        if (  (fifo->wake_level > 0)
+           && (  (fifo->buffer_level >= fifo->wake_level)
+              || (idle && fifo->buffer_level > 0) ) ) {
+
+                fifo->wake_level = 0;
+                return true;
+        }
+
+        return false;
+}
+
+/*==============================================================================
+  End of file
+==============================================================================*/
@@ -0,0 +1,88 @@
+/*=========================================================================*//**
+@file    uart_fifo.h
+
+@author  Daniel Zorychta
+
+@brief   UART receive FIFO. Module does not depend on the system and
+         peripheral headers.
+
+@note    Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+#ifndef _UART_FIFO_H_
+#define _UART_FIFO_H_
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==============================================================================
+  Exported macros
+==============================================================================*/
+
+/*==============================================================================
+  Exported object types
+==============================================================================*/
+/* Rx FIFO (written by IRQ/DMA, read by driver) */
+struct Rx_FIFO {
+        uint8_t        *buffer;         //!< FIFO buffer
+        uint16_t        size;           //!< buffer size
+        uint16_t        buffer_level;   //!< number of bytes in FIFO
+        uint16_t        read_index;     //!< read position
+        uint16_t        write_index;    //!< write position
+        uint16_t        wake_level;     //!< level that wakes reader (0: reader not waiting)
+        uint32_t        received;       //!< number of received bytes
+        uint32_t        overruns;       //!< number of bytes lost because FIFO was full
+};
+
+/*==============================================================================
+  Exported objects
+==============================================================================*/
+
+/*==============================================================================
+  Exported functions
+==============================================================================*/
+extern void     _UART_FIFO__init(struct Rx_FIFO *fifo, uint8_t *buffer, uint16_t size);
+extern bool     _UART_FIFO__write(struct Rx_FIFO *fifo, uint8_t *data);
+extern size_t   _UART_FIFO__read(struct Rx_FIFO *fifo, uint8_t *dst, size_t count);
+extern void     _UART_FIFO__commit(struct Rx_FIFO *fifo, uint16_t write_index);
+extern void     _UART_FIFO__set_wake_level(struct Rx_FIFO *fifo, size_t count);
+extern bool     _UART_FIFO__wake_reader(struct Rx_FIFO *fifo, bool idle);
+
+/*==============================================================================
+  Exported inline functions
+==============================================================================*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _UART_FIFO_H_ */
+/*==============================================================================
+  End of file
+==============================================================================*/
@@ -81,6 +81,11 @@ Reading data from device is the same as reading data from regular file. Driver
 support not blocking character read by using ioctl() function (by using following
 requests: @ref IOCTL_UART__GET_CHAR_UNBLOCKING or @ref IOCTL_VFS__NON_BLOCKING_RD_MODE
 with fread() function). File position is ignored because device handle stream.
+Received data are copied from Rx FIFO in blocks. Reader is woken up when
+requested number of bytes (at most half of Rx FIFO) is received or when line is
+idle. On stm32f4 the receiver can use DMA in circular mode (see configuration).
+Receiver statistics (e.g. overruns) can be read by using
+@ref IOCTL_UART__GET_RX_STAT request.
 
 @{
 */
@@ -121,6 +126,13 @@ extern "C" {
  */
 #define IOCTL_UART__GET_CHAR_UNBLOCKING         _IOR(UART, 0x02, char*)
 
+/**
+ *  @brief  Gets receiver statistics (received bytes and overruns).
+ *  @param  [RD] struct @ref UART_rx_stat_t * receiver statistics
+ *  @return On success 0 is returned, otherwise -1.
+ */
+#define IOCTL_UART__GET_RX_STAT                 _IOR(UART, 0x03, struct UART_rx_stat*)
+
 /*==============================================================================
   Exported object types
 ==============================================================================*/
@@ -164,6 +176,16 @@ typedef struct UART_config {
         u32_t               baud;               /*!< Baudrate.*/
 } UART_config_t;
 
+/**
+ * Type represent receiver statistics.
+ */
+typedef struct UART_rx_stat {
+        u32_t               received;           /*!< Number of received bytes.*/
+        u32_t               fifo_overruns;      /*!< Number of bytes lost because Rx FIFO was full.*/
+        u32_t               hw_overruns;        /*!< Number of peripheral overrun errors.*/
+        u32_t               buffered;           /*!< Number of bytes waiting in Rx FIFO.*/
+} UART_rx_stat_t;
+
 /*==============================================================================
   Exported objects
 ==============================================================================*/
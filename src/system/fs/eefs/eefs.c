@@ -64,11 +64,18 @@ Brief    EEPROM File System. File system for small memories 1-64KiB EEPROM.
 
 #define NAME_LEN                        21      // note: modify with care
 
+#define BMP_BLOCKS_MAX                  (1 + 64)
+#define BMP_MAIN_SIZE                   sizeof(((block_main_t*)0)->bitmap)
+#define BMP_BLOCK_SIZE                  sizeof(((block_bitmap_t*)0)->map)
+
 #define cache_get_block(sys_cache)      cast(block_cached_t*, &sys_cache[1])->block
 #define cache_get_block_num(sys_cache)  cast(block_cached_t*, &sys_cache[1])->block_num
 
 #define FLAG_SYNC                       (1<<0)
 #define FLAG_RDONLY                     (1<<1)
+#define FLAG_WL                         (1<<2)
+
+#define WBUF_BLOCKS_MAX                 16
 
 #define block_is_dir(block_buf)         (block_buf.buf.dir.magic  == BLOCK_MAGIC_DIR)
 #define block_is_dir_entry(block_buf)   (block_buf.buf.dir_entry.magic  == BLOCK_MAGIC_DIR_ENTRY)
@@ -241,6 +248,41 @@ typedef struct {
         block_t buf;
 } block_buf_t;
 
+/**
+ * In-RAM copy of free block bitmap (loaded at first use). Bitmap of main
+ * block and all bitmap blocks are stored continuously. Modified bitmap
+ * blocks are written at sync.
+ */
+typedef struct {
+        u8_t        *map;                               //!< free block bitmap (bit set: free)
+        u16_t        blocks;                            //!< number of blocks in FS
+        u16_t        cursor;                            //!< next-fit allocation cursor
+        u16_t        used;                              //!< number of used blocks
+        u8_t         bitmap_blocks;                     //!< number of bitmap blocks
+        u8_t         dirty[(BMP_BLOCKS_MAX + 7) / 8];   //!< modified bitmap blocks
+} bmp_cache_t;
+
+/**
+ * Write-combining buffer entry. Modified block is kept in RAM and programmed
+ * once at eviction, file close, flush or sync, so many small writes to the
+ * same block (e.g. file head size and mtime update) cost single program cycle.
+ */
+typedef struct {
+        block_buf_t  blk;                               //!< block image (checksum included)
+        u16_t        age;                               //!< last access stamp (LRU)
+        bool         valid;                             //!< entry contains block image
+        bool         dirty;                             //!< block must be programmed
+} wbuf_entry_t;
+
+/**
+ * Write-combining buffer (enabled by "wbuf=<blocks>" mount option).
+ */
+typedef struct {
+        wbuf_entry_t *entry;                            //!< buffer entries
+        u8_t          count;                            //!< number of entries
+        u16_t         stamp;                            //!< access counter
+} wbuf_t;
+
 /**
  * File system handle.
  */
@@ -252,6 +294,8 @@ typedef struct {
         uint16_t     root_dir_block;
         block_buf_t  block;
         block_buf_t  tmpblock;
+        bmp_cache_t  bmp;
+        wbuf_t       wbuf;
         u8_t         flag;
 } EEFS_t;
 
@@ -261,6 +305,7 @@ typedef struct {
 static uint16_t fletcher16(uint8_t const *data, size_t bytes);
 static int block_read(EEFS_t *hdl, block_buf_t *blk);
 static int block_write(EEFS_t *hdl, block_buf_t *blk);
+static int block_program(EEFS_t *hdl, const block_buf_t *blk);
 static bool is_entry_item_used(dir_entry_t *entry);
 static tfile_t eefs2vfs_file_type(uint8_t eefs_file_type);
 static int block_load(EEFS_t *hdl, const char *path);
@@ -271,6 +316,14 @@ static int bmp_block_alloc_ctrl(EEFS_t *hdl, uint16_t blknum, bool allocate);
 static int bmp_block_alloc(EEFS_t *hdl, uint16_t blknum);
 static int bmp_block_free(EEFS_t *hdl, uint16_t blknum);
 static int bmp_get_used_blocks(EEFS_t *hdl, uint16_t *blkused);
+static int bmp_load(EEFS_t *hdl);
+static int bmp_flush(EEFS_t *hdl);
+static void bmp_release(EEFS_t *hdl);
+static int wbuf_init(EEFS_t *hdl, int blocks);
+static int wbuf_flush(EEFS_t *hdl);
+static void wbuf_release(EEFS_t *hdl);
+static wbuf_entry_t *wbuf_find(EEFS_t *hdl, u16_t blknum);
+static int wbuf_write(EEFS_t *hdl, const block_buf_t *blk);
 static const char *path_get_next_item(const char *path, char **name, size_t *len, bool *last);
 static const char *path_get_last_slash(const char *path);
 static int path_alloc_dirname(const char *path, char **path_base);
@@ -341,6 +394,16 @@ API_FS_INIT(eefs, void **fs_handle, const char *src_path, const char *opts)
                                                 hdl->flag |= FLAG_RDONLY;
                                                 DBG("readonly mount");
                                         }
+
+                                        if (sys_stropt_is_flag(opts, "wl")) {
+                                                hdl->flag |= FLAG_WL;
+                                                DBG("enabled wear spreading");
+                                        }
+
+                                        int wbuf = sys_stropt_get_int(opts, "wbuf", 0);
+                                        if (wbuf > 0 && !(hdl->flag & FLAG_RDONLY)) {
+                                                err = wbuf_init(hdl, wbuf);
+                                        }
                                 }
                         } else {
                                 err = EMEDIUMTYPE;
@@ -351,6 +414,8 @@ API_FS_INIT(eefs, void **fs_handle, const char *src_path, const char *opts)
                 if (err) {
                         DBG("init error %d", err);
 
+                        wbuf_release(hdl);
+
                         if (hdl->srcdev) {
                                 sys_fclose(hdl->srcdev);
                         }
@@ -383,6 +448,11 @@ API_FS_RELEASE(eefs, void *fs_handle)
         if (!err) {
                 if ((hdl->open_files == NULL) && (hdl->open_dirs == NULL)) {
 
+                        bmp_flush(hdl);
+                        bmp_release(hdl);
+                        wbuf_flush(hdl);
+                        wbuf_release(hdl);
+
                         sys_cache_drop(hdl->srcdev);
                         sys_fclose(hdl->srcdev);
 
@@ -981,16 +1051,11 @@ API_FS_STATFS(eefs, void *fs_handle, struct statfs *statfs)
         int err = sys_mutex_lock(hdl->lock_mtx, BUSY_TIMEOUT);
         if (!err) {
 
-                hdl->block.num = 0;
-                err = block_read(hdl, &hdl->block);
+                u16_t blkused = 0;
+                err = bmp_get_used_blocks(hdl, &blkused);
                 if (!err) {
-                        statfs->f_blocks = hdl->block.buf.main.blocks;
-
-                        u16_t blkused = 0;
-                        err = bmp_get_used_blocks(hdl, &blkused);
-                        if (!err) {
-                                statfs->f_bfree = statfs->f_blocks - blkused;
-                        }
+                        statfs->f_blocks = hdl->bmp.blocks;
+                        statfs->f_bfree  = statfs->f_blocks - blkused;
                 }
 
                 sys_mutex_unlock(hdl->lock_mtx);
@@ -1121,7 +1186,10 @@ API_FS_CLOSE(eefs, void *fs_handle, void *fhdl, bool force)
                                         if (dev != -1) {
                                                 err = sys_driver_close(dev, force);
                                         } else {
-                                                err = ESUCC;
+                                                err = wbuf_flush(hdl);
+                                                if (force) {
+                                                        err = ESUCC;
+                                                }
                                         }
 
                                         if (!err) {
@@ -1354,6 +1422,8 @@ API_FS_FLUSH(eefs, void *fs_handle, void *fhdl)
                         if (!err) {
                                 if (block_is_node(hdl->block)) {
                                         dev = hdl->block.buf.node.dev;
+                                } else {
+                                        err = wbuf_flush(hdl);
                                 }
                         }
 
@@ -1379,9 +1449,20 @@ API_FS_FLUSH(eefs, void *fs_handle, void *fhdl)
 //==============================================================================
 API_FS_SYNC(eefs, void *fs_handle)
 {
-        UNUSED_ARG1(fs_handle);
+        EEFS_t *hdl = fs_handle;
+
+        int err = sys_mutex_lock(hdl->lock_mtx, BUSY_TIMEOUT);
+        if (!err) {
+                err = bmp_flush(hdl);
+
+                if (!err) {
+                        err = wbuf_flush(hdl);
+                }
+
+                sys_mutex_unlock(hdl->lock_mtx);
+        }
 
-        return ESUCC;
+        return err;
 }
 
 //==============================================================================
@@ -1430,6 +1511,15 @@ static uint16_t fletcher16(uint8_t const *data, size_t bytes)
 //==============================================================================
 static int block_read(EEFS_t *hdl, block_buf_t *blk)
 {
+        if (hdl->wbuf.entry) {
+                wbuf_entry_t *entry = wbuf_find(hdl, blk->num);
+                if (entry) {
+                        entry->age = ++hdl->wbuf.stamp;
+                        memcpy(&blk->buf, &entry->blk.buf, sizeof(block_t));
+                        return ESUCC;
+                }
+        }
+
         memset(&blk->buf, 0, 128);
 
         int err = sys_cache_read(hdl->srcdev, blk->num, sizeof(block_t), 1,
@@ -1451,7 +1541,8 @@ static int block_read(EEFS_t *hdl, block_buf_t *blk)
 
 //==============================================================================
 /**
- * @brief Function write block to memory. Function uses caching subsystem.
+ * @brief Function write block to memory. If write-combining buffer is enabled
+ *        then block is stored in the buffer and programmed later.
  *
  * @param  hdl          FS handle.
  * @param  blk          block to write.
@@ -1469,13 +1560,33 @@ static int block_write(EEFS_t *hdl, block_buf_t *blk)
                                                      sizeof(blk->buf.chsum.buf))
                                         ^ blk->num;
 
-                return sys_cache_write(hdl->srcdev, blk->num, sizeof(block_t), 1,
-                                       cast(u8_t*, &blk->buf),
-                                       hdl->flag & FLAG_SYNC ? CACHE_WRITE_THROUGH
-                                                             : CACHE_WRITE_BACK);
+                if (hdl->wbuf.entry) {
+                        return wbuf_write(hdl, blk);
+                } else {
+                        return block_program(hdl, blk);
+                }
         }
 }
 
+//==============================================================================
+/**
+ * @brief Function program block (with calculated checksum) to memory. Function
+ *        uses caching subsystem.
+ *
+ * @param  hdl          FS handle.
+ * @param  blk          block to write.
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int block_program(EEFS_t *hdl, const block_buf_t *blk)
+{
+        return sys_cache_write(hdl->srcdev, blk->num, sizeof(block_t), 1,
+                               cast(const u8_t*, &blk->buf),
+                               hdl->flag & FLAG_SYNC ? CACHE_WRITE_THROUGH
+                                                     : CACHE_WRITE_BACK);
+}
+
 //==============================================================================
 /**
  * @brief  Function check if entry is used.
@@ -1702,141 +1813,392 @@ static int block_get_file_stat(EEFS_t *hdl, struct stat *stat)
 
 //==============================================================================
 /**
- * @brief  Function find empty block by using bitmap.
+ * @brief  Function load free block bitmap to RAM. Bitmap is loaded only once,
+ *         next calls do not access medium.
  *
  * @param  hdl          EEFS handle
- * @param  blknum       found empty block
  *
  * @return One of errno value.
  */
 //==============================================================================
-static int bmp_block_find_empty(EEFS_t *hdl, uint16_t *blknum)
+static int bmp_load(EEFS_t *hdl)
 {
+        if (hdl->bmp.map) {
+                return ESUCC;
+        }
+
         hdl->tmpblock.num = MAIN_BLOCK_ADDR;
         int err = block_read(hdl, &hdl->tmpblock);
         if (!err) {
-
                 if (hdl->tmpblock.buf.main.magic != BLOCK_MAGIC_MAIN) {
-                        err = EILSEQ;
-                        goto finish;
+                        return EILSEQ;
                 }
 
-                uint16_t blks    = hdl->tmpblock.buf.main.blocks;
-                uint16_t bmpblks = hdl->tmpblock.buf.main.bitmap_blocks;
-                uint8_t *bmp     = hdl->tmpblock.buf.main.bitmap;
-                uint8_t  bsz     = sizeof(hdl->tmpblock.buf.main.bitmap);
-                uint8_t  bmpnext = 1;
+                u8_t  bmpblks = hdl->tmpblock.buf.main.bitmap_blocks;
+                u16_t blocks  = hdl->tmpblock.buf.main.blocks;
+                u8_t *map     = NULL;
 
-                *blknum = 0;
+                // bits out of bitmap blocks are zeroed, so are seen as used
+                size_t size = max(BMP_MAIN_SIZE + (bmpblks * BMP_BLOCK_SIZE),
+                                  (blocks + 7) / 8u);
 
-                do {
-                        for (u8_t i = 0; i < bsz && blks > 0; i++, blks -= 8) {
-                                if (bmp[i] == 0) {
-                                        continue;
-                                }
+                err = sys_zalloc(size, cast(void**, &map));
+                if (err) {
+                        return err;
+                }
 
-                                for (u8_t bit = 0; bit < 8; bit++) {
-                                        if ((bmp[i] >> bit) & 1) {
-                                                *blknum += (i * 8) + bit;
-                                                goto finish;
-                                        }
+                memcpy(map, hdl->tmpblock.buf.main.bitmap, BMP_MAIN_SIZE);
+
+                for (u8_t i = 1; !err && i <= bmpblks; i++) {
+                        hdl->tmpblock.num = i;
+                        err = block_read(hdl, &hdl->tmpblock);
+                        if (!err) {
+                                if (hdl->tmpblock.buf.bitmap.magic == BLOCK_MAGIC_BITMAP) {
+                                        memcpy(&map[BMP_MAIN_SIZE + ((i - 1) * BMP_BLOCK_SIZE)],
+                                               hdl->tmpblock.buf.bitmap.map, BMP_BLOCK_SIZE);
+                                } else {
+                                        DBG("Invalid bitmap block");
+                                        err = EILSEQ;
                                 }
                         }
+                }
 
-                        if (bmpblks && blks > 0) {
-                                *blknum += (bsz * 8);
-
-                                hdl->tmpblock.num = bmpnext;
-                                err = block_read(hdl, &hdl->tmpblock);
-                                if (!err) {
-                                        if (hdl->block.buf.bitmap.magic == BLOCK_MAGIC_BITMAP) {
-                                                bmp = hdl->block.buf.bitmap.map;
-                                                bsz = sizeof(hdl->block.buf.bitmap.map);
-                                                bmpnext++;
-                                        } else {
-                                                DBG("Invalid bitmap block");
-                                                err = EILSEQ;
-                                        }
+                if (!err) {
+                        hdl->bmp.map           = map;
+                        hdl->bmp.blocks        = blocks;
+                        hdl->bmp.bitmap_blocks = bmpblks;
+                        hdl->bmp.cursor        = 0;
+                        hdl->bmp.used          = 0;
+
+                        if (hdl->flag & FLAG_WL) {
+                                // start allocations at different place after each
+                                // mount to not wear blocks at beginning of medium
+                                time_t time = 0;
+                                sys_get_time(&time);
+                                hdl->bmp.cursor = (cast(u32_t, time) ^ sys_get_uptime_ms())
+                                                % blocks;
+                        }
+                        memset(hdl->bmp.dirty, 0, sizeof(hdl->bmp.dirty));
+
+                        for (u16_t blk = 0; blk < blocks; blk++) {
+                                if (!(map[blk / 8] & (1 << (blk % 8)))) {
+                                        hdl->bmp.used++;
                                 }
                         }
+                } else {
+                        sys_free(cast(void**, &map));
+                }
+        }
 
-                        if (*blknum == 0) {
-                                err = ENOSPC;
-                        }
-                } while (!err && bmpblks--);
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief  Function write modified bitmap blocks to medium. Each modified block
+ *         is written once independently of number of changes.
+ *
+ * @param  hdl          EEFS handle
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int bmp_flush(EEFS_t *hdl)
+{
+        int err = ESUCC;
+
+        for (u8_t i = 0; !err && hdl->bmp.map && i <= hdl->bmp.bitmap_blocks; i++) {
+
+                if (!(hdl->bmp.dirty[i / 8] & (1 << (i % 8)))) {
+                        continue;
+                }
+
+                memset(&hdl->tmpblock.buf, 0, sizeof(hdl->tmpblock.buf));
+                hdl->tmpblock.num = i;
+
+                if (i == MAIN_BLOCK_ADDR) {
+                        hdl->tmpblock.buf.main.magic         = BLOCK_MAGIC_MAIN;
+                        hdl->tmpblock.buf.main.blocks        = hdl->bmp.blocks;
+                        hdl->tmpblock.buf.main.bitmap_blocks = hdl->bmp.bitmap_blocks;
+                        memcpy(hdl->tmpblock.buf.main.bitmap, hdl->bmp.map, BMP_MAIN_SIZE);
+                } else {
+                        hdl->tmpblock.buf.bitmap.magic = BLOCK_MAGIC_BITMAP;
+                        memcpy(hdl->tmpblock.buf.bitmap.map,
+                               &hdl->bmp.map[BMP_MAIN_SIZE + ((i - 1) * BMP_BLOCK_SIZE)],
+                               BMP_BLOCK_SIZE);
+                }
+
+                err = block_write(hdl, &hdl->tmpblock);
+                if (!err) {
+                        hdl->bmp.dirty[i / 8] &= ~(1 << (i % 8));
+                }
         }
 
-        finish:
         return err;
 }
 
 //==============================================================================
 /**
- * @brief  Function allocate/release block.
+ * @brief  Function release bitmap cache (modified blocks are not written).
  *
  * @param  hdl          EEFS handle
- * @param  blknum       block number to allocate/release
- * @param  allocate     allocate block if true, otherwise release
+ */
+//==============================================================================
+static void bmp_release(EEFS_t *hdl)
+{
+        if (hdl->bmp.map) {
+                sys_free(cast(void**, &hdl->bmp.map));
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Function allocate write-combining buffer.
+ *
+ * @param  hdl          EEFS handle
+ * @param  blocks       number of buffered blocks
  *
  * @return One of errno value.
  */
 //==============================================================================
-static int bmp_block_alloc_ctrl(EEFS_t *hdl, uint16_t blknum, bool allocate)
+static int wbuf_init(EEFS_t *hdl, int blocks)
 {
-        hdl->tmpblock.num = MAIN_BLOCK_ADDR;
-        int err = block_read(hdl, &hdl->tmpblock);
+        blocks = min(blocks, WBUF_BLOCKS_MAX);
+
+        int err = sys_zalloc(blocks * sizeof(wbuf_entry_t),
+                             cast(void**, &hdl->wbuf.entry));
         if (!err) {
+                hdl->wbuf.count = blocks;
+                hdl->wbuf.stamp = 0;
+                DBG("write-combining buffer: %d blocks", blocks);
+        }
 
-                if (hdl->tmpblock.buf.main.magic != BLOCK_MAGIC_MAIN) {
-                        err = EILSEQ;
-                        goto finish;
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief  Function program all modified blocks of write-combining buffer.
+ *         Blocks are programmed in ascending order (sequential access of
+ *         memory pages).
+ *
+ * @param  hdl          EEFS handle
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int wbuf_flush(EEFS_t *hdl)
+{
+        int err = ESUCC;
+
+        while (!err && hdl->wbuf.entry) {
+                wbuf_entry_t *next = NULL;
+
+                for (u8_t i = 0; i < hdl->wbuf.count; i++) {
+                        wbuf_entry_t *entry = &hdl->wbuf.entry[i];
+
+                        if (  entry->valid && entry->dirty
+                           && (next == NULL || entry->blk.num < next->blk.num)) {
+                                next = entry;
+                        }
                 }
 
-                if (blknum >= hdl->tmpblock.buf.main.blocks) {
-                        err = ENOSPC;
-                        goto finish;
+                if (next == NULL) {
+                        break;
                 }
 
-                u16_t bmpblk = 0;
-                u8_t  blkidx = (blknum / 8);
-                u8_t  blkbit = (blknum % 8);
-                u8_t *bmp    = hdl->tmpblock.buf.main.bitmap;
+                err = block_program(hdl, &next->blk);
+                if (!err) {
+                        next->dirty = false;
+                }
+        }
 
-                if (blkidx >= sizeof(hdl->tmpblock.buf.main.bitmap)) {
+        return err;
+}
 
-                        blkidx -= sizeof(hdl->tmpblock.buf.main.bitmap);
-                        bmpblk  = (blkidx / sizeof(hdl->tmpblock.buf.bitmap.map));
-                        blkidx -= bmpblk * sizeof(hdl->tmpblock.buf.bitmap.map);
-                        bmpblk += 1;
+//==============================================================================
+/**
+ * @brief  Function release write-combining buffer (modified blocks are not
+ *         written).
+ *
+ * @param  hdl          EEFS handle
+ */
+//==============================================================================
+static void wbuf_release(EEFS_t *hdl)
+{
+        if (hdl->wbuf.entry) {
+                sys_free(cast(void**, &hdl->wbuf.entry));
+                hdl->wbuf.count = 0;
+        }
+}
 
-                        if (bmpblk <= hdl->tmpblock.buf.main.bitmap_blocks) {
-                                hdl->tmpblock.num = bmpblk;
-                                err = block_read(hdl, &hdl->tmpblock);
-                                if (!err) {
-                                        bmp = hdl->tmpblock.buf.bitmap.map;
-                                }
-                        } else {
-                                err = ENOSPC;
+//==============================================================================
+/**
+ * @brief  Function find selected block in write-combining buffer.
+ *
+ * @param  hdl          EEFS handle
+ * @param  blknum       block number
+ *
+ * @return Buffer entry or NULL if block is not buffered.
+ */
+//==============================================================================
+static wbuf_entry_t *wbuf_find(EEFS_t *hdl, u16_t blknum)
+{
+        for (u8_t i = 0; i < hdl->wbuf.count; i++) {
+                wbuf_entry_t *entry = &hdl->wbuf.entry[i];
+
+                if (entry->valid && entry->blk.num == blknum) {
+                        return entry;
+                }
+        }
+
+        return NULL;
+}
+
+//==============================================================================
+/**
+ * @brief  Function store block in write-combining buffer. If block is not
+ *         buffered then free or least recently used entry is taken (modified
+ *         block of evicted entry is programmed).
+ *
+ * @param  hdl          EEFS handle
+ * @param  blk          block to write (checksum calculated)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int wbuf_write(EEFS_t *hdl, const block_buf_t *blk)
+{
+        int err = ESUCC;
+
+        wbuf_entry_t *entry = wbuf_find(hdl, blk->num);
+        if (entry == NULL) {
+                entry = &hdl->wbuf.entry[0];
+
+                for (u8_t i = 0; i < hdl->wbuf.count; i++) {
+                        wbuf_entry_t *e = &hdl->wbuf.entry[i];
+
+                        if (!e->valid) {
+                                entry = e;
+                                break;
+
+                        } else if (  cast(u16_t, hdl->wbuf.stamp - e->age)
+                                  >  cast(u16_t, hdl->wbuf.stamp - entry->age) ) {
+                                entry = e;
                         }
                 }
 
-                if (!err) {
-                        if (allocate && !(bmp[blkidx] & (1 << blkbit))) {
-                                err = EADDRINUSE;
+                if (entry->valid && entry->dirty) {
+                        err = block_program(hdl, &entry->blk);
+                }
+        }
+
+        if (!err) {
+                memcpy(&entry->blk, blk, sizeof(block_buf_t));
+                entry->valid = true;
+                entry->dirty = true;
+                entry->age   = ++hdl->wbuf.stamp;
+
+                if (hdl->flag & FLAG_SYNC) {
+                        err = block_program(hdl, &entry->blk);
+                        entry->dirty = (err != ESUCC);
+                }
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief  Function find empty block by using bitmap. Search starts at
+ *         allocation cursor (next-fit).
+ *
+ * @param  hdl          EEFS handle
+ * @param  blknum       found empty block
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int bmp_block_find_empty(EEFS_t *hdl, uint16_t *blknum)
+{
+        int err = bmp_load(hdl);
+        if (!err) {
+                u16_t blocks = hdl->bmp.blocks;
+                u16_t blk    = hdl->bmp.cursor < blocks ? hdl->bmp.cursor : 0;
+
+                for (u16_t n = 0; n < blocks; n++) {
+                        u8_t byte = hdl->bmp.map[blk / 8];
+
+                        if (byte == 0 && (blk % 8) == 0 && (blocks - blk) >= 8) {
+                                // fast skip of fully used byte
+                                n   += 7;
+                                blk += 8;
 
                         } else {
-                                if (allocate) {
-                                        bmp[blkidx] &= ~(1 << blkbit);
-                                } else {
-                                        bmp[blkidx] |= (1 << blkbit);
+                                if (blk != MAIN_BLOCK_ADDR && (byte & (1 << (blk % 8)))) {
+                                        *blknum = blk;
+                                        return ESUCC;
                                 }
 
-                                err = block_write(hdl, &hdl->tmpblock);
+                                blk++;
+                        }
+
+                        if (blk >= blocks) {
+                                blk = 0;
                         }
                 }
+
+                err = ENOSPC;
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief  Function allocate/release block.
+ *
+ * @param  hdl          EEFS handle
+ * @param  blknum       block number to allocate/release
+ * @param  allocate     allocate block if true, otherwise release
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int bmp_block_alloc_ctrl(EEFS_t *hdl, uint16_t blknum, bool allocate)
+{
+        int err = bmp_load(hdl);
+        if (!err) {
+                if (blknum >= hdl->bmp.blocks) {
+                        return ENOSPC;
+                }
+
+                u8_t *byte = &hdl->bmp.map[blknum / 8];
+                u8_t  mask = (1 << (blknum % 8));
+
+                if (allocate) {
+                        if (!(*byte & mask)) {
+                                return EADDRINUSE;
+                        }
+
+                        *byte &= ~mask;
+                        hdl->bmp.used++;
+                        hdl->bmp.cursor = blknum + 1;
+
+                } else if (!(*byte & mask)) {
+                        *byte |= mask;
+                        hdl->bmp.used--;
+                }
+
+                u16_t idx = blknum / 8;
+                u8_t  blk = (idx < BMP_MAIN_SIZE) ? 0 : 1 + ((idx - BMP_MAIN_SIZE) / BMP_BLOCK_SIZE);
+                hdl->bmp.dirty[blk / 8] |= (1 << (blk % 8));
+
+                if (hdl->flag & FLAG_SYNC) {
+                        err = bmp_flush(hdl);
+                }
         }
 
-        finish:
         return err;
 }
 
@@ -1882,56 +2244,11 @@ static int bmp_block_free(EEFS_t *hdl, uint16_t blknum)
 //==============================================================================
 static int bmp_get_used_blocks(EEFS_t *hdl, uint16_t *blkused)
 {
-        hdl->tmpblock.num = MAIN_BLOCK_ADDR;
-        int err = block_read(hdl, &hdl->tmpblock);
+        int err = bmp_load(hdl);
         if (!err) {
-
-                if (hdl->tmpblock.buf.main.magic != BLOCK_MAGIC_MAIN) {
-                        err = EILSEQ;
-                        goto finish;
-                }
-
-                uint16_t blks    = hdl->tmpblock.buf.main.blocks;
-                uint16_t bmpblks = hdl->tmpblock.buf.main.bitmap_blocks;
-                uint8_t *bmp     = hdl->tmpblock.buf.main.bitmap;
-                uint8_t  bsz     = sizeof(hdl->tmpblock.buf.main.bitmap);
-                uint8_t  bmpnext = 1;
-
-                do {
-                        for (u8_t i = 0; i < bsz && blks > 0; i++, blks -= 8) {
-                                u8_t ones;
-
-                                if (bmp[i] == 0xFF) {
-                                        ones = 8;
-                                } else if (bmp[i] == 0) {
-                                        ones = 0;
-                                } else {
-                                        ones = ((bmp[i] >> 7) & 1)
-                                             + ((bmp[i] >> 6) & 1)
-                                             + ((bmp[i] >> 5) & 1)
-                                             + ((bmp[i] >> 4) & 1)
-                                             + ((bmp[i] >> 3) & 1)
-                                             + ((bmp[i] >> 2) & 1)
-                                             + ((bmp[i] >> 1) & 1)
-                                             + ((bmp[i] >> 0) & 1);
-                                }
-
-                                *blkused += (8 - ones);
-                        }
-
-                        if (bmpblks) {
-                                hdl->tmpblock.num = bmpnext;
-                                err = block_read(hdl, &hdl->tmpblock);
-                                if (!err) {
-                                        bmp = hdl->tmpblock.buf.bitmap.map;
-                                        bsz = sizeof(hdl->tmpblock.buf.bitmap.map);
-                                        bmpnext++;
-                                }
-                        }
-                } while (!err && bmpblks--);
+                *blkused = hdl->bmp.used;
         }
 
-        finish:
         return err;
 }
 
@@ -2779,6 +3096,16 @@ static int file_write(EEFS_t *hdl, const u8_t *src, size_t count, fpos_t *fpos,
                                 memcpy(data + blkseek, src, sz);
                         }
 
+                        if (hdl->block.num == baseblk) {
+                                // update of file size and mtime combined with data
+                                time_t time = 0;
+                                sys_get_time(&time);
+                                hdl->block.buf.file.mtime = time;
+
+                                hdl->block.buf.file.size = max((*fpos + *wrcnt + sz),
+                                                               hdl->block.buf.file.size);
+                        }
+
                         err = block_write(hdl, &hdl->block);
 
                         if (!err) {
@@ -2791,7 +3118,7 @@ static int file_write(EEFS_t *hdl, const u8_t *src, size_t count, fpos_t *fpos,
                 }
         }
 
-        if (*wrcnt) {
+        if (*wrcnt && (hdl->block.num != baseblk)) {
                 hdl->block.num = baseblk;
                 err = block_read(hdl, &hdl->block);
                 if (!err) {
@@ -121,6 +121,11 @@ API_FS_INIT(ext4fs, void **fs_handle, const char *src_path, const char *opts)
                 err = ext4_mount(&hdl->bd, &hdl->mp, strstr(opts, "ro"));
                 if (!err) {
                         ext4_cache_write_back(hdl->mp, true);
+
+                        int readahead = sys_stropt_get_int(opts, "readahead", 0);
+                        if (readahead > 0) {
+                                sys_cache_readahead(hdl->bdif.blkobj, readahead);
+                        }
                 }
 
                 finish:
@@ -161,6 +166,7 @@ API_FS_RELEASE(ext4fs, void *fs_handle)
                 err = ext4_umount(hdl->mp);
                 if (err) goto finish;
 
+                sys_cache_readahead(hdl->bdif.blkobj, 0);
                 sys_cache_drop(hdl->bdif.blkobj);
                 sys_mutex_destroy(hdl->bdif.lockobj);
                 sys_fclose(cast(FILE*, hdl->bdif.blkobj));
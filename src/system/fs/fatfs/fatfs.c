@@ -35,6 +35,9 @@
 /*==============================================================================
   Local symbolic constants/macros
 ==============================================================================*/
+#define FREEMAP_SCAN_STEP               512
+#define DEFAULT_FAT_WINDOWS             1
+#define DEFAULT_DIR_WINDOWS             1
 
 /*==============================================================================
   Local types, enums definitions
@@ -53,6 +56,11 @@ struct fatfs {
         FATFS  fatfs;
         int    opened_files;
         int    opened_dirs;
+        bool   winstat;
+#if _LIBFAT_USE_FREEMAP
+        volatile bool freemap_busy;
+        volatile bool freemap_stop;
+#endif
 };
 
 /*==============================================================================
@@ -60,10 +68,21 @@ struct fatfs {
 ==============================================================================*/
 static int    faterr_2_errno(FRESULT fresult);
 static time_t time_fat2unix(uint32_t fattime);
+static void   print_winstat(struct fatfs *hdl);
+#if _LIBFAT_USE_FREEMAP
+static void   freemap_thread(void *arg);
+#endif
 
 /*==============================================================================
   Local object definitions
 ==============================================================================*/
+#if _LIBFAT_USE_FREEMAP
+static const thread_attr_t FREEMAP_THREAD_ATTR = {
+        .stack_depth = STACK_DEPTH_CUSTOM(__OS_IO_STACK_DEPTH__),
+        .priority    = PRIORITY_NORMAL,
+        .detached    = true
+};
+#endif
 
 /*==============================================================================
   Exported object definitions
@@ -86,17 +105,50 @@ static time_t time_fat2unix(uint32_t fattime);
 //==============================================================================
 API_FS_INIT(fatfs, void **fs_handle, const char *src_path, const char *opts)
 {
-        UNUSED_ARG1(opts);
-
         int err = sys_zalloc(sizeof(struct fatfs), fs_handle);
         if (err == ESUCC) {
                 struct fatfs *hdl = *fs_handle;
 
                 err = sys_fopen(src_path, "r+", &hdl->fsfile);
                 if (err == ESUCC) {
+                        /* Number of FAT and directory sectors kept in the window cache */
+                        int fatwin = sys_stropt_get_int(opts, "fatwin", DEFAULT_FAT_WINDOWS);
+                        int dirwin = sys_stropt_get_int(opts, "dirwin", DEFAULT_DIR_WINDOWS);
+                        libfat_set_windows(&hdl->fatfs, max(0, min(fatwin, UINT8_MAX)),
+                                                        max(0, min(dirwin, UINT8_MAX)));
+
+                        hdl->winstat = sys_stropt_is_flag(opts, "winstat");
+
                         err = faterr_2_errno(libfat_mount(hdl->fsfile, &hdl->fatfs));
                 }
 
+                if (err == ESUCC) {
+                        int readahead = sys_stropt_get_int(opts, "readahead", 0);
+                        if (readahead > 0) {
+                                sys_cache_readahead(hdl->fsfile, readahead);
+                        }
+
+                        /* Memory budget of fast seek cluster maps of opened files */
+                        int fastseek = sys_stropt_get_int(opts, "fastseek", 0);
+                        if (fastseek > 0) {
+                                libfat_set_fastseek(&hdl->fatfs, fastseek);
+                        }
+#if _LIBFAT_USE_FREEMAP
+                        /* Free cluster bitmap of size up to selected bytes,
+                           filled in background after mount */
+                        int freemap = sys_stropt_get_int(opts, "freemap", 0);
+                        if (freemap > 0 && libfat_freemap_init(&hdl->fatfs, freemap) == FR_OK) {
+                                hdl->freemap_busy = true;
+
+                                if (sys_thread_create(freemap_thread, &FREEMAP_THREAD_ATTR,
+                                                      hdl, NULL) != ESUCC) {
+                                        hdl->freemap_busy = false;
+                                        libfat_freemap_free(&hdl->fatfs);
+                                }
+                        }
+#endif
+                }
+
                 if (err != ESUCC) {
                         if (hdl->fsfile)
                                 sys_fclose(hdl->fsfile);
@@ -123,8 +175,17 @@ API_FS_RELEASE(fatfs, void *fs_handle)
         int           err = EBUSY;
 
         if (hdl->opened_dirs == 0 && hdl->opened_files == 0) {
+#if _LIBFAT_USE_FREEMAP
+                hdl->freemap_stop = true;
+                while (hdl->freemap_busy) {
+                        sys_sleep_ms(10);
+                }
+#endif
+                print_winstat(hdl);
+
                 err = faterr_2_errno(libfat_umount(&hdl->fatfs));
                 if (!err) {
+                        sys_cache_readahead(hdl->fsfile, 0);
                         sys_cache_drop(hdl->fsfile);
                         sys_fclose(hdl->fsfile);
                         sys_free(fs_handle);
@@ -727,9 +788,59 @@ API_FS_STATFS(fatfs, void *fs_handle, struct statfs *statfs)
 API_FS_SYNC(fatfs, void *fs_handle)
 {
         struct fatfs *hdl = fs_handle;
-        return faterr_2_errno(libfat_sync(&hdl->fatfs));
+
+        int err = faterr_2_errno(libfat_sync(&hdl->fatfs));
+        print_winstat(hdl);
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief Print window cache statistics if enabled by "winstat" mount option
+ *
+ * @param hdl           file system handle
+ */
+//==============================================================================
+static void print_winstat(struct fatfs *hdl)
+{
+        if (hdl->winstat) {
+                const FATWINSTAT *stat = libfat_get_winstat(&hdl->fatfs);
+
+                printk("fatfs: FAT win: %u hit, %u miss, %u wr; dir win: %u hit, %u miss, %u wr",
+                       (uint)stat->hits[0], (uint)stat->misses[0], (uint)stat->writes[0],
+                       (uint)stat->hits[1], (uint)stat->misses[1], (uint)stat->writes[1]);
+        }
 }
 
+#if _LIBFAT_USE_FREEMAP
+//==============================================================================
+/**
+ * @brief Thread fills free cluster bitmap of the volume
+ *
+ * The volume is locked only for a single step, so file operations are
+ * served during the scan.
+ *
+ * @param arg           file system handle
+ */
+//==============================================================================
+static void freemap_thread(void *arg)
+{
+        struct fatfs *hdl  = arg;
+        int           done = 0;
+
+        while (!done && !hdl->freemap_stop) {
+                if (libfat_freemap_scan(&hdl->fatfs, FREEMAP_SCAN_STEP, &done) != FR_OK) {
+                        break;
+                }
+
+                sys_thread_yield();
+        }
+
+        hdl->freemap_busy = false;
+}
+#endif
+
 //==============================================================================
 /**
  * @brief Function handle libfat errors and translate to errno
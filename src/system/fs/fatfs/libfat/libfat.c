@@ -66,6 +66,15 @@
 #define LEAVE_FF(fs, res)       {unlock_fs(fs, res); return res;}
 #define ABORT(fs, res)          {fp->flag |= LIBFAT_FA__ERROR; LEAVE_FF(fs, res);}
 
+#define WIN_INVALID             0xFFFFFFFF  /* Sector number of empty window */
+#define WIN_POOL_FAT            0
+#define WIN_POOL_DIR            1
+
+#if _LIBFAT_USE_FREEMAP
+#define FMAP_READY(fs)          ((fs)->fmap && (fs)->fmap_scan >= (fs)->n_fatent)
+#define FMAP_NEW_CHAIN_RUN      8       /* Free run length preferred for a new chain */
+#endif
+
 /* DBCS code ranges and SBCS extend char conversion table */
 #if   _LIBFAT_CODE_PAGE == 932        /* Japanese Shift-JIS */
 #define _DF1S        0x81             /* DBC 1st byte range 1 start */
@@ -407,13 +416,31 @@ static uint     inc_lock        (FATDIR *dj, int acc);
 static FRESULT  dec_lock        (FATFS *fs, uint i);
 static void     clear_lock      (FATFS *fs);
 #endif
+static int      win_pool        (FATFS *fs, uint32_t sector);
+static FATWIN  *win_find        (FATFS *fs, uint32_t sector);
+static FRESULT  win_write       (FATFS *fs, const uint8_t *buf, uint32_t sector);
+static FRESULT  win_stash       (FATFS *fs);
+static void     win_discard     (FATFS *fs, uint32_t sector, uint32_t count);
+static FRESULT  win_init        (FATFS *fs);
 static FRESULT  sync_window     (FATFS *fs);
+static FRESULT  sync_windows    (FATFS *fs);
 static FRESULT  move_window     (FATFS *fs, uint32_t sector);
 static uint32_t clust2sect      (FATFS *fs, uint32_t clst);
 static uint32_t get_fat         (FATFS *fs, uint32_t clst);
 static FRESULT  put_fat         (FATFS *fs, uint32_t clst, uint32_t val);
 static FRESULT  remove_chain    (FATFS *fs, uint32_t clst);
 static uint32_t create_chain    (FATFS *fs, uint32_t clst);
+#if _LIBFAT_USE_FREEMAP
+static void     fmap_put        (FATFS *fs, uint32_t clst, int used);
+static uint32_t fmap_find       (FATFS *fs, uint32_t from, uint32_t minrun);
+static uint32_t fmap_count_free (FATFS *fs);
+#endif
+#if _LIBFAT_USE_FASTSEEK
+static FRESULT  clmt_walk       (FATFILE *fp, uint32_t *tbl, uint32_t *nruns);
+static FRESULT  clmt_build      (FATFILE *fp);
+static void     clmt_drop       (FATFILE *fp);
+static uint32_t clmt_clust      (FATFILE *fp, uint32_t ofs, uint32_t *rcl);
+#endif
 static FRESULT  dir_sdi         (FATDIR *dj, uint16_t idx);
 static FRESULT  dir_next        (FATDIR *dj, int stretch);
 static FRESULT  dir_alloc       (FATDIR *dj, uint nent);
@@ -654,10 +681,203 @@ static void clear_lock(FATFS *fs)
 }
 #endif
 
+//==============================================================================
+/**
+ * @brief Window cache - select pool of the sector
+ *
+ * @param[in] *fs       File system object
+ * @param[in]  sector   Sector number
+ *
+ * @return WIN_POOL_FAT for sectors of FAT area, WIN_POOL_DIR otherwise
+ */
+//==============================================================================
+static int win_pool(FATFS *fs, uint32_t sector)
+{
+        return (sector >= fs->fatbase && sector < fs->fatbase + fs->fsize * fs->n_fats)
+             ? WIN_POOL_FAT : WIN_POOL_DIR;
+}
+
+//==============================================================================
+/**
+ * @brief Window cache - find the sector
+ *
+ * @param[in] *fs       File system object
+ * @param[in]  sector   Sector number
+ *
+ * @return Cache entry with the sector, NULL if sector is not cached
+ */
+//==============================================================================
+static FATWIN *win_find(FATFS *fs, uint32_t sector)
+{
+        for (uint i = 0; i < (uint)fs->n_fatwin + fs->n_dirwin; i++) {
+                if (fs->wcache[i].sect == sector) {
+                        return &fs->wcache[i];
+                }
+        }
+
+        return NULL;
+}
+
+//==============================================================================
+/**
+ * @brief Window cache - write sector to the disk
+ *
+ * @param[in] *fs       File system object
+ * @param[in] *buf      Sector data
+ * @param[in]  sector   Sector number
+ *
+ * @retval FR_OK        success
+ * @retval FR_DISK_ERR
+ */
+//==============================================================================
+static FRESULT win_write(FATFS *fs, const uint8_t *buf, uint32_t sector)
+{
+        if (_libfat_disk_write(fs->srcfile, buf, sector, 1) != RES_OK)
+                return FR_DISK_ERR;
+
+        /* In FAT area? */
+        if (sector >= fs->fatbase && sector < (fs->fatbase + fs->fsize)) {
+                /* Reflect the change to all FAT copies */
+                for (uint nf = fs->n_fats; nf >= 2; nf--) {
+                        sector += fs->fsize;
+                        _libfat_disk_write(fs->srcfile, buf, sector, 1);
+                }
+
+                fs->wstat.writes[WIN_POOL_FAT]++;
+        } else {
+                fs->wstat.writes[WIN_POOL_DIR]++;
+        }
+
+        return FR_OK;
+}
+
+//==============================================================================
+/**
+ * @brief Window cache - keep the current window in the cache
+ *
+ * Dirty window is not written to the disk but stays dirty in the cache, the
+ * least recently used entry of the pool is written back if needed. When the
+ * pool is disabled or the window content does not come from move_window(),
+ * the window is written back (if dirty) and dropped.
+ *
+ * @param[in] *fs       File system object
+ *
+ * @retval FR_OK        success
+ * @retval FR_DISK_ERR
+ */
+//==============================================================================
+static FRESULT win_stash(FATFS *fs)
+{
+        FATWIN *w, *wend;
+
+        if (fs->winsect == WIN_INVALID)
+                return FR_OK;
+
+        if (win_pool(fs, fs->winsect) == WIN_POOL_FAT) {
+                w    = fs->wcache;
+                wend = w + fs->n_fatwin;
+        } else {
+                w    = fs->wcache + fs->n_fatwin;
+                wend = w + fs->n_dirwin;
+        }
+
+        if (!fs->wstash || w == wend)
+                return sync_window(fs);
+
+        FATWIN *cw = win_find(fs, fs->winsect);
+        if (cw) {
+                /* Entry is a copy of the window until window is modified */
+                if (fs->wflag) {
+                        memcpy(cw->buf, fs->win, SS(fs));
+                }
+        } else {
+                /* Replace empty or least recently used entry of the pool */
+                for (cw = w; w < wend; w++) {
+                        if (w->sect == WIN_INVALID) {
+                                cw = w;
+                                break;
+                        }
+
+                        if (fs->wtick - w->tick > fs->wtick - cw->tick) {
+                                cw = w;
+                        }
+                }
+
+                if (cw->dirty) {
+                        if (win_write(fs, cw->buf, cw->sect) != FR_OK)
+                                return FR_DISK_ERR;
+                }
+
+                memcpy(cw->buf, fs->win, SS(fs));
+                cw->sect = fs->winsect;
+        }
+
+        cw->dirty = fs->wflag;
+        cw->tick  = ++fs->wtick;
+        fs->wflag = 0;
+
+        return FR_OK;
+}
+
+//==============================================================================
+/**
+ * @brief Window cache - drop cached sectors without write back
+ *
+ * @param[in] *fs       File system object
+ * @param[in]  sector   First sector to drop
+ * @param[in]  count    Number of sectors
+ */
+//==============================================================================
+static void win_discard(FATFS *fs, uint32_t sector, uint32_t count)
+{
+        for (uint i = 0; i < (uint)fs->n_fatwin + fs->n_dirwin; i++) {
+                if (fs->wcache[i].sect - sector < count) {
+                        fs->wcache[i].sect  = WIN_INVALID;
+                        fs->wcache[i].dirty = 0;
+                }
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Window cache - allocate cache and invalidate window
+ *
+ * @param[in] *fs       File system object
+ *
+ * @retval FR_OK        success
+ * @retval FR_NOT_ENOUGH_CORE
+ */
+//==============================================================================
+static FRESULT win_init(FATFS *fs)
+{
+        uint n = (uint)fs->n_fatwin + fs->n_dirwin;
+
+        if (n && !fs->wcache) {
+                fs->wcache = _libfat_malloc(n * sizeof(FATWIN));
+                if (!fs->wcache)
+                        return FR_NOT_ENOUGH_CORE;
+        }
+
+        for (uint i = 0; i < n; i++) {
+                fs->wcache[i].sect  = WIN_INVALID;
+                fs->wcache[i].dirty = 0;
+        }
+
+        fs->winsect = WIN_INVALID;
+        fs->wflag   = 0;
+        fs->wstash  = 0;
+        memset(&fs->wstat, 0, sizeof(FATWINSTAT));
+
+        return FR_OK;
+}
+
 //==============================================================================
 /**
  * @brief Flush disk access window
  *
+ * The window is not kept in the window cache after flush (its content can be
+ * changed directly with winsect).
+ *
  * @param[in] *fs       File system object
  *
  * @retval FR_OK        success
@@ -668,21 +888,43 @@ static FRESULT sync_window(FATFS *fs)
 {
         /* Write back the sector if it is dirty */
         if (fs->wflag) {
-                uint32_t wsect = fs->winsect;
-
-                /* Current sector number */
-                if (_libfat_disk_write(fs->srcfile, fs->win, wsect, 1) != RES_OK)
+                if (win_write(fs, fs->win, fs->winsect) != FR_OK)
                         return FR_DISK_ERR;
 
                 fs->wflag = 0;
 
-                /* In FAT area? */
-                if (wsect >= fs->fatbase && wsect < (fs->fatbase + fs->fsize)) {
-                        /* Reflect the change to all FAT copies */
-                        for (uint nf = fs->n_fats; nf >= 2; nf--) {
-                                wsect += fs->fsize;
-                                _libfat_disk_write(fs->srcfile, fs->win, wsect, 1);
-                        }
+                /* Cached copy is older than written sector */
+                win_discard(fs, fs->winsect, 1);
+        }
+
+        fs->wstash = 0;
+
+        return FR_OK;
+}
+
+//==============================================================================
+/**
+ * @brief Flush disk access window and all dirty sectors of window cache
+ *
+ * @param[in] *fs       File system object
+ *
+ * @retval FR_OK        success
+ * @retval FR_DISK_ERR
+ */
+//==============================================================================
+static FRESULT sync_windows(FATFS *fs)
+{
+        if (sync_window(fs) != FR_OK)
+                return FR_DISK_ERR;
+
+        for (uint i = 0; i < (uint)fs->n_fatwin + fs->n_dirwin; i++) {
+                FATWIN *w = &fs->wcache[i];
+
+                if (w->dirty) {
+                        if (win_write(fs, w->buf, w->sect) != FR_OK)
+                                return FR_DISK_ERR;
+
+                        w->dirty = 0;
                 }
         }
 
@@ -693,6 +935,10 @@ static FRESULT sync_window(FATFS *fs)
 /**
  * @brief Move disk access window
  *
+ * The previous window is kept in the window cache and the new one is taken
+ * from the cache if possible. The fs->win[] buffer itself does not move, so
+ * pointers to the window stay valid.
+ *
  * @param[in] *fs       File system object
  * @param[in]  sector   Sector number to make appearance in the fs->win[]
  *
@@ -703,13 +949,30 @@ static FRESULT move_window(FATFS *fs, uint32_t sector)
 {
         /* Changed current window */
         if (sector != fs->winsect) {
-                if (sync_window(fs) != FR_OK)
+                if (win_stash(fs) != FR_OK)
                         return FR_DISK_ERR;
 
-                if (_libfat_disk_read(fs->srcfile, fs->win, sector, 1) != RES_OK)
-                        return FR_DISK_ERR;
+                int     pool = win_pool(fs, sector);
+                FATWIN *w    = win_find(fs, sector);
+                if (w) {
+                        /* Window takes over dirty state, entry stays as copy */
+                        memcpy(fs->win, w->buf, SS(fs));
+                        fs->wflag = w->dirty;
+                        w->dirty  = 0;
+                        w->tick   = ++fs->wtick;
+                        fs->wstat.hits[pool]++;
+
+                } else {
+                        fs->wstat.misses[pool]++;
+
+                        if (_libfat_disk_read(fs->srcfile, fs->win, sector, 1) != RES_OK) {
+                                fs->winsect = WIN_INVALID;
+                                return FR_DISK_ERR;
+                        }
+                }
 
                 fs->winsect = sector;
+                fs->wstash  = 1;
         }
 
         return FR_OK;
@@ -729,11 +992,11 @@ static FRESULT sync_fs(FATFS *fs)
 {
         FRESULT res;
 
-        res = sync_window(fs);
+        res = sync_windows(fs);
         if (res == FR_OK) {
                 /* Update FSInfo sector if needed */
                 if (fs->fs_type == LIBFAT_FS_FAT32 && fs->fsi_flag) {
-                        fs->winsect = 0;
+                        fs->winsect = WIN_INVALID;
 
                         /* Create FSInfo structure */
                         memset(fs->win, 0, 512);
@@ -898,6 +1161,11 @@ static FRESULT put_fat(FATFS *fs, uint32_t clst, uint32_t val)
                 }
 
                 fs->wflag = 1;
+#if _LIBFAT_USE_FREEMAP
+                if (res == FR_OK) {
+                        fmap_put(fs, clst, val != 0);
+                }
+#endif
         }
 
         return res;
@@ -947,6 +1215,9 @@ static FRESULT remove_chain(FATFS *fs, uint32_t clst)
                         if (res != FR_OK)
                                 break;
 
+                        /* Cached sectors of the free cluster are not valid anymore */
+                        win_discard(fs, clust2sect(fs, clst), fs->csize);
+
                         if (fs->free_clust != 0xFFFFFFFF) {
                                 fs->free_clust++;
                                 fs->fsi_flag = 1;
@@ -998,23 +1269,34 @@ static uint32_t create_chain(FATFS *fs, uint32_t clst)
                 scl = clst;
         }
 
-        ncl = scl;
-        for (;;) {
-                ncl++;
-                if (ncl >= fs->n_fatent) {
-                        ncl = 2;
-                        if (ncl > scl) return 0;
-                }
+#if _LIBFAT_USE_FREEMAP
+        if (FMAP_READY(fs)) {
+                /* A stretched chain takes the nearest free cluster (the next
+                   one if possible), a new chain starts at a free run */
+                ncl = fmap_find(fs, scl + 1, clst ? 1 : FMAP_NEW_CHAIN_RUN);
+                if (ncl == 0)
+                        return 0;
+        } else
+#endif
+        {
+                ncl = scl;
+                for (;;) {
+                        ncl++;
+                        if (ncl >= fs->n_fatent) {
+                                ncl = 2;
+                                if (ncl > scl) return 0;
+                        }
 
-                cs = get_fat(fs, ncl);
-                if (cs == 0)
-                        break;
+                        cs = get_fat(fs, ncl);
+                        if (cs == 0)
+                                break;
 
-                if (cs == 0xFFFFFFFF || cs == 1)
-                        return cs;
+                        if (cs == 0xFFFFFFFF || cs == 1)
+                                return cs;
 
-                if (ncl == scl)
-                        return 0;
+                        if (ncl == scl)
+                                return 0;
+                }
         }
 
         res = put_fat(fs, ncl, 0x0FFFFFFF);
@@ -1037,6 +1319,271 @@ static uint32_t create_chain(FATFS *fs, uint32_t clst)
         return ncl;
 }
 
+#if _LIBFAT_USE_FREEMAP
+//==============================================================================
+/**
+ * @brief Free cluster bitmap - set cluster state
+ *
+ * @param[in] *fs       File system object
+ * @param[in]  clst     Cluster number
+ * @param[in]  used     Cluster state (0:free, 1:in use)
+ */
+//==============================================================================
+static void fmap_put(FATFS *fs, uint32_t clst, int used)
+{
+        if (fs->fmap) {
+                if (used) {
+                        fs->fmap[clst / 32] |=  (1UL << (clst % 32));
+                } else {
+                        fs->fmap[clst / 32] &= ~(1UL << (clst % 32));
+                }
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Free cluster bitmap - find free cluster
+ *
+ * Search starts at selected cluster and wraps around at the end of the volume.
+ * Fully used words of the bitmap are skipped at once.
+ *
+ * @param[in] *fs       File system object
+ * @param[in]  from     Cluster to start search from
+ * @param[in]  minrun   Preferred number of contiguous free clusters
+ *
+ * @return 0:No free cluster, >=2:First cluster of the first free run of
+ *         minrun clusters, or first free cluster if there is no such run
+ */
+//==============================================================================
+static uint32_t fmap_find(FATFS *fs, uint32_t from, uint32_t minrun)
+{
+        uint32_t cl    = (from < 2 || from >= fs->n_fatent) ? 2 : from;
+        uint32_t cnt   = fs->n_fatent - 2;
+        uint32_t first = 0;
+        uint32_t start = 0;
+        uint32_t run   = 0;
+
+        while (cnt) {
+                if (cl >= fs->n_fatent) {
+                        /* Runs do not wrap around the volume end */
+                        cl  = 2;
+                        run = 0;
+                }
+
+                if (  (cl % 32) == 0 && cl + 32 <= fs->n_fatent
+                   && fs->fmap[cl / 32] == 0xFFFFFFFF) {
+                        cl  += 32;
+                        cnt -= (cnt > 32) ? 32 : cnt;
+                        run  = 0;
+                        continue;
+                }
+
+                if (fs->fmap[cl / 32] & (1UL << (cl % 32))) {
+                        run = 0;
+                } else {
+                        if (run == 0) {
+                                start = cl;
+                                if (!first) first = cl;
+                        }
+
+                        if (++run >= minrun)
+                                return start;
+                }
+
+                cl++;
+                cnt--;
+        }
+
+        return first;
+}
+
+//==============================================================================
+/**
+ * @brief Free cluster bitmap - count free clusters
+ *
+ * @param[in] *fs       File system object
+ *
+ * @return Number of free clusters
+ */
+//==============================================================================
+static uint32_t fmap_count_free(FATFS *fs)
+{
+        uint32_t n = 0;
+
+        /* Reserved clusters and bits above the last cluster are always set */
+        for (uint32_t i = 0; i < (fs->n_fatent + 31) / 32; i++) {
+                n += __builtin_popcount(~fs->fmap[i]);
+        }
+
+        return n;
+}
+#endif
+
+#if _LIBFAT_USE_FASTSEEK
+//==============================================================================
+/**
+ * @brief Walk the file cluster chain and split it to contiguous runs
+ *
+ * @param[in]  *fp      File object
+ * @param[out] *tbl     Run list {ncl, scl}... to fill (NULL: count runs only)
+ * @param[out] *nruns   Number of runs in the chain
+ *
+ * @retval FR_OK
+ * @retval FR_INT_ERR
+ * @retval FR_DISK_ERR
+ */
+//==============================================================================
+static FRESULT clmt_walk(FATFILE *fp, uint32_t *tbl, uint32_t *nruns)
+{
+        FATFS   *fs    = fp->fs;
+        uint32_t cl    = fp->sclust;
+        uint32_t total = 0;
+        uint32_t pcl, ncl;
+
+        *nruns = 0;
+
+        do {
+                /* Follow the chain while clusters are contiguous */
+                ncl = 0;
+                do {
+                        pcl = cl;
+                        ncl++;
+
+                        cl = get_fat(fs, cl);
+                        if (cl == 0xFFFFFFFF)
+                                return FR_DISK_ERR;
+
+                        /* Broken or cyclic chain */
+                        if (cl <= 1 || ++total > fs->n_fatent - 2)
+                                return FR_INT_ERR;
+
+                } while (cl == pcl + 1 && cl < fs->n_fatent);
+
+                if (tbl) {
+                        *tbl++ = ncl;
+                        *tbl++ = pcl - ncl + 1;
+                }
+
+                (*nruns)++;
+
+        } while (cl < fs->n_fatent);
+
+        return FR_OK;
+}
+
+//==============================================================================
+/**
+ * @brief Build cluster link map table of the file
+ *
+ * The table is a list of contiguous cluster runs of the file chain in format
+ * {size in items, {number of clusters, start cluster}..., 0}. When the table
+ * does not fit in the volume budget the file is marked and the FAT chain is
+ * followed as without the table.
+ *
+ * @param[in] *fp       File object
+ *
+ * @retval FR_OK        Table built or not needed
+ * @retval FR_INT_ERR
+ * @retval FR_DISK_ERR
+ */
+//==============================================================================
+static FRESULT clmt_build(FATFILE *fp)
+{
+        FATFS   *fs = fp->fs;
+        uint32_t nruns, size, *tbl;
+        FRESULT  res;
+
+        if (fp->cltbl || fp->cltbl_fail || fp->sclust == 0 || fs->cltbl_budget == 0)
+                return FR_OK;
+
+        res = clmt_walk(fp, NULL, &nruns);
+        if (res != FR_OK)
+                return res;
+
+        size = (nruns * 2 + 2) * sizeof(uint32_t);
+        if (size > fs->cltbl_budget - fs->cltbl_used) {
+                fp->cltbl_fail = 1;
+                return FR_OK;
+        }
+
+        tbl = _libfat_malloc(size);
+        if (!tbl) {
+                fp->cltbl_fail = 1;
+                return FR_OK;
+        }
+
+        /* Second walk hits the same FAT sectors, mostly from the window */
+        res = clmt_walk(fp, tbl + 1, &nruns);
+        if (res != FR_OK) {
+                _libfat_free(tbl);
+                return res;
+        }
+
+        tbl[0]             = nruns * 2 + 2;
+        tbl[nruns * 2 + 1] = 0;
+
+        fp->cltbl       = tbl;
+        fs->cltbl_used += size;
+
+        return FR_OK;
+}
+
+//==============================================================================
+/**
+ * @brief Release cluster link map table of the file
+ *
+ * @param[in] *fp       File object
+ */
+//==============================================================================
+static void clmt_drop(FATFILE *fp)
+{
+        if (fp->cltbl) {
+                fp->fs->cltbl_used -= fp->cltbl[0] * sizeof(uint32_t);
+                _libfat_free(fp->cltbl);
+                fp->cltbl = NULL;
+        }
+
+        fp->cltbl_fail = 0;
+}
+
+//==============================================================================
+/**
+ * @brief Get cluster of file offset from cluster link map table
+ *
+ * @param[in]  *fp      File object
+ * @param[in]   ofs     File offset
+ * @param[out] *rcl     Number of clusters following in the same run (can be NULL)
+ *
+ * @return 0:Offset not covered by the table (or no table), >=2:Cluster number
+ */
+//==============================================================================
+static uint32_t clmt_clust(FATFILE *fp, uint32_t ofs, uint32_t *rcl)
+{
+        uint32_t *tbl, cl, ncl;
+
+        if (!fp->cltbl)
+                return 0;
+
+        tbl = fp->cltbl + 1;
+        cl  = ofs / SS(fp->fs) / fp->fs->csize;
+
+        for (ncl = *tbl++; ncl; ncl = *tbl++) {
+                if (cl < ncl) {
+                        if (rcl) {
+                                *rcl = ncl - cl - 1;
+                        }
+
+                        return *tbl + cl;
+                }
+
+                cl -= ncl;
+                tbl++;
+        }
+
+        return 0;
+}
+#endif
+
 //==============================================================================
 /**
  * @brief Directory handling - Set directory index
@@ -2431,8 +2978,7 @@ static FRESULT chk_mounted(FATFS *fs)
         fs->fs_type = fmt;
 
         /* Invalidate sector cache */
-        fs->winsect = 0;
-        fs->wflag = 0;
+        win_init(fs);
 
 #if _LIBFAT_FS_LOCK
         /* Clear file lock semaphores */
@@ -2486,7 +3032,17 @@ FRESULT libfat_mount(FILE *fsfile, FATFS *fs)
                 if (!_libfat_create_mutex(&fs->sobj))
                         return FR_INT_ERR;
 
-                return chk_mounted(fs);
+                FRESULT res = win_init(fs);
+                if (res == FR_OK) {
+                        res = chk_mounted(fs);
+                }
+
+                if (res != FR_OK && fs->wcache) {
+                        _libfat_free(fs->wcache);
+                        fs->wcache = NULL;
+                }
+
+                return res;
         }
 
         return FR_DISK_ERR;
@@ -2506,6 +3062,14 @@ FRESULT libfat_umount(FATFS *fs)
 {
         if (fs) {
                 libfat_sync(fs);
+#if _LIBFAT_USE_FREEMAP
+                libfat_freemap_free(fs);
+#endif
+                if (fs->wcache) {
+                        _libfat_free(fs->wcache);
+                        fs->wcache = NULL;
+                }
+
                 _libfat_delete_mutex(fs->sobj);
                 return FR_OK;
         }
@@ -2681,6 +3245,10 @@ FRESULT libfat_open(FATFS *fs, FATFILE *fp, const TCHAR *path, uint8_t mode)
                 fp->fsize  = LOAD_UINT32(dir+DIR_FileSize);     /* File size */
                 fp->fptr   = 0;                                 /* File pointer */
                 fp->dsect  = 0;
+#if _LIBFAT_USE_FASTSEEK
+                fp->cltbl      = NULL;                          /* Cluster link map table is built on first seek */
+                fp->cltbl_fail = 0;
+#endif
 
                 /* Validate file object */
                 fp->fs = dj.fs;
@@ -2754,6 +3322,11 @@ FRESULT libfat_read(FATFILE *fp, void *buff, uint btr, uint *br)
                                         /* Follow from the origin */
                                         clst = fp->sclust;
                                 } else {
+#if _LIBFAT_USE_FASTSEEK
+                                        /* Look up the cluster link map table */
+                                        clst = clmt_clust(fp, fp->fptr, NULL);
+                                        if (!clst)
+#endif
                                         /* Follow cluster chain on the FAT */
                                         clst = get_fat(fp->fs, fp->clust);
                                 }
@@ -2782,18 +3355,40 @@ FRESULT libfat_read(FATFILE *fp, void *buff, uint btr, uint *br)
                         cc = btr / SS(fp->fs);
                         if (cc) {
                                 /* Read maximum contiguous sectors directly */
-                                if (csect + cc > fp->fs->csize) {
-                                        /* Clip at cluster boundary */
-                                        cc = fp->fs->csize - csect;
+                                uint32_t rcl = 0;
+#if _LIBFAT_USE_FASTSEEK
+                                /* Continue through following clusters of the same run */
+                                if (!clmt_clust(fp, fp->fptr, &rcl)) {
+                                        rcl = 0;
+                                }
+#endif
+                                if (csect + cc > fp->fs->csize * (rcl + 1)) {
+                                        /* Clip at cluster (run) boundary */
+                                        cc = fp->fs->csize * (rcl + 1) - csect;
+                                }
+
+                                if (cc > UINT8_MAX) {
+                                        cc = UINT8_MAX;
                                 }
 
                                 if (_libfat_disk_read(fp->fs->srcfile, rbuff, sect, (uint8_t)cc) != RES_OK) {
                                         ABORT(fp->fs, FR_DISK_ERR);
                                 }
+
+                                /* Last cluster of the transfer is current one */
+                                fp->clust += (csect + cc - 1) / fp->fs->csize;
 #if _LIBFAT_FS_TINY
                                 if (fp->fs->wflag && fp->fs->winsect - sect < cc) {
                                         memcpy(rbuff + ((fp->fs->winsect - sect) * SS(fp->fs)), fp->fs->win, SS(fp->fs));
                                 }
+
+                                /* Dirty sectors kept in the window cache are newer too */
+                                for (uint i = 0; i < (uint)fp->fs->n_fatwin + fp->fs->n_dirwin; i++) {
+                                        FATWIN *w = &fp->fs->wcache[i];
+                                        if (w->dirty && w->sect - sect < cc) {
+                                                memcpy(rbuff + ((w->sect - sect) * SS(fp->fs)), w->buf, SS(fp->fs));
+                                        }
+                                }
 #else
                                 if ((fp->flag & LIBFAT_FA__DIRTY) && fp->dsect - sect < cc) {
                                         memcpy(rbuff + ((fp->dsect - sect) * SS(fp->fs)), fp->buf, SS(fp->fs));
@@ -2909,6 +3504,11 @@ FRESULT libfat_write(FATFILE *fp, const void *buff, uint btw, uint *bw)
                                                 fp->sclust = clst = create_chain(fp->fs, 0);
                                         }
                                 } else {
+#if _LIBFAT_USE_FASTSEEK
+                                        /* Look up the cluster link map table */
+                                        clst = clmt_clust(fp, fp->fptr, NULL);
+                                        if (!clst)
+#endif
                                         /* Follow or stretch cluster chain on the FAT */
                                         clst = create_chain(fp->fs, fp->clust);
                                 }
@@ -2971,6 +3571,9 @@ FRESULT libfat_write(FATFILE *fp, const void *buff, uint btw, uint *bw)
                                         memcpy(fp->fs->win, wbuff + ((fp->fs->winsect - sect) * SS(fp->fs)), SS(fp->fs));
                                         fp->fs->wflag = 0;
                                 }
+
+                                /* Cached copies of written sectors are old */
+                                win_discard(fp->fs, sect, cc);
 #else
                                 /* Refill sector cache if it gets invalidated by the direct write */
                                 if (fp->dsect - sect < cc) {
@@ -3120,6 +3723,17 @@ FRESULT libfat_close(FATFILE *fp)
                         unlock_fs(fs, FR_OK);
                 }
         }
+#endif
+#if _LIBFAT_USE_FASTSEEK
+        /* Release cluster link map table */
+        if (res == FR_OK && fp->cltbl) {
+                FATFS *fs = fp->fs;
+                res = validate(fp);
+                if (res == FR_OK) {
+                        clmt_drop(fp);
+                        unlock_fs(fs, FR_OK);
+                }
+        }
 #endif
         if (res == FR_OK) {
                 /* Discard file object */
@@ -3165,6 +3779,27 @@ FRESULT libfat_lseek(FATFILE *fp, uint32_t ofs)
         ifptr = fp->fptr;
         fp->fptr = nsect = 0;
         if (ofs) {
+#if _LIBFAT_USE_FASTSEEK
+                if (fp->fs->cltbl_budget) {
+                        /* Chain was stretched after the table was built */
+                        if (fp->cltbl && ofs <= fp->fsize && !clmt_clust(fp, ofs - 1, NULL)) {
+                                clmt_drop(fp);
+                        }
+
+                        res = clmt_build(fp);
+                        if (res != FR_OK) {
+                                ABORT(fp->fs, res);
+                        }
+
+                        /* Set the cluster of the destination as current one,
+                           the chain walk below has nothing to follow then */
+                        clst = clmt_clust(fp, ofs - 1, NULL);
+                        if (clst) {
+                                fp->clust = clst;
+                                ifptr     = ofs;
+                        }
+                }
+#endif
                 /* Cluster size (byte) */
                 bcs = (uint32_t)fp->fs->csize * SS(fp->fs);
 
@@ -3453,6 +4088,16 @@ FRESULT libfat_getfree(FATFS *fs, uint32_t *nclst)
         /* If free_clust is valid, return it without full cluster scan */
         if (fs->free_clust <= fs->n_fatent - 2) {
                 *nclst = fs->free_clust;
+#if _LIBFAT_USE_FREEMAP
+        } else if (FMAP_READY(fs)) {
+                /* Count free clusters in the bitmap instead of the FAT */
+                fs->free_clust = fmap_count_free(fs);
+
+                if (fs->fs_type == LIBFAT_FS_FAT32)
+                        fs->fsi_flag = 1;
+
+                *nclst = fs->free_clust;
+#endif
         } else {
                 /* Get number of free clusters */
                 uint8_t fat = fs->fs_type;
@@ -3515,6 +4160,125 @@ FRESULT libfat_getfree(FATFS *fs, uint32_t *nclst)
         LEAVE_FF(fs, res);
 }
 
+#if _LIBFAT_USE_FREEMAP
+//==============================================================================
+/**
+ * @brief Allocate free cluster bitmap of the volume
+ *
+ * The bitmap is not used until it is filled by libfat_freemap_scan().
+ *
+ * @param[in] *fs       Pointer to existing library instance
+ * @param[in]  budget   Maximum size of the bitmap in bytes
+ *
+ * @retval FR_OK
+ * @retval FR_NOT_ENOUGH_CORE
+ */
+//==============================================================================
+FRESULT libfat_freemap_init(FATFS *fs, uint32_t budget)
+{
+        uint32_t size = ((fs->n_fatent + 31) / 32) * sizeof(uint32_t);
+        FRESULT  res  = FR_NOT_ENOUGH_CORE;
+
+        ENTER_FF(fs);
+
+        if (!fs->fmap && size <= budget) {
+                uint32_t *fmap = _libfat_malloc(size);
+                if (fmap) {
+                        /* All clusters in use until scanned */
+                        memset(fmap, 0xFF, size);
+
+                        fs->fmap      = fmap;
+                        fs->fmap_scan = 2;
+                        res           = FR_OK;
+                }
+        }
+
+        LEAVE_FF(fs, res);
+}
+
+//==============================================================================
+/**
+ * @brief Fill next part of free cluster bitmap
+ *
+ * Function scans selected number of FAT entries with the volume locked, so
+ * file operations can interleave with the scan between calls. Clusters
+ * changed before being scanned are read from the FAT anyway, so the bitmap
+ * is exact when the scan is finished. The number of free clusters (and
+ * FSINFO on FAT32) is then updated from the bitmap. On error the bitmap is
+ * released.
+ *
+ * @param[in]  *fs      Pointer to existing library instance
+ * @param[in]   count   Number of clusters to scan
+ * @param[out] *done    1 when the bitmap is ready (or not used), 0 otherwise
+ *
+ * @retval FR_OK
+ * @retval FR_DISK_ERR
+ * @retval FR_INT_ERR
+ */
+//==============================================================================
+FRESULT libfat_freemap_scan(FATFS *fs, uint32_t count, int *done)
+{
+        FRESULT  res = FR_OK;
+        uint32_t stat;
+
+        ENTER_FF(fs);
+
+        *done = 1;
+
+        if (fs->fmap && !FMAP_READY(fs)) {
+                while (count-- && fs->fmap_scan < fs->n_fatent) {
+                        stat = get_fat(fs, fs->fmap_scan);
+                        if (stat == 0xFFFFFFFF) {
+                                res = FR_DISK_ERR;
+                                break;
+                        }
+
+                        if (stat == 1) {
+                                res = FR_INT_ERR;
+                                break;
+                        }
+
+                        fmap_put(fs, fs->fmap_scan++, stat != 0);
+                }
+
+                if (res != FR_OK) {
+                        _libfat_free(fs->fmap);
+                        fs->fmap = NULL;
+
+                } else if (FMAP_READY(fs)) {
+                        /* FSINFO free count is only a hint, the bitmap is exact */
+                        fs->free_clust = fmap_count_free(fs);
+
+                        if (fs->fs_type == LIBFAT_FS_FAT32)
+                                fs->fsi_flag = 1;
+                } else {
+                        *done = 0;
+                }
+        }
+
+        LEAVE_FF(fs, res);
+}
+
+//==============================================================================
+/**
+ * @brief Release free cluster bitmap
+ *
+ * @param[in] *fs       Pointer to existing library instance
+ */
+//==============================================================================
+void libfat_freemap_free(FATFS *fs)
+{
+        if (lock_fs(fs)) {
+                if (fs->fmap) {
+                        _libfat_free(fs->fmap);
+                        fs->fmap = NULL;
+                }
+
+                unlock_fs(fs, FR_OK);
+        }
+}
+#endif
+
 //==============================================================================
 /**
  * @brief Truncate File
@@ -3551,6 +4315,10 @@ FRESULT libfat_truncate(FATFILE *fp)
                         fp->fsize = fp->fptr;
 
                         fp->flag |= LIBFAT_FA__WRITTEN;
+#if _LIBFAT_USE_FASTSEEK
+                        /* Cluster link map table does not match the chain anymore */
+                        clmt_drop(fp);
+#endif
                         if (fp->fptr == 0) {
                                 /* When set file size to zero, remove entire cluster chain */
                                 res = remove_chain(fp->fs, fp->sclust);
@@ -109,6 +109,21 @@ extern "C" {
 #endif
 
 
+/* Window cache entry (FATWIN) */
+typedef struct {
+        uint32_t        sect;                   /* Sector in the buffer (0xFFFFFFFF:empty) */
+        uint32_t        tick;                   /* Last use (LRU replacement) */
+        uint8_t         dirty;                  /* Buffer must be written back */
+        uint8_t         buf[_LIBFAT_MAX_SS];    /* Sector data */
+} FATWIN;
+
+/* Window cache statistics, index 0:FAT pool, 1:directory pool (FATWINSTAT) */
+typedef struct {
+        uint32_t        hits[2];                /* Window moves served from the cache */
+        uint32_t        misses[2];              /* Window moves that read the disk */
+        uint32_t        writes[2];              /* Sectors written back */
+} FATWINSTAT;
+
 /* File system object structure (FATFS) */
 typedef struct FATFS {
         uint8_t         fs_type;                /* FAT sub-type (0:Not mounted) */
@@ -134,6 +149,20 @@ typedef struct FATFS {
         uint32_t        database;               /* Data start sector */
         uint32_t        winsect;                /* Current sector appearing in the win[] */
         uint8_t         win[_LIBFAT_MAX_SS];    /* Disk access window for Directory, FAT (and Data on tiny cfg) */
+        uint8_t         wstash;                 /* win[] can be kept in the window cache when moved */
+        uint8_t         n_fatwin;               /* Number of FAT sectors in the window cache */
+        uint8_t         n_dirwin;               /* Number of directory sectors in the window cache */
+        uint32_t        wtick;                  /* Window cache use counter */
+        FATWIN         *wcache;                 /* Window cache, FAT pool followed by directory pool */
+        FATWINSTAT      wstat;                  /* Window cache statistics */
+#if _LIBFAT_USE_FASTSEEK
+        uint32_t        cltbl_budget;           /* Memory budget of cluster link map tables of all files (0:fast seek disabled) */
+        uint32_t        cltbl_used;             /* Memory used by cluster link map tables */
+#endif
+#if _LIBFAT_USE_FREEMAP
+        uint32_t       *fmap;                   /* Free cluster bitmap (bit set:cluster in use, NULL:not used) */
+        uint32_t        fmap_scan;              /* Next cluster to scan (n_fatent:bitmap ready) */
+#endif
         /* File access control feature */
 #if _LIBFAT_FS_LOCK
         struct FILESEM {
@@ -160,10 +189,14 @@ typedef struct {
         uint32_t        dsect;                  /* Current data sector of fpter */
         uint32_t        dir_sect;               /* Sector containing the directory entry */
         uint8_t        *dir_ptr;                /* Pointer to the directory entry in the window */
+#if _LIBFAT_USE_FASTSEEK
+        uint32_t       *cltbl;                  /* Cluster link map table (NULL:not built), {size, {ncl, scl}..., 0} */
+        uint8_t         cltbl_fail;             /* Table does not fit in the budget, not rebuilt until chain is truncated */
+#endif
 #if _LIBFAT_FS_LOCK
         uint            lockid;                 /* File lock ID (index of file semaphore table Files[]) */
 #endif
-#if !_FS_TINY
+#if !_LIBFAT_FS_TINY
         uint8_t         buf[_LIBFAT_MAX_SS];    /* File data read/write buffer */
 #endif
 } FATFILE;
@@ -250,6 +283,11 @@ extern FRESULT  libfat_mkdir     (FATFS*, const TCHAR*);
 extern FRESULT  libfat_chmod     (FATFS*, const TCHAR*, uint8_t, uint8_t);
 extern FRESULT  libfat_utime     (FATFS*, const TCHAR*, const FILEINFO*);
 extern FRESULT  libfat_rename    (FATFS*, const TCHAR*, const TCHAR*);
+#if _LIBFAT_USE_FREEMAP
+extern FRESULT  libfat_freemap_init(FATFS*, uint32_t);
+extern FRESULT  libfat_freemap_scan(FATFS*, uint32_t, int*);
+extern void     libfat_freemap_free(FATFS*);
+#endif
 
 /*==============================================================================
   Exported inline functions
@@ -274,6 +312,24 @@ static inline uint32_t libfat_size(FATFILE *fp)
         return fp->fsize;
 }
 
+static inline void libfat_set_windows(FATFS *fs, uint8_t fat, uint8_t dir)
+{
+        fs->n_fatwin = fat > _LIBFAT_MAX_WINDOWS ? _LIBFAT_MAX_WINDOWS : fat;
+        fs->n_dirwin = dir > _LIBFAT_MAX_WINDOWS ? _LIBFAT_MAX_WINDOWS : dir;
+}
+
+static inline const FATWINSTAT *libfat_get_winstat(FATFS *fs)
+{
+        return &fs->wstat;
+}
+
+#if _LIBFAT_USE_FASTSEEK
+static inline void libfat_set_fastseek(FATFS *fs, uint32_t budget)
+{
+        fs->cltbl_budget = budget;
+}
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,7 +37,34 @@
  * object instead of the sector buffer in the individual file object for file
  * data transfer. This reduces memory consumption 512 bytes each file object.
  */
-#define _LIBFAT_FS_TINY         1       /* 0:Normal or 1:Tiny */
+#define _LIBFAT_FS_TINY         0       /* 0:Normal or 1:Tiny */
+
+
+/* The window cache keeps recently used FAT and directory sectors behind the
+ * disk access window fs->win[]. FAT and directory sectors have separate pools,
+ * so FAT lookups do not evict directory sectors and vice versa. The number of
+ * sectors in each pool is set by libfat_set_windows() before mount (0: pool
+ * disabled, sector is written back and dropped when window is moved).
+ */
+#define _LIBFAT_MAX_WINDOWS     32      /* Maximum number of sectors in a window pool */
+
+
+/* To enable fast seek feature, set _LIBFAT_USE_FASTSEEK to 1. A file object
+ * then builds a cluster link map table (cluster run list) on first seek and
+ * uses it instead of following the FAT chain in seek and read operations.
+ * Tables are allocated on the heap and are limited by the per-volume budget
+ * set by libfat_set_fastseek(). Budget 0 (default) disables the feature.
+ */
+#define _LIBFAT_USE_FASTSEEK    1       /* 0:Disable or 1:Enable */
+
+
+/* To enable free cluster bitmap, set _LIBFAT_USE_FREEMAP to 1. The bitmap of
+ * all clusters of the volume is kept in RAM (1 bit per cluster) and is filled
+ * step by step by libfat_freemap_scan() after mount. When the bitmap is ready
+ * new clusters are allocated from it without reading the FAT and the number of
+ * free clusters is exact.
+ */
+#define _LIBFAT_USE_FREEMAP     1       /* 0:Disable or 1:Enable */
 
 
 /*------------------------------------------------------------------------------
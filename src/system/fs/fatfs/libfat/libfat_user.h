@@ -110,10 +110,8 @@ extern int      _libfat_lock_access     (_LIBFAT_MUTEX_t);
 extern void     _libfat_unlock_access   (_LIBFAT_MUTEX_t);
 extern int      _libfat_delete_mutex    (_LIBFAT_MUTEX_t);
 extern uint32_t _libfat_get_fattime     (void);
-#if _LIBFAT_USE_LFN == 2
 extern void *   _libfat_malloc          (uint);
 extern void     _libfat_free            (void*);
-#endif
 
 #ifdef __cplusplus
 }
@@ -30,21 +30,33 @@
   Include files
 ==============================================================================*/
 #include "config.h"
+#include <string.h>
 #include <sys/types.h>
 #include "dnx/misc.h"
 #include "libc/errno.h"
 #include "kernel/kwrapper.h"
+#include "mm/pool.h"
 #include "fs/pipe.h"
 
 /*==============================================================================
   Local macros
 ==============================================================================*/
+#define PIPE_POOL_SIZE          2
+
+#define PIPE_EVENT_DATA         (1 << 0)
+#define PIPE_EVENT_SPACE        (1 << 1)
 
 /*==============================================================================
   Local object types
 ==============================================================================*/
 struct pipe {
-        queue_t     *queue;
+        u8_t        *buf;               //!< ring buffer
+        size_t       size;              //!< buffer capacity
+        size_t       head;              //!< write index
+        size_t       tail;              //!< read index
+        size_t       level;             //!< number of bytes in buffer
+        mutex_t     *mtx;               //!< buffer access mutex
+        flag_t      *event;             //!< data and space events
         struct pipe *self;
         bool         closed;
 };
@@ -56,8 +68,12 @@ struct pipe {
 /*==============================================================================
   Local objects
 ==============================================================================*/
-static const u32_t PIPE_READ_TIMEOUT  = MAX_DELAY_MS;
-static const u32_t PIPE_WRITE_TIMEOUT = MAX_DELAY_MS;
+static const u32_t PIPE_READ_TIMEOUT         = MAX_DELAY_MS;
+static const u32_t PIPE_WRITE_TIMEOUT        = MAX_DELAY_MS;
+static const u32_t PIPE_NON_BLOCKING_TIMEOUT = 10;
+static const u32_t PIPE_MTX_TIMEOUT          = MAX_DELAY_MS;
+
+static _mm_pool_t pipe_pool = _MM_POOL_INIT("pipe_t", _MM_KRN, sizeof(pipe_t), PIPE_POOL_SIZE);
 
 /*==============================================================================
   Exported objects
@@ -83,29 +99,103 @@ static bool is_valid(pipe_t *this)
         return this && this->self == this;
 }
 
+//==============================================================================
+/**
+ * @brief  Copy data from ring buffer. Data is copied in at most two spans.
+ *         Pipe mutex must be locked.
+ *
+ * @param  this         pipe object
+ * @param  dst          destination buffer
+ * @param  count        number of bytes to read
+ *
+ * @return Number of read bytes.
+ */
+//==============================================================================
+static size_t ring_read(pipe_t *this, u8_t *dst, size_t count)
+{
+        size_t n = min(count, this->level);
+
+        size_t span = min(n, this->size - this->tail);
+        memcpy(dst, &this->buf[this->tail], span);
+        memcpy(dst + span, this->buf, n - span);
+
+        this->tail   = (this->tail + n) % this->size;
+        this->level -= n;
+
+        return n;
+}
+
+//==============================================================================
+/**
+ * @brief  Copy data to ring buffer. Data is copied in at most two spans.
+ *         Pipe mutex must be locked.
+ *
+ * @param  this         pipe object
+ * @param  src          source buffer
+ * @param  count        number of bytes to write
+ *
+ * @return Number of written bytes.
+ */
+//==============================================================================
+static size_t ring_write(pipe_t *this, const u8_t *src, size_t count)
+{
+        size_t n = min(count, this->size - this->level);
+
+        size_t span = min(n, this->size - this->head);
+        memcpy(&this->buf[this->head], src, span);
+        memcpy(this->buf, src + span, n - span);
+
+        this->head   = (this->head + n) % this->size;
+        this->level += n;
+
+        return n;
+}
+
 //==============================================================================
 /**
  * @brief Create pipe object
  *
  * @param[out] pipe     pointer to pointer of pipe handle
+ * @param[in]  capacity pipe buffer size (0 for default size)
  *
  * @return One of errno value.
  */
 //==============================================================================
-int _pipe_create(pipe_t **pipe)
+int _pipe_create(pipe_t **pipe, size_t capacity)
 {
         int err = EINVAL;
 
         if (pipe) {
-                err = _kmalloc(_MM_KRN, sizeof(pipe_t), cast(void**, pipe));
+                capacity = capacity ? capacity : __OS_PIPE_LENGTH__;
+
+                err = _mm_pool_zalloc(&pipe_pool, cast(void**, pipe));
                 if (err == ESUCC) {
+                        pipe_t *this = *pipe;
+
+                        err = _kmalloc(_MM_KRN, capacity, cast(void**, &this->buf));
+
+                        if (err == ESUCC) {
+                                err = _mutex_create(MUTEX_TYPE_NORMAL, &this->mtx);
+                        }
+
+                        if (err == ESUCC) {
+                                err = _flag_create(&this->event);
+                        }
 
-                        err = _queue_create(__OS_PIPE_LENGTH__, sizeof(u8_t), &(*pipe)->queue);
                         if (err == ESUCC) {
-                                (*pipe)->self   = *pipe;
-                                (*pipe)->closed = false;
+                                this->size   = capacity;
+                                this->self   = this;
+                                this->closed = false;
                         } else {
-                                _kfree(_MM_KRN, cast(void**, pipe));
+                                if (this->mtx) {
+                                        _mutex_destroy(this->mtx);
+                                }
+
+                                if (this->buf) {
+                                        _kfree(_MM_KRN, cast(void**, &this->buf));
+                                }
+
+                                _mm_pool_free(&pipe_pool, cast(void**, pipe));
                         }
                 }
         }
@@ -125,9 +215,11 @@ int _pipe_create(pipe_t **pipe)
 int _pipe_destroy(pipe_t *pipe)
 {
         if (is_valid(pipe)) {
-                _queue_destroy(pipe->queue);
+                _flag_destroy(pipe->event);
+                _mutex_destroy(pipe->mtx);
+                _kfree(_MM_KRN, cast(void**, &pipe->buf));
                 pipe->self = NULL;
-                _kfree(_MM_KRN, cast(void**, &pipe));
+                _mm_pool_free(&pipe_pool, cast(void**, &pipe));
                 return ESUCC;
         } else {
                 return EINVAL;
@@ -147,7 +239,28 @@ int _pipe_destroy(pipe_t *pipe)
 int _pipe_get_length(pipe_t *pipe, size_t *len)
 {
         if (len && is_valid(pipe)) {
-                return _queue_get_number_of_items(pipe->queue, len);
+                *len = pipe->level;
+                return ESUCC;
+        } else {
+                return EINVAL;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Return capacity of pipe
+ *
+ * @param pipe          a pipe object
+ * @param capacity      a pipe capacity
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _pipe_get_capacity(pipe_t *pipe, size_t *capacity)
+{
+        if (capacity && is_valid(pipe)) {
+                *capacity = pipe->size;
+                return ESUCC;
         } else {
                 return EINVAL;
         }
@@ -155,7 +268,55 @@ int _pipe_get_length(pipe_t *pipe, size_t *len)
 
 //==============================================================================
 /**
- * @brief Read data from pipe
+ * @brief Change capacity of pipe. Capacity can be changed only if pipe is
+ *        empty.
+ *
+ * @param pipe          a pipe object
+ * @param capacity      a new pipe capacity
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _pipe_set_capacity(pipe_t *pipe, size_t capacity)
+{
+        if (!is_valid(pipe) || (capacity == 0)) {
+                return EINVAL;
+        }
+
+        u8_t *buf = NULL;
+        int   err = _kmalloc(_MM_KRN, capacity, cast(void**, &buf));
+        if (!err) {
+                err = _mutex_lock(pipe->mtx, PIPE_MTX_TIMEOUT);
+                if (!err) {
+                        if (pipe->level == 0) {
+                                u8_t *tmp  = pipe->buf;
+                                pipe->buf  = buf;
+                                pipe->size = capacity;
+                                pipe->head = 0;
+                                pipe->tail = 0;
+                                buf        = tmp;
+                        } else {
+                                err = EBUSY;
+                        }
+
+                        _mutex_unlock(pipe->mtx);
+                }
+
+                _kfree(_MM_KRN, cast(void**, &buf));
+
+                if (!err) {
+                        _flag_set(pipe->event, PIPE_EVENT_SPACE);
+                }
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief Read data from pipe. Function returns data available in the pipe
+ *        (at most count bytes). If pipe is empty then function waits for
+ *        data. If pipe is closed and empty then 0 bytes are read.
  *
  * @param pipe          a pipe object
  * @param buf           a destination buffer
@@ -168,40 +329,52 @@ int _pipe_get_length(pipe_t *pipe, size_t *len)
 //==============================================================================
 int _pipe_read(pipe_t *pipe, u8_t *buf, size_t count, size_t *rdcnt, bool non_blocking)
 {
-        if (is_valid(pipe) && buf && count) {
+        if (!is_valid(pipe) || !buf || !count || !rdcnt) {
+                return EINVAL;
+        }
 
-                size_t n = 0;
-                for (; n < count; n++) {
+        u32_t  tout = non_blocking ? PIPE_NON_BLOCKING_TIMEOUT : PIPE_READ_TIMEOUT;
+        size_t n    = 0;
+        int    err  = ESUCC;
 
-                        size_t noitm = 0;
-                        _queue_get_number_of_items(pipe->queue, &noitm);
+        while (!err) {
+                err = _mutex_lock(pipe->mtx, PIPE_MTX_TIMEOUT);
+                if (err) {
+                        break;
+                }
 
-                        if (pipe->closed && noitm == 0) {
-                                u8_t null = '\0';
-                                _queue_send(pipe->queue, &null, PIPE_WRITE_TIMEOUT);
-                                break;
-                        }
+                bool closed = pipe->closed;
 
-                        u32_t tout = non_blocking || n ? 10 : PIPE_READ_TIMEOUT;
-                        if (_queue_receive(pipe->queue, &buf[n], tout) != ESUCC) {
-                                break;
-                        }
+                n = ring_read(pipe, buf, count);
+                if (n == 0) {
+                        _flag_clear(pipe->event, PIPE_EVENT_DATA);
                 }
 
-                *rdcnt = n;
-                return ESUCC;
-        } else {
-                return EINVAL;
+                _mutex_unlock(pipe->mtx);
+
+                if (n > 0) {
+                        _flag_set(pipe->event, PIPE_EVENT_SPACE);
+                        break;
+                }
+
+                if (closed || (_flag_wait(pipe->event, PIPE_EVENT_DATA, tout) != ESUCC)) {
+                        break;
+                }
         }
+
+        *rdcnt = n;
+
+        return err;
 }
 
 //==============================================================================
 /**
- * @brief Read data from pipe
+ * @brief Write data to pipe. Function waits for free space until all data is
+ *        written.
  *
  * @param pipe          a pipe object
- * @param buf           a destination buffer
- * @param count         a count of bytes to read
+ * @param buf           a source buffer
+ * @param count         a count of bytes to write
  * @param wrcnt         a number of written bytes
  * @param non_blocking  a non-blocking access mode
  *
@@ -210,34 +383,49 @@ int _pipe_read(pipe_t *pipe, u8_t *buf, size_t count, size_t *rdcnt, bool non_bl
 //==============================================================================
 int _pipe_write(pipe_t *pipe, const u8_t *buf, size_t count, size_t *wrcnt, bool non_blocking)
 {
-        if (is_valid(pipe) && buf && count) {
+        if (!is_valid(pipe) || !buf || !count || !wrcnt) {
+                return EINVAL;
+        }
 
-                size_t n = 0;
-                for (; n < count; n++) {
+        u32_t  tout = non_blocking ? PIPE_NON_BLOCKING_TIMEOUT : PIPE_WRITE_TIMEOUT;
+        size_t n    = 0;
+        int    err  = ESUCC;
 
-                        size_t noitm = 0;
-                        _queue_get_number_of_items(pipe->queue, &noitm);
+        while (!err && (n < count)) {
+                err = _mutex_lock(pipe->mtx, PIPE_MTX_TIMEOUT);
+                if (err) {
+                        break;
+                }
 
-                        if (pipe->closed && noitm == 0) {
-                                break;
-                        }
+                if (pipe->closed && (pipe->level == 0)) {
+                        _mutex_unlock(pipe->mtx);
+                        break;
+                }
 
-                        u32_t tout = non_blocking ? 10 : PIPE_WRITE_TIMEOUT;
-                        if (_queue_send(pipe->queue, &buf[n], tout) != ESUCC) {
-                                break;
-                        }
+                size_t wr = ring_write(pipe, buf + n, count - n);
+                if (wr == 0) {
+                        _flag_clear(pipe->event, PIPE_EVENT_SPACE);
                 }
 
-                *wrcnt = n;
-                return ESUCC;
-        } else {
-                return EINVAL;
+                _mutex_unlock(pipe->mtx);
+
+                if (wr > 0) {
+                        n += wr;
+                        _flag_set(pipe->event, PIPE_EVENT_DATA);
+
+                } else if (_flag_wait(pipe->event, PIPE_EVENT_SPACE, tout) != ESUCC) {
+                        break;
+                }
         }
+
+        *wrcnt = n;
+
+        return err;
 }
 
 //==============================================================================
 /**
- * @brief Close pipe
+ * @brief Close pipe. Waiting readers and writers are woken up.
  *
  * @param pipe          a pipe object
  *
@@ -248,9 +436,7 @@ int _pipe_close(pipe_t *pipe)
 {
         if (is_valid(pipe)) {
                 pipe->closed = true;
-
-                const u8_t nul = '\0';
-                return _queue_send(pipe->queue, &nul, PIPE_WRITE_TIMEOUT);
+                return _flag_set(pipe->event, PIPE_EVENT_DATA | PIPE_EVENT_SPACE);
         } else {
                 return EINVAL;
         }
@@ -268,7 +454,17 @@ int _pipe_close(pipe_t *pipe)
 int _pipe_clear(pipe_t *pipe)
 {
         if (is_valid(pipe)) {
-                return _queue_reset(pipe->queue);
+                int err = _mutex_lock(pipe->mtx, PIPE_MTX_TIMEOUT);
+                if (!err) {
+                        pipe->head  = 0;
+                        pipe->tail  = 0;
+                        pipe->level = 0;
+                        _mutex_unlock(pipe->mtx);
+
+                        _flag_set(pipe->event, PIPE_EVENT_SPACE);
+                }
+
+                return err;
         } else {
                 return EINVAL;
         }
@@ -40,8 +40,20 @@
 #define PATH_ROOT_BIN                   "/bin"
 #define PATH_ROOT_PID                   "/pid"
 #define PATH_ROOT_CPUINFO               "/cpuinfo"
-
-#define FILE_BUFFER                     384
+#define PATH_ROOT_CACHEINFO             "/cacheinfo"
+#define PATH_ROOT_MEMINFO               "/meminfo"
+#define PATH_ROOT_KWORKER               "/kworker"
+#define PATH_ROOT_SYSCALLS              "/syscalls"
+
+#define FILE_BUFFER                     512
+#define SYSCALLS_FILE_BUFFER            2048
+#define FILE_BUFFER_SIZE(_file)         ((_file)->content == FILE_CONTENT_SYSCALLS ? SYSCALLS_FILE_BUFFER : FILE_BUFFER)
+
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+#define ROOT_ITEMS                      7
+#else
+#define ROOT_ITEMS                      6
+#endif
 #define PID_STR_LEN                     12
 
 /*==============================================================================
@@ -57,6 +69,10 @@ enum path_content {
         FILE_CONTENT_BIN,
         FILE_CONTENT_PID,
         FILE_CONTENT_CPUINFO,
+        FILE_CONTENT_CACHEINFO,
+        FILE_CONTENT_MEMINFO,
+        FILE_CONTENT_KWORKER,
+        FILE_CONTENT_SYSCALLS,
         _FILE_CONTENT_COUNT
 };
 
@@ -226,6 +242,24 @@ API_FS_OPEN(procfs, void *fs_handle, void **fhdl, fpos_t *fpos, const char *path
         } else if (isstreq(path, PATH_ROOT_CPUINFO)) {
                 return add_file_to_list(fsctx, 0, FILE_CONTENT_CPUINFO, fhdl);
 
+        // "/cacheinfo" path
+        } else if (isstreq(path, PATH_ROOT_CACHEINFO)) {
+                return add_file_to_list(fsctx, 0, FILE_CONTENT_CACHEINFO, fhdl);
+
+        // "/meminfo" path
+        } else if (isstreq(path, PATH_ROOT_MEMINFO)) {
+                return add_file_to_list(fsctx, 0, FILE_CONTENT_MEMINFO, fhdl);
+
+        // "/kworker" path
+        } else if (isstreq(path, PATH_ROOT_KWORKER)) {
+                return add_file_to_list(fsctx, 0, FILE_CONTENT_KWORKER, fhdl);
+
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+        // "/syscalls" path
+        } else if (isstreq(path, PATH_ROOT_SYSCALLS)) {
+                return add_file_to_list(fsctx, 0, FILE_CONTENT_SYSCALLS, fhdl);
+#endif
+
         } else {
                 err = ENOENT;
         }
@@ -322,9 +356,9 @@ API_FS_READ(procfs,
         if (file && file->content < _FILE_CONTENT_COUNT) {
 
                 char *content;
-                err = sys_zalloc(FILE_BUFFER, cast(void**, &content));
+                err = sys_zalloc(FILE_BUFFER_SIZE(file), cast(void**, &content));
                 if (!err) {
-                        size_t data_size = get_file_content(file, content, FILE_BUFFER);
+                        size_t data_size = get_file_content(file, content, FILE_BUFFER_SIZE(file));
                         size_t seek      = min(*fpos, SIZE_MAX);
                         if (seek > data_size) {
                                 *rdcnt = 0;
@@ -403,17 +437,21 @@ API_FS_FSTAT(procfs, void *fs_handle, void *fhdl, struct stat *stat)
         stat->st_uid   = 0;
 
         char *content;
-        int err = sys_zalloc(FILE_BUFFER, cast(void**, &content));
+        int err = sys_zalloc(FILE_BUFFER_SIZE(file), cast(void**, &content));
         if (!err) {
 
                 if (file->content < _FILE_CONTENT_COUNT) {
 
                         if (file->arg >= 0) {
-                                stat->st_size = get_file_content(file, content, FILE_BUFFER);
+                                stat->st_size = get_file_content(file, content, FILE_BUFFER_SIZE(file));
                                 stat->st_type = FILE_TYPE_REGULAR;
 
                                 if (  (file->content == FILE_CONTENT_PID)
-                                   || (file->content == FILE_CONTENT_CPUINFO) ) {
+                                   || (file->content == FILE_CONTENT_CPUINFO)
+                                   || (file->content == FILE_CONTENT_CACHEINFO)
+                                   || (file->content == FILE_CONTENT_MEMINFO)
+                                   || (file->content == FILE_CONTENT_KWORKER)
+                                   || (file->content == FILE_CONTENT_SYSCALLS) ) {
 
                                         time_t t = 0;
                                         sys_get_time(&t);
@@ -539,7 +577,7 @@ API_FS_OPENDIR(procfs, void *fs_handle, const char *path, DIR *dir)
 
                 if (isstreq(path, PATH_ROOT)) {
                         dirinfo->dir_name = PATH_ROOT;
-                        dir->d_items      = 3;
+                        dir->d_items      = ROOT_ITEMS;
 
                 } else if (isstreq(path, PATH_ROOT_PID"/")) {
                         dirinfo->dir_name = PATH_ROOT_PID;
@@ -765,6 +803,64 @@ static int procfs_readdir_root(struct procfs *hdl, DIR *dir)
                 break;
         }
 
+        case 3: {
+                char *content;
+                err = sys_zalloc(FILE_BUFFER, cast(void**, &content));
+                if (!err) {
+                        struct file_info file = {.content = FILE_CONTENT_CACHEINFO, .arg = 0};
+                        dir->dirent.name      = "cacheinfo";
+                        dir->dirent.filetype  = FILE_TYPE_REGULAR;
+                        dir->dirent.size      = get_file_content(&file, content, FILE_BUFFER);
+
+                        sys_free(cast(void**, &content));
+                }
+                break;
+        }
+
+        case 4: {
+                char *content;
+                err = sys_zalloc(FILE_BUFFER, cast(void**, &content));
+                if (!err) {
+                        struct file_info file = {.content = FILE_CONTENT_MEMINFO, .arg = 0};
+                        dir->dirent.name      = "meminfo";
+                        dir->dirent.filetype  = FILE_TYPE_REGULAR;
+                        dir->dirent.size      = get_file_content(&file, content, FILE_BUFFER);
+
+                        sys_free(cast(void**, &content));
+                }
+                break;
+        }
+
+        case 5: {
+                char *content;
+                err = sys_zalloc(FILE_BUFFER, cast(void**, &content));
+                if (!err) {
+                        struct file_info file = {.content = FILE_CONTENT_KWORKER, .arg = 0};
+                        dir->dirent.name      = "kworker";
+                        dir->dirent.filetype  = FILE_TYPE_REGULAR;
+                        dir->dirent.size      = get_file_content(&file, content, FILE_BUFFER);
+
+                        sys_free(cast(void**, &content));
+                }
+                break;
+        }
+
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+        case 6: {
+                char *content;
+                err = sys_zalloc(SYSCALLS_FILE_BUFFER, cast(void**, &content));
+                if (!err) {
+                        struct file_info file = {.content = FILE_CONTENT_SYSCALLS, .arg = 0};
+                        dir->dirent.name      = "syscalls";
+                        dir->dirent.filetype  = FILE_TYPE_REGULAR;
+                        dir->dirent.size      = get_file_content(&file, content, SYSCALLS_FILE_BUFFER);
+
+                        sys_free(cast(void**, &content));
+                }
+                break;
+        }
+#endif
+
         default:
                 err = ENOENT;
                 break;
@@ -892,6 +988,12 @@ static size_t get_file_content(struct file_info *file, char *buff, size_t size)
 {
         size_t         len = 0;
         process_stat_t stat;
+        cache_stat_t   cstat;
+        heap_stat_t    hstat;
+        kworker_stat_t kstat;
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+        syscall_stat_t sstat;
+#endif
 
         switch (file->content) {
         case FILE_CONTENT_PID:
@@ -960,6 +1062,123 @@ static size_t get_file_content(struct file_info *file, char *buff, size_t size)
                 }
                 break;
 
+        case FILE_CONTENT_CACHEINFO:
+                if (sys_cache_get_stat(&cstat) == ESUCC) {
+                        len = sys_snprintf(buff, size,
+                                           "Hits: %u\n"
+                                           "Misses: %u\n"
+                                           "Evictions: %u\n"
+                                           "Prefetched: %u\n"
+                                           "Blocks: %u\n"
+                                           "Dirty Blocks: %u\n"
+                                           "Size: %u bytes\n",
+                                           cstat.hits,
+                                           cstat.misses,
+                                           cstat.evictions,
+                                           cstat.prefetched,
+                                           cstat.blocks,
+                                           cstat.dirty_blocks,
+                                           cstat.size);
+                }
+                break;
+
+        case FILE_CONTENT_MEMINFO:
+                if (sys_get_heap_stat(&hstat) == ESUCC) {
+                        uint frag = 0;
+                        if (hstat.free) {
+                                frag = 100 - ((hstat.largest_free * 100) / hstat.free);
+                        }
+
+                        len = sys_snprintf(buff, size,
+                                           "Size: %u bytes\n"
+                                           "Used: %u bytes\n"
+                                           "Max Used: %u bytes\n"
+                                           "Free: %u bytes\n"
+                                           "Free Blocks: %u\n"
+                                           "Largest Free Block: %u bytes\n"
+                                           "Fragmentation: %u%%\n",
+                                           hstat.size,
+                                           hstat.used,
+                                           hstat.used_max,
+                                           hstat.free,
+                                           hstat.free_blocks,
+                                           hstat.largest_free,
+                                           frag);
+
+                        mem_region_stat_t rstat;
+                        for (size_t i = 0; sys_get_mem_region_stat(i, &rstat) == ESUCC; i++) {
+                                len += sys_snprintf(buff + len, size - len,
+                                                    "Region %u: %p %s%s%s %u/%u bytes\n",
+                                                    i,
+                                                    rstat.start,
+                                                    rstat.attr & MEM_REGION_ATTR_FAST  ? "fast" : "slow",
+                                                    rstat.attr & MEM_REGION_ATTR_DMA   ? ",dma" : "",
+                                                    rstat.attr & MEM_REGION_ATTR_LARGE ? ",large" : "",
+                                                    rstat.heap.used,
+                                                    rstat.heap.size);
+                        }
+                }
+                break;
+
+        case FILE_CONTENT_KWORKER:
+                if (sys_get_kworker_stat(&kstat) == ESUCC) {
+                        len = sys_snprintf(buff, size,
+                                           "I/O Threads: %u\n"
+                                           "Idle Threads: %u\n"
+                                           "Created Threads: %u\n"
+                                           "Queue Depth: %u\n"
+                                           "Max Queue Depth: %u\n",
+                                           kstat.threads,
+                                           kstat.idle,
+                                           kstat.created,
+                                           kstat.queue_depth,
+                                           kstat.queue_depth_max);
+
+                        kworker_thread_stat_t tstat;
+                        for (tid_t tid = 0; (len < size) && (sys_get_kworker_thread_stat(tid, &tstat) == ESUCC); tid++) {
+                                if (tstat.requests || tstat.active) {
+                                        len += sys_snprintf(buff + len, size - len,
+                                                            "Thread %u:%s %u requests, busy %u ms, max wait %u us\n",
+                                                            tid,
+                                                            tstat.active ? "" : " (finished)",
+                                                            tstat.requests,
+                                                            tstat.busy_time,
+                                                            tstat.max_wait);
+                                }
+                        }
+                }
+                break;
+
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+        case FILE_CONTENT_SYSCALLS:
+                len = sys_snprintf(buff, size,
+                                   "# syscall: calls direct max_us |"
+                                   " <4 <16 <64 <256 <1k <4k <16k >=16k us\n");
+
+                for (size_t i = 0; (len < size) && (sys_get_syscall_stat(i, &sstat) == ESUCC); i++) {
+                        if (sstat.count == 0) {
+                                continue;
+                        }
+
+                        len += sys_snprintf(buff + len, size - len,
+                                            "%u: %u %u %u |",
+                                            i,
+                                            sstat.count,
+                                            sstat.direct,
+                                            sstat.time_max);
+
+                        for (int b = 0; (len < size) && (b < _SYSCALL_STAT_BUCKETS); b++) {
+                                len += sys_snprintf(buff + len, size - len,
+                                                    " %u", sstat.histogram[b]);
+                        }
+
+                        if (len < size) {
+                                len += sys_snprintf(buff + len, size - len, "\n");
+                        }
+                }
+                break;
+#endif
+
         default:
                 break;
         }
@@ -38,16 +38,29 @@
 #define PIPE_LENGTH                     __OS_STREAM_BUFFER_LENGTH__
 #define PIPE_WRITE_TIMEOUT              1
 #define PIPE_READ_TIMEOUT               MAX_DELAY
-#define DATA_CHAIN_SIZE                 __RAMFS_FILE_CHAIN_SIZE__
+#define DATA_CHUNK_SIZE                 __RAMFS_FILE_CHAIN_SIZE__
+#define DATA_INDEX_INIT_SIZE            4
+#define NODE_POOL_SIZE                  16
+#define DIR_INIT_SIZE                   8
+#define DIR_LOAD_FACTOR                 2
 
 /*==============================================================================
   Local types, enums definitions
 ==============================================================================*/
-/** regular file data chain */
-typedef struct data_chain {
-        struct data_chain *next;
-        u8_t buf[DATA_CHAIN_SIZE];
-} data_chain_t;
+/** regular file data: chunk table indexed by fpos / DATA_CHUNK_SIZE */
+typedef struct file_data {
+        u8_t           **chunk;                 //!< chunk table (NULL chunk is a hole)
+        u32_t            chunks;                //!< size of chunk table
+} file_data_t;
+
+/** directory: entry table and name hash index */
+typedef struct dir {
+        struct node    **entry;                 //!< entry table (readdir order)
+        struct node    **bucket;                //!< hash buckets chained by node_t::hnext
+        u32_t            count;                 //!< number of entries
+        u32_t            capacity;              //!< size of entry table
+        u32_t            buckets;               //!< number of buckets (power of 2)
+} dir_t;
 
 /** node structure */
 typedef struct node {
@@ -59,11 +72,13 @@ typedef struct node {
         size_t           size;                  //!< file size
         time_t           mtime;                 //!< time of last modification
         time_t           ctime;                 //!< time of creation
+        struct node     *hnext;                 //!< next node in parent's hash bucket
+        u32_t            idx;                   //!< position in parent's entry table
 
         union {
                 pipe_t       *pipe_t;
-                llist_t      *llist_t;
-                data_chain_t *data_chain_t;
+                dir_t        *dir_t;
+                file_data_t  *file_data_t;
                 dev_t         dev_t;
         } data;
 } node_t;
@@ -86,18 +101,30 @@ struct RAMFS {
 /*==============================================================================
   Local function prototypes
 ==============================================================================*/
-static int  new_node                    (struct RAMFS *hdl, node_t *parent, char *filename, tfile_t type, i32_t *item, node_t **child);
-static int  delete_node                 (struct RAMFS *hdl, node_t *base, node_t *target, u32_t position);
-static int  get_node                    (const char *path, node_t *startnode, i32_t deep, i32_t *item, node_t **node);
+static int  new_node                    (struct RAMFS *hdl, node_t *parent, char *filename, tfile_t type, node_t **child);
+static int  delete_node                 (struct RAMFS *hdl, node_t *base, node_t *target);
+static int  get_node                    (const char *path, node_t *startnode, i32_t deep, node_t **node);
 static uint get_path_deep               (const char *path);
 static int  add_node_to_open_files_list (struct RAMFS *hdl, node_t *parent, node_t *child);
 static void clear_regular_file          (node_t *node);
+static int  grow_regular_file           (node_t *node, u32_t chunks);
+static void node_free                   (void *node);
+static u32_t name_hash                  (const char *name, size_t len);
+static int  dir_create                  (dir_t **dir);
+static void dir_destroy                 (dir_t *dir);
+static int  dir_rehash                  (dir_t *dir, u32_t buckets);
+static int  dir_insert                  (dir_t *dir, node_t *node);
+static void dir_remove                  (dir_t *dir, node_t *node);
+static node_t *dir_find                 (dir_t *dir, const char *name, size_t len);
+static void dir_hash_link               (dir_t *dir, node_t *node);
+static void dir_hash_unlink             (dir_t *dir, node_t *node);
 static int  write_regular_file          (node_t *node, const u8_t *src, size_t count, fpos_t fpos, size_t *wrcnt);
 static int  read_regular_file           (node_t *node, u8_t *dst, size_t count, fpos_t fpos, size_t *rdcnt);
 
 /*==============================================================================
   Local object definitions
 ==============================================================================*/
+static mem_pool_t node_pool = SYS_MEM_POOL_INIT("ramfs node", sizeof(node_t), NODE_POOL_SIZE);
 
 /*==============================================================================
   Function definitions
@@ -125,7 +152,7 @@ API_FS_INIT(ramfs, void **fs_handle, const char *src_path, const char *opts)
                 if (err)
                         goto finish;
 
-                err = sys_llist_create(NULL, NULL, cast(llist_t**, &hdl->root_dir.data.llist_t));
+                err = dir_create(&hdl->root_dir.data.dir_t);
                 if (err)
                         goto finish;
 
@@ -142,8 +169,8 @@ API_FS_INIT(ramfs, void **fs_handle, const char *src_path, const char *opts)
                         if (hdl->resource_mtx)
                                 sys_mutex_destroy(hdl->resource_mtx);
 
-                        if (hdl->root_dir.data.llist_t)
-                                sys_llist_destroy(hdl->root_dir.data.llist_t);
+                        if (hdl->root_dir.data.dir_t)
+                                dir_destroy(hdl->root_dir.data.dir_t);
 
                         if (hdl->opended_files)
                                 sys_llist_destroy(hdl->opended_files);
@@ -196,7 +223,7 @@ API_FS_MKNOD(ramfs, void *fs_handle, const char *path, const dev_t dev)
 
                 // parent node must exist
                 node_t *parent;
-                err = get_node(path, &hdl->root_dir, -1, NULL, &parent);
+                err = get_node(path, &hdl->root_dir, -1, &parent);
                 if (!err) {
                         // create new node
                         char *basename = strrchr(path, '/') + 1;
@@ -207,7 +234,7 @@ API_FS_MKNOD(ramfs, void *fs_handle, const char *path, const dev_t dev)
                                 strcpy(child_name, basename);
 
                                 node_t *child;
-                                err = new_node(hdl, parent, child_name, FILE_TYPE_DRV, NULL, &child);
+                                err = new_node(hdl, parent, child_name, FILE_TYPE_DRV, &child);
                                 if (!err) {
                                         child->data.dev_t = dev;
                                 } else {
@@ -242,7 +269,7 @@ API_FS_MKDIR(ramfs, void *fs_handle, const char *path, mode_t mode)
 
                 // parent node must exist
                 node_t *parent;
-                err = get_node(path, &hdl->root_dir, -1, NULL, &parent);
+                err = get_node(path, &hdl->root_dir, -1, &parent);
                 if (!err) {
                         // create new node
                         char *basename = strrchr(path, '/') + 1;
@@ -253,7 +280,7 @@ API_FS_MKDIR(ramfs, void *fs_handle, const char *path, mode_t mode)
                                 strcpy(child_name, basename);
 
                                 node_t *child;
-                                err = new_node(hdl, parent, child_name, FILE_TYPE_DIR, NULL, &child);
+                                err = new_node(hdl, parent, child_name, FILE_TYPE_DIR, &child);
                                 if (!err) {
                                         child->mode = mode;
                                 } else {
@@ -288,7 +315,7 @@ API_FS_MKFIFO(ramfs, void *fs_handle, const char *path, mode_t mode)
 
                 // parent node must exist
                 node_t *parent;
-                err = get_node(path, &hdl->root_dir, -1, NULL, &parent);
+                err = get_node(path, &hdl->root_dir, -1, &parent);
                 if (!err) {
                         // create new node
                         char *basename = strrchr(path, '/') + 1;
@@ -299,7 +326,7 @@ API_FS_MKFIFO(ramfs, void *fs_handle, const char *path, mode_t mode)
                                 strcpy(child_name, basename);
 
                                 node_t *child;
-                                err = new_node(hdl, parent, child_name, FILE_TYPE_PIPE, NULL, &child);
+                                err = new_node(hdl, parent, child_name, FILE_TYPE_PIPE, &child);
                                 if (!err) {
                                         child->mode = mode;
                                 } else {
@@ -333,10 +360,10 @@ API_FS_OPENDIR(ramfs, void *fs_handle, const char *path, DIR *dir)
         if (!err) {
 
                 node_t *parent;
-                err = get_node(path, &hdl->root_dir, 0, NULL, &parent);
+                err = get_node(path, &hdl->root_dir, 0, &parent);
                 if (!err) {
                         if (parent->type == FILE_TYPE_DIR) {
-                                dir->d_items    = sys_llist_size(parent->data.llist_t);
+                                dir->d_items    = parent->data.dir_t->count;
                                 dir->d_seek     = 0;
                                 dir->d_hdl      = parent;
                         } else {
@@ -384,8 +411,12 @@ API_FS_READDIR(ramfs, void *fs_handle, DIR *dir)
         int err = sys_mutex_lock(hdl->resource_mtx, MTX_TIMEOUT);
         if (!err) {
 
-                node_t *parent = dir->d_hdl;
-                node_t *child  = sys_llist_at(parent->data.llist_t, dir->d_seek++);
+                dir_t  *parent = cast(node_t*, dir->d_hdl)->data.dir_t;
+                node_t *child  = NULL;
+
+                if (dir->d_seek < parent->count) {
+                        child = parent->entry[dir->d_seek++];
+                }
 
                 if (child) {
                         dir->dirent.filetype = child->type;
@@ -438,13 +469,13 @@ API_FS_REMOVE(ramfs, void *fs_handle, const char *path)
         if (!err) {
 
                 node_t *parent;
-                err = get_node(path, &hdl->root_dir, -1, NULL, &parent);
+                err = get_node(path, &hdl->root_dir, -1, &parent);
                 if (err){
                         goto finish;
                 }
 
-                i32_t item; node_t *child;
-                err = get_node(path, &hdl->root_dir, 0, &item, &child);
+                node_t *child;
+                err = get_node(path, &hdl->root_dir, 0, &child);
                 if (err) {
                         goto finish;
                 }
@@ -474,7 +505,7 @@ API_FS_REMOVE(ramfs, void *fs_handle, const char *path)
 
                 /* remove node if possible */
                 if (remove_file == true) {
-                        err = delete_node(hdl, parent, child, item);
+                        err = delete_node(hdl, parent, child);
                 } else {
                         err = ESUCC;
                 }
@@ -508,21 +539,41 @@ API_FS_RENAME(ramfs, void *fs_handle, const char *old_name, const char *new_name
         int err = sys_mutex_lock(hdl->resource_mtx, MTX_TIMEOUT);
         if (!err) {
 
-                node_t *target;
-                err = get_node(old_name, &hdl->root_dir, 0, NULL, &target);
+                node_t *parent, *target;
+                err = get_node(old_name, &hdl->root_dir, -1, &parent);
+                if (!err) {
+                        err = get_node(old_name, &hdl->root_dir, 0, &target);
+                }
+
+                if (!err && target == &hdl->root_dir) {
+                        err = EPERM;
+                }
+
                 if (!err) {
                         char *basename = strrchr(new_name, '/') + 1;
 
+                        node_t *node = dir_find(parent->data.dir_t, basename, strlen(basename));
+                        if (node && node != target) {
+                                err = EEXIST;
+                        }
+
                         char *newname;
-                        err = sys_zalloc(strsize(basename), cast(void**, &newname));
+                        if (!err) {
+                                err = sys_zalloc(strsize(basename), cast(void**, &newname));
+                        }
+
                         if (!err) {
                                 strcpy(newname, basename);
 
+                                dir_hash_unlink(parent->data.dir_t, target);
+
                                 if (target->name) {
-                                        sys_free(cast(void**, target->name));
+                                        sys_free(cast(void**, &target->name));
                                 }
 
                                 target->name = newname;
+
+                                dir_hash_link(parent->data.dir_t, target);
                         }
                 }
 
@@ -551,7 +602,7 @@ API_FS_CHMOD(ramfs, void *fs_handle, const char *path, mode_t mode)
         if (!err) {
 
                 node_t *target;
-                err = get_node(path, &hdl->root_dir, 0, NULL, &target);
+                err = get_node(path, &hdl->root_dir, 0, &target);
                 if (!err) {
                         target->mode = mode;
                 }
@@ -582,7 +633,7 @@ API_FS_CHOWN(ramfs, void *fs_handle, const char *path, uid_t owner, gid_t group)
         if (!err) {
 
                 node_t *target;
-                err = get_node(path, &hdl->root_dir, 0, NULL, &target);
+                err = get_node(path, &hdl->root_dir, 0, &target);
                 if (!err) {
                         target->uid = owner;
                         target->gid = group;
@@ -613,7 +664,7 @@ API_FS_STAT(ramfs, void *fs_handle, const char *path, struct stat *stat)
         if (!err) {
 
                 node_t *target;
-                err = get_node(path, &hdl->root_dir, 0, NULL, &target);
+                err = get_node(path, &hdl->root_dir, 0, &target);
                 if (!err) {
                         if ( (strlch(path) == '/' && target->type == FILE_TYPE_DIR)
                            || strlch(path) != '/') {
@@ -766,14 +817,14 @@ API_FS_OPEN(ramfs, void *fs_handle, void **fhdl, fpos_t *fpos, const char *path,
 
                 // open file parent
                 node_t *parent;
-                err = get_node(path, &hdl->root_dir, -1, NULL, &parent);
+                err = get_node(path, &hdl->root_dir, -1, &parent);
                 if (err) {
                         goto finish;
                 }
 
                 // try to open selected file, if not exist then try create if O_CREAT flag is set
-                i32_t item; node_t *child;
-                err = get_node(path, &hdl->root_dir, 0, &item, &child);
+                node_t *child;
+                err = get_node(path, &hdl->root_dir, 0, &child);
                 if (err == ENOENT) {
                         // check that file should be created
                         if (!(flags & O_CREAT)) {
@@ -790,7 +841,7 @@ API_FS_OPEN(ramfs, void *fs_handle, void **fhdl, fpos_t *fpos, const char *path,
 
                         strcpy(file_name, basename);
 
-                        err = new_node(hdl, parent, file_name, FILE_TYPE_REGULAR, &item, &child);
+                        err = new_node(hdl, parent, file_name, FILE_TYPE_REGULAR, &child);
                         if (err) {
                                 sys_free(cast(void**, &file_name));
                                 goto finish;
@@ -878,7 +929,7 @@ API_FS_CLOSE(ramfs, void *fs_handle, void *fhdl, bool force)
                                         bool remove = true;
 
                                         sys_llist_foreach(struct opened_file_info*, file, hdl->opended_files) {
-                                                if (file->child == target) {
+                                                if (file != opened_file && file->child == target) {
                                                         remove = false;
                                                         break;
                                                 }
@@ -887,8 +938,7 @@ API_FS_CLOSE(ramfs, void *fs_handle, void *fhdl, bool force)
                                         if (remove) {
                                                 err = delete_node(hdl,
                                                                   opened_file->parent,
-                                                                  opened_file->child,
-                                                                  pos);
+                                                                  opened_file->child);
                                         }
                                 } else {
                                         err = ESUCC;
@@ -1084,6 +1134,17 @@ API_FS_IOCTL(ramfs, void *fs_handle, void *fhdl, int request, void *arg)
                                         sys_mutex_unlock(hdl->resource_mtx);
                                         return sys_pipe_clear(opened_file->child->data.pipe_t);
 
+                                case IOCTL_PIPE__SET_CAPACITY:
+                                        sys_mutex_unlock(hdl->resource_mtx);
+                                        return arg ? sys_pipe_set_capacity(opened_file->child->data.pipe_t,
+                                                                           *cast(const size_t*, arg))
+                                                   : EINVAL;
+
+                                case IOCTL_PIPE__GET_CAPACITY:
+                                        sys_mutex_unlock(hdl->resource_mtx);
+                                        return sys_pipe_get_capacity(opened_file->child->data.pipe_t,
+                                                                     cast(size_t*, arg));
+
                                 default:
                                         err = EBADRQC;
                                         break;
@@ -1153,19 +1214,18 @@ API_FS_SYNC(ramfs, void *fs_handle)
  *
  * @param[in] *base             base node
  * @param[in] *target           target node
- * @param[in]  position         item in base node that point to target
  *
  * @return One of errno value (errno.h)
  */
 //==============================================================================
-static int delete_node(struct RAMFS *hdl, node_t *base, node_t *target, u32_t position)
+static int delete_node(struct RAMFS *hdl, node_t *base, node_t *target)
 {
         if (target->type == FILE_TYPE_DIR) {
-                if (sys_llist_size(target->data.llist_t) > 0) {
+                if (target->data.dir_t->count > 0) {
                         return ENOTEMPTY;
                 } else {
-                        sys_llist_destroy(target->data.llist_t);
-                        target->data.llist_t = NULL;
+                        dir_destroy(target->data.dir_t);
+                        target->data.dir_t = NULL;
                 }
 
         } else if (target->type == FILE_TYPE_PIPE) {
@@ -1178,11 +1238,13 @@ static int delete_node(struct RAMFS *hdl, node_t *base, node_t *target, u32_t po
                 clear_regular_file(target);
         }
 
+        dir_remove(base->data.dir_t, target);
+
         if (target->name) {
                 sys_free(cast(void**, &target->name));
         }
 
-        sys_llist_erase(base->data.llist_t, position);
+        node_free(target);
 
         hdl->file_count--;
 
@@ -1227,13 +1289,12 @@ static uint get_path_deep(const char *path)
  * @param[in]  startnode        start node
  * @param[out] extPath          external path begin (pointer from path)
  * @param[in]  deep             deep control
- * @param[out] item             node is n-item of list which was found
  * @param[out] node             found node
  *
  * @return One of errno value (errno.h)
  */
 //==============================================================================
-static int get_node(const char *path, node_t *startnode, i32_t deep, i32_t *item, node_t **node)
+static int get_node(const char *path, node_t *startnode, i32_t deep, node_t **node)
 {
         if (!path || !startnode) {
                 return ENOENT;
@@ -1259,37 +1320,17 @@ static int get_node(const char *path, node_t *startnode, i32_t deep, i32_t *item
                 char *path_end    = strchr(path, '/');
                 uint  path_length = !path_end ? strlen(path) : (size_t)path_end - (size_t)path;
 
-                /* get number of list items */
-                int list_size = sys_llist_size(current_node->data.llist_t);
+                /* only directories can be traversed */
+                if (current_node->type != FILE_TYPE_DIR) {
+                        current_node = NULL;
+                        break;
+                }
 
                 /* find that object exist ------------------------------------*/
-                int i = 0;
-                while (list_size > 0) {
-                        node_t *next_node = sys_llist_at(current_node->data.llist_t, i++);
-
-                        if (next_node == NULL) {
-                                dir_deep = 1 - deep;
-                                break;
-                        }
-
-                        if (  strlen(next_node->name) == path_length
-                           && strncmp(next_node->name, path, path_length) == 0 ) {
-
-                                current_node = next_node;
+                current_node = dir_find(current_node->data.dir_t, path, path_length);
 
-                                if (item) {
-                                        *item = i - 1;
-                                }
-
-                                break;
-                        }
-
-                        list_size--;
-                }
-
-                /* directory does not found or error */
-                if (list_size == 0 || current_node == NULL) {
-                        current_node = NULL;
+                /* directory does not found */
+                if (current_node == NULL) {
                         break;
                 }
 
@@ -1313,7 +1354,6 @@ static int get_node(const char *path, node_t *startnode, i32_t deep, i32_t *item
  * @param[in]  parent           parent node
  * @param[in]  filename         filename (must be earlier allocated)
  * @param[in]  type             node type
- * @param[out] item             new node number in base node (can be NULL)
  * @param[out] child            new node
  *
  * @return One of errno value (errno.h)
@@ -1323,7 +1363,6 @@ static int new_node(struct RAMFS *hdl,
                     node_t       *parent,
                     char         *filename,
                     tfile_t       type,
-                    i32_t        *item,
                     node_t      **child)
 {
         if (!parent || !filename) {
@@ -1334,21 +1373,19 @@ static int new_node(struct RAMFS *hdl,
                 return ENOTDIR;
         }
 
-        sys_llist_foreach(node_t*, node, parent->data.llist_t) {
-                if (strncmp(node->name, filename, 255) == 0) {
-                        return EEXIST;
-                }
+        if (dir_find(parent->data.dir_t, filename, strlen(filename))) {
+                return EEXIST;
         }
 
         node_t *node;
-        int err = sys_zalloc(sizeof(node_t), cast(void**, &node));
+        int err = sys_pool_zalloc(&node_pool, cast(void**, &node));
         if (!err) {
 
                 time_t tm = 0;
                 sys_get_time(&tm);
 
                 node->name         = filename;
-                node->data.llist_t = NULL;
+                node->data.dir_t   = NULL;
                 node->gid          = 0;
                 node->uid          = 0;
                 node->mode         = S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP | S_IROTH | S_IWOTH;
@@ -1358,34 +1395,277 @@ static int new_node(struct RAMFS *hdl,
                 node->type         = type;
 
                 if (type == FILE_TYPE_DIR) {
-                        err = sys_llist_create(NULL, NULL, cast(llist_t**, &node->data));
+                        err = dir_create(&node->data.dir_t);
 
                 } else if (type == FILE_TYPE_PIPE) {
-                        err = sys_pipe_create(cast(pipe_t**, &node->data));
+                        err = sys_pipe_create(cast(pipe_t**, &node->data), 0);
                 }
 
                 if (!err) {
-                        if (sys_llist_push_back(parent->data.llist_t, node)) {
-                                if (item) {
-                                        *item = sys_llist_size(parent->data.llist_t) - 1;
-                                }
-
+                        err = dir_insert(parent->data.dir_t, node);
+                        if (!err) {
                                 *child = node;
 
                                 hdl->file_count++;
-                        } else {
-                                err = ENOMEM;
+
+                        } else if (type == FILE_TYPE_DIR) {
+                                dir_destroy(node->data.dir_t);
+
+                        } else if (type == FILE_TYPE_PIPE) {
+                                sys_pipe_destroy(node->data.pipe_t);
                         }
                 }
 
                 if (err) {
-                        sys_free(cast(void**, &node));
+                        sys_pool_free(&node_pool, cast(void**, &node));
                 }
         }
 
         return err;
 }
 
+//==============================================================================
+/**
+ * @brief Function free node object
+ *
+ * @param[in] node              node to free
+ */
+//==============================================================================
+static void node_free(void *node)
+{
+        sys_pool_free(&node_pool, &node);
+}
+
+//==============================================================================
+/**
+ * @brief Function calculate hash of file name (FNV-1a).
+ *
+ * @param[in] name              name (not necessary null terminated)
+ * @param[in] len               name length
+ *
+ * @return Hash value.
+ */
+//==============================================================================
+static u32_t name_hash(const char *name, size_t len)
+{
+        u32_t hash = 2166136261U;
+
+        while (len--) {
+                hash ^= cast(u8_t, *name++);
+                hash *= 16777619U;
+        }
+
+        return hash;
+}
+
+//==============================================================================
+/**
+ * @brief Function create empty directory object.
+ *        Entry table and buckets are allocated at first insert.
+ *
+ * @param[out] dir              created directory
+ *
+ * @return One of errno value (errno.h)
+ */
+//==============================================================================
+static int dir_create(dir_t **dir)
+{
+        return sys_zalloc(sizeof(dir_t), cast(void**, dir));
+}
+
+//==============================================================================
+/**
+ * @brief Function destroy directory object. Nodes are not freed.
+ *
+ * @param[in] dir               directory to destroy
+ */
+//==============================================================================
+static void dir_destroy(dir_t *dir)
+{
+        if (dir->entry) {
+                sys_free(cast(void**, &dir->entry));
+        }
+
+        if (dir->bucket) {
+                sys_free(cast(void**, &dir->bucket));
+        }
+
+        sys_free(cast(void**, &dir));
+}
+
+//==============================================================================
+/**
+ * @brief Function link node to hash bucket.
+ *
+ * @param[in] dir               directory
+ * @param[in] node              node to link
+ */
+//==============================================================================
+static void dir_hash_link(dir_t *dir, node_t *node)
+{
+        node_t **bucket = &dir->bucket[name_hash(node->name, strlen(node->name))
+                                       & (dir->buckets - 1)];
+        node->hnext = *bucket;
+        *bucket     = node;
+}
+
+//==============================================================================
+/**
+ * @brief Function unlink node from hash bucket. Must be called before node
+ *        name is changed.
+ *
+ * @param[in] dir               directory
+ * @param[in] node              node to unlink
+ */
+//==============================================================================
+static void dir_hash_unlink(dir_t *dir, node_t *node)
+{
+        node_t **n = &dir->bucket[name_hash(node->name, strlen(node->name))
+                                  & (dir->buckets - 1)];
+
+        while (*n) {
+                if (*n == node) {
+                        *n = node->hnext;
+                        node->hnext = NULL;
+                        break;
+                }
+
+                n = &(*n)->hnext;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Function rebuild hash buckets with new size.
+ *
+ * @param[in] dir               directory
+ * @param[in] buckets           new number of buckets (power of 2)
+ *
+ * @return One of errno value (errno.h)
+ */
+//==============================================================================
+static int dir_rehash(dir_t *dir, u32_t buckets)
+{
+        node_t **bucket;
+        int err = sys_zalloc(buckets * sizeof(node_t*), cast(void**, &bucket));
+        if (!err) {
+                if (dir->bucket) {
+                        sys_free(cast(void**, &dir->bucket));
+                }
+
+                dir->bucket  = bucket;
+                dir->buckets = buckets;
+
+                for (u32_t i = 0; i < dir->count; i++) {
+                        dir_hash_link(dir, dir->entry[i]);
+                }
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief Function insert node to directory. Node is appended at the end of
+ *        entry table.
+ *
+ * @param[in] dir               directory
+ * @param[in] node              node to insert
+ *
+ * @return One of errno value (errno.h)
+ */
+//==============================================================================
+static int dir_insert(dir_t *dir, node_t *node)
+{
+        int err = ESUCC;
+
+        if (dir->count >= dir->capacity) {
+                u32_t capacity = dir->capacity ? dir->capacity * 2 : DIR_INIT_SIZE;
+
+                node_t **entry;
+                err = sys_malloc(capacity * sizeof(node_t*), cast(void**, &entry));
+                if (!err) {
+                        if (dir->entry) {
+                                memcpy(entry, dir->entry, dir->count * sizeof(node_t*));
+                                sys_free(cast(void**, &dir->entry));
+                        }
+
+                        dir->entry    = entry;
+                        dir->capacity = capacity;
+                }
+        }
+
+        if (!err && dir->buckets == 0) {
+                err = dir_rehash(dir, DIR_INIT_SIZE);
+        }
+
+        if (!err) {
+                node->idx = dir->count;
+                dir->entry[dir->count++] = node;
+                dir_hash_link(dir, node);
+
+                /* growing failure is not critical, chains are longer only */
+                if (dir->count > dir->buckets * DIR_LOAD_FACTOR) {
+                        dir_rehash(dir, dir->buckets * 2);
+                }
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief Function remove node from directory (node is not freed). The last
+ *        entry is moved to the released slot, so removal does not scan or
+ *        shift the entry table. Must be called before node name is freed.
+ *
+ * @param[in] dir               directory
+ * @param[in] node              node to remove
+ */
+//==============================================================================
+static void dir_remove(dir_t *dir, node_t *node)
+{
+        u32_t i = node->idx;
+
+        if (i < dir->count && dir->entry[i] == node) {
+                dir_hash_unlink(dir, node);
+
+                dir->count--;
+                dir->entry[i]      = dir->entry[dir->count];
+                dir->entry[i]->idx = i;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Function find node by name in selected directory.
+ *
+ * @param[in] dir               directory
+ * @param[in] name              name (not necessary null terminated)
+ * @param[in] len               name length
+ *
+ * @return Found node or NULL.
+ */
+//==============================================================================
+static node_t *dir_find(dir_t *dir, const char *name, size_t len)
+{
+        if (dir->buckets == 0) {
+                return NULL;
+        }
+
+        node_t *node = dir->bucket[name_hash(name, len) & (dir->buckets - 1)];
+
+        while (node) {
+                if (strncmp(node->name, name, len) == 0 && node->name[len] == '\0') {
+                        break;
+                }
+
+                node = node->hnext;
+        }
+
+        return node;
+}
+
 //==============================================================================
 /**
  * @brief Function add node to list of open files
@@ -1436,21 +1716,70 @@ static int add_node_to_open_files_list(struct RAMFS *hdl,
 //==============================================================================
 static void clear_regular_file(node_t *node)
 {
-        data_chain_t *chain = node->data.data_chain_t;
+        file_data_t *data = node->data.file_data_t;
 
-        while (chain) {
-                data_chain_t *next = chain->next;
-                sys_free(cast(void**, &chain));
-                chain = next;
+        if (data) {
+                for (u32_t i = 0; i < data->chunks; i++) {
+                        if (data->chunk[i]) {
+                                sys_free(cast(void**, &data->chunk[i]));
+                        }
+                }
+
+                if (data->chunk) {
+                        sys_free(cast(void**, &data->chunk));
+                }
+
+                sys_free(cast(void**, &data));
         }
 
         node->size = 0;
-        node->data.data_chain_t = NULL;
+        node->data.file_data_t = NULL;
 }
 
 //==============================================================================
 /**
- * @brief Function write data to regular file.
+ * @brief Function grow chunk table of regular file. Table grows geometrically
+ *        so appending is amortized constant time. New entries are holes.
+ *
+ * @param node                  node to grow
+ * @param chunks                minimal number of chunks in table
+ *
+ * @retval One of errno value (errno.h)
+ */
+//==============================================================================
+static int grow_regular_file(node_t *node, u32_t chunks)
+{
+        int err = ESUCC;
+
+        if (node->data.file_data_t == NULL) {
+                err = sys_zalloc(sizeof(file_data_t), cast(void**, &node->data.file_data_t));
+        }
+
+        file_data_t *data = node->data.file_data_t;
+
+        if (!err && chunks > data->chunks) {
+                u32_t size = max(chunks, max(data->chunks * 2, DATA_INDEX_INIT_SIZE));
+
+                u8_t **chunk;
+                err = sys_zalloc(size * sizeof(u8_t*), cast(void**, &chunk));
+                if (!err) {
+                        if (data->chunk) {
+                                memcpy(chunk, data->chunk, data->chunks * sizeof(u8_t*));
+                                sys_free(cast(void**, &data->chunk));
+                        }
+
+                        data->chunk  = chunk;
+                        data->chunks = size;
+                }
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief Function write data to regular file. Only chunks that are written
+ *        are allocated, skipped regions stay as holes.
  *
  * @param node                  node to write
  * @param src                   source buffer
@@ -1464,60 +1793,44 @@ static void clear_regular_file(node_t *node)
 static int write_regular_file(node_t *node, const u8_t *src,
                               size_t count, fpos_t fpos, size_t *wrcnt)
 {
-        int           err   = ESUCC;
-        data_chain_t *chain = node->data.data_chain_t;
-        size_t        depth = fpos / DATA_CHAIN_SIZE;
-        size_t        seek  = fpos - (depth * DATA_CHAIN_SIZE);
-
-        if (chain == NULL) {
-                err = sys_zalloc(sizeof(data_chain_t), cast(void**, &chain));
-                if (!err) {
-                        node->data.data_chain_t = chain;
-                }
+        if (count == 0) {
+                return ESUCC;
         }
 
-        // travel to selected chain
-        while (!err && depth) {
-                if (chain->next == NULL) {
-                        err = sys_zalloc(sizeof(data_chain_t),
-                                         cast(void**, &chain->next));
-                }
+        u32_t  idx  = fpos / DATA_CHUNK_SIZE;
+        size_t seek = fpos - (cast(fpos_t, idx) * DATA_CHUNK_SIZE);
 
-                chain = chain->next;
-                depth--;
-        }
+        int err = grow_regular_file(node, (fpos + count + DATA_CHUNK_SIZE - 1) / DATA_CHUNK_SIZE);
 
-        // at position
         while (!err && count) {
-                size_t tocpy = min(DATA_CHAIN_SIZE - seek, count);
-                memcpy(&chain->buf[seek], src, tocpy);
+                u8_t **chunk = &node->data.file_data_t->chunk[idx];
+
+                if (*chunk == NULL) {
+                        err = sys_zalloc(DATA_CHUNK_SIZE, cast(void**, chunk));
+                        if (err) {
+                                break;
+                        }
+                }
+
+                size_t tocpy = min(DATA_CHUNK_SIZE - seek, count);
+                memcpy(&(*chunk)[seek], src, tocpy);
                 src    += tocpy;
                 fpos   += tocpy;
                 *wrcnt += tocpy;
                 count  -= tocpy;
                 seek    = 0;
-
-                if (count) {
-                        if (chain->next == NULL) {
-                                err = sys_zalloc(sizeof(data_chain_t),
-                                                 cast(void**, &chain->next));
-                        }
-
-                        chain = chain->next;
-                }
+                idx++;
         }
 
         // calculate file size
-        if (depth == 0) {
-                node->size = max(node->size, fpos);
-        }
+        node->size = max(node->size, fpos);
 
         return err;
 }
 
 //==============================================================================
 /**
- * @brief Function read data from regular file.
+ * @brief Function read data from regular file. Holes are read as zeros.
  *
  * @param node                  node to read
  * @param dst                   destination buffer
@@ -1533,24 +1846,26 @@ static int read_regular_file(node_t *node, u8_t *dst,
 {
         int err = ESUCC;
 
-        data_chain_t *chain = node->data.data_chain_t;
-        size_t        depth = fpos / DATA_CHAIN_SIZE;
-        size_t        seek  = fpos - (depth * DATA_CHAIN_SIZE);
+        file_data_t *data = node->data.file_data_t;
+        u32_t        idx  = fpos / DATA_CHUNK_SIZE;
+        size_t       seek = fpos - (cast(fpos_t, idx) * DATA_CHUNK_SIZE);
 
-        for (; chain && depth; chain = chain->next, depth--);
-
-        while (chain && count && fpos < node->size) {
-                size_t tocpy = min(DATA_CHAIN_SIZE - seek, count);
+        while (data && count && fpos < node->size && idx < data->chunks) {
+                size_t tocpy = min(DATA_CHUNK_SIZE - seek, count);
                        tocpy = min(tocpy, node->size - fpos);
 
-                memcpy(dst, &chain->buf[seek], tocpy);
+                if (data->chunk[idx]) {
+                        memcpy(dst, &data->chunk[idx][seek], tocpy);
+                } else {
+                        memset(dst, 0, tocpy);
+                }
+
                 dst    += tocpy;
                 fpos   += tocpy;
                 *rdcnt += tocpy;
                 count  -= tocpy;
                 seek    = 0;
-
-                chain = chain->next;
+                idx++;
         }
 
         return err;
@@ -38,12 +38,15 @@
 #include "kernel/kwrapper.h"
 #include "kernel/process.h"
 #include "mm/cache.h"
+#include "mm/pool.h"
 
 /*==============================================================================
   Local symbolic constants/macros
 ==============================================================================*/
 #undef errno
 #define PATH_MAX_LEN             256
+#define FILE_POOL_SIZE           8
+#define DIR_POOL_SIZE            2
 
 /*==============================================================================
   Local types, enums definitions
@@ -56,6 +59,19 @@ typedef struct FS_entry {
         u8_t                children_cnt;
 } FS_entry_t;
 
+/*
+ * Mount point tree. Each node is a path component; node with fs != NULL is
+ * a mount point. Path resolution walks components, so it costs O(depth)
+ * independently of number of mounted file systems.
+ */
+typedef struct mnt_node {
+        struct mnt_node    *child;              //!< first child component
+        struct mnt_node    *next;               //!< next sibling component
+        FS_entry_t         *fs;                 //!< mounted FS (NULL if not mount point)
+        size_t              len;                //!< component name length
+        char                name[];             //!< component name (not terminated)
+} mnt_node_t;
+
 /*==============================================================================
   Local function prototypes
 ==============================================================================*/
@@ -67,18 +83,25 @@ static bool         is_dir_valid            (DIR *dir);
 static int          increase_task_priority  (void);
 static inline void  restore_priority        (int priority);
 static int          parse_flags             (const char *str, u32_t *flags);
-static int          get_path_FS             (const char *path, size_t len, int *position, FS_entry_t **fs_entry);
+static int          get_path_FS             (const char *path, FS_entry_t **fs_entry);
 static int          get_path_base_FS        (const char *path, const char **extPath, FS_entry_t **fs_entry);
 static int          new_absolute_path       (const struct vfs_path *path, enum path_correction corr, char **new_path);
+static mnt_node_t  *mnt_tree_child         (mnt_node_t *node, const char *name, size_t len);
+static int          mnt_tree_insert         (const char *mount_point, FS_entry_t *fs);
+static bool         mnt_tree_remove         (mnt_node_t *node, const char *path);
 
 /*==============================================================================
   Local object definitions
 ==============================================================================*/
 static struct {
-        llist_t *mnt_list;
-        mutex_t *resource_mtx;
+        llist_t    *mnt_list;
+        mutex_t    *resource_mtx;
+        mnt_node_t  mnt_root;
 } VFS;
 
+static _mm_pool_t file_pool = _MM_POOL_INIT("FILE", _MM_KRN, sizeof(FILE), FILE_POOL_SIZE);
+static _mm_pool_t dir_pool  = _MM_POOL_INIT("DIR", _MM_KRN, sizeof(DIR), DIR_POOL_SIZE);
+
 /*==============================================================================
   Function definitions
 ==============================================================================*/
@@ -92,7 +115,7 @@ static struct {
 //==============================================================================
 int _vfs_init(void)
 {
-        int err = _llist_create_krn(_MM_KRN, NULL, NULL, &VFS.mnt_list);
+        int err = _llist_create_krn(_MM_KRN, _llist_functor_cmp_pointers, NULL, &VFS.mnt_list);
         if (!err) {
                 err = _mutex_create(MUTEX_TYPE_RECURSIVE, &VFS.resource_mtx);
         }
@@ -197,8 +220,7 @@ int _vfs_mount(const struct vfs_path   *src_path,
 
                         err = get_path_base_FS(cwd_mount_point, &ext_path, &base_fs);
                         if (!err) {
-                                err = get_path_FS(cwd_mount_point, PATH_MAX_LEN,
-                                                  NULL, &mounted_fs);
+                                err = get_path_FS(cwd_mount_point, &mounted_fs);
                         }
 
                         if (err == ENOENT) {
@@ -224,9 +246,17 @@ int _vfs_mount(const struct vfs_path   *src_path,
                  * mount FS if created
                  */
                 if (!err) {
-                        if (!_llist_push_back(VFS.mnt_list, new_fs)) {
+                        err = mnt_tree_insert(cwd_mount_point, new_fs);
+                        if (!err) {
+                                if (!_llist_push_back(VFS.mnt_list, new_fs)) {
+                                        mnt_tree_remove(&VFS.mnt_root, cwd_mount_point);
+                                        err = ENOMEM;
+                                }
+                        }
+
+                        if (err) {
+                                new_fs->mount_point = NULL;
                                 delete_FS_entry(new_fs);
-                                err = ENOMEM;
                         }
                 }
 
@@ -266,15 +296,26 @@ int _vfs_umount(const struct vfs_path *path)
                 err = _mutex_lock(VFS.resource_mtx, MAX_DELAY_MS);
                 if (not err) {
 
-                        int         position;
                         FS_entry_t *mount_fs;
-                        err = get_path_FS(cwd_path, PATH_MAX_LEN, &position, &mount_fs);
+                        err = get_path_FS(cwd_path, &mount_fs);
 
                         if (not err) {
                                 if (mount_fs->children_cnt == 0) {
-                                        err = delete_FS_entry(mount_fs);
-                                        if (not err) {
+                                        /* entry must leave the list before it is freed */
+                                        int position = _llist_find_begin(VFS.mnt_list, mount_fs);
+
+                                        if (position < 0) {
+                                                err = ENOENT;
+
+                                        } else {
                                                 _llist_take(VFS.mnt_list, position);
+
+                                                err = delete_FS_entry(mount_fs);
+                                                if (not err) {
+                                                        mnt_tree_remove(&VFS.mnt_root, cwd_path);
+                                                } else {
+                                                        _llist_insert(VFS.mnt_list, position, mount_fs);
+                                                }
                                         }
                                 } else {
                                         err = EBUSY;
@@ -462,7 +503,7 @@ int _vfs_opendir(const struct vfs_path *path, DIR **dir)
                 return EINVAL;
         }
 
-        int err = _kmalloc(_MM_KRN, sizeof(DIR), cast(void**, dir));
+        int err = _mm_pool_alloc(&dir_pool, cast(void**, dir));
         if (!err) {
                 char *cwd_path;
                 err = new_absolute_path(path, ADD_SLASH, &cwd_path);
@@ -487,7 +528,7 @@ int _vfs_opendir(const struct vfs_path *path, DIR **dir)
                 if (!err) {
                         (*dir)->header.type = RES_TYPE_DIR;
                 } else {
-                        _kfree(_MM_KRN, cast(void**, dir));
+                        _mm_pool_free(&dir_pool, cast(void**, dir));
                 }
         }
 
@@ -511,7 +552,7 @@ int _vfs_closedir(DIR *dir)
                 err = dir->FS_if->fs_closedir(dir->FS_hdl, dir);
                 if (!err) {
                         dir->header.type = RES_TYPE_UNKNOWN;
-                        _kfree(_MM_KRN, cast(void**, &dir));
+                        _mm_pool_free(&dir_pool, cast(void**, &dir));
                 }
         }
 
@@ -616,7 +657,7 @@ int _vfs_remove(const struct vfs_path *path)
                 err = _mutex_lock(VFS.resource_mtx, MAX_DELAY_MS);
                 if (!err) {
 
-                        err = get_path_FS(cwd_path, PATH_MAX_LEN, NULL, &mount_fs);
+                        err = get_path_FS(cwd_path, &mount_fs);
                         if (err == ENOENT) {
                                 // remove slash at the end
                                 LAST_CHARACTER(cwd_path) = '\0';
@@ -903,7 +944,7 @@ int _vfs_fopen(const struct vfs_path *path, const char *mode, FILE **file)
         }
 
         FILE *file_obj = NULL;
-        err = _kzalloc(_MM_KRN, sizeof(FILE), cast(void**, &file_obj));
+        err = _mm_pool_zalloc(&file_pool, cast(void**, &file_obj));
         if (!err && file_obj) {
 
                 const char *external_path;
@@ -938,6 +979,8 @@ int _vfs_fopen(const struct vfs_path *path, const char *mode, FILE **file)
                                         file_obj->f_lseek = stat.st_size;
                                 }
 
+                                f_flags.bufreq = (stat.st_type == FILE_TYPE_REGULAR);
+
                                 file_obj->FS_hdl      = fs->handle;
                                 file_obj->FS_if       = fs->interface;
                                 file_obj->f_flag      = f_flags;
@@ -956,7 +999,7 @@ int _vfs_fopen(const struct vfs_path *path, const char *mode, FILE **file)
                 if (file_obj->header.type == RES_TYPE_FILE) {
                         *file = file_obj;
                 } else {
-                        _kfree(_MM_KRN, cast(void**, &file_obj));
+                        _mm_pool_free(&file_pool, cast(void**, &file_obj));
                 }
         }
 
@@ -983,7 +1026,7 @@ int _vfs_fclose(FILE *file, bool force)
                         file->header.type = RES_TYPE_UNKNOWN;
                         file->FS_hdl      = NULL;
                         file->FS_hdl      = NULL;
-                        _kfree(_MM_KRN, cast(void**, &file));
+                        _mm_pool_free(&file_pool, cast(void**, &file));
                 }
         }
 
@@ -1534,40 +1577,151 @@ static int parse_flags(const char *str, u32_t *flags)
 
 //==============================================================================
 /**
- * @brief Function return file system entry of selected path
+ * @brief Function find child component of selected mount tree node.
  *
- * @param[in]  path             path to FS
- * @param[in]  len              path length
- * @param[out] position         object position in list (can be NULL)
- * @param[out] fs_entry         found entry
+ * @param[in]  node             parent node
+ * @param[in]  name             component name (not terminated)
+ * @param[in]  len              component name length
+ *
+ * @return Found node or NULL.
+ */
+//==============================================================================
+static mnt_node_t *mnt_tree_child(mnt_node_t *node, const char *name, size_t len)
+{
+        for (mnt_node_t *child = node->child; child; child = child->next) {
+                if (child->len == len && strncmp(child->name, name, len) == 0) {
+                        return child;
+                }
+        }
+
+        return NULL;
+}
+
+//==============================================================================
+/**
+ * @brief Function add mount point to mount tree. Missing path components are
+ *        created.
+ *
+ * @param[in]  mount_point      mount point path (absolute, ended by slash)
+ * @param[in]  fs               file system entry
  *
  * @return One of errno value (errno.h)
  */
 //==============================================================================
-static int get_path_FS(const char *path, size_t len, int *position, FS_entry_t **fs_entry)
+static int mnt_tree_insert(const char *mount_point, FS_entry_t *fs)
 {
-        int pos = 0;
+        mnt_node_t *node = &VFS.mnt_root;
+        const char *name = mount_point + 1;
+        const char *end;
 
-        _llist_foreach(FS_entry_t*, entry, VFS.mnt_list) {
-                if (strncmp(path, entry->mount_point, len) == 0) {
-                        if (position) {
-                                *position = pos;
+        while ((end = strchr(name, '/'))) {
+                size_t      len   = end - name;
+                mnt_node_t *child = mnt_tree_child(node, name, len);
+
+                if (!child) {
+                        int err = _kzalloc(_MM_KRN, sizeof(mnt_node_t) + len,
+                                           cast(void**, &child));
+                        if (err) {
+                                mnt_tree_remove(&VFS.mnt_root, mount_point);
+                                return err;
                         }
 
-                        *fs_entry = entry;
-                        return ESUCC;
+                        memcpy(child->name, name, len);
+                        child->len  = len;
+                        child->next = node->child;
+                        node->child = child;
+                }
+
+                node = child;
+                name = end + 1;
+        }
+
+        node->fs = fs;
+
+        return ESUCC;
+}
+
+//==============================================================================
+/**
+ * @brief Function remove mount point from mount tree. Components that are not
+ *        used by any other mount point are freed.
+ *
+ * @param[in]  node             start node
+ * @param[in]  path             mount point path relative to node (begins with slash)
+ *
+ * @return True if node is not used anymore and can be freed by parent.
+ */
+//==============================================================================
+static bool mnt_tree_remove(mnt_node_t *node, const char *path)
+{
+        const char *name = path + 1;
+        const char *end  = strchr(name, '/');
+
+        if (end) {
+                mnt_node_t **child = &node->child;
+
+                while (*child) {
+                        if (  (*child)->len == cast(size_t, end - name)
+                           && strncmp((*child)->name, name, end - name) == 0) {
+
+                                if (mnt_tree_remove(*child, end)) {
+                                        mnt_node_t *unused = *child;
+                                        *child = unused->next;
+                                        _kfree(_MM_KRN, cast(void**, &unused));
+                                }
+
+                                break;
+                        }
+
+                        child = &(*child)->next;
                 }
+        } else {
+                node->fs = NULL;
+        }
+
+        return node != &VFS.mnt_root && node->fs == NULL && node->child == NULL;
+}
 
-                pos++;
+//==============================================================================
+/**
+ * @brief Function return file system entry mounted exactly at selected path.
+ *
+ * @param[in]  path             path to FS (ended by slash)
+ * @param[out] fs_entry         found entry
+ *
+ * @return One of errno value (errno.h)
+ */
+//==============================================================================
+static int get_path_FS(const char *path, FS_entry_t **fs_entry)
+{
+        int err = _mutex_lock(VFS.resource_mtx, MAX_DELAY_MS);
+        if (!err) {
+                mnt_node_t *node = &VFS.mnt_root;
+                const char *name = path + 1;
+                const char *end;
+
+                while (node && (end = strchr(name, '/'))) {
+                        node = mnt_tree_child(node, name, end - name);
+                        name = end + 1;
+                }
+
+                if (node && node->fs && *name == '\0') {
+                        *fs_entry = node->fs;
+                } else {
+                        err = ENOENT;
+                }
+
+                _mutex_unlock(VFS.resource_mtx);
         }
 
-        return ENOENT;
+        return err;
 }
 
 //==============================================================================
 /**
  * @brief Function returned the base file system of selected path. The external
- *        path is passed by pointer ext_path.
+ *        path is passed by pointer ext_path. The deepest mount point that
+ *        is a directory prefix of path is selected.
  *        Function is thread safe.
  *
  * @param[in]  path           path to FS
@@ -1579,29 +1733,43 @@ static int get_path_FS(const char *path, size_t len, int *position, FS_entry_t *
 //==============================================================================
 static int get_path_base_FS(const char *path, const char **ext_path, FS_entry_t **fs_entry)
 {
-        const char *path_tail = path + strlen(path);
-
-        if (*(path_tail - 1) == '/') {
-                path_tail--;
+        if (path[0] != '/') {
+                return ENOENT;
         }
 
         int err = _mutex_lock(VFS.resource_mtx, MAX_DELAY_MS);
         if (!err) {
-
-                while (path_tail >= path) {
-                        err = get_path_FS(path, path_tail - path + 1, NULL, fs_entry);
-                        if (!err) {
+                mnt_node_t *node = &VFS.mnt_root;
+                FS_entry_t *fs   = node->fs;
+                const char *tail = path;
+                const char *name = path + 1;
+                const char *end;
+
+                while ((end = strchr(name, '/'))) {
+                        node = mnt_tree_child(node, name, end - name);
+                        if (!node) {
                                 break;
-                        } else {
-                                while (*(--path_tail) != '/' && path_tail >= path);
                         }
+
+                        if (node->fs) {
+                                fs   = node->fs;
+                                tail = end;
+                        }
+
+                        name = end + 1;
                 }
 
                 _mutex_unlock(VFS.resource_mtx);
-        }
 
-        if (!err && ext_path) {
-                *ext_path = path_tail;
+                if (fs) {
+                        *fs_entry = fs;
+
+                        if (ext_path) {
+                                *ext_path = tail;
+                        }
+                } else {
+                        err = ENOENT;
+                }
         }
 
         return err;
@@ -77,6 +77,22 @@ inline void  operator delete[](void* ptr  ) {_sysfree(&ptr);}
 #endif
 #endif /* DOXYGEN */
 
+/**
+ * @brief Macro initializes object pool of file system.
+ *
+ * The slab of pool is allocated at first use. If pool is exhausted then
+ * objects are allocated from the file system heap.
+ *
+ * @note Macro can be used only by file system code.
+ *
+ * @param name          pool name
+ * @param objsize       object size
+ * @param count         number of objects in pool
+ *
+ * @see sys_pool_alloc(), sys_pool_zalloc(), sys_pool_free()
+ */
+#define SYS_MEM_POOL_INIT(name, objsize, count) _MM_POOL_INIT(name, _MM_FS, objsize, count)
+
 /**
  * File system types.
  * @see struct statfs
@@ -822,13 +838,14 @@ static inline int sys_driver_stat(dev_t id, struct vfs_dev_stat *stat)
  * @note Function can be used only by file system code.
  *
  * @param pipe     pointer to pointer of pipe handle
+ * @param capacity pipe buffer size (0 for default size, __OS_PIPE_LENGTH__)
  *
  * @return One of @ref errno value.
  */
 //==============================================================================
-static inline int sys_pipe_create(pipe_t **pipe)
+static inline int sys_pipe_create(pipe_t **pipe, size_t capacity)
 {
-        return _pipe_create(pipe);
+        return _pipe_create(pipe, capacity);
 }
 
 //==============================================================================
@@ -864,6 +881,41 @@ static inline int sys_pipe_get_length(pipe_t *pipe, size_t *len)
         return _pipe_get_length(pipe, len);
 }
 
+//==============================================================================
+/**
+ * @brief Return capacity of pipe
+ *
+ * @note Function can be used only by file system code.
+ *
+ * @param pipe          a pipe object
+ * @param capacity      a pipe capacity
+ *
+ * @return One of @ref errno value.
+ */
+//==============================================================================
+static inline int sys_pipe_get_capacity(pipe_t *pipe, size_t *capacity)
+{
+        return _pipe_get_capacity(pipe, capacity);
+}
+
+//==============================================================================
+/**
+ * @brief Change capacity of pipe. Capacity can be changed only if pipe is
+ *        empty.
+ *
+ * @note Function can be used only by file system code.
+ *
+ * @param pipe          a pipe object
+ * @param capacity      a new pipe capacity
+ *
+ * @return One of @ref errno value.
+ */
+//==============================================================================
+static inline int sys_pipe_set_capacity(pipe_t *pipe, size_t capacity)
+{
+        return _pipe_set_capacity(pipe, capacity);
+}
+
 //==============================================================================
 /**
  * @brief Read data from pipe
@@ -55,13 +55,15 @@ typedef struct pipe pipe_t;
 /*==============================================================================
   Exported functions
 ==============================================================================*/
-extern int  _pipe_create    (pipe_t**);
-extern int  _pipe_destroy   (pipe_t*);
-extern int  _pipe_get_length(pipe_t*, size_t*);
-extern int  _pipe_read      (pipe_t*, u8_t*, size_t, size_t*, bool);
-extern int  _pipe_write     (pipe_t*, const u8_t*, size_t, size_t*, bool);
-extern int  _pipe_close     (pipe_t*);
-extern int  _pipe_clear     (pipe_t*);
+extern int  _pipe_create      (pipe_t**, size_t);
+extern int  _pipe_destroy     (pipe_t*);
+extern int  _pipe_get_length  (pipe_t*, size_t*);
+extern int  _pipe_get_capacity(pipe_t*, size_t*);
+extern int  _pipe_set_capacity(pipe_t*, size_t);
+extern int  _pipe_read        (pipe_t*, u8_t*, size_t, size_t*, bool);
+extern int  _pipe_write       (pipe_t*, const u8_t*, size_t, size_t*, bool);
+extern int  _pipe_close       (pipe_t*);
+extern int  _pipe_clear       (pipe_t*);
 
 /*==============================================================================
   Exported inline functions
@@ -116,6 +116,8 @@ extern "C" {
 /* IO operations on files */
 #define IOCTL_PIPE__CLOSE                       _IO(PIPE, 0x00)
 #define IOCTL_PIPE__CLEAR                       _IO(PIPE, 0x01)
+#define IOCTL_PIPE__SET_CAPACITY                _IOW(PIPE, 0x02, const size_t*)
+#define IOCTL_PIPE__GET_CAPACITY                _IOR(PIPE, 0x03, size_t*)
 #define IOCTL_VFS__NON_BLOCKING_RD_MODE         _IO(VFS,  0x00)
 #define IOCTL_VFS__DEFAULT_RD_MODE              _IO(VFS,  0x01)
 #define IOCTL_VFS__IS_NON_BLOCKING_RD_MODE      _IO(VFS,  0x02)
@@ -196,6 +198,7 @@ typedef struct vfs_file_flags {
         bool                eof    :1;          //! end of file
         bool                error  :1;          //! error occurred
         bool                seekmod:1;          //! file position modified
+        bool                bufreq :1;          //! stream is buffered by default (libc stdio)
         struct vfs_fattr    fattr;
 } vfs_file_flags_t;
 
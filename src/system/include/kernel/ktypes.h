@@ -65,9 +65,15 @@ typedef enum {
         RES_TYPE_FLAG          = 0x18FAEC0D
 } res_type_t;
 
-/** KERNELSPACE: object header (must be the first in object) */
+/**
+ * KERNELSPACE: object header (must be the first in object, type must be the last field).
+ * The header precedes each program memory block too: 4 words (16 bytes on
+ * 32-bit CPU) per allocation, prev and owner allow O(1) release.
+ */
 typedef struct res_header {
         struct res_header *next;
+        struct res_header *prev;        //!< previous resource (O(1) release)
+        void              *owner;       //!< process which registered resource
         res_type_t         type;
 } res_header_t;
 
@@ -45,6 +45,15 @@ extern "C" {
 /*==============================================================================
   Exported object types
 ==============================================================================*/
+/**
+ * System log statistics.
+ */
+typedef struct {
+        u32_t logged;           //!< number of logged messages
+        u32_t dropped;          //!< number of messages lost (overwritten or collision)
+        u32_t truncated;        //!< number of messages with truncated arguments
+        u32_t pending;          //!< number of messages waiting for read
+} printk_stat_t;
 
 /*==============================================================================
   Exported objects
@@ -57,10 +66,12 @@ extern "C" {
 size_t _printk_read(char *str, size_t len, u32_t *timestamp_ms);
 void   _printk_clear(void);
 void   _printk(const char*, ...);
+int    _printk_get_stat(printk_stat_t *stat);
 #else
 #define _printk(...)
 #define _printk_read(str, len, timestamp_ms)
 #define _printk_clear()
+#define _printk_get_stat(stat) ENOTSUP
 #endif
 
 /*==============================================================================
@@ -185,6 +185,10 @@ extern const char *_process_get_CWD                     (_process_t*);
 extern int         _process_set_CWD                     (_process_t*, const char*);
 extern int         _process_register_resource           (_process_t*, res_header_t*);
 extern int         _process_release_resource            (_process_t*, res_header_t*, res_type_t);
+extern void       *_process_get_arena                   (_process_t*);
+extern int         _process_set_arena                   (_process_t*, void*);
+extern void       *_process_get_stdio                   (_process_t*);
+extern int         _process_set_stdio                   (_process_t*, void*);
 extern FILE       *_process_get_stderr                  (_process_t*);
 extern const char *_process_get_name                    (_process_t*);
 extern size_t      _process_get_count                   (void);
@@ -205,6 +209,8 @@ extern void        _task_switched_out                   (task_t *task, void *tas
 extern void        _calculate_CPU_load                  (void);
 extern int         _get_average_CPU_load                (avg_CPU_load_t*);
 extern void        _task_get_process_container          (task_t*, _process_t**, tid_t*);
+extern void        _process_syscall_lock                (_process_t*);
+extern void        _process_syscall_unlock              (_process_t*);
 
 /*==============================================================================
   Exported inline functions
@@ -41,6 +41,7 @@ extern "C" {
 /*==============================================================================
   Exported macros
 ==============================================================================*/
+#define _SYSCALL_STAT_BUCKETS           8
 
 /*==============================================================================
   Exported object types
@@ -51,12 +52,6 @@ typedef enum {// NAME                      | RETURN TYPE    | ARG 1
         SYSCALL_MALLOC,                 // | void*          | size_t *size              |                                     |                           |                           |                                           |
         SYSCALL_ZALLOC,                 // | void*          | size_t *size              |                                     |                           |                           |                                           |
         SYSCALL_FREE,                   // | void           | void *mem                 |                                     |                           |                           |                                           |
-    #if __OS_ENABLE_SHARED_MEMORY__ == _YES_
-        SYSCALL_SHMCREATE,              // | int            | const char *key           | size_t *size                        |                           |                           |                                           |
-        SYSCALL_SHMATTACH,              // | int            | const char *key           | void **mem                          | size_t *size              |                           |                                           |
-        SYSCALL_SHMDETACH,              // | int            | const char *key           |                                     |                           |                           |                                           |
-        SYSCALL_SHMDESTROY,             // | int            | const char *key           |                                     |                           |                           |                                           |
-    #endif
         SYSCALL_PROCESSGETSYNCFLAG,     // | int            | pid_t *pid                | flag_t **obj                        |                           |                           |                                           |
         SYSCALL_PROCESSSTATSEEK,        // | int            | size_t *seek              | process_stat_t *stat                |                           |                           |                                           |
         SYSCALL_PROCESSSTATPID,         // | int            | pid_t *pid                | process_stat_t *stat                |                           |                           |                                           |
@@ -64,19 +59,31 @@ typedef enum {// NAME                      | RETURN TYPE    | ARG 1
         SYSCALL_PROCESSGETPRIO,         // | int            | pid_t *pid                |                                     |                           |                           |                                           |
     #if __OS_ENABLE_GETCWD__ == _YES_
         SYSCALL_GETCWD,                 // | char*          | char *buf                 | size_t *size                        |                           |                           |                                           |
-        SYSCALL_SETCWD,                 // | int            | const char *cwd           |                                     |                           |                           |                                           |
     #endif
-    #if ((__OS_SYSTEM_MSG_ENABLE__ > 0) && (__OS_PRINTF_ENABLE__ > 0))
-        SYSCALL_SYSLOGREAD,             // | size_t         | char *str                 | size_t *len                         | u32_t *timestamp          |                           |                                           |
+    #if __OS_ENABLE_TIMEMAN__ == _YES_
+        SYSCALL_GETTIME,                // | time_t         |                           |                                     |                           |                           |                                           |
     #endif
-        SYSCALL_THREADCREATE,           // | tid_t          | thread_func_t             | thread_attr_t *attr                 | void *arg                 |                           |                                           |
         SYSCALL_SEMAPHORECREATE,        // | sem_t*         | const size_t *cnt_max     | const size_t *cnt_init              |                           |                           |                                           |
         SYSCALL_SEMAPHOREDESTROY,       // | void           | sem_t *semaphore          |                                     |                           |                           |                                           |
         SYSCALL_MUTEXCREATE,            // | mutex_t*       | const enum mutex_type *tp |                                     |                           |                           |                                           |
         SYSCALL_MUTEXDESTROY,           // | void           | mutex_t *mutex            |                                     |                           |                           |                                           |
         SYSCALL_QUEUECREATE,            // | queue_t*       | const size_t *length      | const size_t *item_size             |                           |                           |                                           |
         SYSCALL_QUEUEDESTROY,           // | void           | queue_t *queue            |                                     |                           |                           |                                           |
-#define _SYSCALL_GROUP_0_OS_NON_BLOCKING  SYSCALL_QUEUEDESTROY // this group ends at ^this^ syscall --------------------------+---------------------------+---------------------------+-------------------------------------------+
+#define _SYSCALL_GROUP_DIRECT             SYSCALL_QUEUEDESTROY // direct group ends at ^this^ syscall ------------------------+---------------------------+---------------------------+-------------------------------------------+
+    #if __OS_ENABLE_SHARED_MEMORY__ == _YES_
+        SYSCALL_SHMCREATE,              // | int            | const char *key           | size_t *size                        |                           |                           |                                           |
+        SYSCALL_SHMATTACH,              // | int            | const char *key           | void **mem                          | size_t *size              |                           |                                           |
+        SYSCALL_SHMDETACH,              // | int            | const char *key           |                                     |                           |                           |                                           |
+        SYSCALL_SHMDESTROY,             // | int            | const char *key           |                                     |                           |                           |                                           |
+    #endif
+    #if __OS_ENABLE_GETCWD__ == _YES_
+        SYSCALL_SETCWD,                 // | int            | const char *cwd           |                                     |                           |                           |                                           |
+    #endif
+    #if ((__OS_SYSTEM_MSG_ENABLE__ > 0) && (__OS_PRINTF_ENABLE__ > 0))
+        SYSCALL_SYSLOGREAD,             // | size_t         | char *str                 | size_t *len                         | u32_t *timestamp          |                           |                                           |
+    #endif
+        SYSCALL_THREADCREATE,           // | tid_t          | thread_func_t             | thread_attr_t *attr                 | void *arg                 |                           |                                           |
+#define _SYSCALL_GROUP_0_OS_NON_BLOCKING  SYSCALL_THREADCREATE // this group ends at ^this^ syscall --------------------------+---------------------------+---------------------------+-------------------------------------------+
         SYSCALL_THREADKILL,             // | int            | tid_t *tid                |                                     |                           |                           |                                           |
         SYSCALL_PROCESSCREATE,          // | pid_t          | const char *command       | process_attr_t *attr                |                           |                           |                                           |
         SYSCALL_PROCESSCLEANZOMBIE,     // | int            | pid_t *pid                | int *status                         |                           |                           |                                           |
@@ -128,7 +135,6 @@ typedef enum {// NAME                      | RETURN TYPE    | ARG 1
         SYSCALL_FFLUSH,                 // | int            | FILE *file                |                                     |                           |                           |                                           |
         SYSCALL_SYNC,                   // | void           |                           |                                     |                           |                           |                                           |
     #if __OS_ENABLE_TIMEMAN__ == _YES_
-        SYSCALL_GETTIME,                // | time_t         |                           |                                     |                           |                           |                                           |
         SYSCALL_SETTIME,                // | int            | time_t *time              |                                     |                           |                           |                                           |
     #endif
         SYSCALL_DRIVERINIT,             // | dev_t          | const char *mod_name      | int *major                          | int *minor                | const char *node_path     |                                           |
@@ -159,6 +165,39 @@ typedef enum {// NAME                      | RETURN TYPE    | ARG 1
         _SYSCALL_COUNT
 } syscall_t;
 
+/**
+ * Syscall latency statistics. Latency is measured from syscall entry to
+ * return in microseconds. Bucket n counts calls with latency lower than
+ * 4^(n+1) us, the last bucket counts all longer calls.
+ */
+typedef struct {
+        u32_t count;                                    /**< number of calls            */
+        u32_t direct;                                   /**< calls executed directly    */
+        u32_t time_max;                                 /**< max latency [us]           */
+        u32_t histogram[_SYSCALL_STAT_BUCKETS];         /**< latency histogram          */
+} _syscall_stat_t;
+
+/**
+ * kworker I/O thread pool statistics.
+ */
+typedef struct {
+        size_t threads;                                 /**< number of I/O threads      */
+        size_t idle;                                    /**< number of idle I/O threads */
+        size_t queue_depth;                             /**< requests in I/O queue      */
+        size_t queue_depth_max;                         /**< max requests in I/O queue  */
+        u32_t  created;                                 /**< number of created threads  */
+} _syscall_kworker_stat_t;
+
+/**
+ * kworker thread statistics (thread 0 is the kworker main thread).
+ */
+typedef struct {
+        u32_t requests;                                 /**< realized requests          */
+        u32_t busy_time;                                /**< request handling time [ms] */
+        u32_t max_wait;                                 /**< max request wait time [us] */
+        bool  active;                                   /**< thread is running          */
+} _syscall_kworker_thread_stat_t;
+
 /*==============================================================================
   Exported objects
 ==============================================================================*/
@@ -171,6 +210,11 @@ extern pid_t _syscall_client_PID[__OS_TASK_MAX_SYSTEM_THREADS__];
 extern void syscall(syscall_t syscall, void *retptr, ...);
 extern int  _syscall_init();
 extern int  _syscall_kworker_process(int, char**);
+extern int  _syscall_get_kworker_stat(_syscall_kworker_stat_t*);
+extern int  _syscall_get_kworker_thread_stat(tid_t, _syscall_kworker_thread_stat_t*);
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+extern int  _syscall_get_stat(syscall_t, _syscall_stat_t*);
+#endif
 
 /*==============================================================================
   Exported inline functions
@@ -60,6 +60,7 @@
 #include "kernel/process.h"
 #include "kernel/syscall.h"
 #include "mm/cache.h"
+#include "mm/pool.h"
 #include "fs/vfs.h"
 #include "drivers/drvctrl.h"
 #include "portable/cpuctl.h"
@@ -206,6 +207,43 @@ extern "C" {
         _llist_foreach_reverse(type, element, _sys_llist_t__list)
 #endif
 
+/**
+ * @brief BTree's range @b foreach loop.
+ *
+ * Macro creates loop over objects of BTree that are in range [from, to].
+ * Objects are iterated in ascending order.
+ *
+ * @note Macro can be used only by file system or driver code.
+ *
+ * @param type                  object type
+ * @param element               element name of type @b type
+ * @param btree                 [<b>btree_t</b>] BTree object
+ * @param from                  pointer to range begin object (inclusive)
+ * @param to                    pointer to range end object (inclusive)
+ *
+ * @b Example
+ * @code
+        // ...
+
+        bt_obj_t from = {.value = 10};
+        bt_obj_t to   = {.value = 20};
+
+        sys_btree_foreach_range(bt_obj_t, obj, bt, &from, &to) {
+                printk("Value: %d\n", obj.value);
+        }
+
+        // ...
+   @endcode
+ *
+ * @see sys_btree_lower_bound(), sys_btree_upper_bound()
+ */
+#ifdef DOXYGEN
+#define sys_btree_foreach_range(type, element, btree, from, to)
+#else
+#define sys_btree_foreach_range(type, element, _sys_btree_t__btree, from, to)\
+        _btree_foreach_range(type, element, _sys_btree_t__btree, from, to)
+#endif
+
 /*==============================================================================
   Exported object types
 ==============================================================================*/
@@ -223,6 +261,51 @@ typedef struct {} llist_t;
  */
 typedef _mm_region_t mem_region_t;
 
+/**
+ * @brief Memory region attributes.
+ * @see sys_memory_register()
+ */
+enum mem_region_attr {
+        MEM_REGION_ATTR_FAST  = _MM_REGION_ATTR_FAST,   //!< fast memory (internal SRAM, CCM, TCM)
+        MEM_REGION_ATTR_DMA   = _MM_REGION_ATTR_DMA,    //!< memory accessible by DMA
+        MEM_REGION_ATTR_LARGE = _MM_REGION_ATTR_LARGE,  //!< large region preferred for bulk allocations
+};
+
+/**
+ * @brief Memory region statistics type.
+ */
+typedef _mm_region_stat_t mem_region_stat_t;
+
+/**
+ * @brief Cache statistics type.
+ */
+typedef _cache_stat_t cache_stat_t;
+
+/**
+ * @brief Heap statistics type.
+ */
+typedef _heap_stat_t heap_stat_t;
+
+/**
+ * @brief Fixed-size object pool type.
+ */
+typedef _mm_pool_t mem_pool_t;
+
+/**
+ * @brief Syscall latency statistics type.
+ */
+typedef _syscall_stat_t syscall_stat_t;
+
+/**
+ * @brief kworker I/O thread pool statistics type.
+ */
+typedef _syscall_kworker_stat_t kworker_stat_t;
+
+/**
+ * @brief kworker thread statistics type.
+ */
+typedef _syscall_kworker_thread_stat_t kworker_thread_stat_t;
+
 /*==============================================================================
   Exported objects
 ==============================================================================*/
@@ -1982,6 +2065,76 @@ static inline int sys_btree_remove(btree_t *tree, void *data)
         return _btree_remove(tree, data);
 }
 
+//==============================================================================
+/**
+ * @brief  Function return first object that is not less than key.
+ *
+ * @note Function can be used only by file system or driver code.
+ *
+ * @param  tree         BTree object
+ * @param  key          key to find (does not have to exist in tree)
+ * @param  ret          found object
+ *
+ * @return One of errno value.
+ *
+ * @b Example
+ * @code
+        // ...
+
+        bt_obj_t key = {.value = 4};
+        bt_obj_t obj;
+
+        err = sys_btree_lower_bound(bt, &key, &obj);
+        if (!err) {
+                // obj is first object with value >= 4
+        }
+
+        // ...
+   @endcode
+ *
+ * @see sys_btree_upper_bound(), sys_btree_foreach_range()
+ */
+//==============================================================================
+static inline int sys_btree_lower_bound(btree_t *tree, void *key, void *ret)
+{
+        return _btree_lower_bound(tree, key, ret);
+}
+
+//==============================================================================
+/**
+ * @brief  Function return first object that is greater than key.
+ *
+ * @note Function can be used only by file system or driver code.
+ *
+ * @param  tree         BTree object
+ * @param  key          key to find (does not have to exist in tree)
+ * @param  ret          found object
+ *
+ * @return One of errno value.
+ *
+ * @b Example
+ * @code
+        // ...
+
+        bt_obj_t key = {.value = 4};
+        bt_obj_t obj;
+
+        err = sys_btree_upper_bound(bt, &key, &obj);
+        if (!err) {
+                // obj is first object with value > 4
+        }
+
+        // ...
+   @endcode
+ *
+ * @see sys_btree_lower_bound(), sys_btree_foreach_range()
+ */
+//==============================================================================
+static inline int sys_btree_upper_bound(btree_t *tree, void *key, void *ret)
+{
+        return _btree_upper_bound(tree, key, ret);
+}
+
 //==============================================================================
 /**
  * @brief  Function destroy BTree.
@@ -3245,6 +3398,10 @@ static inline void sys_sync()
  *
  * @note Function can be used only by file system or driver code.
  *
+ * @note Message is formatted when system log is read. Format string is stored
+ *       by reference (must be a constant string), string arguments are copied.
+ *       Function can be used in interrupts.
+ *
  * @param format        formatting string
  * @param ...           argument sequence
  *
@@ -5015,6 +5172,86 @@ static inline size_t sys_get_mem_size()
         return _mm_get_mem_size();
 }
 
+//==============================================================================
+/**
+ * @brief  Function return heap statistics of all memory regions: used and
+ *         free memory, number of free blocks and the largest free block
+ *         that can be used to estimate fragmentation.
+ *
+ * @note Function can be used only by file system or driver code.
+ *
+ * @param  stat         statistics (result)
+ *
+ * @return One of errno value.
+ *
+ * @see sys_get_free_mem(), sys_get_used_mem()
+ */
+//==============================================================================
+static inline int sys_get_heap_stat(heap_stat_t *stat)
+{
+        return _mm_get_heap_stat(stat);
+}
+
+//==============================================================================
+/**
+ * @brief  Function allocate object from selected pool. Allocation takes
+ *         constant time. If pool is exhausted then object is allocated
+ *         from the heap.
+ *
+ * @note Function can be used only by file system code.
+ *
+ * @param  pool         pool (initialized by SYS_MEM_POOL_INIT())
+ * @param  obj          pointer to object pointer
+ *
+ * @return One of errno value.
+ *
+ * @see sys_pool_free()
+ */
+//==============================================================================
+static inline int sys_pool_alloc(mem_pool_t *pool, void **obj)
+{
+        return _mm_pool_alloc(pool, obj);
+}
+
+//==============================================================================
+/**
+ * @brief  Function allocate object from selected pool and clear it.
+ *
+ * @note Function can be used only by file system code.
+ *
+ * @param  pool         pool (initialized by SYS_MEM_POOL_INIT())
+ * @param  obj          pointer to object pointer
+ *
+ * @return One of errno value.
+ *
+ * @see sys_pool_free()
+ */
+//==============================================================================
+static inline int sys_pool_zalloc(mem_pool_t *pool, void **obj)
+{
+        return _mm_pool_zalloc(pool, obj);
+}
+
+//==============================================================================
+/**
+ * @brief  Function free object allocated from selected pool. Object pointer
+ *         is set to NULL.
+ *
+ * @note Function can be used only by file system code.
+ *
+ * @param  pool         pool
+ * @param  obj          pointer to object pointer
+ *
+ * @return One of errno value.
+ *
+ * @see sys_pool_alloc(), sys_pool_zalloc()
+ */
+//==============================================================================
+static inline int sys_pool_free(mem_pool_t *pool, void **obj)
+{
+        return _mm_pool_free(pool, obj);
+}
+
 //==============================================================================
 /**
  * @brief Function return OS time in milliseconds.
@@ -5748,17 +5985,55 @@ extern int sys_cache_write(FILE *file, u32_t blkpos, size_t blksz, size_t blkcnt
 //==============================================================================
 extern int sys_cache_read(FILE *file, u32_t blkpos, size_t blksz, size_t blkcnt, u8_t *buf);
 
+//==============================================================================
+/**
+ * @brief  Function enable or disable read-ahead of selected device file.
+ *         When read-ahead is enabled then sequential reads of device are
+ *         detected and next blocks are read to the cache in background.
+ *         Window of read-ahead is adaptive and limited by free memory.
+ *
+ * @note Function can be used only by file system code.
+ *
+ * @param  file         device file
+ * @param  max_blocks   maximum read-ahead window [blocks] (0 to disable)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+extern int sys_cache_readahead(FILE *file, size_t max_blocks);
+
+//==============================================================================
+/**
+ * @brief  Function return statistics of file system cache (hits, misses,
+ *         evictions, number of cached and dirty blocks). If cache is disabled
+ *         then all values are zeroed.
+ *
+ * @param  stat         statistics (result)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static inline int sys_cache_get_stat(cache_stat_t *stat)
+{
+        return _cache_get_stat(stat);
+}
+
 //==============================================================================
 /**
  * @brief  Function register new memory region. The region object should be
  *         visible during entire system runtime. There is no possibility to
  *         remove added region.
  *
+ * Region attributes determine which allocations are placed in region.
+ * Kernel and network objects prefer fast memory, programs, shared memory
+ * and cache buffers prefer large slow memory.
+ *
  * @note Function can be used only by driver code.
  *
  * @param  region       region object (initialized by system)
  * @param  start        region start address
  * @param  size         region size
+ * @param  attr         region attributes (@ref mem_region_attr)
  *
  * @return One of errno value.
  *
@@ -5768,7 +6043,8 @@ extern int sys_cache_read(FILE *file, u32_t blkpos, size_t blksz, size_t blkcnt,
 
         mem_region_t ram2;
 
-        int err = sys_memory_register(&ram2, 0x20001000, 16384);
+        int err = sys_memory_register(&ram2, 0x20001000, 16384,
+                                      MEM_REGION_ATTR_FAST | MEM_REGION_ATTR_DMA);
         if (!err) {
                 // ...
         }
@@ -5778,11 +6054,84 @@ extern int sys_cache_read(FILE *file, u32_t blkpos, size_t blksz, size_t blkcnt,
  *
  */
 //==============================================================================
-static inline int sys_memory_register(mem_region_t *region, void *start, size_t size)
+static inline int sys_memory_register(mem_region_t *region, void *start, size_t size, u8_t attr)
+{
+        return _mm_register_region(region, start, size, attr);
+}
+
+//==============================================================================
+/**
+ * @brief  Function return statistics of selected memory region (start
+ *         address, attributes and heap usage).
+ *
+ * @note Function can be used only by file system or driver code.
+ *
+ * @param  n            region number (0 is the main region)
+ * @param  stat         region statistics (result)
+ *
+ * @return One of errno value. ENOENT if region does not exist.
+ */
+//==============================================================================
+static inline int sys_get_mem_region_stat(size_t n, mem_region_stat_t *stat)
+{
+        return _mm_get_region_stat(n, stat);
+}
+
+//==============================================================================
+/**
+ * @brief  Function return statistics of kworker I/O thread pool (number of
+ *         threads, idle threads, I/O queue depth).
+ *
+ * @note Function can be used only by file system or driver code.
+ *
+ * @param  stat         pool statistics (result)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static inline int sys_get_kworker_stat(kworker_stat_t *stat)
 {
-        return _mm_register_region(region, start, size);
+        return _syscall_get_kworker_stat(stat);
 }
 
+//==============================================================================
+/**
+ * @brief  Function return statistics of selected kworker thread (number of
+ *         requests, busy time, maximum request wait time).
+ *
+ * @note Function can be used only by file system or driver code.
+ *
+ * @param  tid          thread ID (0 is the kworker main thread)
+ * @param  stat         thread statistics (result)
+ *
+ * @return One of errno value. EINVAL if thread ID is out of range.
+ */
+//==============================================================================
+static inline int sys_get_kworker_thread_stat(tid_t tid, kworker_thread_stat_t *stat)
+{
+        return _syscall_get_kworker_thread_stat(tid, stat);
+}
+
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+//==============================================================================
+/**
+ * @brief  Function return latency statistics of selected syscall (number of
+ *         calls, number of direct calls, maximum latency and histogram).
+ *
+ * @note Function can be used only by file system or driver code.
+ *
+ * @param  syscall      syscall number
+ * @param  stat         syscall statistics (result)
+ *
+ * @return One of errno value. EINVAL if syscall does not exist.
+ */
+//==============================================================================
+static inline int sys_get_syscall_stat(size_t syscall, syscall_stat_t *stat)
+{
+        return _syscall_get_stat(syscall, stat);
+}
+#endif
+
 //==============================================================================
 /**
  * @brief  Function return integer value from given configuration.
@@ -54,6 +54,7 @@ extern "C" {
   Exported functions
 ==============================================================================*/
 extern int _gettime(time_t*);
+extern int _gettime_cached(time_t*);
 extern int _settime(time_t*);
 
 /*==============================================================================
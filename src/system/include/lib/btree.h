@@ -62,6 +62,11 @@ extern "C" {
                 for (_type _val; !_err;)\
                         for (_err = _btree_maximum(_btree, &_val); !_err; _err = _btree_predecessor(_btree, &_val, &_val))
 
+#define _btree_foreach_range(_type, _val, _btree, _from, _to) \
+        for (int _err = 0; !_err;)\
+                for (_type _val; !_err;)\
+                        for (_err = _btree_range(_btree, _from, _to, NULL, &_val); !_err; _err = _btree_range(_btree, _from, _to, &_val, &_val))
+
 /*==============================================================================
   Exported object types
 ==============================================================================*/
@@ -105,6 +110,9 @@ extern int  _btree_successor(btree_t *tree, void *key, void *ret);
 extern int  _btree_predecessor(btree_t *tree, void *key, void *ret);
 extern int  _btree_insert(btree_t *tree, void *data);
 extern int  _btree_remove(btree_t *tree, void *data);
+extern int  _btree_lower_bound(btree_t *tree, void *key, void *ret);
+extern int  _btree_upper_bound(btree_t *tree, void *key, void *ret);
+extern int  _btree_range(btree_t *tree, void *from, void *to, void *prev, void *ret);
 extern void _btree_destroy(btree_t *tree);
 
 /*==============================================================================
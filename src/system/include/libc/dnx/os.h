@@ -51,6 +51,7 @@ extern "C" {
 #include <kernel/process.h>
 #include <kernel/printk.h>
 #include <mm/mm.h>
+#include <mm/pool.h>
 #include <drivers/drvctrl.h>
 
 /*==============================================================================
@@ -80,11 +81,32 @@ typedef struct {
         i32_t programs_memory_usage;    /*!< The amount of memory used by users' programs (applications).*/
         i32_t shared_memory_usage;      /*!< The amount of memory used by shared buffers.*/
         i32_t cached_memory_usage;      /*!< The anount of memory used by disc caches.*/
+        i32_t pools_memory_usage;       /*!< The amount of memory reserved by kernel object pools (included in other values).*/
 } memstat_t;
 #else
 typedef _mm_mem_usage_t memstat_t;
 #endif
 
+#ifdef DOXYGEN
+/**
+ * @brief Kernel object pool statistics
+ *
+ * The type contains statistics of selected kernel object pool.
+ *
+ * @see get_memory_pool_stat()
+ */
+typedef struct {
+        const char *name;               /*!< Pool name.*/
+        size_t      object_size;        /*!< Size of object in bytes.*/
+        size_t      object_count;       /*!< Number of objects reserved by pool.*/
+        size_t      used;               /*!< Number of used objects.*/
+        size_t      used_max;           /*!< Max number of used objects.*/
+        u32_t       fallbacks;          /*!< Number of objects allocated from heap (pool exhausted).*/
+} mempoolstat_t;
+#else
+typedef _mm_pool_stat_t mempoolstat_t;
+#endif
+
 #ifdef DOXYGEN
 /**
  * @brief Average CPU load
@@ -279,6 +301,43 @@ static inline i32_t get_module_memory_usage(uint module_number)
         return size;
 }
 
+//==============================================================================
+/**
+ * @brief Function returns statistics of kernel object pool.
+ *
+ * The function get_memory_pool_stat() return statistics of pool selected by
+ * number <i>pool_number</i>. Only pools that are in use are listed.
+ *
+ * @param pool_number       pool number
+ * @param stat              pool statistics
+ *
+ * @exception | @ref EINVAL
+ * @exception | @ref ENOENT
+ *
+ * @return Return @b 0 on success. On error, @b positive value
+ * is returned.
+ *
+ * @b Example
+ * @code
+        #include <dnx/os.h>
+
+        // ...
+
+        mempoolstat_t stat;
+        for (uint i = 0; get_memory_pool_stat(i, &stat) == 0; i++) {
+                printf("%s: %d/%d\n", stat.name, (int)stat.used, (int)stat.object_count);
+        }
+
+        // ...
+
+   @endcode
+ */
+//==============================================================================
+static inline int get_memory_pool_stat(uint pool_number, mempoolstat_t *stat)
+{
+        return _builtinfunc(mm_pool_get_stat, pool_number, stat);
+}
+
 //==============================================================================
 /**
  * @brief Function returns system uptime in seconds.
@@ -993,6 +1052,39 @@ static inline void syslog_clear(void)
         _builtinfunc(printk_clear);
 }
 
+//==============================================================================
+/**
+ * @brief Function return system log statistics.
+ *
+ * The function syslog_get_stat() return number of logged, dropped and
+ * truncated messages, and number of messages waiting for read.
+ *
+ * @param  stat         statistics (result)
+ *
+ * @return Return @b 0 on success. On error, @b positive value (errno)
+ * is returned.
+ *
+ * @b Example
+ * @code
+        #include <dnx/os.h>
+
+        // ...
+
+        printk_stat_t stat;
+        if (syslog_get_stat(&stat) == 0) {
+                printf("Dropped messages: %u\n", stat.dropped);
+        }
+
+        // ...
+
+   @endcode
+ */
+//==============================================================================
+static inline int syslog_get_stat(printk_stat_t *stat)
+{
+        return _builtinfunc(printk_get_stat, stat);
+}
+
 //==============================================================================
 /**
  * @brief Function is used to detect occurred kernel panic.
@@ -252,12 +252,7 @@ static inline FILE *fopen(const char *path, const char *mode)
  * @see fopen()
  */
 //==============================================================================
-static inline int fclose(FILE *file)
-{
-        int r = EOF;
-        syscall(SYSCALL_FCLOSE, &r, file);
-        return r;
-}
+extern int fclose(FILE *file);
 
 //==============================================================================
 /**
@@ -314,7 +309,9 @@ static inline FILE *freopen(const char *path, const char *mode, FILE *file)
  *
  * The function fwrite() writes <i>count</i> elements of data, each <i>size</i>
  * bytes long, to the stream pointed to by <i>file</i>, obtaining them from the
- * location given by <i>ptr</i>.
+ * location given by <i>ptr</i>. If stream is buffered then data is written
+ * to the file when buffer is full, at new line character (line buffered
+ * stream), or by fflush(), fseek(), and fclose() functions.
  *
  * @param ptr           pointer to data
  * @param size          element size
@@ -355,12 +352,7 @@ static inline FILE *freopen(const char *path, const char *mode, FILE *file)
  * @see fread()
  */
 //==============================================================================
-static inline size_t fwrite(const void *ptr, size_t size, size_t count, FILE *file)
-{
-        size_t s = 0;
-        syscall(SYSCALL_FWRITE, &s, ptr, &size, &count, file);
-        return s;
-}
+extern size_t fwrite(const void *ptr, size_t size, size_t count, FILE *file);
 
 //==============================================================================
 /**
@@ -368,7 +360,8 @@ static inline size_t fwrite(const void *ptr, size_t size, size_t count, FILE *fi
  *
  * The function fread() reads <i>count</i> elements of data, each <i>size</i>
  * bytes long, from the stream pointed to by <i>file</i>, storing them at the
- * location given by <i>ptr</i>.
+ * location given by <i>ptr</i>. If stream is buffered then data is read
+ * from the file in buffer size chunks.
  *
  * @param ptr           pointer to data
  * @param size          element size
@@ -406,12 +399,7 @@ static inline size_t fwrite(const void *ptr, size_t size, size_t count, FILE *fi
  * @see fwrite()
  */
 //==============================================================================
-static inline size_t fread(void *ptr, size_t size, size_t count, FILE *file)
-{
-        size_t s = 0;
-        syscall(SYSCALL_FREAD, &s, ptr, &size, &count, file);
-        return s;
-}
+extern size_t fread(void *ptr, size_t size, size_t count, FILE *file);
 
 //==============================================================================
 /**
@@ -459,12 +447,7 @@ static inline size_t fread(void *ptr, size_t size, size_t count, FILE *file)
  * @see fsetpos(), fgetpos(), ftell()
  */
 //==============================================================================
-static inline int fseek(FILE *file, i64_t offset, int mode)
-{
-        size_t r = 1;
-        syscall(SYSCALL_FSEEK, &r, file, &offset, &mode);
-        return r;
-}
+extern int fseek(FILE *file, i64_t offset, int mode);
 
 //==============================================================================
 /**
@@ -599,12 +582,7 @@ static inline void rewind(FILE *file)
  * @see fseek(), fsetpos(), fgetpos()
  */
 //==============================================================================
-static inline i64_t ftell(FILE *file)
-{
-        i64_t lseek = 0;
-        _errno = _builtinfunc(vfs_ftell, file, &lseek);
-        return lseek;
-}
+extern i64_t ftell(FILE *file);
 
 //==============================================================================
 /**
@@ -698,12 +676,7 @@ static inline int fgetpos(FILE *file, fpos_t *pos)
    @endcode
  */
 //==============================================================================
-static inline int fflush(FILE *file)
-{
-        int r = EOF;
-        syscall(SYSCALL_FFLUSH, &r, file);
-        return r;
-}
+extern int fflush(FILE *file);
 
 //==============================================================================
 /**
@@ -746,12 +719,7 @@ static inline int fflush(FILE *file)
  * @see clearerr()
  */
 //==============================================================================
-static inline int feof(FILE *file)
-{
-        int eof = 0;
-        _errno = _builtinfunc(vfs_feof, file, &eof);
-        return _errno | eof;
-}
+extern int feof(FILE *file);
 
 //==============================================================================
 /**
@@ -892,13 +860,36 @@ extern void perror(const char *s);
 /**
  * @brief Function sets stream buffer mode.
  *
- * The routine exist in dnx RTOS only for compatible reasons. Function in this
- * case do nothing.
+ * The setvbuf() function sets buffering of the stream pointed to by
+ * <i>file</i>. In unbuffered mode (@ref _IONBF) each stream operation is
+ * passed directly to the file. In fully buffered mode (@ref _IOFBF) data is
+ * read and written in blocks of buffer size. In line buffered mode
+ * (@ref _IOLBF) output data is additionally written at new line character.
+ * If <i>buffer</i> is @ref NULL then buffer of <i>size</i> bytes is allocated
+ * and freed when stream is closed. Data buffered in the stream is written
+ * before buffer is changed.
  *
- * @note Function not supported.
+ * Stream buffers belong to the process: when a stream is shared between
+ * processes (e.g. stdout) each process has its own buffer and its own buffer
+ * mode. Buffers are written by fflush(), fclose(), exit(), and at return
+ * from main(). Threads of process can use the same stream concurrently.
+ *
+ * Regular files are fully buffered by default (buffer size @ref BUFSIZ),
+ * pipes and devices are unbuffered.
+ *
+ * @note Buffer given by user must be valid until the stream is closed or
+ *       the process exits.
  *
  * @param file      stream
- * @param buffer    buffer
+ * @param buffer    buffer (can be @ref NULL)
+ * @param mode      buffer mode (@ref _IONBF, @ref _IOLBF, @ref _IOFBF)
+ * @param size      buffer size
+ *
+ * @exception | @ref EINVAL
+ * @exception | @ref ENOMEM
+ *
+ * @return On success 0 is returned, otherwise nonzero value and @ref errno is
+ * set appropriately.
  *
  * @b Example
  * @code
@@ -908,36 +899,27 @@ extern void perror(const char *s);
 
         FILE *file = fopen("/foo/bar", "r");
         if (file) {
-               char buffer[100];
-               setbuf(file, buffer);
+               setvbuf(file, NULL, _IOFBF, 512);
 
                // ...
         }
         // ...
    @endcode
  *
- * @see setvbuf()
+ * @see setbuf()
  */
 //==============================================================================
-static inline void setbuf(FILE *file, char *buffer)
-{
-        (void) file;
-        (void) buffer;
-}
+extern int setvbuf(FILE *file, char *buffer, int mode, size_t size);
 
 //==============================================================================
 /**
- * @brief Function sets stream buffer mode.
- *
- * The routine exist in dnx RTOS only for compatible reasons. Function in this
- * case do nothing.
+ * @brief Function sets stream buffer.
  *
- * @note Function not supported.
+ * The setbuf() function is equivalent to:
+ * <pre>setvbuf(file, buffer, buffer ? _IOFBF : _IONBF, BUFSIZ)</pre>
  *
  * @param file      stream
- * @param buffer    buffer
- * @param mode      buffer mode (@ref _IONBF, @ref _IOLBF, @ref _IOFBF)
- * @param size      buffer size
+ * @param buffer    buffer of @ref BUFSIZ size (can be @ref NULL)
  *
  * @b Example
  * @code
@@ -947,25 +929,20 @@ static inline void setbuf(FILE *file, char *buffer)
 
         FILE *file = fopen("/foo/bar", "r");
         if (file) {
-               char buffer[100];
-               setvbuf(file, buffer, _IOFBF, 100);
+               static char buffer[BUFSIZ];
+               setbuf(file, buffer);
 
                // ...
         }
         // ...
    @endcode
  *
- * @see setbuf()
+ * @see setvbuf()
  */
 //==============================================================================
-static inline int setvbuf(FILE *file, char *buffer, int mode, size_t size)
+static inline void setbuf(FILE *file, char *buffer)
 {
-        (void) file;
-        (void) buffer;
-        (void) mode;
-        (void) size;
-
-        return 0;
+        setvbuf(file, buffer, buffer ? _IOFBF : _IONBF, BUFSIZ);
 }
 
 //==============================================================================
@@ -431,9 +431,6 @@ extern int rand(void);
 //==============================================================================
 extern void srand(unsigned int seed);
 
-/*==============================================================================
-  Exported inline functions
-==============================================================================*/
 //==============================================================================
 /**
  * @brief Function allocates memory block.
@@ -461,12 +458,7 @@ extern void srand(unsigned int seed);
  * @see calloc(), realloc(), free()
  */
 //==============================================================================
-static inline void *malloc(size_t size)
-{
-        void *mem = NULL;
-        syscall(SYSCALL_MALLOC, &mem, &size);
-        return mem;
-}
+extern void *malloc(size_t size);
 
 //==============================================================================
 /**
@@ -496,13 +488,7 @@ static inline void *malloc(size_t size)
  * @see malloc(), realloc(), free()
  */
 //==============================================================================
-static inline void *calloc(size_t n, size_t size)
-{
-        void   *mem   = NULL;
-        size_t  bsize = n * size;
-        syscall(SYSCALL_ZALLOC, &mem, &bsize);
-        return mem;
-}
+extern void *calloc(size_t n, size_t size);
 
 //==============================================================================
 /**
@@ -534,12 +520,7 @@ static inline void *calloc(size_t n, size_t size)
  * @see malloc(), calloc(), realloc()
  */
 //==============================================================================
-static inline void free(void *ptr)
-{
-        if (ptr) {
-                syscall(SYSCALL_FREE, NULL, ptr);
-        }
-}
+extern void free(void *ptr);
 
 //==============================================================================
 /**
@@ -587,25 +568,11 @@ static inline void free(void *ptr)
  * @see malloc(), calloc(), free()
  */
 //==============================================================================
-static inline void *realloc(void *ptr, size_t size)
-{
-        extern void* memcpy(void* dest, const void* src, size_t n);
-
-        if (size) {
-                void *mem = malloc(size);
-                if (ptr == NULL)
-                        return mem;
-
-                if (mem) {
-                        memcpy(mem, ptr, size);
-                        free(ptr);
-                        return mem;
-                }
-        }
-
-        return NULL;
-}
+extern void *realloc(void *ptr, size_t size);
 
+/*==============================================================================
+  Exported inline functions
+==============================================================================*/
 //==============================================================================
 /**
  * @brief Function kills current program.
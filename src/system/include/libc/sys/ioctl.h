@@ -71,6 +71,30 @@ extern "C" {
  */
 #define IOCTL_PIPE__CLEAR
 
+/**
+ * @brief Request changes buffer size of \b pipe device.
+ *
+ * Request changes buffer size (capacity) of \b pipe device. Capacity can be
+ * changed only if pipe is empty, otherwise @ref EBUSY error is returned.
+ * Default capacity is configured in system configuration.
+ *
+ * @param [WR] @ref size_t*      new capacity in bytes
+ *
+ * @see   ioctl()
+ */
+#define IOCTL_PIPE__SET_CAPACITY
+
+/**
+ * @brief Request returns buffer size of \b pipe device.
+ *
+ * Request returns buffer size (capacity) of \b pipe device.
+ *
+ * @param [RD] @ref size_t*      capacity in bytes
+ *
+ * @see   ioctl()
+ */
+#define IOCTL_PIPE__GET_CAPACITY
+
 /**
  * @brief Request set stream to non-blocking read mode.
  *
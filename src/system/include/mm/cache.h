@@ -86,6 +86,19 @@ enum cache_mode {
         CACHE_WRITE_BACK
 };
 
+/**
+ * Cache statistics.
+ */
+typedef struct {
+        u32_t  hits;            //!< number of blocks found in cache
+        u32_t  misses;          //!< number of blocks not found in cache
+        u32_t  evictions;       //!< number of blocks evicted by memory pressure
+        u32_t  prefetched;      //!< number of blocks read in advance
+        u32_t  blocks;          //!< number of cached blocks
+        u32_t  dirty_blocks;    //!< number of dirty blocks
+        size_t size;            //!< size of cached data [bytes]
+} _cache_stat_t;
+
 /*==============================================================================
   Exported objects
 ==============================================================================*/
@@ -96,11 +109,13 @@ enum cache_mode {
 extern int  sys_cache_drop(FILE*);
 extern int  sys_cache_write(FILE*, u32_t, size_t, size_t, const u8_t*, enum cache_mode);
 extern int  sys_cache_read(FILE*, u32_t, size_t, size_t, u8_t*);
+extern int  sys_cache_readahead(FILE*, size_t);
 extern int  _cache_init(void);
 extern void _cache_sync(void);
 extern void _cache_drop(void);
 extern void _cache_reduce(size_t);
 extern bool _cache_is_sync_needed(void);
+extern int  _cache_get_stat(_cache_stat_t*);
 
 /*==============================================================================
   Exported inline functions
@@ -69,6 +69,7 @@ extern "C" {
 ==============================================================================*/
 #include <sys/types.h>
 #include <stddef.h>
+#include "config.h"
 
 /*==============================================================================
   Exported symbolic constants/macros
@@ -77,6 +78,27 @@ extern "C" {
 /*==============================================================================
   Exported types, enums definitions
 ==============================================================================*/
+#if __HEAP_ALLOCATOR__ == 1
+typedef struct {
+        /** heap region begin */
+        u8_t *begin;
+
+        /** heap region end */
+        u8_t *end;
+
+        /** allocator control structure (placed at the beginning of the region) */
+        struct tlsf *control;
+
+        /** size of memory available for blocks */
+        size_t size;
+
+        /** heap usage */
+        size_t used;
+
+        /** heap max usage */
+        size_t used_max;
+} _heap_t;
+#else
 typedef struct {
         /** pointer to the heap (ram_heap): for alignment, ram is now a pointer instead of an array */
         u8_t *begin;
@@ -96,6 +118,17 @@ typedef struct {
         /** heap amx usage */
         size_t used_max;
 } _heap_t;
+#endif
+
+/** heap statistics used to estimate fragmentation */
+typedef struct {
+        size_t size;            /**< heap size                  */
+        size_t used;            /**< used memory                */
+        size_t used_max;        /**< max used memory            */
+        size_t free;            /**< free memory                */
+        size_t largest_free;    /**< the largest free block     */
+        size_t free_blocks;     /**< number of free blocks      */
+} _heap_stat_t;
 
 /*==============================================================================
   Exported object declarations
@@ -111,6 +144,7 @@ extern size_t _heap_get_free(_heap_t*);
 extern size_t _heap_get_used(_heap_t*);
 extern size_t _heap_get_size(_heap_t*);
 extern size_t _heap_get_block_size(_heap_t*, void*);
+extern int    _heap_get_stat(_heap_t*, _heap_stat_t*);
 
 #ifdef __cplusplus
 }
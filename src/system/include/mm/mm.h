@@ -56,6 +56,7 @@ typedef struct {
         i32_t programs_memory_usage;
         i32_t shared_memory_usage;
         i32_t cached_memory_usage;
+        i32_t pools_memory_usage;
 } _mm_mem_usage_t;
 
 enum _mm_mem {
@@ -69,11 +70,28 @@ enum _mm_mem {
         _MM_COUNT
 };
 
+/**
+ * Memory region attributes. Region without _MM_REGION_ATTR_FAST attribute
+ * is considered as slow memory (e.g. external SDRAM).
+ */
+enum _mm_region_attr {
+        _MM_REGION_ATTR_FAST  = (1 << 0),       //!< fast memory (internal SRAM, CCM, TCM)
+        _MM_REGION_ATTR_DMA   = (1 << 1),       //!< memory accessible by DMA
+        _MM_REGION_ATTR_LARGE = (1 << 2),       //!< large region preferred for bulk allocations
+};
+
 typedef struct _mm_region {
         _heap_t            heap;
         struct _mm_region *next;
+        u8_t               attr;
 } _mm_region_t;
 
+typedef struct {
+        void        *start;             //!< region start address
+        u8_t         attr;              //!< region attributes
+        _heap_stat_t heap;              //!< region heap statistics
+} _mm_region_stat_t;
+
 /*==============================================================================
   Exported objects
 ==============================================================================*/
@@ -82,13 +100,15 @@ typedef struct _mm_region {
   Exported functions
 ==============================================================================*/
 extern int    _mm_init(void);
-extern int    _mm_register_region(_mm_region_t*, void*, size_t);
+extern int    _mm_register_region(_mm_region_t*, void*, size_t, u8_t);
+extern int    _mm_get_region_stat(size_t, _mm_region_stat_t*);
 extern int    _mm_get_mem_usage_details(_mm_mem_usage_t*);
 extern int    _mm_get_module_mem_usage(uint module, i32_t *usage);
 extern size_t _mm_get_block_size(void*);
 extern size_t _mm_get_mem_free(void);
 extern size_t _mm_get_mem_usage(void);
 extern size_t _mm_get_mem_size(void);
+extern int    _mm_get_heap_stat(_heap_stat_t*);
 extern int    _kzalloc(enum _mm_mem, const size_t, void**, ...);
 extern int    _kmalloc(enum _mm_mem, const size_t, void**, ...);
 extern int    _kfree(enum _mm_mem, void**, ...);
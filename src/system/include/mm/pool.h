@@ -0,0 +1,127 @@
+/*=========================================================================*//**
+File     pool.h
+
+Author   Daniel Zorychta
+
+Brief    Fixed-size object pools.
+
+         Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+#ifndef _MM_POOL_H_
+#define _MM_POOL_H_
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "config.h"
+#include "mm/mm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==============================================================================
+  Exported macros
+==============================================================================*/
+/**
+ * Pool object initializer. The pool storage (slab) is allocated at first
+ * object allocation. When slab is exhausted then objects are allocated from
+ * the heap.
+ *
+ * @param _name         pool name (statistics)
+ * @param _mpur         memory purpose (enum _mm_mem)
+ * @param _objsize      object size
+ * @param _count        number of objects in slab
+ */
+#if __OS_SYSTEM_OBJECT_POOLS_ENABLE__ > 0
+#define _MM_POOL_INIT(_name, _mpur, _objsize, _count)\
+        {.name    = _name,\
+         .mpur    = _mpur,\
+         .objsize = _mm_align((_objsize) < sizeof(void*) ? sizeof(void*) : (_objsize)),\
+         .count   = _count}
+#else
+#define _MM_POOL_INIT(_name, _mpur, _objsize, _count)\
+        {.name    = _name,\
+         .mpur    = _mpur,\
+         .objsize = _mm_align(_objsize),\
+         .count   = 0}
+#endif
+
+/*==============================================================================
+  Exported object types
+==============================================================================*/
+/**
+ * Object pool. Fields are private.
+ */
+typedef struct _mm_pool {
+        struct _mm_pool *next;          /**< next registered pool               */
+        const char      *name;          /**< pool name                          */
+        void            *slab;          /**< objects storage                    */
+        void            *free_obj;      /**< list of free objects               */
+        enum _mm_mem     mpur;          /**< memory purpose                     */
+        u16_t            objsize;       /**< aligned object size                */
+        u16_t            count;         /**< number of objects in slab          */
+        u16_t            used;          /**< used objects in slab               */
+        u16_t            used_max;      /**< max used objects in slab           */
+        u32_t            fallbacks;     /**< objects allocated from heap        */
+} _mm_pool_t;
+
+/**
+ * Object pool statistics.
+ */
+typedef struct {
+        const char *name;               /**< pool name                          */
+        size_t      object_size;        /**< aligned object size                */
+        size_t      object_count;       /**< number of objects in slab          */
+        size_t      used;               /**< used objects in slab               */
+        size_t      used_max;           /**< max used objects in slab           */
+        u32_t       fallbacks;          /**< objects allocated from heap        */
+} _mm_pool_stat_t;
+
+/*==============================================================================
+  Exported objects
+==============================================================================*/
+
+/*==============================================================================
+  Exported functions
+==============================================================================*/
+extern int    _mm_pool_alloc(_mm_pool_t*, void**);
+extern int    _mm_pool_zalloc(_mm_pool_t*, void**);
+extern int    _mm_pool_free(_mm_pool_t*, void**);
+extern int    _mm_pool_get_stat(size_t, _mm_pool_stat_t*);
+extern size_t _mm_pool_get_memory_usage(void);
+
+/*==============================================================================
+  Exported inline functions
+==============================================================================*/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _MM_POOL_H_ */
+/*==============================================================================
+  End of file
+==============================================================================*/
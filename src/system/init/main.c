@@ -98,7 +98,8 @@ void dnxinit(void *arg)
          * The stack region is reused for HEAP purposes.
          */
         static _mm_region_t main_stack;
-        _mm_register_region(&main_stack, STACK_START, STACK_SIZE);
+        _mm_register_region(&main_stack, STACK_START, STACK_SIZE,
+                            _MM_REGION_ATTR_FAST | _MM_REGION_ATTR_DMA);
 
         _task_exit();
 }
@@ -33,6 +33,7 @@
 #include "kernel/ktypes.h"
 #include "kernel/errno.h"
 #include "lib/cast.h"
+#include "mm/pool.h"
 #include "event_groups.h"
 
 /*==============================================================================
@@ -42,6 +43,11 @@
 #define _CEILING(x,y)   (((x) + (y) - 1) / (y))
 #define MS2TICK(ms)     ((ms <= (1000/(configTICK_RATE_HZ)) ? 1 : _CEILING(ms,(1000/(configTICK_RATE_HZ)))) + 1)
 
+/** OBJECT POOLS */
+#define SEMAPHORE_POOL_SIZE     4
+#define MUTEX_POOL_SIZE         8
+#define FLAG_POOL_SIZE          4
+
 /*==============================================================================
   Local types, enums definitions
 ==============================================================================*/
@@ -53,6 +59,9 @@
 /*==============================================================================
   Local object definitions
 ==============================================================================*/
+static _mm_pool_t sem_pool   = _MM_POOL_INIT("sem_t", _MM_KRN, sizeof(sem_t), SEMAPHORE_POOL_SIZE);
+static _mm_pool_t mutex_pool = _MM_POOL_INIT("mutex_t", _MM_KRN, sizeof(mutex_t), MUTEX_POOL_SIZE);
+static _mm_pool_t flag_pool  = _MM_POOL_INIT("flag_t", _MM_KRN, sizeof(flag_t), FLAG_POOL_SIZE);
 
 /*==============================================================================
   Exported object definitions
@@ -490,7 +499,7 @@ int _semaphore_create(size_t cnt_max, size_t cnt_init, sem_t **sem)
         int err = EINVAL;
 
         if (cnt_max > 0 && sem) {
-                err = _kzalloc(_MM_KRN, sizeof(sem_t), cast(void**, sem));
+                err = _mm_pool_zalloc(&sem_pool, cast(void**, sem));
                 if (err == ESUCC) {
 
                         if (cnt_max == 1) {
@@ -513,7 +522,7 @@ int _semaphore_create(size_t cnt_max, size_t cnt_init, sem_t **sem)
                         if ((*sem)->object) {
                                 (*sem)->header.type = RES_TYPE_SEMAPHORE;
                         } else {
-                                _kfree(_MM_KRN, cast(void**, sem));
+                                _mm_pool_free(&sem_pool, cast(void**, sem));
                                 err = ENOMEM;
                         }
                 }
@@ -537,7 +546,7 @@ int _semaphore_destroy(sem_t *sem)
                 sem->header.type = RES_TYPE_UNKNOWN;
                 vSemaphoreDelete(sem->object);
                 sem->object = NULL;
-                return _kfree(_MM_KRN, cast(void**, &sem));
+                return _mm_pool_free(&sem_pool, cast(void**, &sem));
         } else {
                 return EINVAL;
         }
@@ -669,7 +678,7 @@ int _mutex_create(enum mutex_type type, mutex_t **mtx)
         int err = EINVAL;
 
         if (type <= MUTEX_TYPE_NORMAL && mtx) {
-                err = _kzalloc(_MM_KRN, sizeof(mutex_t), cast(void**, mtx));
+                err = _mm_pool_zalloc(&mutex_pool, cast(void**, mtx));
                 if (err == ESUCC) {
                         if (type == MUTEX_TYPE_RECURSIVE) {
                                 (*mtx)->object    = xSemaphoreCreateRecursiveMutexStatic(&(*mtx)->buffer);
@@ -682,7 +691,7 @@ int _mutex_create(enum mutex_type type, mutex_t **mtx)
                         if ((*mtx)->object) {
                                 (*mtx)->header.type = RES_TYPE_MUTEX;
                         } else {
-                                _kfree(_MM_KRN, cast(void**, mtx));
+                                _mm_pool_free(&mutex_pool, cast(void**, mtx));
                                 err = ENOMEM;
                         }
                 }
@@ -706,7 +715,7 @@ int _mutex_destroy(mutex_t *mutex)
                 mutex->header.type = RES_TYPE_UNKNOWN;
                 vSemaphoreDelete(mutex->object);
                 mutex->object = NULL;
-                return _kfree(_MM_KRN, cast(void**, &mutex));
+                return _mm_pool_free(&mutex_pool, cast(void**, &mutex));
         } else {
                 return EINVAL;
         }
@@ -778,14 +787,14 @@ int _flag_create(flag_t **flag)
         int err = EINVAL;
 
         if (flag) {
-                err = _kzalloc(_MM_KRN, sizeof(flag_t), cast(void**, flag));
+                err = _mm_pool_zalloc(&flag_pool, cast(void**, flag));
                 if (err == ESUCC) {
                         (*flag)->object = xEventGroupCreateStatic(&(*flag)->buffer);
 
                         if ((*flag)->object) {
                                 (*flag)->header.type = RES_TYPE_FLAG;
                         } else {
-                                _kfree(_MM_KRN, cast(void**, flag));
+                                _mm_pool_free(&flag_pool, cast(void**, flag));
                                 err = ENOMEM;
                         }
                 }
@@ -809,7 +818,7 @@ int _flag_destroy(flag_t *flag)
                 flag->header.type = RES_TYPE_UNKNOWN;
                 vEventGroupDelete(flag->object);
                 flag->object = NULL;
-                return _kfree(_MM_KRN, cast(void**, &flag));
+                return _mm_pool_free(&flag_pool, cast(void**, &flag));
         } else {
                 return EINVAL;
         }
@@ -829,7 +838,9 @@ int _flag_destroy(flag_t *flag)
 int _flag_wait(flag_t *flag, u32_t bits, const u32_t blocktime_ms)
 {
         if (is_flag_valid(flag)) {
-                if (xEventGroupWaitBits(flag->object, bits, true, true, blocktime_ms)) {
+                /* on timeout function returns currently set bits, not zero */
+                u32_t set = xEventGroupWaitBits(flag->object, bits, true, true, blocktime_ms);
+                if ((set & bits) == bits) {
                         return ESUCC;
                 } else {
                         return ETIME;
@@ -44,24 +44,49 @@
 /*==============================================================================
   Local macros
 ==============================================================================*/
+#define ROWS                    __OS_SYSTEM_MSG_ROWS__
+#define ARGS_MAX                8
+#define STR_SIZE                __OS_SYSTEM_MSG_COLS__
+#define SPEC_LEN                12
 
 /*==============================================================================
   Local object types
 ==============================================================================*/
+/**
+ * Binary message record. Message is formatted when it is read. Arguments are
+ * stored as raw 32-bit words and string arguments are copied to the record.
+ */
+typedef struct {
+        u32_t       seq;                //!< sequence number + 1 (0: record in write)
+        u32_t       timestamp;          //!< message timestamp [ms]
+        const char *format;             //!< message format (must be constant string)
+        u32_t       arg[ARGS_MAX];      //!< raw arguments
+        u8_t        argc;               //!< number of used argument slots
+        u8_t        strlen;             //!< used bytes of string area
+        bool        lock;               //!< record is written by producer
+        char        str[STR_SIZE];      //!< copy of string arguments
+} record_t;
+
+/**
+ * Ring of message records. Producers reserve records by atomic operations
+ * (no scheduler lock, usable in ISR), readers are serialized by scheduler lock.
+ */
 typedef struct {
-        struct {
-                u32_t timestamp;
-                char  str[__OS_SYSTEM_MSG_COLS__];
-        } msg[__OS_SYSTEM_MSG_ROWS__];
-
-        uint8_t wridx;
-        uint8_t rdidx;
-        uint8_t size;
+        record_t rec[ROWS];
+        u32_t    head;                  //!< next sequence number to write
+        u32_t    tail;                  //!< next sequence number to read
+        u32_t    logged;                //!< number of logged messages
+        u32_t    dropped;               //!< number of dropped messages
+        u32_t    truncated;             //!< number of messages with truncated arguments
+        u32_t    reported;              //!< number of dropped messages reported to reader
 } printk_log_t;
 
 /*==============================================================================
   Local function prototypes
 ==============================================================================*/
+static const char *scan_spec(const char *format, bool *star, char *conv);
+static bool store_args(record_t *rec, const char *format, va_list args);
+static size_t format_record(const record_t *rec, char *str, size_t len);
 
 /*==============================================================================
   Local objects
@@ -82,43 +107,63 @@ static printk_log_t log_buf;
 
 //==============================================================================
 /**
- * @brief Function send kernel message on terminal
+ * @brief Function send kernel message to the system log. Function does not
+ *        format message (it is done by reader) and can be used in ISR.
  *
- * @param *format             formated text
+ * @param *format             formated text (constant string)
  * @param ...                 format arguments
  */
 //==============================================================================
 void _printk(const char *format, ...)
 {
-        _kernel_scheduler_lock();
-        {
-                if (log_buf.size >= __OS_SYSTEM_MSG_ROWS__) {
-                        log_buf.size = __OS_SYSTEM_MSG_ROWS__;
-                        if (++log_buf.rdidx >= __OS_SYSTEM_MSG_ROWS__) {
-                                log_buf.rdidx = 0;
-                        }
-                } else {
-                        log_buf.size++;
+        u32_t     timestamp = _kernel_get_time_ms();
+        u32_t     seq;
+        record_t *rec;
+
+        // reserve record; record still written by preempted producer is not
+        // overwritten, the new message is dropped instead
+        do {
+                seq = __atomic_load_n(&log_buf.head, __ATOMIC_ACQUIRE);
+                rec = &log_buf.rec[seq % ROWS];
+
+                if (__atomic_test_and_set(&rec->lock, __ATOMIC_ACQUIRE)) {
+                        __atomic_fetch_add(&log_buf.dropped, 1, __ATOMIC_RELAXED);
+                        return;
                 }
 
-                va_list args;
-                va_start(args, format);
-                _vsnprintf(log_buf.msg[log_buf.wridx].str,
-                           __OS_SYSTEM_MSG_COLS__, format, args);
-                va_end(args);
+                if (__atomic_compare_exchange_n(&log_buf.head, &seq, seq + 1, false,
+                                                __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+                        break;
+                }
 
-                log_buf.msg[log_buf.wridx].timestamp = _kernel_get_time_ms();
+                __atomic_clear(&rec->lock, __ATOMIC_RELEASE);
 
-                if (++log_buf.wridx >= __OS_SYSTEM_MSG_ROWS__) {
-                        log_buf.wridx = 0;
-                }
+        } while (true);
+
+        __atomic_store_n(&rec->seq, 0, __ATOMIC_RELEASE);
+
+        rec->timestamp = timestamp;
+        rec->format    = format;
+
+        va_list args;
+        va_start(args, format);
+        bool complete = store_args(rec, format, args);
+        va_end(args);
+
+        __atomic_store_n(&rec->seq, seq + 1, __ATOMIC_RELEASE);
+        __atomic_clear(&rec->lock, __ATOMIC_RELEASE);
+
+        __atomic_fetch_add(&log_buf.logged, 1, __ATOMIC_RELAXED);
+
+        if (!complete) {
+                __atomic_fetch_add(&log_buf.truncated, 1, __ATOMIC_RELAXED);
         }
-        _kernel_scheduler_unlock();
 }
 
 //==============================================================================
 /**
- * Function read log message.
+ * Function read log message. If messages were dropped since last read then
+ * information about number of dropped messages is returned first.
  *
  * @param str           destination buffer
  * @param len           destination buffer length
@@ -129,29 +174,90 @@ void _printk(const char *format, ...)
 //==============================================================================
 size_t _printk_read(char *str, size_t len, u32_t *timestamp_ms)
 {
-        size_t n = 0;
+        size_t   n     = 0;
+        bool     found = false;
+        u32_t    lost  = 0;
+        record_t rec;
 
         if (str && len) {
                 _kernel_scheduler_lock();
                 {
-                        if (log_buf.size > 0) {
-                                log_buf.size--;
+                        u32_t tail = log_buf.tail;
 
-                                strlcpy(str, log_buf.msg[log_buf.rdidx].str, len);
+                        while (!found) {
+                                u32_t head = __atomic_load_n(&log_buf.head, __ATOMIC_ACQUIRE);
 
-                                n = min(len, strnlen(log_buf.msg[log_buf.rdidx].str,
-                                                     __OS_SYSTEM_MSG_COLS__));
+                                if (head == tail) {
+                                        break;
+                                }
+
+                                if ((head - tail) > ROWS) {
+                                        __atomic_fetch_add(&log_buf.dropped,
+                                                           head - tail - ROWS,
+                                                           __ATOMIC_RELAXED);
+                                        tail = head - ROWS;
+                                }
+
+                                record_t *r   = &log_buf.rec[tail % ROWS];
+                                u32_t     seq = __atomic_load_n(&r->seq, __ATOMIC_ACQUIRE);
+
+                                if (seq != tail + 1) {
+                                        if (  (seq == 0 || cast(i32_t, seq - (tail + 1)) < 0)
+                                           && __atomic_load_n(&r->lock, __ATOMIC_ACQUIRE)) {
+                                                // message is still written
+                                                break;
+                                        }
+
+                                        // message overwritten by newer one
+                                        __atomic_fetch_add(&log_buf.dropped, 1, __ATOMIC_RELAXED);
+                                        tail++;
+                                        continue;
+                                }
+
+                                memcpy(&rec, r, sizeof(record_t));
+
+                                __atomic_thread_fence(__ATOMIC_ACQUIRE);
 
-                                if (timestamp_ms) {
-                                        *timestamp_ms = log_buf.msg[log_buf.rdidx].timestamp;
+                                if (__atomic_load_n(&r->seq, __ATOMIC_RELAXED) != seq) {
+                                        __atomic_fetch_add(&log_buf.dropped, 1, __ATOMIC_RELAXED);
+                                } else {
+                                        found = true;
                                 }
 
-                                if (++log_buf.rdidx >= __OS_SYSTEM_MSG_ROWS__) {
-                                        log_buf.rdidx = 0;
+                                tail++;
+                        }
+
+                        lost = __atomic_load_n(&log_buf.dropped, __ATOMIC_RELAXED)
+                             - log_buf.reported;
+
+                        if (lost) {
+                                log_buf.reported += lost;
+
+                                // dropped messages are reported before read message
+                                if (found) {
+                                        tail--;
+                                        found = false;
                                 }
                         }
+
+                        log_buf.tail = tail;
                 }
                 _kernel_scheduler_unlock();
+
+                if (lost) {
+                        n = _snprintf(str, len, "*** %u message(s) dropped ***", lost);
+
+                        if (timestamp_ms) {
+                                *timestamp_ms = _kernel_get_time_ms();
+                        }
+
+                } else if (found) {
+                        n = format_record(&rec, str, len);
+
+                        if (timestamp_ms) {
+                                *timestamp_ms = rec.timestamp;
+                        }
+                }
         }
 
         return n;
@@ -159,16 +265,259 @@ size_t _printk_read(char *str, size_t len, u32_t *timestamp_ms)
 
 //==============================================================================
 /**
- * Function clear system circular buffer.
+ * Function clear system circular buffer. Statistics are not cleared.
  */
 //==============================================================================
 void _printk_clear(void)
 {
         _kernel_scheduler_lock();
         {
-                memset(&log_buf, 0, sizeof(log_buf));
+                log_buf.tail     = __atomic_load_n(&log_buf.head, __ATOMIC_ACQUIRE);
+                log_buf.reported = __atomic_load_n(&log_buf.dropped, __ATOMIC_RELAXED);
+        }
+        _kernel_scheduler_unlock();
+}
+
+//==============================================================================
+/**
+ * Function return statistics of system log.
+ *
+ * @param stat          statistics (result)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _printk_get_stat(printk_stat_t *stat)
+{
+        if (!stat) {
+                return EINVAL;
+        }
+
+        _kernel_scheduler_lock();
+        {
+                u32_t head = __atomic_load_n(&log_buf.head, __ATOMIC_ACQUIRE);
+                u32_t used = head - log_buf.tail;
+
+                stat->logged    = __atomic_load_n(&log_buf.logged, __ATOMIC_RELAXED);
+                stat->truncated = __atomic_load_n(&log_buf.truncated, __ATOMIC_RELAXED);
+                stat->dropped   = __atomic_load_n(&log_buf.dropped, __ATOMIC_RELAXED);
+
+                // messages overwritten but not yet detected by reader
+                if (used > ROWS) {
+                        stat->dropped += used - ROWS;
+                        used = ROWS;
+                }
+
+                stat->pending = used;
         }
         _kernel_scheduler_unlock();
+
+        return ESUCC;
+}
+
+//==============================================================================
+/**
+ * Function scan conversion specification (the same modifiers as _vsnprintf()).
+ *
+ * @param format        format string just after '%' character
+ * @param star          argument width modifier '*' used
+ * @param conv          conversion character (0 if format is finished)
+ *
+ * @return Format just after conversion specification.
+ */
+//==============================================================================
+static const char *scan_spec(const char *format, bool *star, char *conv)
+{
+        *star = false;
+
+        if (*format == '0') {
+                format++;
+        }
+
+        if (*format == '.') {
+                format++;
+
+                if (*format == '*') {
+                        *star = true;
+                        format++;
+                }
+        }
+
+        while (*format >= '0' && *format <= '9') {
+                format++;
+        }
+
+        if (*format == 'l') {
+                format++;
+        }
+
+        *conv = *format;
+
+        return *conv ? format + 1 : format;
+}
+
+//==============================================================================
+/**
+ * Function store message arguments in record.
+ *
+ * @param rec           record
+ * @param format        message format
+ * @param args          arguments
+ *
+ * @return True if all arguments are stored, false if arguments are truncated.
+ */
+//==============================================================================
+static bool store_args(record_t *rec, const char *format, va_list args)
+{
+        rec->argc   = 0;
+        rec->strlen = 0;
+
+        while ((format = strchr(format, '%'))) {
+                bool star;
+                char conv;
+                format = scan_spec(format + 1, &star, &conv);
+
+                if (conv == '%') {
+                        continue;
+                }
+
+                if (!strchr("sfFcdiuxXp", conv)) {
+                        continue;
+                }
+
+                size_t slots = (star ? 1 : 0) + ((conv == 'f' || conv == 'F') ? 2 : 1);
+                if (rec->argc + slots > ARGS_MAX) {
+                        return false;
+                }
+
+                if (star) {
+                        rec->arg[rec->argc++] = va_arg(args, int);
+                }
+
+                switch (conv) {
+                case 's': {
+                        const char *s = va_arg(args, const char*);
+                        if (!s) {
+                                s = "";
+                        }
+
+                        u8_t offset = min(rec->strlen, STR_SIZE - 1);
+                        rec->arg[rec->argc++] = offset;
+
+                        size_t sz = strlcpy(&rec->str[offset], s, STR_SIZE - offset);
+                        if (sz >= cast(size_t, STR_SIZE - offset)) {
+                                rec->strlen = STR_SIZE;
+                                rec->str[STR_SIZE - 1] = '\0';
+                                return false;
+                        }
+
+                        rec->strlen = offset + sz + 1;
+                        break;
+                }
+
+                case 'f':
+                case 'F': {
+                        double val = va_arg(args, double);
+                        memcpy(&rec->arg[rec->argc], &val, sizeof(double));
+                        rec->argc += 2;
+                        break;
+                }
+
+                case 'c':
+                case 'd':
+                case 'i':
+                case 'u':
+                case 'x':
+                case 'X':
+                case 'p':
+                        rec->arg[rec->argc++] = va_arg(args, int);
+                        break;
+
+                default:
+                        break;
+                }
+        }
+
+        return true;
+}
+
+//==============================================================================
+/**
+ * Function format message stored in record.
+ *
+ * @param rec           record
+ * @param str           destination buffer
+ * @param len           destination buffer length
+ *
+ * @return Number of characters stored in buffer.
+ */
+//==============================================================================
+static size_t format_record(const record_t *rec, char *str, size_t len)
+{
+        const char *format = rec->format;
+        size_t      n      = 0;
+        u8_t        argc   = 0;
+
+        len = min(len, cast(size_t, __OS_SYSTEM_MSG_COLS__));
+
+        while (*format && (n + 1 < len)) {
+
+                if (*format != '%') {
+                        str[n++] = *format++;
+                        continue;
+                }
+
+                const char *spec = format;
+                bool        star;
+                char        conv;
+                format = scan_spec(format + 1, &star, &conv);
+
+                if (conv == '\0') {
+                        break;
+
+                } else if (conv == '%') {
+                        str[n++] = '%';
+                        continue;
+
+                } else if (!strchr("sfFcdiuxXp", conv)) {
+                        continue;
+                }
+
+                char fmt[SPEC_LEN];
+                strlcpy(fmt, spec, min(cast(size_t, format - spec + 1), sizeof(fmt)));
+
+                size_t slots = (star ? 1 : 0) + ((conv == 'f' || conv == 'F') ? 2 : 1);
+                if (argc + slots > rec->argc) {
+                        break;
+                }
+
+                int width = star ? cast(int, rec->arg[argc++]) : 0;
+                int wr    = 0;
+
+                if (conv == 's') {
+                        const char *s = &rec->str[rec->arg[argc++]];
+                        wr = star ? _snprintf(&str[n], len - n, fmt, width, s)
+                                  : _snprintf(&str[n], len - n, fmt, s);
+
+                } else if (conv == 'f' || conv == 'F') {
+                        double val;
+                        memcpy(&val, &rec->arg[argc], sizeof(double));
+                        argc += 2;
+                        wr = star ? _snprintf(&str[n], len - n, fmt, width, val)
+                                  : _snprintf(&str[n], len - n, fmt, val);
+
+                } else {
+                        int val = rec->arg[argc++];
+                        wr = star ? _snprintf(&str[n], len - n, fmt, width, val)
+                                  : _snprintf(&str[n], len - n, fmt, val);
+                }
+
+                n += max(wr, 0);
+        }
+
+        str[min(n, len - 1)] = '\0';
+
+        return n;
 }
 
 #endif
@@ -30,6 +30,7 @@
   Include files
 ==============================================================================*/
 #include <stdlib.h>
+#include <stdio.h>
 #include <errno.h>
 #include <string.h>
 #include <unistd.h>
@@ -51,7 +52,6 @@
 ==============================================================================*/
 #define USERSPACE
 #define KERNELSPACE
-#define foreach_resource(_v, _l)        for (res_header_t *_v = _l; _v; _v = _v->next)
 #define foreach_process(_v, _l)         for (_process_t *_v = _l; _v; _v = cast(_process_t*, _v->header.next))
 
 #define SHEBANGLEN                      64
@@ -60,6 +60,17 @@
 #define ATOMIC for (int __ = 0; __ == 0;)\
         for (int _e = _mutex_lock(process_mtx, MAX_DELAY_MS); _e == 0 && __ == 0; _mutex_unlock(process_mtx), __++)
 
+// critical section of process resource list
+#define RES_ATOMIC(proc) for (int __ = 0; __ == 0;)\
+        for (int _e = _mutex_lock((proc)->res_mtx, MAX_DELAY_MS); _e == 0 && __ == 0; _mutex_unlock((proc)->res_mtx), __++)
+
+// critical section of process threads destroy: used inside ATOMIC, does not
+// wait for direct syscalls (the lock order is opposite), caller tries again
+#define SYSCALL_ATOMIC(proc) for (int __ = 0; __ == 0;)\
+        for (int _e = _mutex_lock((proc)->syscall_mtx, 0); _e == 0 && __ == 0; _mutex_unlock((proc)->syscall_mtx), __++)
+
+#define SYSCALL_RETRY_DELAY_MS          1
+
 #define PROC_MAX_THREADS(proc)          (((proc)->flag & FLAG_KWORKER) ? __OS_TASK_MAX_SYSTEM_THREADS__ : __OS_TASK_MAX_USER_THREADS__)
 
 #define is_proc_valid(proc)             (proc && proc->header.type == RES_TYPE_PROCESS)
@@ -73,6 +84,17 @@
 ==============================================================================*/
 typedef struct _prog_data pdata_t;
 
+typedef struct {
+        size_t           memory_usage;  //!< memory usage (allocated blocks)
+        u16_t            memory_blocks; //!< number of memory blocks
+        u16_t            files;         //!< number of opened files
+        u16_t            dirs;          //!< number of opened directories
+        u16_t            mutexes;       //!< number of mutexes
+        u16_t            semaphores;    //!< number of semaphores and flags
+        u16_t            queues;        //!< number of queues
+        u16_t            sockets;       //!< number of sockets
+} res_stat_t;
+
 struct _process {
         res_header_t     header;        //!< resource header
         task_t          **task;         //!< process tasks
@@ -82,6 +104,11 @@ struct _process {
         FILE            *f_stderr;      //!< stderr file
         void            *globals;       //!< address to global variables
         res_header_t    *res_list;      //!< list of used resources
+        mutex_t         *res_mtx;       //!< resource list protection
+        mutex_t         *syscall_mtx;   //!< direct syscall protection
+        res_stat_t       res_stat;      //!< resource counters
+        void            *arena;         //!< user heap arena (libc)
+        void            *stdio;         //!< stream buffers (libc)
         char            *cwd;           //!< current working path
         const pdata_t   *pdata;         //!< program data
         char            **argv;         //!< program arguments
@@ -106,6 +133,8 @@ static void process_code(void *mainfn);
 static void thread_code(void *args);
 static void process_destroy_all_resources(_process_t *proc);
 static int  resource_destroy(res_header_t *resource);
+static void resource_stat_update(_process_t *proc, res_header_t *resource, int n);
+static void process_free(_process_t *proc);
 static int  argtab_create(const char *str, u8_t *argc, char **argv[]);
 static void argtab_destroy(char **argv);
 static int  find_program(const char *name, const struct _prog_data **prog);
@@ -193,6 +222,12 @@ KERNELSPACE int _process_create(const char *cmd, const process_attr_t *attr, pid
         if (!err) {
                 proc->header.type = RES_TYPE_PROCESS;
 
+                err = _mutex_create(MUTEX_TYPE_NORMAL, &proc->res_mtx);
+                if (err) goto finish;
+
+                err = _mutex_create(MUTEX_TYPE_NORMAL, &proc->syscall_mtx);
+                if (err) goto finish;
+
                 err = process_apply_attributes(proc, attr);
                 if (err) goto finish;
 
@@ -278,7 +313,7 @@ KERNELSPACE int _process_create(const char *cmd, const process_attr_t *attr, pid
 
                 if (proc) {
                         process_destroy_all_resources(proc);
-                        _kfree(_MM_KRN, cast(void**, &proc));
+                        process_free(proc);
                 }
         }
 
@@ -305,9 +340,7 @@ KERNELSPACE void _process_clean_up_killed_processes(void)
                                                   &zombie_process_list);
                         } else {
                                 destroy_process_list = cast(_process_t *, proc->header.next);
-                                _flag_destroy(proc->event);
-                                proc->event = NULL;
-                                _kfree(_MM_KRN, cast(void*, &proc));
+                                process_free(proc);
                         }
                 }
         }
@@ -325,32 +358,45 @@ KERNELSPACE void _process_clean_up_killed_processes(void)
 //==============================================================================
 KERNELSPACE int _process_kill(pid_t pid)
 {
-        int err = ESRCH;
+        int err = EAGAIN;
 
-        ATOMIC {
-                foreach_process(proc, active_process_list) {
-                        if (proc->pid == pid) {
-                                if (proc->event) {
-                                        _flag_set(proc->event, _PROCESS_EXIT_FLAG(0));
-                                }
+        while (err == EAGAIN) {
+                err = ESRCH;
 
-                                u8_t threads = PROC_MAX_THREADS(proc);
+                ATOMIC {
+                        foreach_process(proc, active_process_list) {
+                                if (proc->pid == pid) {
+                                        err = EAGAIN;
 
-                                for (int i = 0; i < threads; i++) {
-                                        if (proc->task[i]) {
-                                                _task_destroy(proc->task[i]);
-                                                proc->task[i] = NULL;
-                                        }
-                                }
+                                        SYSCALL_ATOMIC(proc) {
+                                                if (proc->event) {
+                                                        _flag_set(proc->event, _PROCESS_EXIT_FLAG(0));
+                                                }
 
-                                process_move_list(proc,
-                                                  &active_process_list,
-                                                  &destroy_process_list);
+                                                u8_t threads = PROC_MAX_THREADS(proc);
 
-                                err = ESUCC;
-                                break;
+                                                for (int i = 0; i < threads; i++) {
+                                                        if (proc->task[i]) {
+                                                                _task_destroy(proc->task[i]);
+                                                                proc->task[i] = NULL;
+                                                        }
+                                                }
+
+                                                process_move_list(proc,
+                                                                  &active_process_list,
+                                                                  &destroy_process_list);
+
+                                                err = ESUCC;
+                                        }
+
+                                        break;
+                                }
                         }
                 }
+
+                if (err == EAGAIN) {
+                        _sleep_ms(SYSCALL_RETRY_DELAY_MS);
+                }
         }
 
         return err;
@@ -384,8 +430,7 @@ KERNELSPACE void _process_remove_zombie(_process_t *proc, int *status)
                                         *status = proc->status;
                                 }
 
-                                _flag_destroy(proc->event);
-                                _kfree(_MM_KRN, cast(void*, &proc));
+                                process_free(proc);
 
                                 break;
                         } else {
@@ -409,6 +454,9 @@ KERNELSPACE void _process_exit(_process_t *proc, int status)
         if (is_proc_valid(proc)) {
                 proc->status = status;
 
+                // function is called by process main thread, stream buffers are written
+                fflush(NULL);
+
                 va_list none;
                 if (proc->f_stdin) {
                         _vfs_vfioctl(proc->f_stdin, IOCTL_VFS__DEFAULT_RD_MODE, none);
@@ -425,23 +473,35 @@ KERNELSPACE void _process_exit(_process_t *proc, int status)
                         _vfs_vfioctl(proc->f_stderr, IOCTL_VFS__DEFAULT_WR_MODE, none);
                 }
 
-                ATOMIC {
-                        if (proc->event) {
-                                _flag_set(proc->event, _PROCESS_EXIT_FLAG(0));
-                        }
+                bool exited = false;
+
+                while (!exited) {
+                        ATOMIC {
+                                SYSCALL_ATOMIC(proc) {
+                                        if (proc->event) {
+                                                _flag_set(proc->event, _PROCESS_EXIT_FLAG(0));
+                                        }
+
+                                        u8_t threads = PROC_MAX_THREADS(proc);
+
+                                        for (int i = 1; i < threads; i++) {
+                                                if (proc->task[i]) {
+                                                        _task_destroy(proc->task[i]);
+                                                        proc->task[i] = NULL;
+                                                }
+                                        }
 
-                        u8_t threads = PROC_MAX_THREADS(proc);
+                                        process_move_list(proc, &active_process_list, &destroy_process_list);
 
-                        for (int i = 1; i < threads; i++) {
-                                if (proc->task[i]) {
-                                        _task_destroy(proc->task[i]);
-                                        proc->task[i] = NULL;
+                                        proc->task[0] = NULL;
+
+                                        exited = true;
                                 }
                         }
 
-                        process_move_list(proc, &active_process_list, &destroy_process_list);
-
-                        proc->task[0] = NULL;
+                        if (!exited) {
+                                _sleep_ms(SYSCALL_RETRY_DELAY_MS);
+                        }
                 }
 
                 _task_exit();
@@ -889,20 +949,29 @@ u8_t _process_get_max_threads(_process_t *proc)
 //==============================================================================
 KERNELSPACE int _process_register_resource(_process_t *proc, res_header_t *resource)
 {
+        int err = ESRCH;
+
         if (is_proc_valid(proc)) {
-                ATOMIC {
-                        if (proc->res_list == NULL) {
-                                proc->res_list = resource;
-                        } else {
-                                resource->next = proc->res_list;
-                                proc->res_list = resource;
+                err = ETIME;
+
+                RES_ATOMIC(proc) {
+                        resource->owner = proc;
+                        resource->prev  = NULL;
+                        resource->next  = proc->res_list;
+
+                        if (proc->res_list) {
+                                proc->res_list->prev = resource;
                         }
-                }
 
-                return ESUCC;
-        } else {
-                return ESRCH;
+                        proc->res_list = resource;
+
+                        resource_stat_update(proc, resource, 1);
+
+                        err = ESUCC;
+                }
         }
+
+        return err;
 }
 
 //==============================================================================
@@ -924,33 +993,35 @@ KERNELSPACE int _process_release_resource(_process_t *proc, res_header_t *resour
                 err = ENOENT;
                 res_header_t *obj_to_destroy = NULL;
 
-                ATOMIC {
-                        res_header_t *prev     = NULL;
-                        int           max_deep = 1024;
-
-                        foreach_resource(curr, proc->res_list) {
-                                if (curr == resource) {
-                                        if (curr->type == type) {
-                                                if (proc->res_list == curr) {
-                                                        proc->res_list = proc->res_list->next;
-                                                } else {
-                                                        prev->next = curr->next;
-                                                }
-
-                                                obj_to_destroy = curr;
+                RES_ATOMIC(proc) {
+                        // owner is checked first, neighbours of foreign object are not touched
+                        bool linked = resource
+                                   && resource->owner == proc
+                                   && (resource->prev ? resource->prev->next == resource
+                                                      : proc->res_list == resource)
+                                   && (resource->next ? resource->next->prev == resource
+                                                      : true);
+                        if (linked) {
+                                if (resource->type == type) {
+                                        if (resource->prev) {
+                                                resource->prev->next = resource->next;
                                         } else {
-                                                err = EFAULT;
+                                                proc->res_list = resource->next;
                                         }
 
-                                        break;
-                                } else {
+                                        if (resource->next) {
+                                                resource->next->prev = resource->prev;
+                                        }
 
-                                        prev = curr;
+                                        resource->next  = NULL;
+                                        resource->prev  = NULL;
+                                        resource->owner = NULL;
 
-                                        if (--max_deep == 0) {
-                                                _assert(max_deep > 0);
-                                                _kernel_panic_report(_KERNEL_PANIC_DESC_CAUSE_INTERNAL);
-                                        }
+                                        resource_stat_update(proc, resource, -1);
+
+                                        obj_to_destroy = resource;
+                                } else {
+                                        err = EFAULT;
                                 }
                         }
                 }
@@ -966,6 +1037,92 @@ KERNELSPACE int _process_release_resource(_process_t *proc, res_header_t *resour
         return err;
 }
 
+//==============================================================================
+/**
+ * @brief  Function return user heap arena of selected process.
+ *
+ * @param  proc         process container
+ *
+ * @return Arena object or NULL if arena is not created.
+ */
+//==============================================================================
+USERSPACE void *_process_get_arena(_process_t *proc)
+{
+        return is_proc_valid(proc) ? proc->arena : NULL;
+}
+
+//==============================================================================
+/**
+ * @brief  Function set user heap arena of selected process. Arena can be set
+ *         only once, arena memory must be a resource of process.
+ *
+ * @param  proc         process container
+ * @param  arena        arena object
+ *
+ * @return One of errno value (EEXIST if arena is already set).
+ */
+//==============================================================================
+USERSPACE int _process_set_arena(_process_t *proc, void *arena)
+{
+        int err = ESRCH;
+
+        if (is_proc_valid(proc)) {
+                RES_ATOMIC(proc) {
+                        if (proc->arena == NULL) {
+                                proc->arena = arena;
+                                err = ESUCC;
+                        } else {
+                                err = EEXIST;
+                        }
+                }
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return stream buffers of selected process.
+ *
+ * @param  proc         process container
+ *
+ * @return Stream buffers object or NULL if object is not created.
+ */
+//==============================================================================
+USERSPACE void *_process_get_stdio(_process_t *proc)
+{
+        return is_proc_valid(proc) ? proc->stdio : NULL;
+}
+
+//==============================================================================
+/**
+ * @brief  Function set stream buffers object of selected process. Object can
+ *         be set only once, object memory must be a resource of process.
+ *
+ * @param  proc         process container
+ * @param  stdio        stream buffers object
+ *
+ * @return One of errno value (EEXIST if object is already set).
+ */
+//==============================================================================
+USERSPACE int _process_set_stdio(_process_t *proc, void *stdio)
+{
+        int err = ESRCH;
+
+        if (is_proc_valid(proc)) {
+                RES_ATOMIC(proc) {
+                        if (proc->stdio == NULL) {
+                                proc->stdio = stdio;
+                                err = ESUCC;
+                        } else {
+                                err = EEXIST;
+                        }
+                }
+        }
+
+        return err;
+}
+
 //==============================================================================
 /**
  * @brief  Function create a new thread for selected process.
@@ -1054,15 +1211,23 @@ KERNELSPACE int _process_thread_kill(_process_t *proc, tid_t tid)
         int err = EINVAL;
 
         if (is_proc_valid(proc) && is_tid_in_range(proc, tid)) {
-                ATOMIC {
-                        _task_destroy(proc->task[tid]);
-                        proc->task[tid] = NULL;
+                while (err == EINVAL) {
+                        ATOMIC {
+                                SYSCALL_ATOMIC(proc) {
+                                        _task_destroy(proc->task[tid]);
+                                        proc->task[tid] = NULL;
 
-                        if (proc->event) {
-                                _flag_set(proc->event, _PROCESS_EXIT_FLAG(tid));
+                                        if (proc->event) {
+                                                _flag_set(proc->event, _PROCESS_EXIT_FLAG(tid));
+                                        }
+
+                                        err = ESUCC;
+                                }
                         }
 
-                        err = ESUCC;
+                        if (err == EINVAL) {
+                                _sleep_ms(SYSCALL_RETRY_DELAY_MS);
+                        }
                 }
         }
 
@@ -1093,6 +1258,34 @@ KERNELSPACE task_t *_process_thread_get_task(_process_t *proc, tid_t tid)
 
 }
 
+//==============================================================================
+/**
+ * @brief  Function lock threads destroy of selected process. When locked then
+ *         no thread of the process can be killed or finished, so calling
+ *         thread can execute kernel code in own context (direct syscall)
+ *         without risk that will be destroyed in the middle of operation.
+ *         Other processes are not locked.
+ *
+ * @param  proc         process (caller)
+ */
+//==============================================================================
+KERNELSPACE void _process_syscall_lock(_process_t *proc)
+{
+        _mutex_lock(proc->syscall_mtx, MAX_DELAY_MS);
+}
+
+//==============================================================================
+/**
+ * @brief  Function unlock threads destroy locked by _process_syscall_lock().
+ *
+ * @param  proc         process (caller)
+ */
+//==============================================================================
+KERNELSPACE void _process_syscall_unlock(_process_t *proc)
+{
+        _mutex_unlock(proc->syscall_mtx);
+}
+
 //==============================================================================
 /**
  * @brief  Function return process container and thread ID associated with task.
@@ -1311,9 +1504,19 @@ static void process_destroy_all_resources(_process_t *proc)
         }
 
         // free all resources
-        while (proc->res_list) {
-                res_header_t *resource = proc->res_list;
-                proc->res_list = resource->next;
+        res_header_t *res_list = NULL;
+
+        RES_ATOMIC(proc) {
+                res_list       = proc->res_list;
+                proc->res_list = NULL;
+                proc->arena    = NULL;
+                proc->stdio    = NULL;
+                memset(&proc->res_stat, 0, sizeof(res_stat_t));
+        }
+
+        while (res_list) {
+                res_header_t *resource = res_list;
+                res_list = resource->next;
 
                 int err = resource_destroy(resource);
                 if (err != ESUCC) {
@@ -1349,15 +1552,23 @@ static void process_get_stat(_process_t *proc, process_stat_t *stat)
 {
         memset(stat, 0, sizeof(process_stat_t));
 
+        RES_ATOMIC(proc) {
+                stat->memory_usage       = proc->res_stat.memory_usage;
+                stat->memory_block_count = proc->res_stat.memory_blocks;
+                stat->files_count        = proc->res_stat.files;
+                stat->dir_count          = proc->res_stat.dirs;
+                stat->mutexes_count      = proc->res_stat.mutexes;
+                stat->semaphores_count   = proc->res_stat.semaphores;
+                stat->queue_count        = proc->res_stat.queues;
+                stat->socket_count       = proc->res_stat.sockets;
+        }
+
         stat->name            = proc->pdata->name;
         stat->pid             = proc->pid;
         stat->stack_size      = proc->task[0] ? *proc->pdata->stack_depth : 0;
         stat->stack_max_usage = proc->task[0] ? (stat->stack_size - _task_get_free_stack(proc->task[0])) : 0;
         stat->priority        = proc->task[0] ? _task_get_priority(proc->task[0]) : 0;
         stat->CPU_load        = proc->CPU_load;
-        stat->memory_usage    = 0;
-        stat->threads_count   = 0;
-        stat->socket_count    = 0;
         stat->threads_count   = 0;
 
         u8_t threads = PROC_MAX_THREADS(proc);
@@ -1367,39 +1578,6 @@ static void process_get_stat(_process_t *proc, process_stat_t *stat)
                 }
         }
 
-        foreach_resource(res, proc->res_list) {
-                switch (res->type) {
-                case RES_TYPE_FILE:
-                        stat->files_count++;
-                        break;
-
-                case RES_TYPE_DIR:
-                        stat->dir_count++;
-                        break;
-
-                case RES_TYPE_MUTEX:
-                        stat->mutexes_count++;
-                        break;
-
-                case RES_TYPE_QUEUE:
-                        stat->queue_count++;
-                        break;
-
-                case RES_TYPE_FLAG:
-                case RES_TYPE_SEMAPHORE:
-                        stat->semaphores_count++;
-                        break;
-
-                case RES_TYPE_MEMORY:
-                        stat->memory_block_count++;
-                        stat->memory_usage += _mm_get_block_size(res);
-                        break;
-
-                default:
-                        break;
-                }
-        }
-
         stat->memory_usage = _mm_align(stat->memory_usage);
 }
 
@@ -1637,6 +1815,86 @@ static int resource_destroy(res_header_t *resource)
         return ESUCC;
 }
 
+//==============================================================================
+/**
+ * @brief  Function update resource counters of process. Function must be called
+ *         in resource list critical section.
+ *
+ * @param  proc         process
+ * @param  resource     registered or released resource
+ * @param  n            1 if resource is registered, -1 if released
+ */
+//==============================================================================
+static void resource_stat_update(_process_t *proc, res_header_t *resource, int n)
+{
+        res_stat_t *rs = &proc->res_stat;
+
+        switch (resource->type) {
+        case RES_TYPE_FILE:
+                rs->files += n;
+                break;
+
+        case RES_TYPE_DIR:
+                rs->dirs += n;
+                break;
+
+        case RES_TYPE_MUTEX:
+                rs->mutexes += n;
+                break;
+
+        case RES_TYPE_QUEUE:
+                rs->queues += n;
+                break;
+
+        case RES_TYPE_FLAG:
+        case RES_TYPE_SEMAPHORE:
+                rs->semaphores += n;
+                break;
+
+        case RES_TYPE_SOCKET:
+                rs->sockets += n;
+                break;
+
+        case RES_TYPE_MEMORY:
+                rs->memory_blocks += n;
+                rs->memory_usage  += n * cast(int, _mm_get_block_size(resource));
+                break;
+
+        default:
+                break;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Function free process object. Process resources must be destroyed
+ *         before.
+ *
+ * @param  proc         process to free
+ */
+//==============================================================================
+static void process_free(_process_t *proc)
+{
+        if (proc->event) {
+                _flag_destroy(proc->event);
+                proc->event = NULL;
+        }
+
+        if (proc->res_mtx) {
+                _mutex_destroy(proc->res_mtx);
+                proc->res_mtx = NULL;
+        }
+
+        if (proc->syscall_mtx) {
+                _mutex_destroy(proc->syscall_mtx);
+                proc->syscall_mtx = NULL;
+        }
+
+        proc->header.type = RES_TYPE_UNKNOWN;
+
+        _kfree(_MM_KRN, cast(void*, &proc));
+}
+
 //==============================================================================
 /**
  * @brief  Function check if first command argument is a path.
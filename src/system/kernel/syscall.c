@@ -49,12 +49,24 @@
 #include "mm/shm.h"
 #include "mm/cache.h"
 #include "dnx/misc.h"
+#include "portable/cpuctl.h"
 
 /*==============================================================================
   Local macros
 ==============================================================================*/
 #define SYSCALL_QUEUE_LENGTH            4
 
+#if __OS_TASK_KWORKER_MODE__ == 0
+#define IO_THREADS_MIN                  min(__OS_TASK_KWORKER_IO_THREADS__, __OS_TASK_MAX_SYSTEM_THREADS__ - 1)
+#define IO_THREADS_MAX                  (__OS_TASK_MAX_SYSTEM_THREADS__ - 1)
+#define IO_THREAD_IDLE_TIMEOUT          __OS_TASK_KWORKER_IDLE_TIME__
+#define IO_DISPATCH_RETRY_MS            10
+#else
+#define IO_THREADS_MIN                  min(__OS_TASK_KWORKER_IO_THREADS__, __OS_TASK_MAX_SYSTEM_THREADS__ - 1)
+#define IO_THREADS_MAX                  IO_THREADS_MIN
+#define IO_THREAD_IDLE_TIMEOUT          MAX_DELAY_MS
+#endif
+
 #if __OS_SYSTEM_FS_CACHE_ENABLE__ > 0
 #define SYNC_PERIOD_MS                  (1000 * __OS_SYSTEM_CACHE_SYNC_PERIOD__)
 #else
@@ -78,13 +90,17 @@
 /*==============================================================================
   Local object types
 ==============================================================================*/
-typedef struct {
+typedef struct syscallrq {
         void       *retptr;
         _process_t *client_proc;
         tid_t       client_thread;
         syscall_t   syscall_no;
         va_list     args;
         int         err;
+        bool        direct;     // executed in the caller's context
+        bool        deferred;   // direct call must be repeated by kworker
+        u32_t       queued;     // time of passing request to kworker [us]
+        struct syscallrq *next; // next request waiting for free I/O queue slot
 } syscallrq_t;
 
 typedef void (*syscallfunc_t)(syscallrq_t*);
@@ -93,8 +109,17 @@ typedef void (*syscallfunc_t)(syscallrq_t*);
   Local function prototypes
 ==============================================================================*/
 static void syscall_do(void *rq);
-#if __OS_TASK_KWORKER_MODE__ == 1
-static void syscall_RTR(void *rq_queue);
+static void syscall_do_direct(syscallrq_t *rq);
+static void syscall_do_queued(syscallrq_t *rq);
+static void syscall_kill_client(syscallrq_t *rq, const char *msg);
+static void syscall_io_thread(void *arg);
+static int  io_thread_create(void);
+#if __OS_TASK_KWORKER_MODE__ == 0
+static void io_thread_dispatch(syscallrq_t *rq);
+static void io_thread_flush(void);
+#endif
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+static void syscall_stat_update(syscall_t syscall, bool direct, u32_t time_us);
 #endif
 
 
@@ -209,6 +234,14 @@ static void syscall_shmdestroy(syscallrq_t *rq);
 ==============================================================================*/
 #if __OS_TASK_KWORKER_MODE__ == 0
 static queue_t *call_request;
+static queue_t *call_blocking;
+
+/* blocking requests that not fit to I/O queue (used by kworker thread only) */
+static struct {
+        syscallrq_t *head;
+        syscallrq_t *tail;
+        size_t       count;
+} io_pending;
 #elif __OS_TASK_KWORKER_MODE__ == 1
 static queue_t *call_nonblocking;
 static queue_t *call_blocking;
@@ -216,6 +249,26 @@ static queue_t *call_blocking;
 #error __OS_TASK_KWORKER_MODE__: unknown mode
 #endif
 
+static const thread_attr_t io_thread_attr = {
+        .stack_depth = STACK_DEPTH_CUSTOM(__OS_IO_STACK_DEPTH__),
+        .priority    = PRIORITY_NORMAL,
+        .detached    = true
+};
+
+/* kworker I/O thread pool state and statistics */
+static struct {
+        int                            threads;
+        int                            idle;
+        size_t                         queue_depth_max;
+        u32_t                          created;
+        u32_t                          busy_us[__OS_TASK_MAX_SYSTEM_THREADS__];
+        _syscall_kworker_thread_stat_t thread[__OS_TASK_MAX_SYSTEM_THREADS__];
+} kworker;
+
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+static _syscall_stat_t syscall_latency[_SYSCALL_COUNT];
+#endif
+
 /* syscall table */
 static const syscallfunc_t syscalltab[] = {
         [SYSCALL_MOUNT ] = syscall_mount,
@@ -368,6 +421,9 @@ int _syscall_init()
         catcherr(err = _queue_create(SYSCALL_QUEUE_LENGTH, sizeof(syscallrq_t*),
                                      &call_request), exit);
 
+        catcherr(err = _queue_create(SYSCALL_QUEUE_LENGTH, sizeof(syscallrq_t*),
+                                     &call_blocking), exit);
+
 #elif __OS_TASK_KWORKER_MODE__ == 1
         catcherr(err = _queue_create(SYSCALL_QUEUE_LENGTH, sizeof(syscallrq_t*),
                                      &call_nonblocking), exit);
@@ -386,7 +442,9 @@ int _syscall_init()
 
 //==============================================================================
 /**
- * @brief  Function call selected syscall [USERSPACE].
+ * @brief  Function call selected syscall [USERSPACE]. Syscalls of direct
+ *         group are executed in the caller's context, other syscalls are
+ *         realized by kworker.
  *
  * @param  syscall      syscall number
  * @param  retptr       pointer to return value
@@ -396,72 +454,120 @@ int _syscall_init()
 void syscall(syscall_t syscall, void *retptr, ...)
 {
         if (syscall < _SYSCALL_COUNT) {
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+                u32_t tref = _cpuctl_get_time_us();
+#endif
                 _process_t *proc; tid_t tid;
                 _task_get_process_container(_THIS_TASK, &proc, &tid);
 
                 _assert(proc);
                 _assert(is_tid_in_range(proc, tid));
 
-                flag_t *event_flags = NULL;
-                _errno = _process_get_event_flags(proc, &event_flags);
-                _assert(event_flags);
+                syscallrq_t syscallrq = {
+                        .syscall_no     = syscall,
+                        .client_proc    = proc,
+                        .client_thread  = tid,
+                        .retptr         = retptr,
+                        .err            = ESUCC,
+                        .direct         = (syscall <= _SYSCALL_GROUP_DIRECT),
+                        .deferred       = false
+                };
+
+                if (syscallrq.direct) {
+                        va_start(syscallrq.args, retptr);
+                        syscall_do_direct(&syscallrq);
+                        va_end(syscallrq.args);
 
-                if (!_errno && event_flags) {
+                        _errno = syscallrq.err;
+                }
 
-                        syscallrq_t syscallrq = {
-                                .syscall_no     = syscall,
-                                .client_proc    = proc,
-                                .client_thread  = tid,
-                                .retptr         = retptr,
-                                .err            = ESUCC
-                        };
+                if (!syscallrq.direct || syscallrq.deferred) {
+                        syscallrq.direct = false;
+                        syscallrq.err    = ESUCC;
 
                         va_start(syscallrq.args, retptr);
-                        {
-                                syscallrq_t *syscallrq_ptr = &syscallrq;
-                                queue_t     *call_rq       = NULL;
+                        syscall_do_queued(&syscallrq);
+                        va_end(syscallrq.args);
+                }
+
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+                syscall_stat_update(syscall, syscallrq.direct,
+                                    _cpuctl_get_time_us() - tref);
+#endif
+        } else {
+                _errno = ENOSYS;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Function realize syscall in the caller's context [USERSPACE].
+ *         Threads destroy of the caller process is locked during syscall so
+ *         caller cannot be killed in the middle of operation. Other processes
+ *         are not locked. If syscall cannot be finished directly then request
+ *         is marked as deferred and is passed to kworker.
+ *
+ * @param  rq           request information
+ */
+//==============================================================================
+static void syscall_do_direct(syscallrq_t *rq)
+{
+        _process_syscall_lock(rq->client_proc);
+        syscalltab[rq->syscall_no](rq);
+        _process_syscall_unlock(rq->client_proc);
+}
+
+//==============================================================================
+/**
+ * @brief  Function pass syscall to kworker and wait for result [USERSPACE].
+ *
+ * @param  rq           request information
+ */
+//==============================================================================
+static void syscall_do_queued(syscallrq_t *rq)
+{
+        flag_t *event_flags = NULL;
+        _errno = _process_get_event_flags(rq->client_proc, &event_flags);
+        _assert(event_flags);
+
+        if (!_errno && event_flags) {
+                queue_t *call_rq = NULL;
 
 #if __OS_TASK_KWORKER_MODE__ == 0
-                                call_rq = call_request;
+                call_rq = call_request;
 #elif __OS_TASK_KWORKER_MODE__ == 1
-                                if (syscall <= _SYSCALL_GROUP_0_OS_NON_BLOCKING) {
-                                        call_rq = call_nonblocking;
+                if (rq->syscall_no <= _SYSCALL_GROUP_0_OS_NON_BLOCKING) {
+                        call_rq = call_nonblocking;
 
-                                } else if (syscall <= _SYSCALL_GROUP_1_BLOCKING) {
-                                        call_rq = call_blocking;
+                } else if (rq->syscall_no <= _SYSCALL_GROUP_1_BLOCKING) {
+                        call_rq = call_blocking;
 
-                                } else {
-                                        _errno = ENOSYS;
-                                        va_end(syscallrq.args);
-                                        return;
-                                }
+                } else {
+                        _errno = ENOSYS;
+                        return;
+                }
 #endif
 
-                                while (true) {
-                                        if (_queue_send(call_rq,
-                                                        &syscallrq_ptr,
-                                                        2000) == ESUCC) {
+                rq->queued = _cpuctl_get_time_us();
 
-                                                if (_flag_wait(event_flags,
-                                                               _PROCESS_SYSCALL_FLAG(tid),
-                                                               MAX_DELAY_MS) == ESUCC) {
+                while (true) {
+                        if (_queue_send(call_rq, &rq, 2000) == ESUCC) {
 
-                                                        if (syscallrq.err) {
-                                                                _errno = syscallrq.err;
-                                                        }
-                                                }
+                                if (_flag_wait(event_flags,
+                                               _PROCESS_SYSCALL_FLAG(rq->client_thread),
+                                               MAX_DELAY_MS) == ESUCC) {
 
-                                                break;
-                                        } else {
-                                                _printk("syscall: busy timeout");
-                                                _assert_msg(false, "Probably started to less I/O threads");
+                                        if (rq->err) {
+                                                _errno = rq->err;
                                         }
                                 }
+
+                                break;
+                        } else {
+                                _printk("syscall: busy timeout");
+                                _assert_msg(false, "Probably started to less I/O threads");
                         }
-                        va_end(syscallrq.args);
                 }
-        } else {
-                _errno = ENOSYS;
         }
 }
 
@@ -479,39 +585,23 @@ int _syscall_kworker_process(int argc, char *argv[])
 {
         UNUSED_ARG2(argc, argv);
 
-        static const thread_attr_t blocking_thread_attr = {
-                .stack_depth = STACK_DEPTH_CUSTOM(__OS_IO_STACK_DEPTH__),
-                .priority    = PRIORITY_NORMAL,
-                .detached    = true
-        };
-
         _task_get_process_container(_THIS_TASK, &_kworker_proc, NULL);
         _assert(_kworker_proc);
 
-#if __OS_TASK_KWORKER_MODE__ == 1
-        int iothrs_created = 0;
-
-        for (int i = 0;
-                (i < __OS_TASK_KWORKER_IO_THREADS__)
-             && (i < __OS_TASK_MAX_SYSTEM_THREADS__ - 1); i++) {
+        kworker.thread[0].active = true;
 
-                int err = _process_thread_create(_kworker_proc,
-                                                 syscall_RTR,
-                                                 &blocking_thread_attr,
-                                                 call_blocking,
-                                                 NULL);
+        int iothrs_created = 0;
 
-                if (err) {
-                        _assert_msg(false, "Fail in creating Ready-To-Run thread");
+        for (int i = 0; i < IO_THREADS_MIN; i++) {
+                if (io_thread_create() != ESUCC) {
+                        _assert_msg(false, "Fail in creating I/O thread");
                         break;
                 }
 
                 iothrs_created++;
         }
 
-        _printk("Created %d/%d Ready-To-Run IO threads",
-                iothrs_created, __OS_TASK_KWORKER_IO_THREADS__);
-#endif
+        _printk("Created %d/%d I/O threads", iothrs_created, IO_THREADS_MIN);
 
 #if __OS_SYSTEM_FS_CACHE_ENABLE__ > 0
         u32_t sync_period_ref = _kernel_get_time_ms();
@@ -521,40 +611,20 @@ int _syscall_kworker_process(int argc, char *argv[])
 
         for (;;) {
 #if __OS_TASK_KWORKER_MODE__ == 0
-                if (_queue_receive(call_request, &sysrq, SYNC_PERIOD_MS) == ESUCC) {
+                u32_t timeout = io_pending.head ? IO_DISPATCH_RETRY_MS : SYNC_PERIOD_MS;
+
+                if (_queue_receive(call_request, &sysrq, timeout) == ESUCC) {
 
                         _process_clean_up_killed_processes();
 
                         if (sysrq->syscall_no <= _SYSCALL_GROUP_0_OS_NON_BLOCKING) {
                                 syscall_do(sysrq);
                         } else {
-                                _kernel_release_resources();
-
-                                /* create new syscall task */
-                                switch (_process_thread_create(_kworker_proc,
-                                                               syscall_do,
-                                                               &blocking_thread_attr,
-                                                               sysrq, NULL) ) {
-                                case ESUCC:
-                                        _task_yield();
-                                        break;
-
-                                // destroy top process to get free memory
-                                case ENOMEM:
-                                        _assert_msg(false, "no free memory");
-                                        _process_clean_up_killed_processes();
-                                        _kernel_release_resources();
-                                        _vfs_sync();
-                                        _cache_sync();
-                                        // go through
-
-                                default:
-                                        _queue_send(call_request, &sysrq, MAX_DELAY_MS);
-                                        _sleep_ms(5);
-                                        break;
-                                }
+                                io_thread_dispatch(sysrq);
                         }
                 }
+
+                io_thread_flush();
 #elif __OS_TASK_KWORKER_MODE__ == 1
                 if (_queue_receive(call_nonblocking, &sysrq, SYNC_PERIOD_MS) == ESUCC) {
                         _process_clean_up_killed_processes();
@@ -587,6 +657,9 @@ static void syscall_do(void *rq)
         tid_t tid = _process_get_active_thread();
         _assert(is_tid_in_range(_process_get_active(), tid));
 
+        u32_t start = _cpuctl_get_time_us();
+        u32_t wait  = start - sysrq->queued;
+
         flag_t *flags = NULL;
         if (_process_get_event_flags(sysrq->client_proc, &flags) != ESUCC) {
                 _kernel_panic_report(_KERNEL_PANIC_DESC_CAUSE_INTERNAL);
@@ -598,41 +671,333 @@ static void syscall_do(void *rq)
         syscalltab[sysrq->syscall_no](sysrq);
         _syscall_client_PID[tid] = 0;
 
+        bool sync = _cache_is_sync_needed()
+                 && (sysrq->syscall_no <= _SYSCALL_GROUP_1_BLOCKING);
+
+        // request object is not valid after flag set (client's stack)
         if (_flag_set(flags, _PROCESS_SYSCALL_FLAG(sysrq->client_thread)) != ESUCC) {
                 _assert(false);
         }
 
+        u32_t busy = _cpuctl_get_time_us() - start;
+
+        _kernel_scheduler_lock();
+        {
+                _syscall_kworker_thread_stat_t *stat = &kworker.thread[tid];
+
+                stat->requests++;
+                stat->max_wait       = max(stat->max_wait, wait);
+                kworker.busy_us[tid] += busy;
+                stat->busy_time     += kworker.busy_us[tid] / 1000;
+                kworker.busy_us[tid] %= 1000;
+        }
+        _kernel_scheduler_unlock();
+
         // If there is lack of memory and FS sync is required then thread
         // synchronize all file systems to reduce cache size.
-        if (  _cache_is_sync_needed()
-           && sysrq->syscall_no <= _SYSCALL_GROUP_1_BLOCKING) {
-
+        if (sync) {
                 _vfs_sync();
                 _cache_sync();
         }
 }
 
-#if __OS_TASK_KWORKER_MODE__ == 1
 //==============================================================================
 /**
- * @brief  Function handle thread ready-to-run feature.
+ * @brief  Function create new I/O thread. Thread is counted as idle until
+ *         takes first request.
  *
- * @param  rq           request information
+ * @return One of errno value.
+ */
+//==============================================================================
+static int io_thread_create(void)
+{
+        _kernel_scheduler_lock();
+        kworker.threads++;
+        kworker.idle++;
+        _kernel_scheduler_unlock();
+
+        tid_t tid = 0;
+        int   err = _process_thread_create(_kworker_proc, syscall_io_thread,
+                                           &io_thread_attr, NULL, &tid);
+
+        _kernel_scheduler_lock();
+        if (err) {
+                kworker.threads--;
+                kworker.idle--;
+        } else {
+                kworker.created++;
+                kworker.thread[tid].active = true;
+        }
+        _kernel_scheduler_unlock();
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief  I/O thread. Thread realizes blocking syscalls from I/O queue. Thread
+ *         that is idle longer than IO_THREAD_IDLE_TIMEOUT is finished if
+ *         there is more threads than IO_THREADS_MIN.
+ *
+ * @param  arg          not used
  */
 //==============================================================================
-static void syscall_RTR(void *rq_queue)
+static void syscall_io_thread(void *arg)
 {
+        UNUSED_ARG1(arg);
+
+        tid_t tid = _process_get_active_thread();
+
         for (;;) {
                 syscallrq_t *sysrq;
+                size_t       items = 0;
+
+                if (_queue_receive(call_blocking, &sysrq, IO_THREAD_IDLE_TIMEOUT) == ESUCC) {
+                        _queue_get_number_of_items(call_blocking, &items);
+
+                        _kernel_scheduler_lock();
+                        kworker.idle--;
+                        kworker.queue_depth_max = max(kworker.queue_depth_max, items + 1);
+                        _kernel_scheduler_unlock();
 
-                if (_queue_receive(rq_queue, &sysrq, MAX_DELAY_MS) == ESUCC) {
                         _process_clean_up_killed_processes();
                         syscall_do(sysrq);
+
+                        _kernel_scheduler_lock();
+                        kworker.idle++;
+                        _kernel_scheduler_unlock();
+
+                } else {
+                        // queue is checked in the same lock as dispatcher's
+                        // thread count check, so no request can be left alone
+                        bool finish = false;
+
+                        _kernel_scheduler_lock();
+                        _queue_get_number_of_items(call_blocking, &items);
+
+                        if ((items == 0) && (kworker.threads > IO_THREADS_MIN)) {
+                                kworker.threads--;
+                                kworker.idle--;
+                                kworker.thread[tid].active = false;
+                                finish = true;
+                        }
+                        _kernel_scheduler_unlock();
+
+                        if (finish) {
+                                break;
+                        }
+                }
+        }
+}
+
+#if __OS_TASK_KWORKER_MODE__ == 0
+//==============================================================================
+/**
+ * @brief  Function pass blocking syscall to I/O queue. Request is added at the
+ *         end of pending list, so requests are passed to I/O threads in
+ *         arrival order.
+ *
+ * @param  rq           request information
+ */
+//==============================================================================
+static void io_thread_dispatch(syscallrq_t *rq)
+{
+        rq->next = NULL;
+
+        if (io_pending.tail) {
+                io_pending.tail->next = rq;
+        } else {
+                io_pending.head = rq;
+        }
+
+        io_pending.tail = rq;
+        io_pending.count++;
+
+        io_thread_flush();
+}
+
+//==============================================================================
+/**
+ * @brief  Function move pending requests to I/O queue. If there is no idle
+ *         thread for the requests then new I/O thread is created (up to
+ *         IO_THREADS_MAX). Kworker thread never waits for free queue slot.
+ *         Requests that not fit stay pending and are moved in next loop of
+ *         kworker, only clients of these requests wait.
+ */
+//==============================================================================
+static void io_thread_flush(void)
+{
+        while (io_pending.head) {
+                size_t items = 0;
+                bool   spawn = false;
+
+                _kernel_scheduler_lock();
+                _queue_get_number_of_items(call_blocking, &items);
+                spawn = (cast(size_t, max(kworker.idle, 0)) < (items + io_pending.count))
+                     && (kworker.threads < IO_THREADS_MAX);
+                _kernel_scheduler_unlock();
+
+                if (spawn) {
+                        _kernel_release_resources();
+
+                        int err = io_thread_create();
+                        if ((err != ESUCC) && (kworker.threads == 0)) {
+                                // there is no thread to realize request, destroy
+                                // top process to get free memory and try again
+                                _assert_msg(false, "no free memory");
+                                _process_clean_up_killed_processes();
+                                _kernel_release_resources();
+                                _vfs_sync();
+                                _cache_sync();
+                                _sleep_ms(5);
+                                continue;
+                        }
+                }
+
+                if (_queue_send(call_blocking, &io_pending.head, 0) != ESUCC) {
+                        break;
+                }
+
+                io_pending.head = io_pending.head->next;
+                io_pending.count--;
+
+                if (io_pending.head == NULL) {
+                        io_pending.tail = NULL;
                 }
         }
 }
 #endif
 
+//==============================================================================
+/**
+ * @brief  Function print error message on client's stderr and kill client
+ *         process. Client cannot be killed in its own context, so direct
+ *         request is deferred and error is handled again by kworker.
+ *
+ * @param  rq           request information
+ * @param  msg          error message
+ */
+//==============================================================================
+static void syscall_kill_client(syscallrq_t *rq, const char *msg)
+{
+        if (rq->direct) {
+                rq->deferred = true;
+
+        } else {
+                size_t wrcnt;
+                _vfs_fwrite(msg, strlen(msg), &wrcnt, _process_get_stderr(GETPROCESS()));
+
+                pid_t pid = 0;
+                _process_get_pid(GETPROCESS(), &pid);
+                _process_kill(pid);
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Function return statistics of kworker I/O thread pool.
+ *
+ * @param  stat         statistics (result)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _syscall_get_kworker_stat(_syscall_kworker_stat_t *stat)
+{
+        if (stat) {
+                size_t items = 0;
+                _queue_get_number_of_items(call_blocking, &items);
+
+                _kernel_scheduler_lock();
+                stat->threads         = max(kworker.threads, 0);
+                stat->idle            = max(kworker.idle, 0);
+                stat->queue_depth     = items;
+                stat->queue_depth_max = kworker.queue_depth_max;
+                stat->created         = kworker.created;
+                _kernel_scheduler_unlock();
+
+                return ESUCC;
+        } else {
+                return EINVAL;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Function return statistics of selected kworker thread.
+ *
+ * @param  tid          thread ID (0 is the kworker main thread)
+ * @param  stat         statistics (result)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _syscall_get_kworker_thread_stat(tid_t tid, _syscall_kworker_thread_stat_t *stat)
+{
+        if ((tid < __OS_TASK_MAX_SYSTEM_THREADS__) && stat) {
+                _kernel_scheduler_lock();
+                *stat = kworker.thread[tid];
+                _kernel_scheduler_unlock();
+
+                return ESUCC;
+        } else {
+                return EINVAL;
+        }
+}
+
+#if __OS_SYSTEM_SYSCALL_STATISTICS_ENABLE__ > 0
+//==============================================================================
+/**
+ * @brief  Function update latency statistics of selected syscall.
+ *
+ * @param  syscall      syscall number
+ * @param  direct       syscall executed directly
+ * @param  time_us      syscall latency [us]
+ */
+//==============================================================================
+static void syscall_stat_update(syscall_t syscall, bool direct, u32_t time_us)
+{
+        uint bucket = 0;
+        for (u32_t limit = 4; (time_us >= limit) && (bucket < _SYSCALL_STAT_BUCKETS - 1); limit <<= 2) {
+                bucket++;
+        }
+
+        _kernel_scheduler_lock();
+        {
+                _syscall_stat_t *stat = &syscall_latency[syscall];
+
+                stat->count++;
+                stat->direct += direct ? 1 : 0;
+                stat->time_max = max(stat->time_max, time_us);
+                stat->histogram[bucket]++;
+        }
+        _kernel_scheduler_unlock();
+}
+
+//==============================================================================
+/**
+ * @brief  Function return latency statistics of selected syscall.
+ *
+ * @param  syscall      syscall number
+ * @param  stat         statistics (result)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _syscall_get_stat(syscall_t syscall, _syscall_stat_t *stat)
+{
+        if ((syscall < _SYSCALL_COUNT) && stat) {
+                _kernel_scheduler_lock();
+                *stat = syscall_latency[syscall];
+                _kernel_scheduler_unlock();
+
+                return ESUCC;
+        } else {
+                return EINVAL;
+        }
+}
+#endif
+
 //==============================================================================
 /**
  * @brief  This syscall mount selected file system to selected path.
@@ -802,13 +1167,7 @@ static void syscall_closedir(syscallrq_t *rq)
 
         int err = _process_release_resource(GETPROCESS(), cast(res_header_t*, dir), RES_TYPE_DIR);
         if (err == EFAULT) {
-                const char *msg = "*** Error: object is not a dir! ***\n";
-                size_t wrcnt;
-                _vfs_fwrite(msg, strlen(msg), &wrcnt, _process_get_stderr(GETPROCESS()));
-
-                pid_t pid = 0;
-                _process_get_pid(GETPROCESS(), &pid);
-                _process_kill(pid);
+                syscall_kill_client(rq, "*** Error: object is not a dir! ***\n");
         }
 
         SETERRNO(err);
@@ -1010,13 +1369,7 @@ static void syscall_fclose(syscallrq_t *rq)
 
         int err = _process_release_resource(GETPROCESS(), cast(res_header_t*, file), RES_TYPE_FILE);
         if (err == EFAULT) {
-                const char *msg = "*** Error: object is not a file! ***\n";
-                size_t wrcnt;
-                _vfs_fwrite(msg, strlen(msg), &wrcnt, _process_get_stderr(GETPROCESS()));
-
-                pid_t pid = 0;
-                _process_get_pid(GETPROCESS(), &pid);
-                _process_kill(pid);
+                syscall_kill_client(rq, "*** Error: object is not a file! ***\n");
         }
 
         SETERRNO(err);
@@ -1133,7 +1486,19 @@ static void syscall_sync(syscallrq_t *rq)
 static void syscall_gettime(syscallrq_t *rq)
 {
         time_t time = -1;
-        SETERRNO(_gettime(&time));
+
+        if (rq->direct) {
+                int err = _gettime_cached(&time);
+                if (err == EAGAIN) {
+                        rq->deferred = true;
+                        return;
+                }
+
+                SETERRNO(err);
+        } else {
+                SETERRNO(_gettime(&time));
+        }
+
         SETRETURN(time_t, time);
 }
 
@@ -1247,13 +1612,7 @@ static void syscall_free(syscallrq_t *rq)
 
         int err = _process_release_resource(GETPROCESS(), cast(res_header_t*, mem) - 1, RES_TYPE_MEMORY);
         if (err != ESUCC) {
-                const char *msg = "*** Error: double free or corruption ***\n";
-                size_t wrcnt;
-                _vfs_fwrite(msg, strlen(msg), &wrcnt, _process_get_stderr(GETPROCESS()));
-
-                pid_t pid = 0;
-                _process_get_pid(GETPROCESS(), &pid);
-                _process_kill(pid);
+                syscall_kill_client(rq, "*** Error: double free or corruption ***\n");
         }
 
         SETERRNO(err);
@@ -1531,13 +1890,7 @@ static void syscall_semaphoredestroy(syscallrq_t *rq)
 
         int err = _process_release_resource(GETPROCESS(), cast(res_header_t*, sem), RES_TYPE_SEMAPHORE);
         if (err != ESUCC) {
-                const char *msg = "*** Error: object is not a semaphore! ***\n";
-                size_t wrcnt;
-                _vfs_fwrite(msg, strlen(msg), &wrcnt, _process_get_stderr(GETPROCESS()));
-
-                pid_t pid = 0;
-                _process_get_pid(GETPROCESS(), &pid);
-                _process_kill(pid);
+                syscall_kill_client(rq, "*** Error: object is not a semaphore! ***\n");
         }
 
         SETERRNO(err);
@@ -1581,13 +1934,7 @@ static void syscall_mutexdestroy(syscallrq_t *rq)
 
         int err = _process_release_resource(GETPROCESS(), cast(res_header_t*, mtx), RES_TYPE_MUTEX);
         if (err != ESUCC) {
-                const char *msg = "*** Error: object is not a mutex! ***\n";
-                size_t wrcnt;
-                _vfs_fwrite(msg, strlen(msg), &wrcnt, _process_get_stderr(GETPROCESS()));
-
-                pid_t pid = 0;
-                _process_get_pid(GETPROCESS(), &pid);
-                _process_kill(pid);
+                syscall_kill_client(rq, "*** Error: object is not a mutex! ***\n");
         }
 
         SETERRNO(err);
@@ -1632,13 +1979,7 @@ static void syscall_queuedestroy(syscallrq_t *rq)
 
         int err = _process_release_resource(GETPROCESS(), cast(res_header_t*, q), RES_TYPE_QUEUE);
         if (err != ESUCC) {
-                const char *msg = "*** Error: object is not a queue! ***\n";
-                size_t wrcnt;
-                _vfs_fwrite(msg, strlen(msg), &wrcnt, _process_get_stderr(GETPROCESS()));
-
-                pid_t pid = 0;
-                _process_get_pid(GETPROCESS(), &pid);
-                _process_kill(pid);
+                syscall_kill_client(rq, "*** Error: object is not a queue! ***\n");
         }
 
         SETERRNO(err);
@@ -1731,13 +2072,7 @@ static void syscall_netsocketdestroy(syscallrq_t *rq)
 
         int err = _process_release_resource(GETPROCESS(), cast(res_header_t*, socket), RES_TYPE_SOCKET);
         if (err != ESUCC) {
-                const char *msg = "*** Error: object is not a socket! ***\n";
-                size_t wrcnt;
-                _vfs_fwrite(msg, strlen(msg), &wrcnt, _process_get_stderr(GETPROCESS()));
-
-                pid_t pid = 0;
-                _process_get_pid(GETPROCESS(), &pid);
-                _process_kill(pid);
+                syscall_kill_client(rq, "*** Error: object is not a socket! ***\n");
         }
 
         SETERRNO(err);
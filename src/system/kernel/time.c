@@ -33,6 +33,7 @@
 #include "kernel/time.h"
 #include "kernel/errno.h"
 #include "kernel/sysfunc.h"
+#include "kernel/kwrapper.h"
 #include "fs/vfs.h"
 
 /*==============================================================================
@@ -50,6 +51,10 @@
 /*==============================================================================
   Local objects
 ==============================================================================*/
+#if __OS_ENABLE_TIMEMAN__ == _YES_
+static u32_t  time_ref;
+static time_t timecache;
+#endif
 
 /*==============================================================================
   Exported objects
@@ -87,34 +92,59 @@
 //==============================================================================
 int _gettime(time_t *timer)
 {
-        static uint32_t time_ref  = 0;
-        static time_t   timecache = 0;
+        int err = _gettime_cached(timer);
+
+        if (err == EAGAIN) {
+                FILE *rtc;
+
+                struct vfs_path cpath;
+                cpath.CWD  = NULL;
+                cpath.PATH = __OS_RTC_FILE_PATH__;
+
+                err = _vfs_fopen(&cpath, "r", &rtc);
+                if (!err) {
+                        size_t rdcnt;
+                        err = _vfs_fread(timer, sizeof(time_t), &rdcnt, rtc);
+                        _vfs_fclose(rtc, false);
+
+                        _kernel_scheduler_lock();
+                        timecache = *timer;
+                        time_ref  = sys_time_get_reference();
+                        _kernel_scheduler_unlock();
+                }
+        }
+
+        return err;
+}
 
+//==============================================================================
+/**
+ * @brief  Get current time from time cache. Function does not access RTC
+ *         device so can be called directly in the caller's context.
+ *
+ * @param  timer        Pointer to an object of type time_t, where the time
+ *                      value is stored.
+ *
+ * @return One of errno value. EAGAIN if cache expired.
+ */
+//==============================================================================
+int _gettime_cached(time_t *timer)
+{
         int err = EINVAL;
 
         if (timer) {
+                _kernel_scheduler_lock();
+
                 if (  (time_ref == 0) || (timecache == 0)
                    || sys_time_is_expired(time_ref, 500)) {
 
-                        FILE *rtc;
-
-                        struct vfs_path cpath;
-                        cpath.CWD  = NULL;
-                        cpath.PATH = __OS_RTC_FILE_PATH__;
-
-                        err = _vfs_fopen(&cpath, "r", &rtc);
-                        if (!err) {
-                                size_t rdcnt;
-                                err = _vfs_fread(timer, sizeof(time_t), &rdcnt, rtc);
-                                timecache = *timer;
-                                _vfs_fclose(rtc, false);
-
-                                time_ref = sys_time_get_reference();
-                        }
+                        err = EAGAIN;
                 } else {
                         *timer = timecache;
                         err    = ESUCC;
                 }
+
+                _kernel_scheduler_unlock();
         }
 
         return err;
@@ -149,6 +179,10 @@ int _settime(time_t *timer)
                         size_t wrcnt;
                         result = _vfs_fwrite(timer, sizeof(time_t), &wrcnt, rtc);
                         _vfs_fclose(rtc, false);
+
+                        _kernel_scheduler_lock();
+                        time_ref = 0;
+                        _kernel_scheduler_unlock();
                 }
         }
 
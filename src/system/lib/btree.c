@@ -3,7 +3,7 @@ File     btree.c
 
 Author   Daniel Zorychta
 
-Brief    BTree library.
+Brief    BTree library (self-balancing red-black tree).
 
          Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
 
@@ -44,6 +44,8 @@ Brief    BTree library.
 #define parent(n)               (n->parent)
 #define left(n)                 (n->left)
 #define right(n)                (n->right)
+#define color(n)                (n->color)
+#define is_red(n)               ((n) && (n)->color == RED)
 
 #define data(t,n)               (((char *)n) + node_size(t))
 #define data_copy(t, d, s)      memcpy(d, s, elem_size(t))
@@ -67,10 +69,16 @@ struct _btree_struct {
         btree_obj_dtor_t    node_dtor;
 };
 
+typedef enum {
+        RED,
+        BLACK
+} color_t;
+
 typedef struct node {
         struct node *parent;
         struct node *left;
         struct node *right;
+        color_t      color;
 } btnode_t;
 
 /*==============================================================================
@@ -83,6 +91,12 @@ static btnode_t *node_search(btree_t*, btnode_t*, void *);
 static void      node_close(btree_t*, btnode_t*);
 static btnode_t *node_successor(btnode_t*);
 static btnode_t *node_make(btree_t *tree, void *data);
+static btnode_t *node_bound(btree_t *tree, void *key, bool strict);
+static void      rotate_left(btree_t *tree, btnode_t *node);
+static void      rotate_right(btree_t *tree, btnode_t *node);
+static void      insert_fixup(btree_t *tree, btnode_t *node);
+static void      remove_fixup(btree_t *tree, btnode_t *node, btnode_t *parent);
+static void      transplant(btree_t *tree, btnode_t *dst, btnode_t *src);
 static void     *malloc_usr(size_t size, void *allocctx);
 static void      free_usr(void *mem, void *freectx);
 static void     *malloc_krn(size_t size, void *allocctx);
@@ -392,40 +406,40 @@ int _btree_predecessor(btree_t *tree, void *key, void *ret)
 //==============================================================================
 int _btree_insert(btree_t *tree, void *data)
 {
-        btnode_t *enode = node_search(tree, root(tree), data);
-        if (enode) {
-                return EEXIST;
-        }
-
-        btnode_t *newnode = node_make(tree, data);
-        if (!newnode) {
-                return ENOMEM;
-        }
-
         btnode_t *parent = NULL;
         btnode_t *node   = root(tree);
+        int       result = 0;
 
         while (node) {
                 parent = node;
-                if (data_compare(tree, data, data(tree, node)) < 0) {
+                result = data_compare(tree, data, data(tree, node));
+
+                if (result < 0) {
                         node = left(node);
-                } else {
+                } else if (result > 0) {
                         node = right(node);
+                } else {
+                        return EEXIST;
                 }
         }
 
+        btnode_t *newnode = node_make(tree, data);
+        if (!newnode) {
+                return ENOMEM;
+        }
+
         parent(newnode) = parent;
 
         if (!parent) {
                 root(tree) = newnode;
+        } else if (result < 0) {
+                left(parent) = newnode;
         } else {
-                if (data_compare(tree, data, data(tree, parent)) < 0) {
-                        left(parent) = newnode;
-                } else {
-                        right(parent) = newnode;
-                }
+                right(parent) = newnode;
         }
 
+        insert_fixup(tree, newnode);
+
         return ESUCC;
 }
 
@@ -441,46 +455,47 @@ int _btree_insert(btree_t *tree, void *data)
 //==============================================================================
 int _btree_remove(btree_t *tree, void *key)
 {
-        if (!root(tree)) {
-                return ENOENT;
-        }
-
-        btnode_t *remove;
-        btnode_t *other;
         btnode_t *node = node_search(tree, root(tree), key);
-
         if (!node) {
                 return ENOENT;
         }
 
-        if (!left(node) || !right(node)) {
-                remove = node;
-        } else {
-                remove = node_successor(node);
-        }
+        btnode_t *child;
+        btnode_t *parent;
+        color_t   color = color(node);
 
-        if (left(remove)) {
-                other = left(remove);
-        } else {
-                other = right(remove);
-        }
+        if (!left(node)) {
+                child  = right(node);
+                parent = parent(node);
+                transplant(tree, node, child);
 
-        if (other) {
-                parent(other) = parent(remove);
-        }
+        } else if (!right(node)) {
+                child  = left(node);
+                parent = parent(node);
+                transplant(tree, node, child);
 
-        if (!parent(remove)) {
-                root(tree) = other;
         } else {
-                if (remove == left(parent(remove))) {
-                        left(parent(remove)) = other;
+                btnode_t *next = node_minimum(right(node));
+                color = color(next);
+                child = right(next);
+
+                if (parent(next) == node) {
+                        parent = next;
                 } else {
-                        right(parent(remove)) = other;
+                        parent = parent(next);
+                        transplant(tree, next, child);
+                        right(next) = right(node);
+                        parent(right(next)) = next;
                 }
+
+                transplant(tree, node, next);
+                left(next) = left(node);
+                parent(left(next)) = next;
+                color(next) = color(node);
         }
 
-        if (node != remove) {
-                data_copy(tree, data(tree, node), data(tree, remove));
+        if (color == BLACK) {
+                remove_fixup(tree, child, parent);
         }
 
         if (tree->node_dtor) {
@@ -492,6 +507,79 @@ int _btree_remove(btree_t *tree, void *key)
         return ESUCC;
 }
 
+//==============================================================================
+/**
+ * @brief  Function return first object that is not less than key
+ *         (lower bound).
+ *
+ * @param  tree         BTree object
+ * @param  key          key to find
+ * @param  ret          found object
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _btree_lower_bound(btree_t *tree, void *key, void *ret)
+{
+        btnode_t *node = node_bound(tree, key, false);
+        if (node) {
+                data_copy(tree, ret, data(tree, node));
+                return ESUCC;
+        }
+
+        return ENOENT;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return first object that is greater than key
+ *         (upper bound).
+ *
+ * @param  tree         BTree object
+ * @param  key          key to find
+ * @param  ret          found object
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _btree_upper_bound(btree_t *tree, void *key, void *ret)
+{
+        btnode_t *node = node_bound(tree, key, true);
+        if (node) {
+                data_copy(tree, ret, data(tree, node));
+                return ESUCC;
+        }
+
+        return ENOENT;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return next object of range [from, to]. The key does not
+ *         have to exist in tree, so objects can be removed while iterating.
+ *
+ * @param  tree         BTree object
+ * @param  from         range begin (inclusive)
+ * @param  to           range end (inclusive)
+ * @param  prev         previously returned object (NULL to start iteration)
+ * @param  ret          next object in range
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _btree_range(btree_t *tree, void *from, void *to, void *prev, void *ret)
+{
+        btnode_t *node = prev ? node_bound(tree, prev, true)
+                              : node_bound(tree, from, false);
+
+        if (node && data_compare(tree, data(tree, node), to) <= 0) {
+                data_copy(tree, ret, data(tree, node));
+                return ESUCC;
+        }
+
+        return ENOENT;
+}
+
 //==============================================================================
 /**
  * @brief  Function destroy BTree.
@@ -667,11 +755,247 @@ static btnode_t *node_make(btree_t *tree, void *data)
         if (node) {
                 data_copy(tree, data(tree, node), data);
                 parent(node) = left(node) = right(node) = NULL;
+                color(node)  = RED;
         }
 
         return node;
 }
 
+//==============================================================================
+/**
+ * @brief  Function find first node that is not less (or greater if strict)
+ *         than key.
+ *
+ * @param  tree         BTree object
+ * @param  key          key to find
+ * @param  strict       true: find greater node, false: find not less node
+ *
+ * @return Found node or NULL.
+ */
+//==============================================================================
+static btnode_t *node_bound(btree_t *tree, void *key, bool strict)
+{
+        btnode_t *found = NULL;
+        btnode_t *node  = root(tree);
+
+        while (node) {
+                int result = data_compare(tree, data(tree, node), key);
+
+                if (result > 0 || (result == 0 && !strict)) {
+                        found = node;
+                        node  = left(node);
+                } else {
+                        node  = right(node);
+                }
+        }
+
+        return found;
+}
+
+//==============================================================================
+/**
+ * @brief  Function replace subtree dst by subtree src.
+ *
+ * @param  tree         BTree object
+ * @param  dst          replaced node
+ * @param  src          new node (can be NULL)
+ */
+//==============================================================================
+static void transplant(btree_t *tree, btnode_t *dst, btnode_t *src)
+{
+        if (!parent(dst)) {
+                root(tree) = src;
+        } else if (dst == left(parent(dst))) {
+                left(parent(dst)) = src;
+        } else {
+                right(parent(dst)) = src;
+        }
+
+        if (src) {
+                parent(src) = parent(dst);
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Function rotate subtree left.
+ *
+ * @param  tree         BTree object
+ * @param  node         subtree root
+ */
+//==============================================================================
+static void rotate_left(btree_t *tree, btnode_t *node)
+{
+        btnode_t *pivot = right(node);
+
+        right(node) = left(pivot);
+        if (left(pivot)) {
+                parent(left(pivot)) = node;
+        }
+
+        transplant(tree, node, pivot);
+
+        left(pivot)  = node;
+        parent(node) = pivot;
+}
+
+//==============================================================================
+/**
+ * @brief  Function rotate subtree right.
+ *
+ * @param  tree         BTree object
+ * @param  node         subtree root
+ */
+//==============================================================================
+static void rotate_right(btree_t *tree, btnode_t *node)
+{
+        btnode_t *pivot = left(node);
+
+        left(node) = right(pivot);
+        if (right(pivot)) {
+                parent(right(pivot)) = node;
+        }
+
+        transplant(tree, node, pivot);
+
+        right(pivot) = node;
+        parent(node) = pivot;
+}
+
+//==============================================================================
+/**
+ * @brief  Function restore red-black properties after insert.
+ *
+ * @param  tree         BTree object
+ * @param  node         inserted node
+ */
+//==============================================================================
+static void insert_fixup(btree_t *tree, btnode_t *node)
+{
+        while (is_red(parent(node))) {
+                btnode_t *parent  = parent(node);
+                btnode_t *gparent = parent(parent);
+
+                if (parent == left(gparent)) {
+                        btnode_t *uncle = right(gparent);
+
+                        if (is_red(uncle)) {
+                                color(parent)  = BLACK;
+                                color(uncle)   = BLACK;
+                                color(gparent) = RED;
+                                node = gparent;
+                        } else {
+                                if (node == right(parent)) {
+                                        node = parent;
+                                        rotate_left(tree, node);
+                                        parent = parent(node);
+                                }
+
+                                color(parent)  = BLACK;
+                                color(gparent) = RED;
+                                rotate_right(tree, gparent);
+                        }
+                } else {
+                        btnode_t *uncle = left(gparent);
+
+                        if (is_red(uncle)) {
+                                color(parent)  = BLACK;
+                                color(uncle)   = BLACK;
+                                color(gparent) = RED;
+                                node = gparent;
+                        } else {
+                                if (node == left(parent)) {
+                                        node = parent;
+                                        rotate_right(tree, node);
+                                        parent = parent(node);
+                                }
+
+                                color(parent)  = BLACK;
+                                color(gparent) = RED;
+                                rotate_left(tree, gparent);
+                        }
+                }
+        }
+
+        color(root(tree)) = BLACK;
+}
+
+//==============================================================================
+/**
+ * @brief  Function restore red-black properties after remove.
+ *
+ * @param  tree         BTree object
+ * @param  node         node that replaced removed one (can be NULL)
+ * @param  parent       parent of node
+ */
+//==============================================================================
+static void remove_fixup(btree_t *tree, btnode_t *node, btnode_t *parent)
+{
+        while (node != root(tree) && !is_red(node)) {
+                if (node == left(parent)) {
+                        btnode_t *sibling = right(parent);
+
+                        if (is_red(sibling)) {
+                                color(sibling) = BLACK;
+                                color(parent)  = RED;
+                                rotate_left(tree, parent);
+                                sibling = right(parent);
+                        }
+
+                        if (!is_red(left(sibling)) && !is_red(right(sibling))) {
+                                color(sibling) = RED;
+                                node   = parent;
+                                parent = parent(node);
+                        } else {
+                                if (!is_red(right(sibling))) {
+                                        color(left(sibling)) = BLACK;
+                                        color(sibling) = RED;
+                                        rotate_right(tree, sibling);
+                                        sibling = right(parent);
+                                }
+
+                                color(sibling) = color(parent);
+                                color(parent)  = BLACK;
+                                color(right(sibling)) = BLACK;
+                                rotate_left(tree, parent);
+                                node = root(tree);
+                        }
+                } else {
+                        btnode_t *sibling = left(parent);
+
+                        if (is_red(sibling)) {
+                                color(sibling) = BLACK;
+                                color(parent)  = RED;
+                                rotate_right(tree, parent);
+                                sibling = left(parent);
+                        }
+
+                        if (!is_red(left(sibling)) && !is_red(right(sibling))) {
+                                color(sibling) = RED;
+                                node   = parent;
+                                parent = parent(node);
+                        } else {
+                                if (!is_red(left(sibling))) {
+                                        color(right(sibling)) = BLACK;
+                                        color(sibling) = RED;
+                                        rotate_left(tree, sibling);
+                                        sibling = left(parent);
+                                }
+
+                                color(sibling) = color(parent);
+                                color(parent)  = BLACK;
+                                color(left(sibling)) = BLACK;
+                                rotate_right(tree, parent);
+                                node = root(tree);
+                        }
+                }
+        }
+
+        if (node) {
+                color(node) = BLACK;
+        }
+}
+
 //==============================================================================
 /**
  * @brief  Allocate memory in user space.
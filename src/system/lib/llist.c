@@ -34,6 +34,7 @@
 #include "lib/llist.h"
 #include <string.h>
 #include "libc/errno.h"
+#include "mm/pool.h"
 
 /*==============================================================================
   Local macros
@@ -46,6 +47,8 @@
 #define cast(t, v) ((t)(v))
 #endif
 
+#define ITEM_POOL_SIZE          32
+
 /*==============================================================================
   Local object types
 ==============================================================================*/
@@ -69,6 +72,8 @@ struct _llist {
         llist_obj_dtor_t     obj_dtor;
         item_t              *head;
         item_t              *tail;
+        item_t              *cursor;    // last accessed item (can be NULL)
+        int                  cursor_pos;// position of cursor item
         llist_t             *self;
         size_t               count;
 };
@@ -83,13 +88,15 @@ static int     append           (llist_t *this, const void *data);
 static int     insert_item      (llist_t *this, int index, const void *data);
 static item_t *get_item         (llist_t *this, int position);
 static int     remove_item      (llist_t *this, item_t *item, bool unlink);
-static void    quicksort        (llist_t *this, int left, int right);
+static void    mergesort        (llist_t *this);
 static void   *usrmalloc        (size_t size, void *allocctx);
 static void    usrfree          (void *mem, void *freectx);
 static void   *krnmalloc        (size_t size, void *allocctx);
 static void    krnfree          (void *mem, void *freectx);
 static void   *modmalloc        (size_t size, void *allocctx);
 static void    modfree          (void *mem, void *freectx);
+static item_t *item_alloc       (llist_t *this);
+static void    item_free        (llist_t *this, item_t *item);
 
 
 /*==============================================================================
@@ -97,6 +104,9 @@ static void    modfree          (void *mem, void *freectx);
 ==============================================================================*/
 static const uint32_t magic_number = 0x6D89B264;
 
+/* items of kernel lists */
+static _mm_pool_t item_pool = _MM_POOL_INIT("llist item", _MM_KRN, sizeof(item_t), ITEM_POOL_SIZE);
+
 /*==============================================================================
   Function definitions
 ==============================================================================*/
@@ -133,6 +143,8 @@ int _llist_create_usr(llist_malloc_t      malloc,
                         (*list)->obj_dtor    = obj_dtor;
                         (*list)->head        = NULL;
                         (*list)->tail        = NULL;
+                        (*list)->cursor      = NULL;
+                        (*list)->cursor_pos  = 0;
                         (*list)->count       = 0;
                         (*list)->self        = *list;
 
@@ -175,6 +187,8 @@ int _llist_create_krn(enum _mm_mem        mem,
                         (*list)->obj_dtor    = obj_dtor;
                         (*list)->head        = NULL;
                         (*list)->tail        = NULL;
+                        (*list)->cursor      = NULL;
+                        (*list)->cursor_pos  = 0;
                         (*list)->count       = 0;
                         (*list)->self        = *list;
 
@@ -215,6 +229,8 @@ int _llist_create_mod(size_t              modid,
                         (*list)->obj_dtor    = obj_dtor;
                         (*list)->head        = NULL;
                         (*list)->tail        = NULL;
+                        (*list)->cursor      = NULL;
+                        (*list)->cursor_pos  = 0;
                         (*list)->count       = 0;
                         (*list)->self        = *list;
 
@@ -552,9 +568,10 @@ int _llist_clear(llist_t *this)
                         remove_item(this, item_rm, false);
                 }
 
-                this->count = 0;
-                this->head  = NULL;
-                this->tail  = NULL;
+                this->count  = 0;
+                this->head   = NULL;
+                this->tail   = NULL;
+                this->cursor = NULL;
 
                 return 1;
         }
@@ -573,7 +590,7 @@ void _llist_sort(llist_t *this)
 {
         if (is_llist_valid(this)) {
                 if (this->cmp_functor) {
-                        quicksort(this, 0, this->count - 1);
+                        mergesort(this);
                 }
         }
 }
@@ -589,7 +606,7 @@ void _llist_unique(llist_t *this)
 {
         if (is_llist_valid(this)) {
                 if (this->cmp_functor) {
-                        quicksort(this, 0, this->count - 1);
+                        mergesort(this);
 
                         item_t *item = this->head;
                         while (item && item->next) {
@@ -996,7 +1013,7 @@ int _llist_functor_cmp_strings(const void *a, const void *b)
 {
         int d = strcmp(cast(char *, a), cast(char *, b));
 
-        if (d)
+        if (d > 0)
                 return 1;
         else if (d == 0)
                 return 0;
@@ -1030,7 +1047,9 @@ static bool is_iterator_valid(llist_iterator_t *this)
 
 //==============================================================================
 /**
- * @brief  Return pointer to the element container
+ * @brief  Return pointer to the element container. Walk starts from the
+ *         nearest of head, tail or last accessed item, so sequential access
+ *         by index costs O(1).
  * @param  this         list object
  * @param  position     begin's position
  * @return On success begin is returned, otherwise NULL
@@ -1038,34 +1057,45 @@ static bool is_iterator_valid(llist_iterator_t *this)
 //==============================================================================
 static item_t *get_item(llist_t *this, int position)
 {
-        enum direction {DIR_FORWARD, DIR_BACKWARD};
-
         if (position < 0 || cast(size_t, position) >= this->count) {
                 return NULL;
+        }
 
-        } else {
-                enum direction dir;
-                item_t        *item;
+        item_t *item = this->head;
+        int     pos  = 0;
+        int     dist = position;
 
-                if (cast(size_t, position) <= this->count / 2) {
-                        dir      = DIR_FORWARD;
-                        item     = this->head;
-                } else {
-                        dir      = DIR_BACKWARD;
-                        item     = this->tail;
-                        position = this->count - position - 1;
-                }
+        if (cast(int, this->count) - 1 - position < dist) {
+                item = this->tail;
+                pos  = this->count - 1;
+                dist = pos - position;
+        }
 
-                while (item) {
-                        if (position-- == 0) {
-                                return item;
-                        } else {
-                                item = dir == DIR_FORWARD ? item->next : item->prev;
-                        }
+        if (this->cursor) {
+                int cdist = this->cursor_pos > position ? this->cursor_pos - position
+                                                        : position - this->cursor_pos;
+                if (cdist < dist) {
+                        item = this->cursor;
+                        pos  = this->cursor_pos;
                 }
         }
 
-        return NULL;
+        while (item && pos < position) {
+                item = item->next;
+                pos++;
+        }
+
+        while (item && pos > position) {
+                item = item->prev;
+                pos--;
+        }
+
+        if (item) {
+                this->cursor     = item;
+                this->cursor_pos = position;
+        }
+
+        return item;
 }
 
 //==============================================================================
@@ -1080,6 +1110,15 @@ static item_t *get_item(llist_t *this, int position)
 static int remove_item(llist_t *this, item_t *item, bool unlink)
 {
         if (item) {
+                /* keep cursor valid if position of cursor is known */
+                if (this->cursor == item) {
+                        this->cursor = item->next;
+                } else if (this->cursor && item->prev == NULL) {
+                        this->cursor_pos--;
+                } else if (item->next != NULL) {
+                        this->cursor = NULL;
+                }
+
                 if (item->prev == NULL) {
                         this->head = item->next;
                 } else {
@@ -1105,7 +1144,7 @@ static int remove_item(llist_t *this, item_t *item, bool unlink)
                         item->data = NULL;
                 }
 
-                this->free(item, this->freectx);
+                item_free(this, item);
 
                 this->count--;
 
@@ -1136,7 +1175,7 @@ static int insert_item(llist_t *this, int index, const void *data)
                 return 0;
 
         } else {
-                item_t *new_item = this->malloc(sizeof(item_t), this->allocctx);
+                item_t *new_item = item_alloc(this);
                 if (new_item) {
                         new_item->data = const_cast(void*, data);
 
@@ -1147,12 +1186,15 @@ static int insert_item(llist_t *this, int index, const void *data)
                                 item->prev->next = new_item;
                                 item->prev       = new_item;
 
+                                this->cursor     = new_item;
+                                this->cursor_pos = index;
+
                                 this->count++;
 
                                 return 1;
                         }
 
-                        this->free(new_item, this->freectx);
+                        item_free(this, new_item);
                 }
 
         }
@@ -1170,7 +1212,7 @@ static int insert_item(llist_t *this, int index, const void *data)
 //==============================================================================
 static int prepend(llist_t *this, const void *data)
 {
-        item_t *new_item = this->malloc(sizeof(item_t), this->allocctx);
+        item_t *new_item = item_alloc(this);
         if (new_item) {
                 new_item->data = const_cast(void*, data);
 
@@ -1186,6 +1228,7 @@ static int prepend(llist_t *this, const void *data)
                         this->head       = new_item;
                 }
 
+                this->cursor_pos++;
                 this->count++;
 
                 return 1;
@@ -1204,7 +1247,7 @@ static int prepend(llist_t *this, const void *data)
 //==============================================================================
 static int append(llist_t *this, const void *data)
 {
-        item_t *new_item = this->malloc(sizeof(item_t), this->allocctx);
+        item_t *new_item = item_alloc(this);
         if (new_item) {
                 new_item->data = const_cast(void*, data);
 
@@ -1230,52 +1273,78 @@ static int append(llist_t *this, const void *data)
 
 //==============================================================================
 /**
- * @brief  Quicksort algorithm
+ * @brief  Merge sort algorithm (bottom-up, stable, without recursion).
+ *         Items are relinked, data pointers are not moved.
  * @param  this         list object
- * @param  left         left position (sort border)
- * @param  right        right position (sort border)
  * @return None
  */
 //==============================================================================
-static void quicksort(llist_t *this, int left, int right)
+static void mergesort(llist_t *this)
 {
-        int     i, j;
-        void   *pivot;
-        item_t *item_i, *item_j, *item_r, *item_l;
+        if (this->count < 2) {
+                return;
+        }
 
-        i = (left + right) / 2;
+        item_t *list = this->head;
+        item_t *tail = NULL;
+        int     size = 1;
+        int     merges;
 
-        item_i = get_item(this, i);
-        item_r = get_item(this, right);
-        item_l = get_item(this, left);
-        pivot  = item_i->data;
+        do {
+                item_t *p = list;
+                list      = NULL;
+                tail      = NULL;
+                merges    = 0;
 
-        item_i->data = item_r->data;
+                while (p) {
+                        merges++;
 
-        item_j = item_i = item_l;
-        for (i = j = left; i < right; item_i = item_i->next, i++) {
+                        item_t *q     = p;
+                        int     psize = 0;
+                        int     qsize = size;
 
-                if (this->cmp_functor(item_i->data, pivot) < 0) {
+                        while (q && psize < size) {
+                                q = q->next;
+                                psize++;
+                        }
+
+                        while (psize > 0 || (qsize > 0 && q)) {
+                                item_t *e;
+
+                                if (psize == 0) {
+                                        e = q; q = q->next; qsize--;
+
+                                } else if (qsize == 0 || !q) {
+                                        e = p; p = p->next; psize--;
 
-                        void *data   = item_j->data;
-                        item_j->data = item_i->data;
-                        item_i->data = data;
+                                } else if (this->cmp_functor(p->data, q->data) <= 0) {
+                                        e = p; p = p->next; psize--;
+
+                                } else {
+                                        e = q; q = q->next; qsize--;
+                                }
+
+                                if (tail) {
+                                        tail->next = e;
+                                } else {
+                                        list = e;
+                                }
 
-                        item_j = item_j->next;
-                        j++;
+                                e->prev = tail;
+                                tail    = e;
+                        }
+
+                        p = q;
                 }
-        }
 
-        item_r->data = item_j->data;
-        item_j->data = pivot;
+                tail->next = NULL;
+                size *= 2;
 
-        if (left < j - 1) {
-                quicksort(this, left, j - 1);
-        }
+        } while (merges > 1);
 
-        if (j + 1 < right) {
-                quicksort(this, j + 1, right);
-        }
+        this->head   = list;
+        this->tail   = tail;
+        this->cursor = NULL;
 }
 
 //==============================================================================
@@ -1310,6 +1379,45 @@ static void usrfree(void *mem, void *freectx)
         free(mem);
 }
 
+//==============================================================================
+/**
+ * @brief  Allocate list item. Items of kernel lists are allocated from pool.
+ *
+ * @param  this         list object
+ *
+ * @return On success pointer to allocated item, otherwise NULL
+ */
+//==============================================================================
+static item_t *item_alloc(llist_t *this)
+{
+        if (this->malloc == krnmalloc && this->allocctx == cast(void*, _MM_KRN)) {
+                void *item = NULL;
+                _mm_pool_alloc(&item_pool, &item);
+                return item;
+        } else {
+                return this->malloc(sizeof(item_t), this->allocctx);
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Free list item.
+ *
+ * @param  this         list object
+ * @param  item         item to free
+ *
+ * @return None
+ */
+//==============================================================================
+static void item_free(llist_t *this, item_t *item)
+{
+        if (this->free == krnfree && this->freectx == cast(void*, _MM_KRN)) {
+                _mm_pool_free(&item_pool, cast(void**, &item));
+        } else {
+                this->free(item, this->freectx);
+        }
+}
+
 //==============================================================================
 /**
  * @brief  Allocate memory in user space
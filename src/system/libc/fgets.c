@@ -33,7 +33,9 @@
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
+#include <dnx/misc.h>
 #include "lib/unarg.h"
+#include "stdio_buf.h"
 
 /*==============================================================================
   Local macros
@@ -81,15 +83,45 @@ char *fgets(char *str, int size, FILE *stream)
                 return NULL;
         }
 
+        stdio_buf_t *fbuf = _stdio_lock(stream, true);
+
         struct stat file_stat;
-        if (fstat(stream, &file_stat) == 0) {
+        if (fbuf || (fstat(stream, &file_stat) == 0)) {
 
                 char *p = str;
                 int   c = EOF;
 
                 size--;
 
-                if (file_stat.st_type == FILE_TYPE_PIPE || file_stat.st_type == FILE_TYPE_DRV) {
+                if (fbuf) {
+                        while ((c != '\n') && (size > 0)) {
+
+                                if (fbuf->wr || (fbuf->pos >= fbuf->len)) {
+                                        c = fgetc(stream);      // refill buffer
+                                        if (c == EOF) {
+                                                break;
+                                        } else {
+                                                *p++ = c;
+                                                size--;
+                                                continue;
+                                        }
+                                }
+
+                                u8_t  *src = fbuf->data + fbuf->pos;
+                                size_t len = min(cast(size_t, size), fbuf->len - fbuf->pos);
+                                u8_t  *nl  = memchr(src, '\n', len);
+                                size_t cpy = nl ? cast(size_t, nl - src) + 1 : len;
+
+                                memcpy(p, src, cpy);
+                                fbuf->pos += cpy;
+                                size      -= cpy;
+                                p         += cpy;
+                                c          = p[-1];
+                        }
+
+                        _stdio_unlock(fbuf);
+
+                } else if (file_stat.st_type == FILE_TYPE_PIPE || file_stat.st_type == FILE_TYPE_DRV) {
 
                         while ((c != '\n') && size--) {
 
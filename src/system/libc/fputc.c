@@ -32,6 +32,7 @@
 #include <config.h>
 #include <stdio.h>
 #include "lib/unarg.h"
+#include "stdio_buf.h"
 
 /*==============================================================================
   Local macros
@@ -75,6 +76,21 @@ int fputc(int c, FILE *stream)
 {
 #if (__OS_PRINTF_ENABLE__ > 0)
         if (stream) {
+                stdio_buf_t *fbuf = _stdio_lock(stream, false);
+                if (fbuf) {
+                        bool put = fbuf->wr && (fbuf->pos < fbuf->size)
+                                && !((fbuf->mode == _IOLBF) && (c == '\n'));
+                        if (put) {
+                                fbuf->data[fbuf->pos++] = c;
+                        }
+
+                        _stdio_unlock(fbuf);
+
+                        if (put) {
+                                return c;
+                        }
+                }
+
                 char ch = (char)c;
                 if (fwrite(&ch, sizeof(char), 1, stream) == 1) {
                         return c;
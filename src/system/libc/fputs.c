@@ -35,6 +35,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "lib/unarg.h"
+#include "stdio_buf.h"
 
 /*==============================================================================
   Local macros
@@ -81,7 +82,17 @@ static int f_puts(const char *s, FILE *file, bool puts)
         if (file) {
                 int n = EOF;
 
-                if (puts) {
+                stdio_buf_t *fbuf = puts ? _stdio_lock(file, true) : NULL;
+
+                if (fbuf) {
+                        n = fwrite(s, sizeof(char), strlen(s), file);
+                        if (fputc('\n', file) != EOF) {
+                                n++;
+                        }
+
+                        _stdio_unlock(fbuf);
+
+                } else if (puts) {
                         char *buf = malloc(strlen(s) + 2);
                         if (buf) {
                                 strcpy(buf, s);
@@ -0,0 +1,134 @@
+/*=========================================================================*//**
+@file    fread.c
+
+@author  Daniel Zorychta
+
+@brief   Buffered stream read.
+
+@note    Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include <config.h>
+#include <stdio.h>
+#include <string.h>
+#include <dnx/misc.h>
+#include "stdio_buf.h"
+
+/*==============================================================================
+  Local macros
+==============================================================================*/
+
+/*==============================================================================
+  Local object types
+==============================================================================*/
+
+/*==============================================================================
+  Local function prototypes
+==============================================================================*/
+
+/*==============================================================================
+  Local objects
+==============================================================================*/
+
+/*==============================================================================
+  Exported objects
+==============================================================================*/
+
+/*==============================================================================
+  External objects
+==============================================================================*/
+
+/*==============================================================================
+  Function definitions
+==============================================================================*/
+
+//==============================================================================
+/**
+ * @brief Function read data from stream. Small reads are served from stream
+ *        buffer, reads not smaller than buffer are done directly.
+ *
+ * @param[out] ptr              destination
+ * @param[in]  size             item size
+ * @param[in]  count            number of items
+ * @param[in]  file             stream
+ *
+ * @return Number of read items.
+ */
+//==============================================================================
+size_t fread(void *ptr, size_t size, size_t count, FILE *file)
+{
+        stdio_buf_t *fbuf = (ptr && size && count) ? _stdio_lock(file, true) : NULL;
+
+        if (!fbuf) {
+                size_t n = 0;
+                syscall(SYSCALL_FREAD, &n, ptr, &size, &count, file);
+                return n;
+        }
+
+        if (_stdio_drain(fbuf) != 0) {
+                _stdio_unlock(fbuf);
+                return 0;
+        }
+
+        u8_t  *dst = ptr;
+        size_t len = size * count;
+        size_t n   = 0;
+
+        while (n < len) {
+                size_t avail = fbuf->len - fbuf->pos;
+
+                if (avail) {
+                        size_t cpy = min(avail, len - n);
+                        memcpy(dst + n, fbuf->data + fbuf->pos, cpy);
+                        fbuf->pos += cpy;
+                        n         += cpy;
+
+                } else if ((len - n) >= fbuf->size) {
+                        n += _stdio_read(dst + n, len - n, file);
+                        break;
+
+                } else {
+                        stdio_buf_t *out = (stdout != file) ? _stdio_lock(stdout, false) : NULL;
+                        if (out) {
+                                _stdio_drain(out);
+                                _stdio_unlock(out);
+                        }
+
+                        fbuf->pos = 0;
+                        fbuf->len = _stdio_read(fbuf->data, fbuf->size, file);
+
+                        if (fbuf->len == 0) {
+                                break;
+                        }
+                }
+        }
+
+        _stdio_unlock(fbuf);
+
+        return n / size;
+}
+
+/*==============================================================================
+  End of file
+==============================================================================*/
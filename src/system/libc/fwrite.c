@@ -0,0 +1,126 @@
+/*=========================================================================*//**
+@file    fwrite.c
+
+@author  Daniel Zorychta
+
+@brief   Buffered stream write.
+
+@note    Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include <config.h>
+#include <stdio.h>
+#include <string.h>
+#include "stdio_buf.h"
+
+/*==============================================================================
+  Local macros
+==============================================================================*/
+
+/*==============================================================================
+  Local object types
+==============================================================================*/
+
+/*==============================================================================
+  Local function prototypes
+==============================================================================*/
+
+/*==============================================================================
+  Local objects
+==============================================================================*/
+
+/*==============================================================================
+  Exported objects
+==============================================================================*/
+
+/*==============================================================================
+  External objects
+==============================================================================*/
+
+/*==============================================================================
+  Function definitions
+==============================================================================*/
+
+//==============================================================================
+/**
+ * @brief Function write data to stream. Data is collected in stream buffer
+ *        and written when buffer is full, at new line (line buffered mode),
+ *        or at fflush(), fseek(), and fclose(). Writes not smaller than buffer
+ *        are done directly.
+ *
+ * @param[in] ptr               source
+ * @param[in] size              item size
+ * @param[in] count             number of items
+ * @param[in] file              stream
+ *
+ * @return Number of written items.
+ */
+//==============================================================================
+size_t fwrite(const void *ptr, size_t size, size_t count, FILE *file)
+{
+        stdio_buf_t *fbuf = (ptr && size && count) ? _stdio_lock(file, true) : NULL;
+
+        if (!fbuf) {
+                size_t n = 0;
+                syscall(SYSCALL_FWRITE, &n, ptr, &size, &count, file);
+                return n;
+        }
+
+        if (!fbuf->wr && (fbuf->len > 0)) {
+                /* drop read data and restore file position */
+                fseek(file, 0, SEEK_CUR);
+        }
+
+        size_t len = size * count;
+        size_t n   = 0;
+
+        if ((fbuf->pos + len) > fbuf->size) {
+                if (_stdio_drain(fbuf) != 0) {
+                        _stdio_unlock(fbuf);
+                        return 0;
+                }
+        }
+
+        if (len >= fbuf->size) {
+                n = _stdio_write(ptr, len, file);
+
+        } else {
+                memcpy(fbuf->data + fbuf->pos, ptr, len);
+                fbuf->pos += len;
+                fbuf->wr   = true;
+                n          = len;
+
+                if ((fbuf->mode == _IOLBF) && memchr(ptr, '\n', len)) {
+                        _stdio_drain(fbuf);
+                }
+        }
+
+        _stdio_unlock(fbuf);
+
+        return n / size;
+}
+
+/*==============================================================================
+  End of file
+==============================================================================*/
@@ -32,6 +32,7 @@
 #include <config.h>
 #include <stdio.h>
 #include "lib/unarg.h"
+#include "stdio_buf.h"
 
 /*==============================================================================
   Local macros
@@ -77,12 +78,22 @@ int getc(FILE *stream)
                 return EOF;
         }
 
-        int chr = 0;
-        if (fread(&chr, sizeof(char), 1, stream) != 0) {
-                if (ferror(stream) || feof(stream)) {
-                        return EOF;
+        stdio_buf_t *fbuf = _stdio_lock(stream, false);
+        if (fbuf) {
+                int c = EOF;
+                if (!fbuf->wr && (fbuf->pos < fbuf->len)) {
+                        c = fbuf->data[fbuf->pos++];
                 }
-        } else {
+
+                _stdio_unlock(fbuf);
+
+                if (c != EOF) {
+                        return c;
+                }
+        }
+
+        u8_t chr = 0;
+        if (fread(&chr, sizeof(char), 1, stream) != 1) {
                 return EOF;
         }
 
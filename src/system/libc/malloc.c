@@ -0,0 +1,470 @@
+/*=========================================================================*//**
+@file    malloc.c
+
+@author  Daniel Zorychta
+
+@brief   User heap: small objects are served from per-process arena.
+
+@note    Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <dnx/misc.h>
+#include "mm/mm.h"
+
+/*==============================================================================
+  Local macros
+==============================================================================*/
+#define ARENA_CHUNK_SIZE        __OS_USER_HEAP_ARENA_CHUNK_SIZE__
+#define ARENA_CLASSES           8
+
+/*
+ * Block tag: [31:24] magic, [23] used flag, [22:20] size class,
+ * [19:0] block offset in chunk (in words). Magic must differ from the most
+ * significant byte of kernel memory block type (RES_TYPE_MEMORY).
+ */
+#define ARENA_TAG_MASK          0xFF800000
+#define ARENA_TAG_USED          0xA7800000
+#define ARENA_TAG_FREE          0xA7000000
+
+#define BLOCK_HDR_SIZE          offsetof(block_t, next)
+#define BLOCK_OF(_ptr)          cast(block_t*, cast(u8_t*, _ptr) - BLOCK_HDR_SIZE)
+#define IS_BLOCK_USED(_blk)     (((_blk)->tag & ARENA_TAG_MASK) == ARENA_TAG_USED)
+#define IS_BLOCK_FREE(_blk)     (((_blk)->tag & ARENA_TAG_MASK) == ARENA_TAG_FREE)
+#define BLOCK_TAG(_c, _offs)    (((u32_t)(_c) << 20) | ((_offs) / sizeof(u32_t)))
+#define BLOCK_CLASS(_tag)       (((_tag) >> 20) & 0x7)
+#define BLOCK_OFFSET(_tag)      (((_tag) & 0xFFFFF) * sizeof(u32_t))
+
+#if (ARENA_CHUNK_SIZE > 0) && (ARENA_CHUNK_SIZE < 256)
+#error User heap arena chunk must be at least 256 bytes long
+#endif
+
+/*==============================================================================
+  Local object types
+==============================================================================*/
+/* arena block, next pointer of free block overlays user data */
+typedef struct block {
+        u32_t         tag;
+        struct block *next;
+} block_t;
+
+/* per-process arena */
+typedef struct arena {
+        block_t *free[ARENA_CLASSES];   //!< free lists of size classes
+        u8_t    *chunk;                 //!< current chunk
+        size_t   chunk_used;            //!< carved part of current chunk
+} arena_t;
+
+/* chunk header, blocks follow the header */
+typedef struct {
+        arena_t *arena;                 //!< owner of chunk
+} chunk_t;
+
+/*==============================================================================
+  Local function prototypes
+==============================================================================*/
+static void *heap_alloc(size_t size, bool clear);
+static void  heap_free(void *ptr);
+
+/*==============================================================================
+  Local objects
+==============================================================================*/
+#if ARENA_CHUNK_SIZE > 0
+static const u16_t class_size[ARENA_CLASSES] = {8, 16, 24, 32, 48, 64, 96, 128};
+#endif
+
+/*==============================================================================
+  Exported objects
+==============================================================================*/
+
+/*==============================================================================
+  External objects
+==============================================================================*/
+
+/*==============================================================================
+  Function definitions
+==============================================================================*/
+#if ARENA_CHUNK_SIZE > 0
+//==============================================================================
+/**
+ * @brief  Function return arena of current process. Arena is created at first
+ *         use.
+ *
+ * @return Arena object or NULL on error.
+ */
+//==============================================================================
+static arena_t *arena_get(void)
+{
+        _process_t *proc  = _builtinfunc(process_get_active);
+        arena_t    *arena = _builtinfunc(process_get_arena, proc);
+
+        if (arena == NULL) {
+                arena = heap_alloc(sizeof(arena_t), true);
+                if (arena) {
+                        if (_builtinfunc(process_set_arena, proc, arena) != 0) {
+                                heap_free(arena);
+                                arena = _builtinfunc(process_get_arena, proc);
+                        }
+                }
+        }
+
+        return arena;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return size class of object.
+ *
+ * @param  size         object size
+ *
+ * @return Class index or ARENA_CLASSES if object is too big for arena.
+ */
+//==============================================================================
+static uint arena_class(size_t size)
+{
+        uint c = 0;
+
+        while (c < ARENA_CLASSES && size > class_size[c]) {
+                c++;
+        }
+
+        return c;
+}
+
+//==============================================================================
+/**
+ * @brief  Function carve block of selected class from current chunk. Function
+ *         must be called with scheduler locked.
+ *
+ * @param  arena        arena
+ * @param  c            size class
+ *
+ * @return Block or NULL if chunk is exhausted.
+ */
+//==============================================================================
+static block_t *arena_carve(arena_t *arena, uint c)
+{
+        size_t   stride = BLOCK_HDR_SIZE + class_size[c];
+        block_t *blk    = NULL;
+
+        if (arena->chunk && (arena->chunk_used + stride <= ARENA_CHUNK_SIZE)) {
+                blk      = cast(block_t*, arena->chunk + arena->chunk_used);
+                blk->tag = ARENA_TAG_FREE | BLOCK_TAG(c, arena->chunk_used);
+                arena->chunk_used += stride;
+        }
+
+        return blk;
+}
+
+//==============================================================================
+/**
+ * @brief  Function switch arena to the new chunk. Rest of the current chunk
+ *         is moved to free lists of classes that fit. Function must be called
+ *         with scheduler locked.
+ *
+ * @param  arena        arena
+ * @param  chunk        new chunk
+ */
+//==============================================================================
+static void arena_set_chunk(arena_t *arena, u8_t *chunk)
+{
+        for (int c = ARENA_CLASSES - 1; c >= 0; c--) {
+                block_t *blk;
+                while ((blk = arena_carve(arena, c))) {
+                        blk->next      = arena->free[c];
+                        arena->free[c] = blk;
+                }
+        }
+
+        cast(chunk_t*, chunk)->arena = arena;
+
+        arena->chunk      = chunk;
+        arena->chunk_used = sizeof(chunk_t);
+}
+
+//==============================================================================
+/**
+ * @brief  Function allocate small object from arena. If arena is exhausted
+ *         then new chunk is allocated from program heap.
+ *
+ * @param  arena        arena
+ * @param  c            size class
+ *
+ * @return Allocated object or NULL on error.
+ */
+//==============================================================================
+static void *arena_alloc(arena_t *arena, uint c)
+{
+        block_t *blk   = NULL;
+        u8_t    *chunk = NULL;
+
+        while (blk == NULL) {
+                _builtinfunc(kernel_scheduler_lock);
+
+                if (chunk) {
+                        arena_set_chunk(arena, chunk);
+                }
+
+                blk = arena->free[c];
+                if (blk) {
+                        arena->free[c] = blk->next;
+                } else {
+                        blk = arena_carve(arena, c);
+                }
+
+                if (blk) {
+                        blk->tag |= ARENA_TAG_USED;
+                }
+
+                _builtinfunc(kernel_scheduler_unlock);
+
+                if (blk == NULL) {
+                        chunk = heap_alloc(ARENA_CHUNK_SIZE, false);
+                        if (chunk == NULL) {
+                                return NULL;
+                        }
+                }
+        }
+
+        return &blk->next;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return object to the arena that owns chunk of block.
+ *
+ * @param  blk          block to free
+ */
+//==============================================================================
+static void arena_free(block_t *blk)
+{
+        chunk_t *chunk = cast(chunk_t*, cast(u8_t*, blk) - BLOCK_OFFSET(blk->tag));
+        arena_t *arena = chunk->arena;
+        uint     c     = BLOCK_CLASS(blk->tag);
+
+        _builtinfunc(kernel_scheduler_lock);
+
+        blk->tag       = ARENA_TAG_FREE | (blk->tag & ~ARENA_TAG_MASK);
+        blk->next      = arena->free[c];
+        arena->free[c] = blk;
+
+        _builtinfunc(kernel_scheduler_unlock);
+}
+#endif
+
+//==============================================================================
+/**
+ * @brief  Function allocate memory block from program heap (by syscall).
+ *
+ * @param  size         block size
+ * @param  clear        clear block
+ *
+ * @return Allocated block or NULL on error.
+ */
+//==============================================================================
+static void *heap_alloc(size_t size, bool clear)
+{
+        void *mem = NULL;
+        syscall(clear ? SYSCALL_ZALLOC : SYSCALL_MALLOC, &mem, &size);
+        return mem;
+}
+
+//==============================================================================
+/**
+ * @brief  Function free memory block of program heap (by syscall).
+ *
+ * @param  ptr          block to free
+ */
+//==============================================================================
+static void heap_free(void *ptr)
+{
+        syscall(SYSCALL_FREE, NULL, ptr);
+}
+
+//==============================================================================
+/**
+ * @brief  Function allocate memory block. Small objects are allocated from
+ *         process arena, bigger objects from program heap.
+ *
+ * @param  size         block size
+ * @param  clear        clear block
+ *
+ * @return Allocated block or NULL on error.
+ */
+//==============================================================================
+static void *user_alloc(size_t size, bool clear)
+{
+#if ARENA_CHUNK_SIZE > 0
+        uint c = arena_class(size);
+
+        if (size > 0 && c < ARENA_CLASSES) {
+                arena_t *arena = arena_get();
+                if (arena) {
+                        void *mem = arena_alloc(arena, c);
+                        if (mem && clear) {
+                                memset(mem, 0, class_size[c]);
+                        }
+
+                        return mem;
+                }
+        }
+#endif
+        return heap_alloc(size, clear);
+}
+
+//==============================================================================
+/**
+ * @brief  Function return usable size of allocated block.
+ *
+ * @param  ptr          allocated block
+ *
+ * @return Block size, SIZE_MAX if unknown.
+ */
+//==============================================================================
+static size_t user_block_size(void *ptr)
+{
+#if ARENA_CHUNK_SIZE > 0
+        block_t *blk = BLOCK_OF(ptr);
+
+        if (IS_BLOCK_USED(blk)) {
+                return class_size[BLOCK_CLASS(blk->tag)];
+        }
+#endif
+
+        size_t size = _builtinfunc(mm_get_block_size, cast(res_header_t*, ptr) - 1);
+
+        if (size == 0) {
+                return SIZE_MAX;
+        } else {
+                return (size > sizeof(res_header_t)) ? (size - sizeof(res_header_t)) : 0;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Function allocates memory block.
+ *
+ * @param size      size bytes to allocate
+ *
+ * @return Pointer to the allocated memory or NULL on error.
+ */
+//==============================================================================
+void *malloc(size_t size)
+{
+        return user_alloc(size, false);
+}
+
+//==============================================================================
+/**
+ * @brief Function allocates memory block and clear it.
+ *
+ * @param n         number of elements
+ * @param size      size of elements
+ *
+ * @return Pointer to the allocated memory or NULL on error.
+ */
+//==============================================================================
+void *calloc(size_t n, size_t size)
+{
+        if (size && (n > (SIZE_MAX / size))) {
+                _errno = ENOMEM;
+                return NULL;
+        }
+
+        return user_alloc(n * size, true);
+}
+
+//==============================================================================
+/**
+ * @brief Function frees allocated memory block.
+ *
+ * @param ptr       pointer to memory space to be freed
+ */
+//==============================================================================
+void free(void *ptr)
+{
+        if (ptr) {
+#if ARENA_CHUNK_SIZE > 0
+                block_t *blk = BLOCK_OF(ptr);
+
+                if (IS_BLOCK_USED(blk)) {
+                        arena_free(blk);
+                        return;
+
+                } else if (IS_BLOCK_FREE(blk)) {
+                        fputs("*** Error: double free or corruption ***\n", stderr);
+                        abort();
+                }
+#endif
+                heap_free(ptr);
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Function changes the size of allocated memory block.
+ *
+ * @param ptr       pointer to memory space
+ * @param size      size of new memory space
+ *
+ * @return Pointer to the new memory space or NULL on error.
+ */
+//==============================================================================
+void *realloc(void *ptr, size_t size)
+{
+        if (ptr == NULL) {
+                return malloc(size);
+        }
+
+        if (size == 0) {
+                free(ptr);
+                return NULL;
+        }
+
+        size_t old_size = user_block_size(ptr);
+
+#if ARENA_CHUNK_SIZE > 0
+        if (IS_BLOCK_USED(BLOCK_OF(ptr)) && (size <= old_size)) {
+                return ptr;
+        }
+#endif
+
+        void *mem = malloc(size);
+        if (mem) {
+                memcpy(mem, ptr, min(old_size, size));
+                free(ptr);
+        }
+
+        return mem;
+}
+
+/*==============================================================================
+  End of file
+==============================================================================*/
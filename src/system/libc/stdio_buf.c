@@ -0,0 +1,584 @@
+/*=========================================================================*//**
+@file    stdio_buf.c
+
+@author  Daniel Zorychta
+
+@brief   Stream buffers of process and stdio functions that use them.
+
+@note    Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include <config.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <dnx/thread.h>
+#include <dnx/misc.h>
+#include "stdio_buf.h"
+
+/*==============================================================================
+  Local macros
+==============================================================================*/
+
+/*==============================================================================
+  Local object types
+==============================================================================*/
+/* buffer lookup mode */
+enum buf_get {
+        BUF_FIND,                       //!< existing buffer only
+        BUF_DEFAULT,                    //!< create default buffer of regular file
+        BUF_CREATE                      //!< create buffer of any stream
+};
+
+/* stream buffers of process */
+typedef struct {
+        mutex_t     *mtx;               //!< buffers lock (recursive)
+        stdio_buf_t *list;              //!< buffers of streams used by process
+} stdio_t;
+
+/*==============================================================================
+  Local function prototypes
+==============================================================================*/
+
+/*==============================================================================
+  Local objects
+==============================================================================*/
+
+/*==============================================================================
+  Exported objects
+==============================================================================*/
+
+/*==============================================================================
+  External objects
+==============================================================================*/
+
+/*==============================================================================
+  Function definitions
+==============================================================================*/
+
+//==============================================================================
+/**
+ * @brief  Function return stream buffers of current process.
+ *
+ * @param  create       create object if does not exist
+ *
+ * @return Stream buffers object or NULL.
+ */
+//==============================================================================
+static stdio_t *stdio_get(bool create)
+{
+        _process_t *proc  = _builtinfunc(process_get_active);
+        stdio_t    *stdio = _builtinfunc(process_get_stdio, proc);
+
+        if (stdio == NULL && create) {
+                stdio = calloc(1, sizeof(stdio_t));
+                if (stdio) {
+                        stdio->mtx = mutex_new(MUTEX_TYPE_RECURSIVE);
+
+                        if (  !stdio->mtx
+                           || _builtinfunc(process_set_stdio, proc, stdio) != 0) {
+
+                                if (stdio->mtx) {
+                                        mutex_delete(stdio->mtx);
+                                }
+
+                                free(stdio);
+                                stdio = _builtinfunc(process_get_stdio, proc);
+                        }
+                }
+        }
+
+        return stdio;
+}
+
+//==============================================================================
+/**
+ * @brief  Function set data of stream buffer. Buffer must be empty.
+ *
+ * @param  fbuf         stream buffer
+ * @param  buffer       user buffer (NULL to allocate buffer)
+ * @param  mode         buffer mode (_IOFBF, _IOLBF, _IONBF)
+ * @param  size         buffer size
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int buf_set(stdio_buf_t *fbuf, char *buffer, int mode, size_t size)
+{
+        if (fbuf->own && fbuf->data) {
+                free(fbuf->data);
+        }
+
+        fbuf->data = NULL;
+        fbuf->size = 0;
+        fbuf->pos  = 0;
+        fbuf->len  = 0;
+        fbuf->wr   = false;
+        fbuf->own  = false;
+        fbuf->mode = _IONBF;
+
+        if (mode != _IONBF) {
+                fbuf->data = buffer ? cast(u8_t*, buffer) : malloc(size);
+                if (fbuf->data) {
+                        fbuf->size = size;
+                        fbuf->own  = (buffer == NULL);
+                        fbuf->mode = mode;
+                } else {
+                        return ENOMEM;
+                }
+        }
+
+        return ESUCC;
+}
+
+//==============================================================================
+/**
+ * @brief  Function lock stream buffers of process and return buffer of
+ *         selected stream. Buffer of regular file is created at first access.
+ *
+ * @param  file         stream
+ * @param  get          lookup mode
+ *
+ * @return Locked buffer or NULL if stream has no buffer (nothing is locked).
+ */
+//==============================================================================
+static stdio_buf_t *buf_lock(FILE *file, enum buf_get get)
+{
+        if (!file) {
+                return NULL;
+        }
+
+        bool     bufreq = (get == BUF_DEFAULT) && file->f_flag.bufreq;
+        bool     create = (get == BUF_CREATE) || bufreq;
+        stdio_t *stdio  = stdio_get(create);
+        if (!stdio) {
+                return NULL;
+        }
+
+        _builtinfunc(mutex_lock, stdio->mtx, MAX_DELAY_MS);
+
+        stdio_buf_t *fbuf = stdio->list;
+        while (fbuf && fbuf->file != file) {
+                fbuf = fbuf->next;
+        }
+
+        if (!fbuf && create) {
+                fbuf = calloc(1, sizeof(stdio_buf_t));
+                if (fbuf) {
+                        fbuf->mtx   = stdio->mtx;
+                        fbuf->file  = file;
+                        fbuf->mode  = _IONBF;
+                        fbuf->next  = stdio->list;
+                        stdio->list = fbuf;
+
+                        if (bufreq) {
+                                buf_set(fbuf, NULL, _IOFBF, BUFSIZ);
+                        }
+                }
+        }
+
+        if (!fbuf) {
+                _builtinfunc(mutex_unlock, stdio->mtx);
+        }
+
+        return fbuf;
+}
+
+//==============================================================================
+/**
+ * @brief  Function remove stream buffer of process. Buffer must be locked
+ *         and is unlocked by this function.
+ *
+ * @param  fbuf         stream buffer
+ */
+//==============================================================================
+static void buf_remove(stdio_buf_t *fbuf)
+{
+        stdio_t *stdio = stdio_get(false);
+        mutex_t *mtx   = fbuf->mtx;
+
+        for (stdio_buf_t **b = &stdio->list; *b; b = &(*b)->next) {
+                if (*b == fbuf) {
+                        *b = fbuf->next;
+                        break;
+                }
+        }
+
+        buf_set(fbuf, NULL, _IONBF, 0);
+        free(fbuf);
+
+        _builtinfunc(mutex_unlock, mtx);
+}
+
+//==============================================================================
+/**
+ * @brief  Function drop data read to stream buffer. File position is moved
+ *         back to the first not consumed byte.
+ *
+ * @param  fbuf         stream buffer
+ */
+//==============================================================================
+static void buf_discard(stdio_buf_t *fbuf)
+{
+        if (!fbuf->wr && (fbuf->pos < fbuf->len)) {
+                i64_t offset = -cast(i64_t, fbuf->len - fbuf->pos);
+                int   mode   = SEEK_CUR;
+                int   r      = EOF;
+                syscall(SYSCALL_FSEEK, &r, fbuf->file, &offset, &mode);
+        }
+
+        if (!fbuf->wr) {
+                fbuf->pos = 0;
+                fbuf->len = 0;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Function return locked buffer of stream. Buffer is created at first
+ *         access if stream is buffered by default (regular file) and create
+ *         flag is set.
+ *
+ * @param  file         stream
+ * @param  create       create default buffer
+ *
+ * @return Locked buffer, or NULL if stream is unbuffered (nothing is locked).
+ */
+//==============================================================================
+stdio_buf_t *_stdio_lock(FILE *file, bool create)
+{
+        stdio_buf_t *fbuf = buf_lock(file, create ? BUF_DEFAULT : BUF_FIND);
+
+        if (fbuf && !fbuf->data) {
+                _stdio_unlock(fbuf);
+                fbuf = NULL;
+        }
+
+        return fbuf;
+}
+
+//==============================================================================
+/**
+ * @brief  Function unlock stream buffer locked by _stdio_lock().
+ *
+ * @param  fbuf         stream buffer
+ */
+//==============================================================================
+void _stdio_unlock(stdio_buf_t *fbuf)
+{
+        _builtinfunc(mutex_unlock, fbuf->mtx);
+}
+
+//==============================================================================
+/**
+ * @brief  Function read bytes directly from file (syscall).
+ *
+ * @param  ptr          destination
+ * @param  len          number of bytes to read
+ * @param  file         stream
+ *
+ * @return Number of read bytes.
+ */
+//==============================================================================
+size_t _stdio_read(void *ptr, size_t len, FILE *file)
+{
+        size_t n = 0, size = 1;
+        syscall(SYSCALL_FREAD, &n, ptr, &size, &len, file);
+        return cast(ssize_t, n) < 0 ? 0 : n;
+}
+
+//==============================================================================
+/**
+ * @brief  Function write bytes directly to file (syscall).
+ *
+ * @param  ptr          source
+ * @param  len          number of bytes to write
+ * @param  file         stream
+ *
+ * @return Number of written bytes.
+ */
+//==============================================================================
+size_t _stdio_write(const void *ptr, size_t len, FILE *file)
+{
+        size_t n = 0, size = 1;
+        syscall(SYSCALL_FWRITE, &n, ptr, &size, &len, file);
+        return cast(ssize_t, n) < 0 ? 0 : n;
+}
+
+//==============================================================================
+/**
+ * @brief  Function write data collected in stream buffer. Buffer must be
+ *         locked.
+ *
+ * @param  fbuf         stream buffer
+ *
+ * @return On success 0 is returned, otherwise EOF.
+ */
+//==============================================================================
+int _stdio_drain(stdio_buf_t *fbuf)
+{
+        if (!fbuf->wr) {
+                return 0;
+        }
+
+        size_t len = fbuf->pos;
+        fbuf->pos  = 0;
+        fbuf->wr   = false;
+
+        size_t n = _stdio_write(fbuf->data, len, fbuf->file);
+        if (n < len) {
+                memmove(fbuf->data, fbuf->data + n, len - n);
+                fbuf->pos = len - n;
+                fbuf->wr  = true;
+                return EOF;
+        }
+
+        return 0;
+}
+
+//==============================================================================
+/**
+ * @brief  Function sets stream buffer of current process.
+ *
+ * @param  file         stream
+ * @param  buffer       user buffer (NULL to allocate buffer)
+ * @param  mode         buffer mode (_IOFBF, _IOLBF, _IONBF)
+ * @param  size         buffer size
+ *
+ * @return On success 0 is returned, otherwise EOF and errno is set.
+ */
+//==============================================================================
+int setvbuf(FILE *file, char *buffer, int mode, size_t size)
+{
+        if (!file || mode < _IOFBF || mode > _IONBF || (mode != _IONBF && size == 0)) {
+                _errno = EINVAL;
+                return EOF;
+        }
+
+        stdio_buf_t *fbuf = buf_lock(file, BUF_CREATE);
+        if (!fbuf) {
+                _errno = ENOMEM;
+                return EOF;
+        }
+
+        int err = ESUCC;
+
+        if (_stdio_drain(fbuf) != 0) {
+                err = EIO;
+        } else {
+                buf_discard(fbuf);
+                err = buf_set(fbuf, buffer, mode, size);
+        }
+
+        _stdio_unlock(fbuf);
+
+        if (err) {
+                _errno = err;
+                return EOF;
+        }
+
+        return 0;
+}
+
+//==============================================================================
+/**
+ * @brief  Function write buffered data of stream. If stream is NULL then
+ *         buffers of all streams used by current process are written.
+ *
+ * @param  file         stream
+ *
+ * @return On success 0 is returned, otherwise EOF and errno is set.
+ */
+//==============================================================================
+int fflush(FILE *file)
+{
+        int r = 0;
+
+        if (file == NULL) {
+                stdio_t *stdio = stdio_get(false);
+                if (stdio) {
+                        _builtinfunc(mutex_lock, stdio->mtx, MAX_DELAY_MS);
+
+                        for (stdio_buf_t *fbuf = stdio->list; fbuf; fbuf = fbuf->next) {
+                                if (_stdio_drain(fbuf) != 0) {
+                                        r = EOF;
+                                }
+                        }
+
+                        _builtinfunc(mutex_unlock, stdio->mtx);
+                }
+
+                return r;
+        }
+
+        stdio_buf_t *fbuf = _stdio_lock(file, false);
+        if (fbuf) {
+                r = _stdio_drain(fbuf);
+                buf_discard(fbuf);
+        }
+
+        if (r == 0) {
+                r = EOF;
+                syscall(SYSCALL_FFLUSH, &r, file);
+        }
+
+        if (fbuf) {
+                _stdio_unlock(fbuf);
+        }
+
+        return r;
+}
+
+//==============================================================================
+/**
+ * @brief  Function set file position. Buffered data is written or dropped.
+ *
+ * @param  file         stream
+ * @param  offset       offset
+ * @param  mode         seek mode (SEEK_SET, SEEK_CUR, SEEK_END)
+ *
+ * @return On success 0 is returned, otherwise nonzero value.
+ */
+//==============================================================================
+int fseek(FILE *file, i64_t offset, int mode)
+{
+        int r = 0;
+
+        stdio_buf_t *fbuf = _stdio_lock(file, false);
+        if (fbuf) {
+                r = _stdio_drain(fbuf);
+
+                if (!fbuf->wr) {
+                        if (mode == SEEK_CUR) {
+                                offset -= cast(i64_t, fbuf->len - fbuf->pos);
+                        }
+
+                        fbuf->pos = 0;
+                        fbuf->len = 0;
+                }
+        }
+
+        if (r == 0) {
+                r = EOF;
+                syscall(SYSCALL_FSEEK, &r, file, &offset, &mode);
+        }
+
+        if (fbuf) {
+                _stdio_unlock(fbuf);
+        }
+
+        return r;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return file position including buffered data.
+ *
+ * @param  file         stream
+ *
+ * @return File position or -1 on error.
+ */
+//==============================================================================
+i64_t ftell(FILE *file)
+{
+        i64_t lseek = 0;
+
+        stdio_buf_t *fbuf = _stdio_lock(file, false);
+
+        _errno = _builtinfunc(vfs_ftell, file, &lseek);
+
+        if (fbuf) {
+                if (!_errno) {
+                        if (fbuf->wr) {
+                                lseek += fbuf->pos;
+                        } else {
+                                lseek -= fbuf->len - fbuf->pos;
+                        }
+                }
+
+                _stdio_unlock(fbuf);
+        }
+
+        return _errno ? -1 : lseek;
+}
+
+//==============================================================================
+/**
+ * @brief  Function check end-of-file indicator. Stream is not at the end if
+ *         read data are still in buffer.
+ *
+ * @param  file         stream
+ *
+ * @return Nonzero value if end of file is reached, otherwise 0.
+ */
+//==============================================================================
+int feof(FILE *file)
+{
+        int eof = 0;
+
+        stdio_buf_t *fbuf = _stdio_lock(file, false);
+
+        _errno = _builtinfunc(vfs_feof, file, &eof);
+
+        if (fbuf) {
+                if (!fbuf->wr && (fbuf->pos < fbuf->len)) {
+                        eof = 0;
+                }
+
+                _stdio_unlock(fbuf);
+        }
+
+        return _errno | eof;
+}
+
+//==============================================================================
+/**
+ * @brief  Function close stream. Buffered data is written and buffer of
+ *         process is released.
+ *
+ * @param  file         stream
+ *
+ * @return On success 0 is returned, otherwise EOF.
+ */
+//==============================================================================
+int fclose(FILE *file)
+{
+        stdio_buf_t *fbuf = buf_lock(file, BUF_FIND);
+        if (fbuf) {
+                if (fbuf->data) {
+                        _stdio_drain(fbuf);
+                }
+
+                buf_remove(fbuf);
+        }
+
+        int r = EOF;
+        syscall(SYSCALL_FCLOSE, &r, file);
+        return r;
+}
+
+/*==============================================================================
+  End of file
+==============================================================================*/
@@ -0,0 +1,88 @@
+/*=========================================================================*//**
+@file    stdio_buf.h
+
+@author  Daniel Zorychta
+
+@brief   Stream buffer helpers used by stdio functions.
+
+@note    Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+#ifndef _STDIO_BUF_H_
+#define _STDIO_BUF_H_
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include <config.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*==============================================================================
+  Exported macros
+==============================================================================*/
+
+/*==============================================================================
+  Exported object types
+==============================================================================*/
+/**
+ * Stream buffer. Buffers are owned by process, so each process that uses
+ * shared stream (e.g. stdout) has own buffer. Buffers of process are
+ * protected by a single recursive mutex.
+ */
+typedef struct stdio_buf {
+        struct stdio_buf *next;                 //!< next buffer of process
+        mutex_t          *mtx;                  //!< process stream buffers lock
+        FILE             *file;                 //!< buffered stream
+        u8_t             *data;                 //!< buffer data (NULL if stream is unbuffered)
+        size_t            size;                 //!< buffer size
+        size_t            pos;                  //!< read position or number of bytes to write
+        size_t            len;                  //!< number of bytes read to buffer
+        u8_t              mode;                 //!< buffer mode (_IOFBF, _IOLBF, _IONBF)
+        bool              wr;                   //!< buffer contains data to write
+        bool              own;                  //!< buffer data allocated by library
+} stdio_buf_t;
+
+/*==============================================================================
+  Exported objects
+==============================================================================*/
+
+/*==============================================================================
+  Exported functions
+==============================================================================*/
+extern stdio_buf_t *_stdio_lock(FILE *file, bool create);
+extern void         _stdio_unlock(stdio_buf_t *fbuf);
+extern int          _stdio_drain(stdio_buf_t *fbuf);
+extern size_t       _stdio_read(void *ptr, size_t len, FILE *file);
+extern size_t       _stdio_write(const void *ptr, size_t len, FILE *file);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _STDIO_BUF_H_ */
+/*==============================================================================
+  End of file
+==============================================================================*/
@@ -36,6 +36,8 @@ Brief    Cache management.
 #include "kernel/kwrapper.h"
 #include "kernel/kpanic.h"
 #include "kernel/sysfunc.h"
+#include "kernel/process.h"
+#include "kernel/syscall.h"
 #include "lib/cast.h"
 #include "lib/unarg.h"
 
@@ -45,14 +47,40 @@ Brief    Cache management.
 #define cache_buf(cache)        cache[1]
 #define MTX_TIMEOUT             MAX_DELAY_MS
 
+/**
+ * Number of hash table buckets (must be power of 2).
+ */
+#define HASH_TABLE_SIZE         64
+
+/**
+ * Maximum number of contiguous dirty blocks merged in single write request
+ * during synchronization.
+ */
+#define SYNC_MERGE_MAX_BLOCKS   16
+
+/**
+ * Maximum number of devices with enabled read-ahead.
+ */
+#define READAHEAD_DEVICES       4
+
+/**
+ * Initial read-ahead window [blocks].
+ */
+#define READAHEAD_MIN_WINDOW    2
+
+/**
+ * Maximum number of blocks read by read-ahead thread in single request.
+ */
+#define READAHEAD_CHUNK         8
+
 /*==============================================================================
   Local object types
 ==============================================================================*/
 typedef struct cache {
-        struct cache       *next;               //!< next cache object
-        struct cache       *prev;               //!< previous cache object
+        struct cache       *next;               //!< next (less recently used) cache object
+        struct cache       *prev;               //!< previous (more recently used) cache object
+        struct cache       *hnext;              //!< next cache object in hash bucket
         dev_t               dev;                //!< device ID (final medium)
-        i32_t               temp;               //!< cache temperature
         u32_t               pos;                //!< file position (block number)
         size_t              size;               //!< block size
         bool                dirty;              //!< cache is dirty
@@ -60,9 +88,29 @@ typedef struct cache {
 } cache_t;
 
 typedef struct {
-        cache_t            *list_head;          //!< the smallest cache
+        dev_t               dev;                //!< device
+        size_t              max_window;         //!< maximum window [blocks], 0 if disabled
+        size_t              window;             //!< current window [blocks]
+        u32_t               next_blk;           //!< expected next block of sequential access
+        u32_t               end_blk;            //!< end of already requested blocks
+        u32_t               blkpos;             //!< first block to prefetch
+        size_t              blksz;              //!< block size
+        size_t              blkcnt;             //!< number of blocks to prefetch
+} readahead_t;
+
+typedef struct {
+        cache_t            *list_head;          //!< the most recently used cache
+        cache_t            *list_tail;          //!< the least recently used cache
+        cache_t            *hash[HASH_TABLE_SIZE]; //!< cache index (device, block)
         mutex_t            *list_mtx;           //!< protection mutex
         bool                sync_needed;        //!< FS synchronization needed to free dirty caches
+        u32_t               hits;               //!< number of blocks found in cache
+        u32_t               misses;             //!< number of blocks not found in cache
+        u32_t               evictions;          //!< number of blocks evicted by memory pressure
+        u32_t               prefetched;         //!< number of blocks read in advance
+        size_t              size;               //!< size of cached blocks [bytes]
+        readahead_t         ra[READAHEAD_DEVICES];//!< read-ahead state of devices
+        sem_t              *ra_sem;             //!< read-ahead request semaphore
 } cache_man_t;
 
 /*==============================================================================
@@ -87,7 +135,144 @@ static cache_man_t cman;
 /*==============================================================================
   Function definitions
 ==============================================================================*/
+//==============================================================================
+/**
+ * @brief Function write contiguous blocks to device in single request.
+ *
+ * @param  dev          block device
+ * @param  blkpos       first block position
+ * @param  blksz        block size
+ * @param  blkcnt       block count
+ * @param  buf          buffer to write from (blocks)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int write_blocks(dev_t dev, u32_t blkpos, size_t blksz, size_t blkcnt, const u8_t *buf)
+{
+        fpos_t fpos  = cast(fpos_t, blkpos) * blksz;
+        size_t wrcnt = 0;
+        size_t wrsz  = blksz * blkcnt;
+        struct vfs_fattr fattr = {false, false};
+
+        int err = _driver_write(dev, buf, wrsz, &fpos, &wrcnt, fattr);
+
+        if (!err && (wrcnt != wrsz)) {
+                err = EIO;
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief Function read contiguous blocks from device in single request.
+ *
+ * @param  dev          block device
+ * @param  blkpos       first block position
+ * @param  blksz        block size
+ * @param  blkcnt       block count
+ * @param  buf          buffer to read (blocks)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int read_blocks(dev_t dev, u32_t blkpos, size_t blksz, size_t blkcnt, u8_t *buf)
+{
+        fpos_t fpos  = cast(fpos_t, blkpos) * blksz;
+        size_t rdcnt = 0;
+        size_t rdsz  = blksz * blkcnt;
+        struct vfs_fattr fattr = {false, false};
+
+        int err = _driver_read(dev, buf, rdsz, &fpos, &rdcnt, fattr);
+
+        if (!err && (rdcnt != rdsz)) {
+                err = EIO;
+        }
+
+        return err;
+}
+
 #if __OS_SYSTEM_FS_CACHE_ENABLE__ > 0
+//==============================================================================
+/**
+ * @brief Function calculate hash table bucket of selected block.
+ *
+ * @param  dev          device
+ * @param  blkpos       block position
+ *
+ * @return Bucket index.
+ */
+//==============================================================================
+static inline size_t cache_hash(dev_t dev, u32_t blkpos)
+{
+        u32_t key = (cast(u32_t, dev) * 0x9E3779B1) ^ blkpos;
+        key ^= key >> 16;
+
+        return key & (HASH_TABLE_SIZE - 1);
+}
+
+//==============================================================================
+/**
+ * @brief Function add cache object at the beginning of LRU list.
+ *
+ * @param  cache        cache object
+ */
+//==============================================================================
+static void lru_link(cache_t *cache)
+{
+        cache->prev = NULL;
+        cache->next = cman.list_head;
+
+        if (cman.list_head) {
+                cman.list_head->prev = cache;
+        } else {
+                cman.list_tail = cache;
+        }
+
+        cman.list_head = cache;
+}
+
+//==============================================================================
+/**
+ * @brief Function remove cache object from LRU list.
+ *
+ * @param  cache        cache object
+ */
+//==============================================================================
+static void lru_unlink(cache_t *cache)
+{
+        if (cache->prev) {
+                cache->prev->next = cache->next;
+        } else {
+                cman.list_head = cache->next;
+        }
+
+        if (cache->next) {
+                cache->next->prev = cache->prev;
+        } else {
+                cman.list_tail = cache->prev;
+        }
+
+        cache->next = NULL;
+        cache->prev = NULL;
+}
+
+//==============================================================================
+/**
+ * @brief Function mark cache object as the most recently used.
+ *
+ * @param  cache        cache object
+ */
+//==============================================================================
+static void lru_touch(cache_t *cache)
+{
+        if (cache != cman.list_head) {
+                lru_unlink(cache);
+                lru_link(cache);
+        }
+}
+
 //==============================================================================
 /**
  * @brief Function allocate new cache object and add to list.
@@ -112,15 +297,14 @@ static int cache_alloc(dev_t dev, u32_t blkpos, size_t blksz, cache_t **cache)
                 (*cache)->dev  = dev;
                 (*cache)->pos  = blkpos;
                 (*cache)->size = blksz;
-                (*cache)->next = cman.list_head;
 
-                if ((*cache)->next) {
-                        (*cache)->next->prev = *cache;
-                }
+                size_t bucket     = cache_hash(dev, blkpos);
+                (*cache)->hnext   = cman.hash[bucket];
+                cman.hash[bucket] = *cache;
 
-                cman.list_head = *cache;
+                lru_link(*cache);
 
-                printk("CACHE: created (%d B)", blksz);
+                cman.size += blksz;
         }
 
         return err;
@@ -140,25 +324,20 @@ static int cache_free(cache_t *cache)
         int err = EINVAL;
 
         if (cache) {
-                printk("CACHE: freed (%d B)", cache->size);
-
-                if (cache == cman.list_head) {
-                        cman.list_head = cache->next;
-
-                        if (cman.list_head) {
-                                cman.list_head->prev = NULL;
+                cache_t **c = &cman.hash[cache_hash(cache->dev, cache->pos)];
+                while (*c) {
+                        if (*c == cache) {
+                                *c = cache->hnext;
+                                break;
                         }
 
-                } else {
-                        if (cache->next) {
-                                cache->next->prev = cache->prev;
-                        }
-
-                        if (cache->prev) {
-                                cache->prev->next = cache->next;
-                        }
+                        c = &(*c)->hnext;
                 }
 
+                lru_unlink(cache);
+
+                cman.size -= cache->size;
+
                 memset(cache, 0, sizeof(cache_t));
 
                 err = _kfree(_MM_CACHE, cast(void*, &cache));
@@ -172,7 +351,7 @@ static int cache_free(cache_t *cache)
 
 //==============================================================================
 /**
- * @brief Function search cache of selected parameters in list.
+ * @brief Function search cache of selected parameters in hash table.
  *        Only files that are linked directly to drivers are supported. Regular
  *        files are not supported because can be buffered by parent file system.
  *
@@ -187,10 +366,8 @@ static int cache_find(dev_t dev, u32_t blkpos, cache_t **cache)
 {
         int err = ENOENT;
 
-        cache_t *c = cman.list_head;
+        cache_t *c = cman.hash[cache_hash(dev, blkpos)];
         while (c) {
-                cache_t *next = c->next;
-
                 if ((c->dev == dev) && (c->pos == blkpos)) {
 
                         *cache = c;
@@ -198,7 +375,7 @@ static int cache_find(dev_t dev, u32_t blkpos, cache_t **cache)
                         break;
                 }
 
-                c = next;
+                c = c->hnext;
         }
 
         return err;
@@ -206,48 +383,278 @@ static int cache_find(dev_t dev, u32_t blkpos, cache_t **cache)
 
 //==============================================================================
 /**
- * @brief Function analyze caches and find the lowest temperature of cache and
- *        calculate how many this caches is. Function calculate count of dirty
- *        caches and total number of caches.
- *
- * @param  tmin         minimal temperature
- * @param  tmincnt      number of caches of minimal temperature
- * @param  dirty        number of dirty caches
- * @param  count        number of all caches
+ * @brief Function return read-ahead object of selected device.
+ *
+ * @param  dev          device
+ *
+ * @return Read-ahead object or NULL if read-ahead is disabled for device.
  */
 //==============================================================================
-static void get_cache_stats(i32_t *tmin, size_t *tmincnt, size_t *dirty, size_t *count)
+static readahead_t *readahead_get(dev_t dev)
 {
-        *tmin    = INT32_MAX;
-        *tmincnt = 0;
-        *dirty   = 0;
-        *count   = 0;
-
-        cache_t *cache = cman.list_head;
-        while (cache) {
-                if (!cache->dirty) {
-                        if (cache->temp < *tmin) {
-                                *tmin    = cache->temp;
-                                *tmincnt = 1;
-
-                        } else if (cache->temp == *tmin) {
-                                *tmincnt += 1;
+        for (size_t i = 0; i < READAHEAD_DEVICES; i++) {
+                if (cman.ra[i].max_window && cman.ra[i].dev == dev) {
+                        return &cman.ra[i];
+                }
+        }
+
+        return NULL;
+}
+
+//==============================================================================
+/**
+ * @brief Function detect sequential access of device and request prefetch of
+ *        next blocks. Window is doubled on each sequential access up to the
+ *        maximum value and is limited by free memory. Read-ahead is not
+ *        started if cached data occupies more memory than is still free.
+ *        Function must be called when cache list is locked.
+ *
+ * @param  dev          device
+ * @param  blkpos       block position
+ * @param  blksz        block size
+ * @param  blkcnt       block count
+ */
+//==============================================================================
+static void readahead_detect(dev_t dev, u32_t blkpos, size_t blksz, size_t blkcnt)
+{
+        readahead_t *ra = readahead_get(dev);
+        if (!ra) {
+                return;
+        }
+
+        if (blkpos == ra->next_blk) {
+                ra->window = max(ra->window * 2, READAHEAD_MIN_WINDOW);
+                ra->window = min(ra->window, ra->max_window);
+        } else {
+                ra->window  = 0;
+                ra->end_blk = 0;
+        }
+
+        ra->next_blk = blkpos + blkcnt;
+
+        size_t free  = _mm_get_mem_free();
+        size_t spare = 0;
+
+        if (free > __OS_SYSTEM_CACHE_MIN_FREE__) {
+                spare = (free - __OS_SYSTEM_CACHE_MIN_FREE__) / 2;
+        }
+
+        size_t window = ra->window;
+
+        if (cman.size >= free) {
+                window = 0;
+        } else {
+                window = min(window, spare / (blksz + sizeof(cache_t)));
+        }
+
+        u32_t begin = max(ra->next_blk, ra->end_blk);
+        u32_t end   = ra->next_blk + window;
+
+        if ((end > begin) && (ra->blkcnt == 0)) {
+                ra->blkpos  = begin;
+                ra->blkcnt  = end - begin;
+                ra->blksz   = blksz;
+                ra->end_blk = end;
+
+                _semaphore_signal(cman.ra_sem);
+        }
+}
+
+//==============================================================================
+/**
+ * @brief Function read selected blocks to the cache if not cached yet.
+ *
+ * @param  dev          block device
+ * @param  blkpos       block position
+ * @param  blksz        block size
+ * @param  blkcnt       block count
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int cache_prefetch(dev_t dev, u32_t blkpos, size_t blksz, size_t blkcnt)
+{
+        u8_t *buf = NULL;
+        int   err = _kmalloc(_MM_CACHE, blkcnt * blksz, cast(void*, &buf));
+        if (!err) {
+                err = _mutex_lock(cman.list_mtx, MTX_TIMEOUT);
+                if (!err) {
+                        // read-ahead disabled in the meantime
+                        if (!readahead_get(dev)) {
+                                blkcnt = 0;
                         }
-                } else {
-                        *dirty += 1;
+
+                        while (!err && blkcnt) {
+                                cache_t *cache = NULL;
+
+                                if (cache_find(dev, blkpos, &cache) == ESUCC) {
+                                        blkpos++;
+                                        blkcnt--;
+                                        continue;
+                                }
+
+                                size_t n = 1;
+                                while (  (n < blkcnt)
+                                      && (cache_find(dev, blkpos + n, &cache) != ESUCC) ) {
+                                        n++;
+                                }
+
+                                err = read_blocks(dev, blkpos, blksz, n, buf);
+
+                                for (size_t i = 0; !err && i < n; i++) {
+                                        err = cache_alloc(dev, blkpos + i, blksz, &cache);
+                                        if (!err) {
+                                                memcpy(&cache_buf(cache), &buf[i * blksz], blksz);
+                                                cman.prefetched++;
+                                        }
+                                }
+
+                                blkpos += n;
+                                blkcnt -= n;
+                        }
+
+                        _mutex_unlock(cman.list_mtx);
+                }
+
+                _kfree(_MM_CACHE, cast(void*, &buf));
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief Read-ahead thread. Thread reads blocks requested by sequential access
+ *        detector in background.
+ *
+ * @param  arg          not used
+ */
+//==============================================================================
+static void readahead_thread(void *arg)
+{
+        UNUSED_ARG1(arg);
+
+        for (;;) {
+                if (_semaphore_wait(cman.ra_sem, MAX_DELAY_MS) != ESUCC) {
+                        continue;
                 }
 
-                *count += 1;
-                cache   = cache->next;
+                for (size_t i = 0; i < READAHEAD_DEVICES; i++) {
+                        dev_t  dev    = 0;
+                        u32_t  blkpos = 0;
+                        size_t blksz  = 0;
+                        size_t blkcnt = 0;
+
+                        if (_mutex_lock(cman.list_mtx, MTX_TIMEOUT) == ESUCC) {
+                                readahead_t *ra = &cman.ra[i];
+
+                                dev        = ra->dev;
+                                blkpos     = ra->blkpos;
+                                blksz      = ra->blksz;
+                                blkcnt     = ra->max_window ? ra->blkcnt : 0;
+                                ra->blkcnt = 0;
+
+                                _mutex_unlock(cman.list_mtx);
+                        }
+
+                        while (blkcnt) {
+                                size_t n = min(blkcnt, READAHEAD_CHUNK);
+
+                                if (cache_prefetch(dev, blkpos, blksz, n) != ESUCC) {
+                                        break;
+                                }
+
+                                blkpos += n;
+                                blkcnt -= n;
+                        }
+                }
         }
 }
 
+//==============================================================================
+/**
+ * @brief Function synchronize selected dirty cache with device. Dirty caches
+ *        of next contiguous blocks of the same device are merged and written
+ *        in single request. If selected cache is in the middle of dirty blocks
+ *        run then synchronization starts from the first block of run.
+ *
+ * @param  cache        dirty cache object
+ * @param  synced       number of synchronized caches (incremented)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+static int cache_flush(cache_t *cache, u16_t *synced)
+{
+        cache_t *c = NULL;
+
+        // find first block of dirty run
+        while (  cache->pos > 0
+              && cache_find(cache->dev, cache->pos - 1, &c) == ESUCC
+              && c->dirty && c->size == cache->size) {
+
+                cache = c;
+        }
+
+        // calculate length of dirty run
+        size_t n = 1;
+        while (  n < SYNC_MERGE_MAX_BLOCKS
+              && cache_find(cache->dev, cache->pos + n, &c) == ESUCC
+              && c->dirty && c->size == cache->size) {
+
+                n++;
+        }
+
+        u8_t *blks = NULL;
+        if (n > 1) {
+                if (_kmalloc(_MM_CACHE, n * cache->size, cast(void*, &blks)) != ESUCC) {
+                        n = 1;
+                }
+        }
+
+        int err;
+
+        if (blks) {
+                c = cache;
+                for (size_t i = 0; i < n; i++) {
+                        memcpy(&blks[i * cache->size], &cache_buf(c), c->size);
+                        cache_find(cache->dev, cache->pos + i + 1, &c);
+                }
+
+                err = write_blocks(cache->dev, cache->pos, cache->size, n, blks);
+
+                _kfree(_MM_CACHE, cast(void*, &blks));
+
+        } else {
+                err = write_blocks(cache->dev, cache->pos, cache->size, 1,
+                                   cast(const u8_t*, &cache_buf(cache)));
+        }
+
+        if (err) {
+                printk("CACHE: sync error %d [%d:%d:%d]", err,
+                       _dev_t__extract_modno(cache->dev),
+                       _dev_t__extract_major(cache->dev),
+                       _dev_t__extract_minor(cache->dev));
+        } else {
+                c = cache;
+                for (size_t i = 0; i < n; i++) {
+                        c->dirty = false;
+                        cache_find(cache->dev, cache->pos + i + 1, &c);
+                }
+
+                *synced += n;
+        }
+
+        return err;
+}
+
 //==============================================================================
 /**
  * @brief Function write block to selected device. If cache exist then block is
  *        write to the cache. If cache does not exist then new one is created.
  *        When CACHE_WRITE_THROUGH is used then data is write both to the cache
- *        and device.
+ *        and device. Contiguous blocks that cannot be cached are written to
+ *        the device in single request.
  *
  * @param  dev          block device
  * @param  blkpos       block position
@@ -264,25 +671,27 @@ static int _cache_write(dev_t dev, u32_t blkpos, size_t blksz, size_t blkcnt, co
         int err = ESUCC;
 
         if (mode == CACHE_WRITE_THROUGH) {
-                fpos_t fpos  = cast(fpos_t, blkpos) * blksz;
-                size_t wrcnt = 0;
-                size_t wrsz  = blksz * blkcnt;
-                struct vfs_fattr fattr = {false, false};
-
-                err = _driver_write(dev, buf, wrsz, &fpos, &wrcnt, fattr);
+                err = write_blocks(dev, blkpos, blksz, blkcnt, buf);
+        }
 
-                if (!err && (wrcnt != wrsz) ) {
-                        err = EIO;
-                }
+        if (!err) {
+                err = _mutex_lock(cman.list_mtx, MTX_TIMEOUT);
         }
 
-        while (!err && blkcnt--) {
-                cache_t *cache = NULL;
+        if (!err) {
+                const u8_t *direct_buf = NULL;
+                u32_t       direct_pos = 0;
+                size_t      direct_cnt = 0;
 
-                err = _mutex_lock(cman.list_mtx, MTX_TIMEOUT);
-                if (!err) {
+                while (!err && blkcnt--) {
+                        cache_t *cache = NULL;
 
-                        if (cache_find(dev, blkpos, &cache) != ESUCC) {
+                        if (cache_find(dev, blkpos, &cache) == ESUCC) {
+                                lru_touch(cache);
+                                cman.hits++;
+
+                        } else {
+                                cman.misses++;
 
                                 if (cache_alloc(dev, blkpos, blksz, &cache) != ESUCC) {
                                         cache = NULL;
@@ -292,26 +701,27 @@ static int _cache_write(dev_t dev, u32_t blkpos, size_t blksz, size_t blkcnt, co
                         if (cache) {
                                 memcpy(&cache_buf(cache), buf, blksz);
                                 cache->dirty = true;
-                                cache->temp++;
-                        }
-
-                        _mutex_unlock(cman.list_mtx);
-                }
 
-                if (!err && !cache && mode != CACHE_WRITE_THROUGH) {
-                        fpos_t fpos  = cast(fpos_t, blkpos) * blksz;
-                        size_t wrcnt = 0;
-                        struct vfs_fattr fattr = {false, false};
+                        } else if (mode != CACHE_WRITE_THROUGH) {
+                                if (direct_cnt == 0) {
+                                        direct_buf = buf;
+                                        direct_pos = blkpos;
+                                }
 
-                        err = _driver_write(dev, buf, blksz, &fpos, &wrcnt, fattr);
+                                direct_cnt++;
+                        }
 
-                        if (!err && wrcnt != blksz) {
-                                err = EIO;
+                        if (direct_cnt && (cache || blkcnt == 0)) {
+                                err = write_blocks(dev, direct_pos, blksz,
+                                                   direct_cnt, direct_buf);
+                                direct_cnt = 0;
                         }
+
+                        blkpos++;
+                        buf += blksz;
                 }
 
-                blkpos++;
-                buf += blksz;
+                _mutex_unlock(cman.list_mtx);
         }
 
         return err;
@@ -321,7 +731,9 @@ static int _cache_write(dev_t dev, u32_t blkpos, size_t blksz, size_t blkcnt, co
 /**
  * @brief Function read block from selected device. If cache exist then cache
  *        data is used. If cache does not exist then file is read and new cache
- *        is created.
+ *        is created. Contiguous blocks that are not cached are read from the
+ *        device in single request. If read-ahead is enabled for the device
+ *        then sequential access triggers prefetch of next blocks.
  *
  * @param  dev          block dev
  * @param  blkpos       block position
@@ -334,41 +746,52 @@ static int _cache_write(dev_t dev, u32_t blkpos, size_t blksz, size_t blkcnt, co
 //==============================================================================
 static int _cache_read(dev_t dev, u32_t blkpos, size_t blksz, size_t blkcnt, u8_t *buf)
 {
-        int err = ESUCC;
+        u32_t  first = blkpos;
+        size_t count = blkcnt;
 
-        while (!err && blkcnt--) {
-                cache_t *cache = NULL;
+        int err = _mutex_lock(cman.list_mtx, MTX_TIMEOUT);
+        if (!err) {
 
-                err = _mutex_lock(cman.list_mtx, MTX_TIMEOUT);
-                if (!err) {
+                while (!err && blkcnt) {
+                        cache_t *cache = NULL;
 
                         if (cache_find(dev, blkpos, &cache) == ESUCC) {
                                 memcpy(buf, &cache_buf(cache), blksz);
-                                cache->temp++;
+                                lru_touch(cache);
+                                cman.hits++;
+
+                                blkpos++;
+                                buf += blksz;
+                                blkcnt--;
 
                         } else {
-                                fpos_t fpos  = cast(fpos_t, blkpos) * blksz;
-                                size_t rdcnt = 0;
-                                struct vfs_fattr fattr = {false, false};
+                                size_t n = 1;
+                                while (  (n < blkcnt)
+                                      && (cache_find(dev, blkpos + n, &cache) != ESUCC) ) {
+                                        n++;
+                                }
 
-                                err = _driver_read(dev, buf, blksz, &fpos, &rdcnt, fattr);
+                                cman.misses += n;
 
-                                if (!err && rdcnt != blksz) {
-                                        err = EIO;
-                                }
+                                err = read_blocks(dev, blkpos, blksz, n, buf);
 
-                                if (!err) {
+                                while (!err && n--) {
                                         if (cache_alloc(dev, blkpos, blksz, &cache) == ESUCC) {
                                                 memcpy(&cache_buf(cache), buf, blksz);
                                         }
+
+                                        blkpos++;
+                                        buf += blksz;
+                                        blkcnt--;
                                 }
                         }
+                }
 
-                        _mutex_unlock(cman.list_mtx);
+                if (!err) {
+                        readahead_detect(dev, first, blksz, count);
                 }
 
-                blkpos++;
-                buf += blksz;
+                _mutex_unlock(cman.list_mtx);
         }
 
         return err;
@@ -404,35 +827,12 @@ void _cache_sync(void)
         if (!err) {
                 u16_t sync_cnt = 0;
 
-                cache_t *cache = cman.list_head;
-
-                while (cache) {
-                        cache_t *next = cache->next;
-
-                        if (cache->dirty) {
-
-                                fpos_t fpos  = cast(fpos_t, cache->pos) * cache->size;
-                                size_t wrcnt = 0;
-                                struct vfs_fattr fattr = {false, false};
-
-                                int e = _driver_write(cache->dev,
-                                                      cast(const u8_t*, &cache_buf(cache)),
-                                                      cache->size, &fpos, &wrcnt, fattr);
-                                if (e) {
-                                        printk("CACHE: sync error %d [%d:%d:%d]", e,
-                                               _dev_t__extract_modno(cache->dev),
-                                               _dev_t__extract_major(cache->dev),
-                                               _dev_t__extract_minor(cache->dev));
-                                } else {
-                                        cache->dirty = false;
+                for (cache_t *cache = cman.list_head; cache; cache = cache->next) {
+                        while (cache->dirty) {
+                                if (cache_flush(cache, &sync_cnt) != ESUCC) {
+                                        break;
                                 }
-
-                                sync_cnt++;
                         }
-
-                        cache->temp--;
-
-                        cache = next;
                 }
 
                 cman.sync_needed = false;
@@ -493,36 +893,26 @@ void _cache_reduce(size_t size)
         int err = _mutex_lock(cman.list_mtx, MTX_TIMEOUT);
         if (!err) {
 
-                if (cman.list_head && to_reduce > 0) {
-
-                        // Algorithm find caches that have the lowest
-                        // temperature that means there are used very rare.
-                        i32_t  tmin;
-                        size_t tmincnt, dirty, count;
-                        get_cache_stats(&tmin, &tmincnt, &dirty, &count);
-
-                        while (to_reduce > 0 && dirty < count) {
-
-                                cache_t *cache = cman.list_head;
-                                while (cache && tmincnt > 0) {
-                                        cache_t *next = cache->next;
+                if (cman.list_tail && to_reduce > 0) {
 
-                                        if (!cache->dirty && cache->temp == tmin) {
-                                                to_reduce -= cache->size + sizeof(cache_t);
-                                                cache_free(cache);
-                                                tmincnt--;
+                        // Algorithm frees the least recently used caches
+                        // starting from the end of the LRU list. Dirty caches
+                        // are skipped because must be synchronized first.
+                        size_t dirty = 0;
 
-                                                if (to_reduce <= 0) {
-                                                        break;
-                                                }
-                                        }
+                        cache_t *cache = cman.list_tail;
+                        while (cache && to_reduce > 0) {
+                                cache_t *prev = cache->prev;
 
-                                        cache = next;
+                                if (cache->dirty) {
+                                        dirty++;
+                                } else {
+                                        to_reduce -= cache->size + sizeof(cache_t);
+                                        cache_free(cache);
+                                        cman.evictions++;
                                 }
 
-                                if (to_reduce > 0) {
-                                        get_cache_stats(&tmin, &tmincnt, &dirty, &count);
-                                }
+                                cache = prev;
                         }
 
                         // There is still not enough space so system try to
@@ -557,6 +947,49 @@ bool _cache_is_sync_needed(void)
 #endif
 }
 
+//==============================================================================
+/**
+ * @brief Function return statistics of cache subsystem.
+ *
+ * @param  stat         statistics (result)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _cache_get_stat(_cache_stat_t *stat)
+{
+        if (!stat) {
+                return EINVAL;
+        }
+
+        memset(stat, 0, sizeof(_cache_stat_t));
+
+#if __OS_SYSTEM_FS_CACHE_ENABLE__ > 0
+        int err = _mutex_lock(cman.list_mtx, MTX_TIMEOUT);
+        if (!err) {
+                stat->hits       = cman.hits;
+                stat->misses     = cman.misses;
+                stat->evictions  = cman.evictions;
+                stat->prefetched = cman.prefetched;
+
+                for (cache_t *cache = cman.list_head; cache; cache = cache->next) {
+                        stat->blocks++;
+                        stat->size += cache->size;
+
+                        if (cache->dirty) {
+                                stat->dirty_blocks++;
+                        }
+                }
+
+                _mutex_unlock(cman.list_mtx);
+        }
+
+        return err;
+#else
+        return ESUCC;
+#endif
+}
+
 //==============================================================================
 /**
  * @brief  Function drop cache of selected device (sync on dirty pages).
@@ -595,26 +1028,17 @@ int sys_cache_drop(FILE *file)
                         if (cache->dev == stat.st_dev) {
 
                                 if (cache->dirty) {
-
-                                        fpos_t fpos  = cast(fpos_t, cache->pos) * cache->size;
-                                        size_t wrcnt = 0;
-                                        struct vfs_fattr fattr = {false, false};
-
-                                        err = _driver_write(cache->dev,
-                                                            cast(const u8_t*, &cache_buf(cache)),
-                                                            cache->size, &fpos, &wrcnt, fattr);
-                                        if (err) {
-                                                printk("CACHE: sync error %d [%d:%d:%d]", err,
-                                                       _dev_t__extract_modno(cache->dev),
-                                                       _dev_t__extract_major(cache->dev),
-                                                       _dev_t__extract_minor(cache->dev));
-                                        } else {
-                                                cache->dirty = false;
-                                        }
+                                        u16_t synced = 0;
+                                        err = cache_flush(cache, &synced);
                                 }
 
-                                if (!err) {
+                                if (!err && !cache->dirty) {
                                         cache_free(cache);
+
+                                } else if (!err) {
+                                        // cache was not first block of dirty run
+                                        // and it will be visited again
+                                        continue;
                                 }
                         }
 
@@ -629,6 +1053,85 @@ int sys_cache_drop(FILE *file)
         return err;
 }
 
+//==============================================================================
+/**
+ * @brief  Function enable or disable read-ahead of selected device file.
+ *         When read-ahead is enabled then sequential reads of device are
+ *         detected and next blocks are read to the cache in background by
+ *         read-ahead thread. Window of read-ahead is adaptive and limited by
+ *         free memory. Regular files are not supported.
+ *
+ * @param  file         device file
+ * @param  max_blocks   maximum read-ahead window [blocks] (0 to disable)
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int sys_cache_readahead(FILE *file, size_t max_blocks)
+{
+        if (!file) {
+                return EINVAL;
+        }
+
+#if __OS_SYSTEM_FS_CACHE_ENABLE__ > 0
+        struct stat stat;
+        int err = _vfs_fstat(file, &stat);
+        if (err) {
+                return err;
+        } else if (stat.st_type != FILE_TYPE_DRV) {
+                return ENOTSUP;
+        }
+
+        err = _mutex_lock(cman.list_mtx, MTX_TIMEOUT);
+        if (!err) {
+                if (max_blocks && !cman.ra_sem) {
+                        static const thread_attr_t attr = {
+                                .stack_depth = STACK_DEPTH_CUSTOM(__OS_IO_STACK_DEPTH__),
+                                .priority    = PRIORITY_NORMAL,
+                                .detached    = true
+                        };
+
+                        err = _semaphore_create(1, 0, &cman.ra_sem);
+                        if (!err) {
+                                err = _process_thread_create(_kworker_proc,
+                                                             readahead_thread,
+                                                             &attr, NULL, NULL);
+                                if (err) {
+                                        _semaphore_destroy(cman.ra_sem);
+                                        cman.ra_sem = NULL;
+                                }
+                        }
+                }
+
+                if (!err) {
+                        readahead_t *ra = readahead_get(stat.st_dev);
+
+                        for (size_t i = 0; !ra && max_blocks && i < READAHEAD_DEVICES; i++) {
+                                if (cman.ra[i].max_window == 0) {
+                                        ra = &cman.ra[i];
+                                }
+                        }
+
+                        if (ra) {
+                                memset(ra, 0, sizeof(readahead_t));
+                                ra->dev        = stat.st_dev;
+                                ra->max_window = max_blocks;
+
+                        } else if (max_blocks) {
+                                err = ENOSPC;
+                        }
+                }
+
+                _mutex_unlock(cman.list_mtx);
+        }
+
+        return err;
+#else
+        UNUSED_ARG1(max_blocks);
+        return ESUCC;
+#endif
+}
+
 //==============================================================================
 /**
  * @brief Function write block to selected file. If cache exist then block is
@@ -660,17 +1163,7 @@ int sys_cache_write(FILE *file, u32_t blkpos, size_t blksz, size_t blkcnt, const
                         err = _cache_write(stat.st_dev, blkpos, blksz, blkcnt, buf, mode);
 #else
                         UNUSED_ARG1(mode);
-
-                        fpos_t fpos  = cast(fpos_t, blkpos) * blksz;
-                        size_t wrcnt = 0;
-                        size_t wrsz  = blksz * blkcnt;
-                        struct vfs_fattr fattr = {false, false};
-
-                        err = _driver_write(stat.st_dev, buf, wrsz, &fpos, &wrcnt, fattr);
-
-                        if (!err && (wrcnt != wrsz) ) {
-                                err = EIO;
-                        }
+                        err = write_blocks(stat.st_dev, blkpos, blksz, blkcnt, buf);
 #endif
                 } else {
                         err = _vfs_fseek(file, cast(i64_t, blkpos) * blksz, VFS_SEEK_SET);
@@ -718,16 +1211,7 @@ int sys_cache_read(FILE *file, u32_t blkpos, size_t blksz, size_t blkcnt, u8_t *
 #if __OS_SYSTEM_FS_CACHE_ENABLE__ > 0
                         err = _cache_read(stat.st_dev, blkpos, blksz, blkcnt, buf);
 #else
-                        fpos_t fpos  = cast(fpos_t, blkpos) * blksz;
-                        size_t rdcnt = 0;
-                        size_t rdsz  = blksz * blkcnt;
-                        struct vfs_fattr fattr = {false, false};
-
-                        err = _driver_read(stat.st_dev, buf, rdsz, &fpos, &rdcnt, fattr);
-
-                        if (!err && (rdcnt != rdsz)) {
-                                err = EIO;
-                        }
+                        err = read_blocks(stat.st_dev, blkpos, blksz, blkcnt, buf);
 #endif
                 } else {
                         err = _vfs_fseek(file, cast(i64_t, blkpos) * blksz, VFS_SEEK_SET);
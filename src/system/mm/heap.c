@@ -67,6 +67,8 @@
 #include "kernel/errno.h"
 #include <string.h>
 
+#if __HEAP_ALLOCATOR__ == 0
+
 /*==============================================================================
   Local symbolic constants/macros
 ==============================================================================*/
@@ -435,6 +437,53 @@ size_t _heap_get_block_size(_heap_t *heap, void *rmem)
     return blksize;
 }
 
+//==============================================================================
+/**
+ * @brief  Function return heap statistics (fragmentation).
+ *
+ * @param  heap         heap object
+ * @param  stat         statistics
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _heap_get_stat(_heap_t *heap, _heap_stat_t *stat)
+{
+        if (!heap || !stat) {
+                return EINVAL;
+        }
+
+        memset(stat, 0, sizeof(_heap_stat_t));
+
+        _kernel_scheduler_lock();
+
+        for (struct mem *mem = (struct mem *)(void *)heap->begin;
+             mem < heap->end;
+             mem = (struct mem *)(void *)&heap->begin[mem->next]) {
+
+                if (!mem->used) {
+                        size_t size = mem->next - (size_t)((u8_t *)mem - heap->begin)
+                                    - SIZEOF_STRUCT_MEM;
+
+                        stat->free_blocks++;
+                        if (size > stat->largest_free) {
+                                stat->largest_free = size;
+                        }
+                }
+        }
+
+        stat->size     = heap->size;
+        stat->used     = heap->used;
+        stat->used_max = heap->used_max;
+        stat->free     = heap->size - heap->used;
+
+        _kernel_scheduler_unlock();
+
+        return ESUCC;
+}
+
+#endif
+
 /*==============================================================================
   End of file
 ==============================================================================*/
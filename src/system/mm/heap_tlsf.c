@@ -0,0 +1,683 @@
+/*=========================================================================*//**
+File     heap_tlsf.c
+
+Author   Daniel Zorychta
+
+Brief    Two-Level Segregated Fit (TLSF) heap allocator.
+
+         Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include "config.h"
+#include "mm/heap.h"
+#include "kernel/kwrapper.h"
+#include "kernel/errno.h"
+#include <string.h>
+
+#if __HEAP_ALLOCATOR__ == 1
+
+/*==============================================================================
+  Local symbolic constants/macros
+==============================================================================*/
+/**
+ * Calculate memory size for an aligned buffer.
+ */
+#define MEM_ALIGN_SIZE(size)            (((size) + _HEAP_ALIGN_ - 1) & ~(_HEAP_ALIGN_-1))
+
+/** alignment shift */
+#if _HEAP_ALIGN_ == 8
+#define ALIGN_SIZE_LOG2                 3
+#else
+#define ALIGN_SIZE_LOG2                 2
+#endif
+
+/** number of second level lists in each first level (log2) */
+#define SL_INDEX_COUNT_LOG2             3
+#define SL_INDEX_COUNT                  (1 << SL_INDEX_COUNT_LOG2)
+
+/** blocks smaller than SMALL_BLOCK_SIZE are stored in first level 0 */
+#define FL_INDEX_SHIFT                  (SL_INDEX_COUNT_LOG2 + ALIGN_SIZE_LOG2)
+#define SMALL_BLOCK_SIZE                (1 << FL_INDEX_SHIFT)
+
+/** block flags stored in size field */
+#define BLOCK_FREE_BIT                  (1 << 0)
+#define BLOCK_PREV_FREE_BIT             (1 << 1)
+
+/** block data starts after size field, previous physical block pointer is
+ *  stored in the last word of previous block (valid only if it is free) */
+#define BLOCK_OVERHEAD                  sizeof(size_t)
+#define BLOCK_START_OFFSET              (offsetof(block_t, size) + sizeof(size_t))
+#define BLOCK_SIZE_MIN                  (sizeof(block_t) - sizeof(block_t*))
+
+/** the smallest allocated data block */
+#define BLOCK_MIN_SIZE_ALIGNED          MEM_ALIGN_SIZE(__HEAP_BLOCK_SIZE__)
+
+/*==============================================================================
+  Local types, enums definitions
+==============================================================================*/
+/**
+ * Block header. Fields next_free and prev_free are valid only if block is
+ * free, otherwise are part of the block data.
+ */
+typedef struct block {
+        struct block *prev_phys;        /**< previous physical block (if free) */
+        size_t        size;             /**< block data size and flags        */
+        struct block *next_free;        /**< next free block in list          */
+        struct block *prev_free;        /**< previous free block in list      */
+} block_t;
+
+/**
+ * Allocator control structure. Object is located at the beginning of the heap
+ * region and arrays of lists are placed directly after it.
+ */
+struct tlsf {
+        block_t       null_block;       /**< end of free lists                */
+        block_t      *first;            /**< first physical block             */
+        size_t        fl_count;         /**< number of first level lists      */
+        u32_t         fl_bitmap;        /**< not empty first level lists      */
+        u32_t        *sl_bitmap;        /**< not empty second level lists     */
+        block_t     **blocks;           /**< heads of free lists              */
+};
+
+/*==============================================================================
+  Local function prototypes
+==============================================================================*/
+
+/*==============================================================================
+  Local object definitions
+==============================================================================*/
+
+/*==============================================================================
+  Exported object definitions
+==============================================================================*/
+
+/*==============================================================================
+  Function definitions
+==============================================================================*/
+
+//==============================================================================
+/**
+ * @brief  Find last (most significant) set bit.
+ */
+//==============================================================================
+static inline int bit_fls(size_t word)
+{
+        return word ? (31 - __builtin_clz(word)) : -1;
+}
+
+//==============================================================================
+/**
+ * @brief  Find first (least significant) set bit.
+ */
+//==============================================================================
+static inline int bit_ffs(u32_t word)
+{
+        return __builtin_ffs(word) - 1;
+}
+
+//==============================================================================
+/**
+ * @brief  Block helpers.
+ */
+//==============================================================================
+static inline size_t block_size(const block_t *block)
+{
+        return block->size & ~(BLOCK_FREE_BIT | BLOCK_PREV_FREE_BIT);
+}
+
+static inline void block_set_size(block_t *block, size_t size)
+{
+        block->size = size | (block->size & (BLOCK_FREE_BIT | BLOCK_PREV_FREE_BIT));
+}
+
+static inline bool block_is_last(const block_t *block)
+{
+        return block_size(block) == 0;
+}
+
+static inline bool block_is_free(const block_t *block)
+{
+        return block->size & BLOCK_FREE_BIT;
+}
+
+static inline bool block_is_prev_free(const block_t *block)
+{
+        return block->size & BLOCK_PREV_FREE_BIT;
+}
+
+static inline void *block_to_ptr(const block_t *block)
+{
+        return (u8_t *)block + BLOCK_START_OFFSET;
+}
+
+static inline block_t *block_from_ptr(const void *ptr)
+{
+        return (block_t *)((u8_t *)ptr - BLOCK_START_OFFSET);
+}
+
+static inline block_t *block_offset(const void *ptr, size_t offset)
+{
+        return (block_t *)((u8_t *)ptr + offset);
+}
+
+static inline block_t *block_next(const block_t *block)
+{
+        return block_offset(block_to_ptr(block), block_size(block) - BLOCK_OVERHEAD);
+}
+
+static inline block_t *block_link_next(block_t *block)
+{
+        block_t *next   = block_next(block);
+        next->prev_phys = block;
+        return next;
+}
+
+static inline void block_mark_as_free(block_t *block)
+{
+        block_t *next = block_link_next(block);
+        next->size   |= BLOCK_PREV_FREE_BIT;
+        block->size  |= BLOCK_FREE_BIT;
+}
+
+static inline void block_mark_as_used(block_t *block)
+{
+        block_t *next = block_next(block);
+        next->size   &= ~BLOCK_PREV_FREE_BIT;
+        block->size  &= ~BLOCK_FREE_BIT;
+}
+
+//==============================================================================
+/**
+ * @brief  Calculate list indexes of selected block size.
+ *
+ * @param  size         block size
+ * @param  fli          first level index
+ * @param  sli          second level index
+ */
+//==============================================================================
+static void mapping_insert(size_t size, int *fli, int *sli)
+{
+        if (size < SMALL_BLOCK_SIZE) {
+                *fli = 0;
+                *sli = size / (SMALL_BLOCK_SIZE / SL_INDEX_COUNT);
+        } else {
+                int fl = bit_fls(size);
+                *sli   = (size >> (fl - SL_INDEX_COUNT_LOG2)) ^ SL_INDEX_COUNT;
+                *fli   = fl - (FL_INDEX_SHIFT - 1);
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Calculate list indexes of the first list that contains blocks that
+ *         are big enough for selected size (size is rounded up to next list).
+ *
+ * @param  size         requested size
+ * @param  fli          first level index
+ * @param  sli          second level index
+ */
+//==============================================================================
+static void mapping_search(size_t size, int *fli, int *sli)
+{
+        if (size >= SMALL_BLOCK_SIZE) {
+                size += (1 << (bit_fls(size) - SL_INDEX_COUNT_LOG2)) - 1;
+        }
+
+        mapping_insert(size, fli, sli);
+}
+
+//==============================================================================
+/**
+ * @brief  Find free block in the first not empty list starting from selected
+ *         indexes.
+ *
+ * @param  ctl          allocator control
+ * @param  fli          first level index (updated)
+ * @param  sli          second level index (updated)
+ *
+ * @return Free block or NULL if not found.
+ */
+//==============================================================================
+static block_t *search_suitable_block(struct tlsf *ctl, int *fli, int *sli)
+{
+        int   fl     = *fli;
+        u32_t sl_map = ctl->sl_bitmap[fl] & (~0U << *sli);
+
+        if (!sl_map) {
+                u32_t fl_map = ctl->fl_bitmap & (~0U << (fl + 1));
+                if (!fl_map) {
+                        return NULL;
+                }
+
+                fl     = bit_ffs(fl_map);
+                *fli   = fl;
+                sl_map = ctl->sl_bitmap[fl];
+        }
+
+        int sl = bit_ffs(sl_map);
+        *sli   = sl;
+
+        return ctl->blocks[fl * SL_INDEX_COUNT + sl];
+}
+
+//==============================================================================
+/**
+ * @brief  Remove free block from selected list.
+ */
+//==============================================================================
+static void remove_free_block(struct tlsf *ctl, block_t *block, int fl, int sl)
+{
+        block_t *prev   = block->prev_free;
+        block_t *next   = block->next_free;
+        next->prev_free = prev;
+        prev->next_free = next;
+
+        block_t **head = &ctl->blocks[fl * SL_INDEX_COUNT + sl];
+
+        if (*head == block) {
+                *head = next;
+
+                if (next == &ctl->null_block) {
+                        ctl->sl_bitmap[fl] &= ~(1U << sl);
+
+                        if (!ctl->sl_bitmap[fl]) {
+                                ctl->fl_bitmap &= ~(1U << fl);
+                        }
+                }
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Insert free block to selected list.
+ */
+//==============================================================================
+static void insert_free_block(struct tlsf *ctl, block_t *block, int fl, int sl)
+{
+        block_t **head = &ctl->blocks[fl * SL_INDEX_COUNT + sl];
+
+        block->next_free       = *head;
+        block->prev_free       = &ctl->null_block;
+        (*head)->prev_free     = block;
+        *head                  = block;
+
+        ctl->fl_bitmap        |= (1U << fl);
+        ctl->sl_bitmap[fl]    |= (1U << sl);
+}
+
+static void block_remove(struct tlsf *ctl, block_t *block)
+{
+        int fl, sl;
+        mapping_insert(block_size(block), &fl, &sl);
+        remove_free_block(ctl, block, fl, sl);
+}
+
+static void block_insert(struct tlsf *ctl, block_t *block)
+{
+        int fl, sl;
+        mapping_insert(block_size(block), &fl, &sl);
+        insert_free_block(ctl, block, fl, sl);
+}
+
+//==============================================================================
+/**
+ * @brief  Split block and return remaining part.
+ */
+//==============================================================================
+static block_t *block_split(block_t *block, size_t size)
+{
+        block_t *remaining = block_offset(block_to_ptr(block), size - BLOCK_OVERHEAD);
+
+        remaining->size = block_size(block) - (size + BLOCK_OVERHEAD);
+        block_set_size(block, size);
+        block_mark_as_free(remaining);
+
+        return remaining;
+}
+
+//==============================================================================
+/**
+ * @brief  Merge block with previous physical block.
+ */
+//==============================================================================
+static block_t *block_absorb(block_t *prev, block_t *block)
+{
+        prev->size += block_size(block) + BLOCK_OVERHEAD;
+        block_link_next(prev);
+        return prev;
+}
+
+static block_t *block_merge_prev(struct tlsf *ctl, block_t *block)
+{
+        if (block_is_prev_free(block)) {
+                block_t *prev = block->prev_phys;
+                block_remove(ctl, prev);
+                block = block_absorb(prev, block);
+        }
+
+        return block;
+}
+
+static block_t *block_merge_next(struct tlsf *ctl, block_t *block)
+{
+        block_t *next = block_next(block);
+
+        if (block_is_free(next)) {
+                block_remove(ctl, next);
+                block = block_absorb(block, next);
+        }
+
+        return block;
+}
+
+//==============================================================================
+/**
+ * @brief  Return unused tail of free block to the free lists.
+ */
+//==============================================================================
+static void block_trim_free(struct tlsf *ctl, block_t *block, size_t size)
+{
+        if (block_size(block) >= sizeof(block_t) + size) {
+                block_t *remaining = block_split(block, size);
+                block_link_next(block);
+                remaining->size |= BLOCK_PREV_FREE_BIT;
+                block_insert(ctl, remaining);
+        }
+}
+
+//==============================================================================
+/**
+* @brief  Initialize heap: allocator control and one big free block.
+*
+* @param  heap          heap object
+* @param  start         memory start address
+* @param  size          memory size
+*
+* @return One of errno value.
+*/
+//==============================================================================
+int _heap_init(_heap_t *heap, void *start, size_t size)
+{
+        if (!heap || !start || !size) {
+                return EINVAL;
+        }
+
+        u8_t *begin = (u8_t *)MEM_ALIGN_SIZE((size_t)start);
+        u8_t *end   = (u8_t *)(((size_t)start + size) & ~(_HEAP_ALIGN_ - 1));
+
+        size_t   fl_count = bit_fls(end - begin) - FL_INDEX_SHIFT + 2;
+        size_t   ctl_size = MEM_ALIGN_SIZE(sizeof(struct tlsf))
+                          + MEM_ALIGN_SIZE(fl_count * sizeof(u32_t))
+                          + fl_count * SL_INDEX_COUNT * sizeof(block_t*);
+
+        u8_t    *pool      = begin + MEM_ALIGN_SIZE(ctl_size) + BLOCK_START_OFFSET;
+        ssize_t  pool_size = (end - pool) - BLOCK_START_OFFSET - BLOCK_OVERHEAD;
+        pool_size          = pool_size & ~(_HEAP_ALIGN_ - 1);
+
+        if ((pool_size < (ssize_t)BLOCK_SIZE_MIN) || (fl_count > 32)) {
+                return ENOMEM;
+        }
+
+        struct tlsf *ctl = (struct tlsf *)begin;
+        memset(ctl, 0, ctl_size);
+
+        ctl->null_block.next_free = &ctl->null_block;
+        ctl->null_block.prev_free = &ctl->null_block;
+        ctl->fl_count             = fl_count;
+        ctl->sl_bitmap            = (u32_t *)(begin + MEM_ALIGN_SIZE(sizeof(struct tlsf)));
+        ctl->blocks               = (block_t **)((u8_t *)ctl->sl_bitmap
+                                    + MEM_ALIGN_SIZE(fl_count * sizeof(u32_t)));
+
+        for (size_t i = 0; i < fl_count * SL_INDEX_COUNT; i++) {
+                ctl->blocks[i] = &ctl->null_block;
+        }
+
+        /* one big free block (previous block does not exist) */
+        block_t *block = block_from_ptr(pool);
+        block->size    = pool_size;
+        block_mark_as_free(block);
+        block_insert(ctl, block);
+        ctl->first     = block;
+
+        /* sentinel block at the end of heap */
+        block_t *last  = block_link_next(block);
+        last->size     = BLOCK_PREV_FREE_BIT;
+
+        heap->begin    = start;
+        heap->end      = (u8_t *)start + size;
+        heap->control  = ctl;
+        heap->size     = pool_size + BLOCK_OVERHEAD;
+        heap->used     = 0;
+        heap->used_max = 0;
+
+        return ESUCC;
+}
+
+//==============================================================================
+/**
+ * @brief  Put a block back on the heap.
+ *
+ * @param  heap         heap object
+ * @param  rmem         block returned by _heap_alloc()
+ * @param  freed        freed block size (can be NULL)
+ */
+//==============================================================================
+void _heap_free(_heap_t *heap, void *rmem, size_t *freed)
+{
+        if (heap && (u8_t *)rmem >= heap->begin && (u8_t *)rmem < heap->end) {
+
+                _kernel_scheduler_lock();
+
+                struct tlsf *ctl   = heap->control;
+                block_t     *block = block_from_ptr(rmem);
+
+                size_t blksize = block_size(block) + BLOCK_OVERHEAD;
+                heap->used    -= blksize;
+
+                if (freed) {
+                        *freed = blksize;
+                }
+
+                block_mark_as_free(block);
+                block = block_merge_prev(ctl, block);
+                block = block_merge_next(ctl, block);
+                block_insert(ctl, block);
+
+                _kernel_scheduler_unlock();
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Allocate a block of memory with a minimum of 'size' bytes.
+ *         Searching of free block takes constant time.
+ *
+ * @param  heap         heap object
+ * @param  size         is the minimum size of the requested block in bytes.
+ * @param  allocated    real size of allocated block (it can be bigger than size)
+
+ * @return Pointer to allocated memory or NULL if no free memory was found.
+ */
+//==============================================================================
+void *_heap_alloc(_heap_t *heap, size_t size, size_t *allocated)
+{
+        if (!heap || size == 0 || size > heap->size) {
+                return NULL;
+        }
+
+        size = MEM_ALIGN_SIZE(size);
+
+        if (size < BLOCK_MIN_SIZE_ALIGNED) {
+                size = BLOCK_MIN_SIZE_ALIGNED;
+        }
+
+        if (size < BLOCK_SIZE_MIN) {
+                size = BLOCK_SIZE_MIN;
+        }
+
+        void *ptr = NULL;
+
+        _kernel_scheduler_lock();
+
+        struct tlsf *ctl = heap->control;
+
+        int fl, sl;
+        mapping_search(size, &fl, &sl);
+
+        if (fl < (int)ctl->fl_count) {
+
+                block_t *block = search_suitable_block(ctl, &fl, &sl);
+
+                if (block != &ctl->null_block && block) {
+                        remove_free_block(ctl, block, fl, sl);
+                        block_trim_free(ctl, block, size);
+                        block_mark_as_used(block);
+
+                        size_t used    = block_size(block) + BLOCK_OVERHEAD;
+                        heap->used    += used;
+                        heap->used_max = heap->used_max < heap->used ? heap->used : heap->used_max;
+
+                        if (allocated) {
+                                *allocated = used;
+                        }
+
+                        ptr = block_to_ptr(block);
+                }
+        }
+
+        _kernel_scheduler_unlock();
+
+        return ptr;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return free heap
+ *
+ * @param  heap         heap object
+ *
+ * @return Free heap value
+ */
+//==============================================================================
+size_t _heap_get_free(_heap_t *heap)
+{
+        return (heap->size - heap->used);
+}
+
+//==============================================================================
+/**
+ * @brief  Function return used heap
+ *
+ * @param  heap         heap object
+ *
+ * @return Use heap value
+ */
+//==============================================================================
+size_t _heap_get_used(_heap_t *heap)
+{
+        return heap->used;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return heap size
+ *
+ * @param  heap         heap object
+ *
+ * @return Heap size
+ */
+//==============================================================================
+size_t _heap_get_size(_heap_t *heap)
+{
+        return heap->end - heap->begin;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return size of selected block
+ *
+ * @param  heap     heap object
+ * @param  rmem     memory block
+ *
+ * @return Block size, 0 on error
+ */
+//==============================================================================
+size_t _heap_get_block_size(_heap_t *heap, void *rmem)
+{
+        size_t blksize = 0;
+
+        if (heap && (u8_t *)rmem >= heap->begin && (u8_t *)rmem < heap->end) {
+                blksize = block_size(block_from_ptr(rmem)) + BLOCK_OVERHEAD;
+        }
+
+        return blksize;
+}
+
+//==============================================================================
+/**
+ * @brief  Function return heap statistics (fragmentation).
+ *
+ * @param  heap         heap object
+ * @param  stat         statistics
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _heap_get_stat(_heap_t *heap, _heap_stat_t *stat)
+{
+        if (!heap || !stat) {
+                return EINVAL;
+        }
+
+        memset(stat, 0, sizeof(_heap_stat_t));
+
+        _kernel_scheduler_lock();
+
+        struct tlsf *ctl = heap->control;
+
+        for (block_t *block = ctl->first; !block_is_last(block); block = block_next(block)) {
+                if (block_is_free(block)) {
+                        stat->free_blocks++;
+
+                        if (block_size(block) > stat->largest_free) {
+                                stat->largest_free = block_size(block);
+                        }
+                }
+        }
+
+        stat->size     = heap->size;
+        stat->used     = heap->used;
+        stat->used_max = heap->used_max;
+        stat->free     = heap->size - heap->used;
+
+        _kernel_scheduler_unlock();
+
+        return ESUCC;
+}
+
+#endif
+
+/*==============================================================================
+  End of file
+==============================================================================*/
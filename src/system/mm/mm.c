@@ -37,6 +37,7 @@
 #include "mm/heap.h"
 #include "mm/cache.h"
 #include "mm/shm.h"
+#include "mm/pool.h"
 #include "lib/cast.h"
 #include "kernel/errno.h"
 #include "kernel/ktypes.h"
@@ -79,22 +80,53 @@
  */
 #define IS_IN_HEAP(heap, mem)           ((mem) >= cast(void*, (heap).begin) && (mem) < (cast(void*, (heap).end)))
 
+/**
+ * Number of region ranks used by placement policy.
+ */
+#define REGION_RANKS                    3
+
 /*==============================================================================
   Local object types
 ==============================================================================*/
+/**
+ * Region placement policy. Regions are searched in order: regions that have
+ * all preferred attributes and no avoided attributes, then regions without
+ * avoided attributes, then the rest.
+ */
+typedef struct {
+        u8_t prefer;
+        u8_t avoid;
+} policy_t;
 
 /*==============================================================================
   Local function prototypes
 ==============================================================================*/
 static int kalloc(enum _mm_mem mpur, size_t size, bool clear, void **mem, void *arg);
+static int region_rank(const _mm_region_t *region, const policy_t *pol);
+static void *region_alloc(const policy_t *pol, size_t size, size_t *allocated);
 
 /*==============================================================================
   Local objects
 ==============================================================================*/
-static _mm_region_t memory_region;
+static _mm_region_t memory_region = {.attr = _MM_REGION_ATTR_FAST | _MM_REGION_ATTR_DMA};
 static i32_t        memory_usage[_MM_COUNT - 1];
 static i32_t       *module_memory_usage;
 
+/**
+ * Placement policy of each memory purpose. Kernel and network objects are
+ * hot so fast RAM is preferred. Bulk buffers (programs, shared memory, cache)
+ * are placed in large slow RAM if available to leave fast RAM for the rest.
+ */
+static const policy_t policy[_MM_COUNT] = {
+        [_MM_KRN]   = {.prefer = _MM_REGION_ATTR_FAST,                        .avoid = 0},
+        [_MM_FS]    = {.prefer = 0,                                           .avoid = 0},
+        [_MM_NET]   = {.prefer = _MM_REGION_ATTR_FAST | _MM_REGION_ATTR_DMA,  .avoid = 0},
+        [_MM_PROG]  = {.prefer = _MM_REGION_ATTR_LARGE,                       .avoid = _MM_REGION_ATTR_FAST},
+        [_MM_SHM]   = {.prefer = _MM_REGION_ATTR_LARGE,                       .avoid = _MM_REGION_ATTR_FAST},
+        [_MM_CACHE] = {.prefer = _MM_REGION_ATTR_LARGE,                       .avoid = _MM_REGION_ATTR_FAST},
+        [_MM_MOD]   = {.prefer = _MM_REGION_ATTR_DMA,                         .avoid = 0},
+};
+
 /*==============================================================================
   Exported objects
 ==============================================================================*/
@@ -148,11 +180,12 @@ int _mm_init(void)
  * @param  region       region to register
  * @param  start        region start address
  * @param  size         region size
+ * @param  attr         region attributes (enum _mm_region_attr)
  *
  * @return One of errno values.
  */
 //==============================================================================
-int _mm_register_region(_mm_region_t *region, void *start, size_t size)
+int _mm_register_region(_mm_region_t *region, void *start, size_t size, u8_t attr)
 {
         int err = EINVAL;
 
@@ -168,6 +201,7 @@ int _mm_register_region(_mm_region_t *region, void *start, size_t size)
                 for (_mm_region_t *r = &memory_region; r; r = r->next) {
                         if (r->next == NULL) {
                                 region->next = NULL;
+                                region->attr = attr;
                                 err = _heap_init(&region->heap, start, size);
                                 if (!err) {
                                         r->next = region;
@@ -262,6 +296,8 @@ int _kfree(enum _mm_mem mpur, void **mem, ...)
                                 usage = arg;
                                 err   = ESUCC;
                                 (*cast(res_header_t**, mem))->next = NULL;
+                                (*cast(res_header_t**, mem))->prev = NULL;
+                                (*cast(res_header_t**, mem))->owner = NULL;
                                 (*cast(res_header_t**, mem))->type = RES_TYPE_UNKNOWN;
                         } else {
                                 err = EFAULT;
@@ -322,6 +358,7 @@ int _mm_get_mem_usage_details(_mm_mem_usage_t *mem_usage)
                 mem_usage->programs_memory_usage    = memory_usage[_MM_PROG];
                 mem_usage->shared_memory_usage      = memory_usage[_MM_SHM];
                 mem_usage->cached_memory_usage      = memory_usage[_MM_CACHE];
+                mem_usage->pools_memory_usage       = _mm_pool_get_memory_usage();
                 mem_usage->modules_memory_usage     = 0;
 
                 for (size_t i = 0; i < _drvreg_number_of_modules; i++) {
@@ -428,6 +465,121 @@ size_t _mm_get_mem_size(void)
         return ramsize;
 }
 
+//==============================================================================
+/**
+ * @brief  Return statistics of selected memory region.
+ *
+ * @param  n            region number
+ * @param  stat         region statistics
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _mm_get_region_stat(size_t n, _mm_region_stat_t *stat)
+{
+        if (!stat) {
+                return EINVAL;
+        }
+
+        for (_mm_region_t *r = &memory_region; r; r = r->next) {
+                if (n-- == 0) {
+                        stat->start = r->heap.begin;
+                        stat->attr  = r->attr;
+                        return _heap_get_stat(&r->heap, &stat->heap);
+                }
+        }
+
+        return ENOENT;
+}
+
+//==============================================================================
+/**
+ * @brief  Return heap statistics of all memory regions. Field largest_free
+ *         is the largest free block found in any region.
+ *
+ * @param  stat         heap statistics
+ *
+ * @return One of errno value.
+ */
+//==============================================================================
+int _mm_get_heap_stat(_heap_stat_t *stat)
+{
+        if (!stat) {
+                return EINVAL;
+        }
+
+        memset(stat, 0, sizeof(_heap_stat_t));
+
+        for (_mm_region_t *r = &memory_region; r; r = r->next) {
+                _heap_stat_t rstat;
+                if (_heap_get_stat(&r->heap, &rstat) == ESUCC) {
+                        stat->size        += rstat.size;
+                        stat->used        += rstat.used;
+                        stat->used_max    += rstat.used_max;
+                        stat->free        += rstat.free;
+                        stat->free_blocks += rstat.free_blocks;
+
+                        if (rstat.largest_free > stat->largest_free) {
+                                stat->largest_free = rstat.largest_free;
+                        }
+                }
+        }
+
+        return ESUCC;
+}
+
+//==============================================================================
+/**
+ * @brief  Return rank of region for selected placement policy. Regions with
+ *         lower rank are used first.
+ *
+ * @param  region       region
+ * @param  pol          placement policy
+ *
+ * @return Region rank.
+ */
+//==============================================================================
+static int region_rank(const _mm_region_t *region, const policy_t *pol)
+{
+        if (region->attr & pol->avoid) {
+                return 2;
+        } else if ((region->attr & pol->prefer) == pol->prefer) {
+                return 0;
+        } else {
+                return 1;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Allocate block in regions selected by placement policy.
+ *
+ * @param[in]  pol              placement policy
+ * @param[in]  size             block size
+ * @param[out] allocated        allocated block size
+ *
+ * @return Allocated block or NULL if there is no free memory.
+ */
+//==============================================================================
+static void *region_alloc(const policy_t *pol, size_t size, size_t *allocated)
+{
+        for (int rank = 0; rank < REGION_RANKS; rank++) {
+                for (_mm_region_t *r = &memory_region; r; r = r->next) {
+
+                        if (  (region_rank(r, pol) == rank)
+                           && (_heap_get_free(&r->heap) >= size) ) {
+
+                                void *blk = _heap_alloc(&r->heap, size, allocated);
+                                if (blk) {
+                                        return blk;
+                                }
+                        }
+                }
+        }
+
+        return NULL;
+}
+
 //==============================================================================
 /**
  * @brief  Allocate memory
@@ -500,45 +652,37 @@ static int kalloc(enum _mm_mem mpur, size_t size, bool clear, void **mem, void *
 
                 for (int try = 0; try <= 1; try++) {
                         size_t allocated = 0;
-                        void  *blk       = NULL;
-
-                        for (_mm_region_t *r = &memory_region; r; r = r->next) {
-                                if (_heap_get_free(&r->heap) >= size) {
-
-                                        blk = _heap_alloc(&r->heap, size, &allocated);
+                        void  *blk       = region_alloc(&policy[mpur], size, &allocated);
 
-                                        if (blk) {
-                                                _kernel_scheduler_lock();
-                                                *usage += allocated;
-                                                _kernel_scheduler_unlock();
+                        if (blk) {
+                                _kernel_scheduler_lock();
+                                *usage += allocated;
+                                _kernel_scheduler_unlock();
 
-                                                if (clear) {
-                                                        memset(blk, 0, size);
-                                                }
+                                if (clear) {
+                                        memset(blk, 0, size);
+                                }
 
-                                                if (mpur == _MM_PROG) {
-                                                         cast(res_header_t*, blk)->next = NULL;
-                                                         cast(res_header_t*, blk)->type = RES_TYPE_MEMORY;
-                                                }
+                                if (mpur == _MM_PROG) {
+                                         cast(res_header_t*, blk)->next = NULL;
+                                         cast(res_header_t*, blk)->prev = NULL;
+                                         cast(res_header_t*, blk)->type = RES_TYPE_MEMORY;
+                                }
 
-                                                *mem = blk;
+                                *mem = blk;
 
-                                                err = ESUCC;
-                                                goto finish;
-                                        }
-                                }
+                                err = ESUCC;
+                                goto finish;
                         }
 
-                        if (!blk) {
-                                err = ENOMEM;
+                        err = ENOMEM;
 
-                                if (mpur == _MM_CACHE) {
-                                        break;
+                        if (mpur == _MM_CACHE) {
+                                break;
 
-                                } else {
-                                        if (try == 0) {
-                                                _cache_reduce(size);
-                                        }
+                        } else {
+                                if (try == 0) {
+                                        _cache_reduce(size);
                                 }
                         }
                 }
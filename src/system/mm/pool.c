@@ -0,0 +1,290 @@
+/*=========================================================================*//**
+File     pool.c
+
+Author   Daniel Zorychta
+
+Brief    Fixed-size object pools.
+
+         Copyright (C) 2017 Daniel Zorychta <daniel.zorychta@gmail.com>
+
+         This program is free software; you can redistribute it and/or modify
+         it under the terms of the GNU General Public License as published by
+         the Free Software Foundation and modified by the dnx RTOS exception.
+
+         NOTE: The modification  to the GPL is  included to allow you to
+               distribute a combined work that includes dnx RTOS without
+               being obliged to provide the source  code for proprietary
+               components outside of the dnx RTOS.
+
+         The dnx RTOS  is  distributed  in the hope  that  it will be useful,
+         but WITHOUT  ANY  WARRANTY;  without  even  the implied  warranty of
+         MERCHANTABILITY  or  FITNESS  FOR  A  PARTICULAR  PURPOSE.  See  the
+         GNU General Public License for more details.
+
+         Full license text is available on the following file: doc/license.txt.
+
+
+*//*==========================================================================*/
+
+/*==============================================================================
+  Include files
+==============================================================================*/
+#include <string.h>
+#include "config.h"
+#include "mm/pool.h"
+#include "mm/mm.h"
+#include "lib/cast.h"
+#include "kernel/errno.h"
+#include "kernel/kwrapper.h"
+
+/*==============================================================================
+  Local macros
+==============================================================================*/
+#define SLAB_SIZE(_pool)                ((size_t)(_pool)->objsize * (_pool)->count)
+
+#define IS_IN_SLAB(_pool, _obj)         (  (_pool)->slab\
+                                        && (cast(u8_t*, _obj) >= cast(u8_t*, (_pool)->slab))\
+                                        && (cast(u8_t*, _obj) <  cast(u8_t*, (_pool)->slab) + SLAB_SIZE(_pool)))
+
+/*==============================================================================
+  Local object types
+==============================================================================*/
+/** free object (list item stored in object memory) */
+typedef struct free_obj {
+        struct free_obj *next;
+} free_obj_t;
+
+/*==============================================================================
+  Local function prototypes
+==============================================================================*/
+
+/*==============================================================================
+  Local objects
+==============================================================================*/
+/** list of pools with allocated slab */
+static _mm_pool_t *pool_list;
+
+/*==============================================================================
+  Exported objects
+==============================================================================*/
+
+/*==============================================================================
+  External objects
+==============================================================================*/
+
+/*==============================================================================
+  Function definitions
+==============================================================================*/
+
+//==============================================================================
+/**
+ * @brief  Function allocate pool slab and build list of free objects. Slab is
+ *         allocated out of scheduler lock because of cache reduction. If other
+ *         thread allocate slab in the meantime then new slab is freed.
+ *
+ * @param  pool         pool
+ */
+//==============================================================================
+static void slab_create(_mm_pool_t *pool)
+{
+        void *slab = NULL;
+
+        if (_kmalloc(pool->mpur, SLAB_SIZE(pool), &slab) == ESUCC) {
+
+                bool used = false;
+
+                _kernel_scheduler_lock();
+
+                if (pool->slab == NULL) {
+                        free_obj_t *list = NULL;
+
+                        for (int i = pool->count - 1; i >= 0; i--) {
+                                free_obj_t *obj = cast(free_obj_t*,
+                                                       cast(u8_t*, slab)
+                                                       + (i * pool->objsize));
+                                obj->next = list;
+                                list      = obj;
+                        }
+
+                        pool->free_obj = list;
+                        pool->slab     = slab;
+                        pool->next     = pool_list;
+                        pool_list      = pool;
+                        used           = true;
+                }
+
+                _kernel_scheduler_unlock();
+
+                if (!used) {
+                        _kfree(pool->mpur, &slab);
+                }
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Allocate object from selected pool. If pool is exhausted then
+ *         object is allocated from the heap.
+ *
+ * @param[in]  pool             pool
+ * @param[out] obj              pointer to object pointer
+ *
+ * @return One of errno values.
+ */
+//==============================================================================
+int _mm_pool_alloc(_mm_pool_t *pool, void **obj)
+{
+        if (!pool || !obj) {
+                return EINVAL;
+        }
+
+        if (pool->count && !pool->slab) {
+                slab_create(pool);
+        }
+
+        free_obj_t *fobj = NULL;
+
+        _kernel_scheduler_lock();
+
+        fobj = pool->free_obj;
+
+        if (fobj) {
+                pool->free_obj = fobj->next;
+
+                if (++pool->used > pool->used_max) {
+                        pool->used_max = pool->used;
+                }
+        } else {
+                pool->fallbacks++;
+        }
+
+        _kernel_scheduler_unlock();
+
+        if (fobj) {
+                *obj = fobj;
+                return ESUCC;
+        } else {
+                return _kmalloc(pool->mpur, pool->objsize, obj);
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Allocate object from selected pool and clear it.
+ *
+ * @param[in]  pool             pool
+ * @param[out] obj              pointer to object pointer
+ *
+ * @return One of errno values.
+ */
+//==============================================================================
+int _mm_pool_zalloc(_mm_pool_t *pool, void **obj)
+{
+        int err = _mm_pool_alloc(pool, obj);
+        if (!err) {
+                memset(*obj, 0, pool->objsize);
+        }
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief  Free object allocated by _mm_pool_alloc(). Object pointer is set
+ *         to NULL.
+ *
+ * @param[in]     pool          pool
+ * @param[in,out] obj           pointer to object pointer
+ *
+ * @return One of errno values.
+ */
+//==============================================================================
+int _mm_pool_free(_mm_pool_t *pool, void **obj)
+{
+        if (!pool || !obj || !*obj) {
+                return EINVAL;
+        }
+
+        if (IS_IN_SLAB(pool, *obj)) {
+                _kernel_scheduler_lock();
+
+                free_obj_t *fobj = *obj;
+                fobj->next       = pool->free_obj;
+                pool->free_obj   = fobj;
+                pool->used--;
+
+                _kernel_scheduler_unlock();
+
+                *obj = NULL;
+
+                return ESUCC;
+
+        } else {
+                return _kfree(pool->mpur, obj);
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Return statistics of selected pool. Only pools that are in use
+ *         (slab allocated) are listed.
+ *
+ * @param  n            pool number
+ * @param  stat         statistics
+ *
+ * @return One of errno values.
+ */
+//==============================================================================
+int _mm_pool_get_stat(size_t n, _mm_pool_stat_t *stat)
+{
+        if (!stat) {
+                return EINVAL;
+        }
+
+        int err = ENOENT;
+
+        _kernel_scheduler_lock();
+
+        for (_mm_pool_t *pool = pool_list; pool; pool = pool->next) {
+                if (n-- == 0) {
+                        stat->name         = pool->name;
+                        stat->object_size  = pool->objsize;
+                        stat->object_count = pool->count;
+                        stat->used         = pool->used;
+                        stat->used_max     = pool->used_max;
+                        stat->fallbacks    = pool->fallbacks;
+                        err                = ESUCC;
+                        break;
+                }
+        }
+
+        _kernel_scheduler_unlock();
+
+        return err;
+}
+
+//==============================================================================
+/**
+ * @brief  Return memory reserved by all pool slabs.
+ *
+ * @return Memory size in bytes.
+ */
+//==============================================================================
+size_t _mm_pool_get_memory_usage(void)
+{
+        size_t size = 0;
+
+        _kernel_scheduler_lock();
+
+        for (_mm_pool_t *pool = pool_list; pool; pool = pool->next) {
+                size += SLAB_SIZE(pool);
+        }
+
+        _kernel_scheduler_unlock();
+
+        return size;
+}
+
+/*==============================================================================
+  End of file
+==============================================================================*/
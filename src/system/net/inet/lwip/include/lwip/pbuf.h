@@ -41,8 +41,10 @@ extern "C" {
 #endif
 
 /** Currently, the pbuf_custom code is only needed for one specific configuration
- * of IP_FRAG */
+ * of IP_FRAG (can be enabled by port e.g. for zero-copy network drivers) */
+#ifndef LWIP_SUPPORT_CUSTOM_PBUF
 #define LWIP_SUPPORT_CUSTOM_PBUF (IP_FRAG && !IP_FRAG_USES_STATIC_BUF && !LWIP_NETIF_TX_SINGLE_PBUF)
+#endif
 
 #define PBUF_TRANSPORT_HLEN 20
 #define PBUF_IP_HLEN        20
@@ -37,18 +37,53 @@
 /*==============================================================================
   Local macros
 ==============================================================================*/
+#if __NETWORK_NETIF_ZERO_COPY__ > 0
+#define RX_PBUF_COUNT           __NETWORK_NETIF_ZERO_COPY_RX_BUFFERS__
+#define RX_BATCH_SIZE           8
+
+#if ETH_PAD_SIZE != 0
+#error Zero-copy interface requires ETH_PAD_SIZE equal to 0
+#endif
+#endif
 
 /*==============================================================================
   Local object types
 ==============================================================================*/
+#if __NETWORK_NETIF_ZERO_COPY__ > 0
+/* custom pbuf that holds buffer exchanged with Ethernet DMA */
+typedef struct rx_pbuf {
+        struct pbuf_custom  pbuf;
+        struct rx_pbuf     *next;
+        void               *buffer;
+} rx_pbuf_t;
+
+/* pre-allocated Rx pbufs and buffers of Ethernet DMA ring */
+typedef struct {
+        rx_pbuf_t              *free;
+        ETHMAC_packet_buffer_t *ring;
+        u16_t                   ring_size;
+        bool                    attached;
+        rx_pbuf_t               rx_pbuf[RX_PBUF_COUNT];
+        u32_t                   buffer[RX_PBUF_COUNT][ETHMAC_PACKET_BUFFER_SIZE / sizeof(u32_t)];
+} rx_pool_t;
+#endif
 
 /*==============================================================================
   Local function prototypes
 ==============================================================================*/
+#if __NETWORK_NETIF_ZERO_COPY__ > 0
+static void rx_pbuf_free(struct pbuf *p);
+static void tx_pbuf_release(ETHMAC_packet_chain_t *packet);
+static void attach_rx_buffers(inet_t *inet);
+static void detach_rx_buffers(inet_t *inet);
+#endif
 
 /*==============================================================================
   Local objects
 ==============================================================================*/
+#if __NETWORK_NETIF_ZERO_COPY__ > 0
+static rx_pool_t *rx_pool;
+#endif
 
 /*==============================================================================
   Exported objects
@@ -77,6 +112,28 @@
 //==============================================================================
 int _inetdrv_hardware_init(inet_t *inet)
 {
+#if __NETWORK_NETIF_ZERO_COPY__ > 0
+        /* allocate Rx pbufs (memory is never released because pbufs can be
+           still used by the stack when interface is stopped) */
+        if (rx_pool == NULL) {
+                int err = _kzalloc(_MM_NET, sizeof(rx_pool_t), cast(void**, &rx_pool));
+                if (err) {
+                        LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_inet_port_hardware_init: no memory for Rx pbufs\n"));
+                        return err;
+                }
+
+                for (int i = 0; i < RX_PBUF_COUNT; i++) {
+                        rx_pbuf_t *rxp = &rx_pool->rx_pbuf[i];
+                        rxp->pbuf.custom_free_function = rx_pbuf_free;
+                        rxp->buffer = rx_pool->buffer[i];
+                        rxp->next   = rx_pool->free;
+                        rx_pool->free = rxp;
+                }
+        }
+
+        attach_rx_buffers(inet);
+#endif
+
         /* set MAC address */
         int err = sys_ioctl(inet->if_file, IOCTL_ETHMAC__SET_MAC_ADDR, inet->netif.hwaddr);
         if (err) {
@@ -111,10 +168,206 @@ int _inetdrv_hardware_deinit(inet_t *inet)
         if (err) {
                 LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_inet_port_hardware_deinit: stop fail\n"));
         }
+#if __NETWORK_NETIF_ZERO_COPY__ > 0
+        else {
+                detach_rx_buffers(inet);
+        }
+#endif
 
         return err;
 }
 
+#if __NETWORK_NETIF_ZERO_COPY__ > 0
+//==============================================================================
+/**
+ * @brief  Function receive packets from the network interface (zero-copy).
+ *         Free Rx pbufs buffers are exchanged with buffers of received packets
+ *         in Ethernet DMA ring. All pending packets (up to batch size) are
+ *         received by single request. Function receives packets until timeout.
+ *
+ * @param  inet                 inet container
+ * @param  input_timeout        packet receive timeout
+ *
+ * @note   Called from network interface thread.
+ */
+//==============================================================================
+void _inetdrv_handle_input(inet_t *inet, u32_t timeout)
+{
+        rx_pbuf_t             *rxp[RX_BATCH_SIZE];
+        ETHMAC_packet_buffer_t pkt[RX_BATCH_SIZE];
+        ETHMAC_packet_batch_t  batch;
+
+        do {
+                /* take free pbufs */
+                u16_t n = 0;
+
+                sys_critical_section_begin();
+                while (n < RX_BATCH_SIZE && rx_pool->free) {
+                        rxp[n]         = rx_pool->free;
+                        rx_pool->free  = rxp[n]->next;
+                        pkt[n].buffer  = rxp[n]->buffer;
+                        pkt[n].size    = 0;
+                        n++;
+                }
+                sys_critical_section_end();
+
+                if (n == 0) {
+                        LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_netman_handle_input: no free Rx pbufs\n"));
+                        sys_sleep_ms(10);
+                        break;
+                }
+
+                /* receive packets */
+                batch.packet  = pkt;
+                batch.count   = n;
+                batch.timeout = timeout;
+
+                if (sys_ioctl(inet->if_file, IOCTL_ETHMAC__RECEIVE_PACKETS_ZERO_COPY, &batch) != 0) {
+                        LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_netman_handle_input: receive error\n"));
+                        batch.count = 0;
+                }
+
+                /* pass packets to the stack, return not used pbufs */
+                for (u16_t i = 0; i < n; i++) {
+                        if (i < batch.count) {
+                                LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_netman_handle_input: packet size = %d\n", pkt[i].size));
+
+                                rxp[i]->buffer = pkt[i].buffer;
+
+                                struct pbuf *p = pbuf_alloced_custom(PBUF_RAW, pkt[i].size,
+                                                                     PBUF_REF, &rxp[i]->pbuf,
+                                                                     rxp[i]->buffer,
+                                                                     ETHMAC_PACKET_BUFFER_SIZE);
+
+                                if (inet->netif.input(p, &inet->netif) != ERR_OK) {
+                                        pbuf_free(p);
+                                } else {
+                                        inet->rx_packets++;
+                                        inet->rx_bytes += pkt[i].size;
+                                }
+                        } else {
+                                rx_pbuf_free(&rxp[i]->pbuf.pbuf);
+                        }
+                }
+
+        } while (batch.count > 0);
+
+        LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_netman_handle_input: packet receive timeout\n"));
+}
+
+//==============================================================================
+/**
+ * @brief  Function return Rx pbuf to the pool (custom pbuf free function).
+ *
+ * @param  p            pbuf to release
+ *
+ * @note   Called from any thread that release pbuf.
+ */
+//==============================================================================
+static void rx_pbuf_free(struct pbuf *p)
+{
+        rx_pbuf_t *rxp = cast(rx_pbuf_t*, p);
+
+        sys_critical_section_begin();
+        rxp->next     = rx_pool->free;
+        rx_pool->free = rxp;
+        sys_critical_section_end();
+}
+
+//==============================================================================
+/**
+ * @brief  Function release pbuf sent in zero-copy mode.
+ *
+ * @param  packet       packet chain (pbuf)
+ *
+ * @note   Called by driver from TCPIP thread.
+ */
+//==============================================================================
+static void tx_pbuf_release(ETHMAC_packet_chain_t *packet)
+{
+        pbuf_free(cast(struct pbuf*, packet));
+}
+
+//==============================================================================
+/**
+ * @brief  Function gives port buffers to Ethernet DMA ring, so all buffers
+ *         exchanged by zero-copy receive belong to the port. Buffers are
+ *         allocated once and are never released. If driver does not accept
+ *         the buffers then packets are copied from driver's buffers.
+ *
+ * @param  inet         inet container
+ *
+ * @note   Called from network interface thread before Ethernet start.
+ */
+//==============================================================================
+static void attach_rx_buffers(inet_t *inet)
+{
+        ETHMAC_packet_batch_t batch;
+
+        if (rx_pool->ring == NULL) {
+                /* too small table, request returns size of DMA ring */
+                batch.packet = NULL;
+                batch.count  = 0;
+                sys_ioctl(inet->if_file, IOCTL_ETHMAC__SET_RX_BUFFERS, &batch);
+
+                if (batch.count == 0) {
+                        return;
+                }
+
+                int err = _kzalloc(_MM_NET, batch.count * sizeof(ETHMAC_packet_buffer_t),
+                                   cast(void**, &rx_pool->ring));
+                if (err) {
+                        LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_inet_port_hardware_init: no memory for DMA ring\n"));
+                        return;
+                }
+
+                rx_pool->ring_size = batch.count;
+        }
+
+        /* buffers are missing when driver was released with attached buffers */
+        for (u16_t i = 0; i < rx_pool->ring_size; i++) {
+                if (rx_pool->ring[i].buffer == NULL) {
+                        int err = _kmalloc(_MM_NET, ETHMAC_PACKET_BUFFER_SIZE,
+                                           &rx_pool->ring[i].buffer);
+                        if (err) {
+                                LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_inet_port_hardware_init: no memory for DMA ring\n"));
+                                return;
+                        }
+                }
+        }
+
+        /* driver's own buffers are returned as NULL */
+        batch.packet = rx_pool->ring;
+        batch.count  = rx_pool->ring_size;
+
+        if (sys_ioctl(inet->if_file, IOCTL_ETHMAC__SET_RX_BUFFERS, &batch) == 0) {
+                rx_pool->attached = true;
+        }
+}
+
+//==============================================================================
+/**
+ * @brief  Function takes port buffers back from stopped Ethernet DMA ring.
+ *
+ * @param  inet         inet container
+ *
+ * @note   Called from network interface thread after Ethernet stop.
+ */
+//==============================================================================
+static void detach_rx_buffers(inet_t *inet)
+{
+        if (rx_pool && rx_pool->attached) {
+                /* NULL entries restore driver's own buffers */
+                ETHMAC_packet_batch_t batch;
+                batch.packet = rx_pool->ring;
+                batch.count  = rx_pool->ring_size;
+
+                if (sys_ioctl(inet->if_file, IOCTL_ETHMAC__SET_RX_BUFFERS, &batch) == 0) {
+                        rx_pool->attached = false;
+                }
+        }
+}
+#else
 //==============================================================================
 /**
  * @brief  Function receive packet from the network interface.
@@ -169,6 +422,7 @@ void _inetdrv_handle_input(inet_t *inet, u32_t timeout)
 
         LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_netman_handle_input: packet receive timeout\n"));
 }
+#endif
 
 //==============================================================================
 /**
@@ -194,6 +448,26 @@ err_t _inetdrv_handle_output(struct netif *netif, struct pbuf *p)
 {
       inet_t *inet = netif->state;
 
+#if __NETWORK_NETIF_ZERO_COPY__ > 0
+      /* pbuf is referenced by DMA until driver release it */
+      pbuf_ref(p);
+
+      ETHMAC_packet_zero_copy_t zc;
+      zc.packet  = cast(ETHMAC_packet_chain_t*, p);
+      zc.release = tx_pbuf_release;
+
+      u16_t tot_len = p->tot_len;
+
+      if (sys_ioctl(inet->if_file, IOCTL_ETHMAC__SEND_PACKET_ZERO_COPY, &zc) == 0) {
+              inet->tx_packets++;
+              inet->tx_bytes += tot_len;
+              return ERR_OK;
+      } else {
+              pbuf_free(p);
+              LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_netman_handle_output: packet send error\n"));
+              return ERR_IF;
+      }
+#else
       if (sys_ioctl(inet->if_file, IOCTL_ETHMAC__SEND_PACKET_FROM_CHAIN, p) == 0) {
               inet->tx_packets++;
               inet->tx_bytes += p->tot_len;
@@ -202,6 +476,7 @@ err_t _inetdrv_handle_output(struct netif *netif, struct pbuf *p)
               LWIP_DEBUGF(LOW_LEVEL_DEBUG, ("_netman_handle_output: packet send error\n"));
               return ERR_IF;
       }
+#endif
 }
 
 //==============================================================================
@@ -967,6 +967,12 @@ static inline void *_netcalloc(size_t count, size_t size)
  */
 #define LWIP_NETIF_TX_SINGLE_PBUF               0
 
+/**
+ * LWIP_SUPPORT_CUSTOM_PBUF==1: custom pbufs are used by zero-copy network
+ * interface driver (Rx buffers exchanged with Ethernet DMA).
+ */
+#define LWIP_SUPPORT_CUSTOM_PBUF                (IP_FRAG || __NETWORK_NETIF_ZERO_COPY__)
+
 /*
    ------------------------------------
    ---------- LOOPIF options ----------
@@ -33,11 +33,16 @@ Brief    Network management.
 #include "net/inet/inet.h"
 #include "cpuctl.h"
 #include "kernel/sysfunc.h"
+#include "mm/pool.h"
 
 /*==============================================================================
   Local macros
 ==============================================================================*/
 #define MAXIMUM_SAFE_UDP_PAYLOAD                508
+#define SOCKET_POOL_SIZE                        4
+
+/* size of socket object with context of the biggest family */
+#define SOCKET_OBJ_SIZE                         (_mm_align(sizeof(SOCKET)) + _mm_align(sizeof(INET_socket_t)))
 
 #define PROXY_TABLE                             static const proxy_func_t proxy[_NET_FAMILY__COUNT]
 #define PROXY_ADD_FAMILY(_family, _proxy_func)  [NET_FAMILY__##_family] = (proxy_func_t)_proxy_func
@@ -61,6 +66,7 @@ typedef int (*proxy_func_t)();
 /*==============================================================================
   Local objects
 ==============================================================================*/
+static _mm_pool_t socket_pool = _MM_POOL_INIT("SOCKET", _MM_NET, SOCKET_OBJ_SIZE, SOCKET_POOL_SIZE);
 
 /*==============================================================================
   Exported objects
@@ -84,13 +90,7 @@ typedef int (*proxy_func_t)();
 //==============================================================================
 static int socket_alloc(SOCKET **socket, NET_family_t family)
 {
-        static const uint8_t net_socket_size[_NET_FAMILY__COUNT] = {
-                [NET_FAMILY__INET] = _mm_align(sizeof(INET_socket_t)),
-        };
-
-        int err = _kzalloc(_MM_NET,
-                           _mm_align(sizeof(SOCKET)) + net_socket_size[family],
-                           cast(void**, socket));
+        int err = _mm_pool_zalloc(&socket_pool, cast(void**, socket));
         if (!err) {
                 (*socket)->header.type = RES_TYPE_SOCKET;
                 (*socket)->family      = family;
@@ -111,7 +111,7 @@ static int socket_alloc(SOCKET **socket, NET_family_t family)
 static void socket_free(SOCKET **socket)
 {
         (*socket)->header.type = RES_TYPE_UNKNOWN;
-        _kfree(_MM_NET, cast(void**, socket));
+        _mm_pool_free(&socket_pool, cast(void**, socket));
         *socket = NULL;
 }
 
@@ -90,8 +90,8 @@ void _cpuctl_init(void)
         _cpuctl_init_CPU_load_counter();
         #endif
 
-        _mm_register_region(&ram2, RAM2_START, RAM2_SIZE);
-        _mm_register_region(&ram3, RAM3_START, RAM3_SIZE);
+        _mm_register_region(&ram2, RAM2_START, RAM2_SIZE, _MM_REGION_ATTR_FAST | _MM_REGION_ATTR_DMA);
+        _mm_register_region(&ram3, RAM3_START, RAM3_SIZE, _MM_REGION_ATTR_FAST | _MM_REGION_ATTR_DMA);
 }
 
 //==============================================================================
@@ -173,6 +173,31 @@ u32_t _cpuctl_get_CPU_load_counter_delta(void)
 }
 #endif
 
+//==============================================================================
+/**
+ * @brief  Function return microsecond counter. Counter is calculated from
+ *         system tick counter and SysTick value. Function should be used in
+ *         thread context only (time measurement). Counter overflows after
+ *         ~71 minutes.
+ *
+ * @return Microsecond counter value.
+ */
+//==============================================================================
+u32_t _cpuctl_get_time_us(void)
+{
+        u32_t tick, val;
+
+        do {
+                tick = _kernel_get_tick_counter();
+                val  = SysTick->VAL;
+        } while (tick != _kernel_get_tick_counter());
+
+        u32_t load    = SysTick->LOAD + 1;
+        u32_t tick_us = 1000000 / (u32_t)__OS_TASK_SCHED_FREQ__;
+
+        return (tick * tick_us) + (u32_t)(((u64_t)(load - 1 - val) * tick_us) / load);
+}
+
 //==============================================================================
 /**
  * @brief  Function sleep CPU weakly. All IRQs must be able to wake up CPU.